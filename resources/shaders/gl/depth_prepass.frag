@@ -0,0 +1,5 @@
+#version 460
+
+// Depth only, color writes are masked off by the pass
+void main() {
+}
@@ -0,0 +1,19 @@
+#version 460
+
+layout(location = 0) in vec3 inPosition;
+
+layout(std140, binding = 0) uniform CameraData {
+   mat4 view;
+   mat4 proj;
+   vec3 viewPos;
+} camera;
+
+uniform mat4 model;
+
+// Same transform as the geometry pass, so the forward pass passes its depth equal test
+invariant gl_Position;
+
+void main() {
+   vec4 worldPos = model * vec4(inPosition, 1.0);
+   gl_Position = camera.proj * camera.view * worldPos;
+}
@@ -0,0 +1,195 @@
+#version 460
+
+#define PI 3.14159265358979
+
+// The depth prepass already resolved visibility, only the visible fragment of each pixel is shaded
+layout(early_fragment_tests) in;
+
+layout(location = 0) in vec3 fragPos;
+layout(location = 1) in vec3 fragNormal;
+layout(location = 2) in vec2 fragUV;
+
+layout(location = 0) out vec4 fragColor;
+
+struct LightData {
+   uint lightType; // 0 = Dir, 1 = Point, 2 = Spot
+   vec3 position;
+   vec3 direction;
+   vec3 color;
+   float intensity;
+   float constant;
+   float linear;
+   float quadratic;
+   float innerCone;
+   float outerCone;
+};
+
+layout(std140, binding = 0) uniform CameraData {
+   mat4 view;
+   mat4 proj;
+   vec3 viewPos;
+} camera;
+
+layout(std140, binding = 2) uniform MaterialData {
+   float ao;
+   float roughness;
+   float metallic;
+   vec3 albedo;
+} material;
+
+// Global lights (directional or unbounded) first, clusters index the rest
+layout(std430, binding = 1) readonly buffer LightsData {
+   LightData lights[];
+} lights;
+
+// Screen tiles by exponential depth slices, each cluster's lights are a range of lightIndices
+layout(std430, binding = 6) readonly buffer ClusterData {
+   uvec4 gridSize;     // xyz cluster counts, w global light count
+   vec4 depthSlicing;  // near, far, slice = log(depth) * z + w
+   uvec2 clusters[];   // offset, count
+} clusterData;
+
+layout(std430, binding = 7) readonly buffer LightIndexData {
+   uint lightIndices[];
+} lightIndexData;
+
+layout(binding = 0) uniform sampler2D albedoSampler;
+layout(binding = 1) uniform sampler2D normalSampler;
+layout(binding = 2) uniform sampler2D roughnessSampler;
+layout(binding = 3) uniform sampler2D metallicSampler;
+layout(binding = 4) uniform sampler2D aoSampler;
+
+// === Material Utility Functions ===
+
+mat3 computeTBN(vec3 N, vec2 uv, vec3 pos) {
+   vec3 dp1 = dFdx(pos);
+   vec3 dp2 = dFdy(pos);
+   vec2 duv1 = dFdx(uv);
+   vec2 duv2 = dFdy(uv);
+   vec3 T = normalize(duv2.y * dp1 - duv1.y * dp2);
+   vec3 B = normalize(-duv2.x * dp1 + duv1.x * dp2);
+   return mat3(T, B, N);
+}
+
+// === Clustering ===
+
+uint getClusterIndex(vec2 uv, float viewDepth) {
+   uvec3 grid = clusterData.gridSize.xyz;
+   uvec2 tile = min(uvec2(uv * vec2(grid.xy)), grid.xy - 1u);
+   float slice = log(max(viewDepth, clusterData.depthSlicing.x)) * clusterData.depthSlicing.z +
+                 clusterData.depthSlicing.w;
+   uint z = min(uint(max(slice, 0.0)), grid.z - 1u);
+   return tile.x + grid.x * (tile.y + grid.y * z);
+}
+
+// === PBR Functions ===
+
+vec3 fresnelSchlick(float cosTheta, vec3 F0) {
+   return F0 + (1.0 - F0) * pow(clamp(1.0 - cosTheta, 0.0, 1.0), 5.0);
+}
+
+float distributionGGX(vec3 N, vec3 H, float roughness) {
+   float a = roughness * roughness;
+   float a2 = a * a;
+   float NdotH = max(dot(N, H), 0.0);
+   float NdotH2 = NdotH * NdotH;
+   float denom = (NdotH2 * (a2 - 1.0) + 1.0);
+   denom = PI * denom * denom;
+   return a2 / denom;
+}
+
+float geometrySchlickGGX(float NdotV, float roughness) {
+   float r = roughness + 1.0;
+   float k = (r * r) / 8.0;
+   return NdotV / (NdotV * (1.0 - k) + k);
+}
+
+float geometrySmith(vec3 N, vec3 V, vec3 L, float roughness) {
+   float ggx1 = geometrySchlickGGX(max(dot(N, V), 0.0), roughness);
+   float ggx2 = geometrySchlickGGX(max(dot(N, L), 0.0), roughness);
+   return ggx1 * ggx2;
+}
+
+// === Tonemapping ===
+
+vec3 ACESFilm(vec3 x) {
+    const float a = 2.51;
+    const float b = 0.03;
+    const float c = 2.43;
+    const float d = 0.59;
+    const float e = 0.14;
+    return clamp((x * (a * x + b)) / (x * (c * x + d) + e), 0.0, 1.0);
+}
+
+// === Lighting calculation ===
+
+vec3 evaluateLight(LightData light, vec3 worldPos, vec3 N, vec3 V, vec3 albedo, float roughness,
+                   float metallic, vec3 F0) {
+   vec3 L;
+   vec3 radiance = light.color * light.intensity;
+   if (light.lightType == 0u) { // Directional
+      L = normalize(-light.direction);
+   } else {
+      L = normalize(light.position - worldPos);
+      float dist = length(light.position - worldPos);
+      float attenuation = 1.0 / (light.constant +
+            light.linear * dist +
+            light.quadratic * dist * dist);
+      radiance *= attenuation;
+      // Spotlight cone
+      if (light.lightType == 2u) {
+         float theta = dot(L, normalize(-light.direction));
+         float epsilon = light.innerCone - light.outerCone;
+         float intensity = clamp((theta - light.outerCone) / epsilon, 0.0, 1.0);
+         radiance *= intensity;
+      }
+   }
+   // PBR shading
+   vec3 H = normalize(V + L);
+   float NDF = distributionGGX(N, H, roughness);
+   float G = geometrySmith(N, V, L, roughness);
+   vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+   vec3 numerator = NDF * G * F;
+   float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.001;
+   vec3 specular = numerator / denominator;
+   vec3 kS = F;
+   vec3 kD = (1.0 - kS) * (1.0 - metallic);
+   float NdotL = max(dot(N, L), 0.0);
+   return (kD * albedo / PI + specular) * radiance * NdotL;
+}
+
+void main() {
+   // Surface the geometry pass would have written to the G-buffer
+   mat3 TBN = computeTBN(normalize(fragNormal), fragUV, fragPos);
+   vec3 normalTS = texture(normalSampler, fragUV).rgb * 2.0 - 1.0;
+   vec3 N = normalize(TBN * normalTS);
+   vec3 albedo = texture(albedoSampler, fragUV).rgb * material.albedo;
+   float roughness = texture(roughnessSampler, fragUV).r * material.roughness;
+   float metallic = texture(metallicSampler, fragUV).r * material.metallic;
+   float ao = texture(aoSampler, fragUV).r * material.ao;
+   vec3 worldPos = fragPos;
+   vec3 V = normalize(camera.viewPos - worldPos);
+   vec3 F0 = mix(vec3(0.04), albedo, metallic);
+   vec3 finalColor = vec3(0.0);
+   // Global lights reach every pixel, the rest only the clusters their range touches
+   for (uint i = 0; i < clusterData.gridSize.w; ++i) {
+      LightData light = lights.lights[i];
+      finalColor += evaluateLight(light, worldPos, N, V, albedo, roughness, metallic, F0);
+   }
+   // Screen position in the clusterer's convention, the uv the lighting pass samples with
+   vec4 clipPos = camera.proj * camera.view * vec4(worldPos, 1.0);
+   vec2 screenUV = clamp(clipPos.xy / clipPos.w * 0.5 + 0.5, 0.0, 1.0);
+   float viewDepth = -(camera.view * vec4(worldPos, 1.0)).z;
+   uvec2 cluster = clusterData.clusters[getClusterIndex(screenUV, viewDepth)];
+   for (uint i = cluster.x; i < cluster.x + cluster.y; ++i) {
+      LightData light = lights.lights[lightIndexData.lightIndices[i]];
+      finalColor += evaluateLight(light, worldPos, N, V, albedo, roughness, metallic, F0);
+   }
+   // AO
+   vec3 ambient = vec3(0.03) * albedo * ao;
+   finalColor += ambient;
+   vec4 tonemapped = vec4(ACESFilm(finalColor), 1.0);
+   // Gamma correction
+   float gamma = 2.2;
+   fragColor = vec4(pow(tonemapped.rgb, vec3(1.0 / gamma)), 1.0);
+}
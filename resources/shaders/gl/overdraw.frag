@@ -0,0 +1,11 @@
+#version 460
+
+layout(early_fragment_tests) in;
+
+layout(location = 0) out vec4 fragColor;
+
+// Each shaded fragment adds to the pixel under additive blending, so one layer is dark red,
+// two to eight layers ramp through red and yellow and sixteen or more saturate to white
+void main() {
+   fragColor = vec4(1.0 / 8.0, 1.0 / 16.0, 1.0 / 32.0, 1.0);
+}
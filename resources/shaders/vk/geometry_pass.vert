@@ -14,6 +14,9 @@ layout(location = 0) out vec3 fragPos;
 layout(location = 1) out vec3 fragNormal;
 layout(location = 2) out vec2 fragUV;
 
+// Matches the depth prepass bit for bit, the forward pass tests depth for equality
+invariant gl_Position;
+
 layout(push_constant) uniform ObjectData {
    mat4 model;
 } object;
@@ -24,12 +24,22 @@ layout(std140, set = 0, binding = 0) uniform CameraData {
    vec3 viewPos;
 } camera;
 
-#define MAX_LIGHTS 256
-layout(std140, set = 0, binding = 1) uniform LightsData {
-   uint lightCount;
-   LightData lights[MAX_LIGHTS];
+// Global lights (directional or unbounded) first, clusters index the rest
+layout(std430, set = 0, binding = 1) readonly buffer LightsData {
+   LightData lights[];
 } lights;
 
+// Screen tiles by exponential depth slices, each cluster's lights are a range of lightIndices
+layout(std430, set = 0, binding = 6) readonly buffer ClusterData {
+   uvec4 gridSize;     // xyz cluster counts, w global light count
+   vec4 depthSlicing;  // near, far, slice = log(depth) * z + w
+   uvec2 clusters[];   // offset, count
+} clusterData;
+
+layout(std430, set = 0, binding = 7) readonly buffer LightIndexData {
+   uint lightIndices[];
+} lightIndexData;
+
 layout(set = 0, binding = 3) uniform sampler2D gAlbedo;   // RGB color + A AO
 layout(set = 0, binding = 4) uniform sampler2D gNormal;   // RG encoded normal + B roughness + A metallic
 layout(set = 0, binding = 5) uniform sampler2D gDepth;    // R depth value
@@ -56,6 +66,17 @@ vec3 decodeOctNormal(vec2 enc) {
    return normalize(n);
 }
 
+// === Clustering ===
+
+uint getClusterIndex(vec2 uv, float viewDepth) {
+   uvec3 grid = clusterData.gridSize.xyz;
+   uvec2 tile = min(uvec2(uv * vec2(grid.xy)), grid.xy - 1u);
+   float slice = log(max(viewDepth, clusterData.depthSlicing.x)) * clusterData.depthSlicing.z +
+                 clusterData.depthSlicing.w;
+   uint z = min(uint(max(slice, 0.0)), grid.z - 1u);
+   return tile.x + grid.x * (tile.y + grid.y * z);
+}
+
 // === PBR Functions ===
 
 vec3 fresnelSchlick(float cosTheta, vec3 F0) {
@@ -97,6 +118,41 @@ vec3 ACESFilm(vec3 x) {
 
 // === Lighting calculation ===
 
+vec3 evaluateLight(LightData light, vec3 worldPos, vec3 N, vec3 V, vec3 albedo, float roughness,
+                   float metallic, vec3 F0) {
+   vec3 L;
+   vec3 radiance = light.color * light.intensity;
+   if (light.lightType == 0u) { // Directional
+      L = normalize(-light.direction);
+   } else {
+      L = normalize(light.position - worldPos);
+      float dist = length(light.position - worldPos);
+      float attenuation = 1.0 / (light.constant +
+            light.linear * dist +
+            light.quadratic * dist * dist);
+      radiance *= attenuation;
+      // Spotlight cone
+      if (light.lightType == 2u) {
+         float theta = dot(L, normalize(-light.direction));
+         float epsilon = light.innerCone - light.outerCone;
+         float intensity = clamp((theta - light.outerCone) / epsilon, 0.0, 1.0);
+         radiance *= intensity;
+      }
+   }
+   // PBR shading
+   vec3 H = normalize(V + L);
+   float NDF = distributionGGX(N, H, roughness);
+   float G = geometrySmith(N, V, L, roughness);
+   vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
+   vec3 numerator = NDF * G * F;
+   float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.001;
+   vec3 specular = numerator / denominator;
+   vec3 kS = F;
+   vec3 kD = (1.0 - kS) * (1.0 - metallic);
+   float NdotL = max(dot(N, L), 0.0);
+   return (kD * albedo / PI + specular) * radiance * NdotL;
+}
+
 void main() {
    vec4 gNormalTex = texture(gNormal, fragUV);
    vec3 albedo = texture(gAlbedo, fragUV).rgb;
@@ -109,38 +165,16 @@ void main() {
    vec3 V = normalize(camera.viewPos - worldPos);
    vec3 F0 = mix(vec3(0.04), albedo, metallic);
    vec3 finalColor = vec3(0.0);
-   for (uint i = 0; i < lights.lightCount; ++i) {
-      vec3 L;
-      vec3 radiance = lights.lights[i].color * lights.lights[i].intensity;
-      if (lights.lights[i].lightType == 0u) { // Directional
-         L = normalize(-lights.lights[i].direction);
-      } else {
-         L = normalize(lights.lights[i].position - worldPos);
-         float dist = length(lights.lights[i].position - worldPos);
-         float attenuation = 1.0 / (lights.lights[i].constant +
-               lights.lights[i].linear * dist +
-               lights.lights[i].quadratic * dist * dist);
-         radiance *= attenuation;
-         // Spotlight cone
-         if (lights.lights[i].lightType == 2u) {
-            float theta = dot(L, normalize(-lights.lights[i].direction));
-            float epsilon = lights.lights[i].innerCone - lights.lights[i].outerCone;
-            float intensity = clamp((theta - lights.lights[i].outerCone) / epsilon, 0.0, 1.0);
-            radiance *= intensity;
-         }
-      }
-      // PBR shading
-      vec3 H = normalize(V + L);
-      float NDF = distributionGGX(N, H, roughness);
-      float G = geometrySmith(N, V, L, roughness);
-      vec3 F = fresnelSchlick(max(dot(H, V), 0.0), F0);
-      vec3 numerator = NDF * G * F;
-      float denominator = 4.0 * max(dot(N, V), 0.0) * max(dot(N, L), 0.0) + 0.001;
-      vec3 specular = numerator / denominator;
-      vec3 kS = F;
-      vec3 kD = (1.0 - kS) * (1.0 - metallic);
-      float NdotL = max(dot(N, L), 0.0);
-      finalColor += (kD * albedo / PI + specular) * radiance * NdotL;
+   // Global lights reach every pixel, the rest only the clusters their range touches
+   for (uint i = 0; i < clusterData.gridSize.w; ++i) {
+      LightData light = lights.lights[i];
+      finalColor += evaluateLight(light, worldPos, N, V, albedo, roughness, metallic, F0);
+   }
+   float viewDepth = -(camera.view * vec4(worldPos, 1.0)).z;
+   uvec2 cluster = clusterData.clusters[getClusterIndex(fragUV, viewDepth)];
+   for (uint i = cluster.x; i < cluster.x + cluster.y; ++i) {
+      LightData light = lights.lights[lightIndexData.lightIndices[i]];
+      finalColor += evaluateLight(light, worldPos, N, V, albedo, roughness, metallic, F0);
    }
    // AO
    vec3 ambient = vec3(0.03) * albedo * ao;
@@ -0,0 +1,48 @@
+#version 460
+
+struct DrawData {
+   mat4 model;
+   uint firstTriangle;
+   uint firstIndex;
+   int vertexOffset;
+   uint indices16;
+   uint materialSlot;
+};
+
+layout(set = 0, binding = 1) uniform usampler2D visibility;
+
+// Sorted by firstTriangle, one entry per draw of the visibility pass
+layout(std430, set = 0, binding = 2) readonly buffer DrawTable {
+   DrawData draws[];
+} drawTable;
+
+layout(push_constant) uniform ResolveData {
+   vec2 viewportSize;
+   uint drawCount;
+   uint materialSlot;
+} resolve;
+
+float materialDepth(uint slot) {
+   return float(slot + 1u) / 16777216.0;
+}
+
+uint findDraw(uint triangle) {
+   uint low = 0u;
+   uint high = resolve.drawCount - 1u;
+   while (low < high) {
+      uint mid = (low + high + 1u) >> 1;
+      if (drawTable.draws[mid].firstTriangle <= triangle)
+         low = mid;
+      else
+         high = mid - 1u;
+   }
+   return low;
+}
+
+void main() {
+   uint triangle = texelFetch(visibility, ivec2(gl_FragCoord.xy), 0).r;
+   // Empty pixels keep the cleared depth, no material draw reaches it
+   if (triangle == 0u)
+      discard;
+   gl_FragDepth = materialDepth(drawTable.draws[findDraw(triangle)].materialSlot);
+}
@@ -0,0 +1,179 @@
+#version 460
+
+// Only pixels whose material depth equals this material's run the shader
+layout(early_fragment_tests) in;
+
+struct DrawData {
+   mat4 model;
+   uint firstTriangle;
+   uint firstIndex;
+   int vertexOffset;
+   uint indices16;
+   uint materialSlot;
+};
+
+layout(std140, set = 0, binding = 0) uniform CameraData {
+   mat4 view;
+   mat4 proj;
+   vec3 viewPos;
+} camera;
+
+layout(set = 0, binding = 1) uniform usampler2D visibility;
+
+// Sorted by firstTriangle, one entry per draw of the visibility pass
+layout(std430, set = 0, binding = 2) readonly buffer DrawTable {
+   DrawData draws[];
+} drawTable;
+
+// The shared geometry pool, 8 floats per vertex: position, normal, uv
+layout(std430, set = 0, binding = 3) readonly buffer VertexPool {
+   float vertices[];
+} vertexPool;
+
+// 16-bit indices packed two per word
+layout(std430, set = 0, binding = 4) readonly buffer IndexPool16 {
+   uint indices[];
+} indexPool16;
+
+layout(std430, set = 0, binding = 5) readonly buffer IndexPool32 {
+   uint indices[];
+} indexPool32;
+
+layout(push_constant) uniform ResolveData {
+   vec2 viewportSize;
+   uint drawCount;
+   uint materialSlot;
+} resolve;
+
+layout(std140, set = 1, binding = 16) uniform MaterialData {
+   float ao;
+   float roughness;
+   float metallic;
+   vec3 albedo;
+} material;
+
+layout(set = 1, binding = 0) uniform sampler2D albedoSampler;
+layout(set = 1, binding = 1) uniform sampler2D normalSampler;
+layout(set = 1, binding = 2) uniform sampler2D roughnessSampler;
+layout(set = 1, binding = 3) uniform sampler2D metallicSampler;
+layout(set = 1, binding = 4) uniform sampler2D aoSampler;
+
+layout(location = 0) out vec4 gAlbedo; // RGB color + A AO
+layout(location = 1) out vec4 gNormal; // RG encoded normal + B roughness + A metallic
+
+struct Vertex {
+   vec3 position;
+   vec3 normal;
+   vec2 uv;
+};
+
+// Perspective correct barycentrics of the pixel and their change one pixel right and down
+struct Barycentrics {
+   vec3 lambda;
+   vec3 ddx;
+   vec3 ddy;
+};
+
+uint findDraw(uint triangle) {
+   uint low = 0u;
+   uint high = resolve.drawCount - 1u;
+   while (low < high) {
+      uint mid = (low + high + 1u) >> 1;
+      if (drawTable.draws[mid].firstTriangle <= triangle)
+         low = mid;
+      else
+         high = mid - 1u;
+   }
+   return low;
+}
+
+uint fetchIndex(DrawData draw, uint corner) {
+   uint index = draw.firstIndex + corner;
+   if (draw.indices16 != 0u)
+      return (indexPool16.indices[index >> 1] >> ((index & 1u) * 16u)) & 0xFFFFu;
+   return indexPool32.indices[index];
+}
+
+Vertex fetchVertex(DrawData draw, uint corner) {
+   uint base = uint(int(fetchIndex(draw, corner)) + draw.vertexOffset) * 8u;
+   Vertex vertex;
+   vertex.position = vec3(vertexPool.vertices[base], vertexPool.vertices[base + 1u],
+                          vertexPool.vertices[base + 2u]);
+   vertex.normal = vec3(vertexPool.vertices[base + 3u], vertexPool.vertices[base + 4u],
+                        vertexPool.vertices[base + 5u]);
+   vertex.uv = vec2(vertexPool.vertices[base + 6u], vertexPool.vertices[base + 7u]);
+   return vertex;
+}
+
+Barycentrics computeBarycentrics(vec4 clip0, vec4 clip1, vec4 clip2, vec2 ndc) {
+   Barycentrics result;
+   vec3 invW = 1.0 / vec3(clip0.w, clip1.w, clip2.w);
+   vec2 ndc0 = clip0.xy * invW.x;
+   vec2 ndc1 = clip1.xy * invW.y;
+   vec2 ndc2 = clip2.xy * invW.z;
+   float invDet = 1.0 / determinant(mat2(ndc2 - ndc1, ndc0 - ndc1));
+   // Screen space gradients of lambda / w, which interpolate linearly
+   vec3 ddx = vec3(ndc1.y - ndc2.y, ndc2.y - ndc0.y, ndc0.y - ndc1.y) * invDet * invW;
+   vec3 ddy = vec3(ndc2.x - ndc1.x, ndc0.x - ndc2.x, ndc1.x - ndc0.x) * invDet * invW;
+   float ddxSum = dot(ddx, vec3(1.0));
+   float ddySum = dot(ddy, vec3(1.0));
+   vec2 delta = ndc - ndc0;
+   float interpInvW = invW.x + delta.x * ddxSum + delta.y * ddySum;
+   float interpW = 1.0 / interpInvW;
+   result.lambda = interpW * (vec3(invW.x, 0.0, 0.0) + delta.x * ddx + delta.y * ddy);
+   // One pixel is 2 / size in normalized device coordinates
+   vec2 pixel = 2.0 / resolve.viewportSize;
+   ddx *= pixel.x;
+   ddy *= pixel.y;
+   ddxSum *= pixel.x;
+   ddySum *= pixel.y;
+   result.ddx = (result.lambda * interpInvW + ddx) / (interpInvW + ddxSum) - result.lambda;
+   result.ddy = (result.lambda * interpInvW + ddy) / (interpInvW + ddySum) - result.lambda;
+   return result;
+}
+
+vec2 encodeOctNormal(vec3 n) {
+   n /= (abs(n.x) + abs(n.y) + abs(n.z));
+   vec2 enc = n.xy;
+   if (n.z < 0.0) {
+      enc = (1.0 - abs(enc.yx)) * sign(enc.xy);
+   }
+   return enc * 0.5 + 0.5;
+}
+
+void main() {
+   uint triangle = texelFetch(visibility, ivec2(gl_FragCoord.xy), 0).r;
+   DrawData draw = drawTable.draws[findDraw(triangle)];
+   uint localTriangle = triangle - draw.firstTriangle;
+   Vertex v0 = fetchVertex(draw, localTriangle * 3u);
+   Vertex v1 = fetchVertex(draw, localTriangle * 3u + 1u);
+   Vertex v2 = fetchVertex(draw, localTriangle * 3u + 2u);
+   vec3 world0 = (draw.model * vec4(v0.position, 1.0)).xyz;
+   vec3 world1 = (draw.model * vec4(v1.position, 1.0)).xyz;
+   vec3 world2 = (draw.model * vec4(v2.position, 1.0)).xyz;
+   mat4 viewProj = camera.proj * camera.view;
+   vec2 ndc = gl_FragCoord.xy / resolve.viewportSize * 2.0 - 1.0;
+   Barycentrics bary = computeBarycentrics(viewProj * vec4(world0, 1.0),
+                                           viewProj * vec4(world1, 1.0),
+                                           viewProj * vec4(world2, 1.0), ndc);
+   // Interpolated attributes and their screen derivatives, as the rasterizer would give them
+   vec2 uv = mat3x2(v0.uv, v1.uv, v2.uv) * bary.lambda;
+   vec2 uvDx = mat3x2(v0.uv, v1.uv, v2.uv) * bary.ddx;
+   vec2 uvDy = mat3x2(v0.uv, v1.uv, v2.uv) * bary.ddy;
+   mat3 worldCorners = mat3(world0, world1, world2);
+   vec3 posDx = worldCorners * bary.ddx;
+   vec3 posDy = worldCorners * bary.ddy;
+   mat3 normalMatrix = transpose(inverse(mat3(draw.model)));
+   vec3 N = normalize(normalMatrix * (mat3(v0.normal, v1.normal, v2.normal) * bary.lambda));
+   // Same TBN as the geometry pass, from the analytic derivatives
+   vec3 T = normalize(uvDy.y * posDx - uvDx.y * posDy);
+   vec3 B = normalize(-uvDy.x * posDx + uvDx.x * posDy);
+   mat3 TBN = mat3(T, B, N);
+   vec3 normalTS = textureGrad(normalSampler, uv, uvDx, uvDy).rgb * 2.0 - 1.0;
+   vec3 normalWS = normalize(TBN * normalTS);
+   gAlbedo = vec4(textureGrad(albedoSampler, uv, uvDx, uvDy).rgb * material.albedo,
+                  textureGrad(aoSampler, uv, uvDx, uvDy).r * material.ao);
+   gNormal = vec4(encodeOctNormal(normalWS),
+                  textureGrad(roughnessSampler, uv, uvDx, uvDy).r * material.roughness,
+                  textureGrad(metallicSampler, uv, uvDx, uvDy).r * material.metallic);
+}
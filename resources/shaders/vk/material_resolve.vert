@@ -0,0 +1,18 @@
+#version 460
+
+layout(push_constant) uniform ResolveData {
+   vec2 viewportSize;
+   uint drawCount;
+   uint materialSlot;
+} resolve;
+
+// Depth the material depth pass writes for every pixel of this material slot
+float materialDepth(uint slot) {
+   return float(slot + 1u) / 16777216.0;
+}
+
+void main() {
+   // Full-screen triangle at the material's depth, the equal test keeps only its pixels
+   vec2 pos = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+   gl_Position = vec4(pos * 2.0 - 1.0, materialDepth(resolve.materialSlot), 1.0);
+}
@@ -0,0 +1,15 @@
+#version 460
+
+layout(early_fragment_tests) in;
+
+layout(push_constant) uniform DrawData {
+   mat4 model;
+   uint firstTriangle;
+} draw;
+
+// Frame wide triangle id, 0 is left for pixels no triangle covers
+layout(location = 0) out uint outTriangle;
+
+void main() {
+   outTriangle = draw.firstTriangle + uint(gl_PrimitiveID);
+}
@@ -0,0 +1,18 @@
+#version 460
+
+layout(location = 0) in vec3 inPosition;
+
+layout(std140, set = 0, binding = 0) uniform CameraData {
+   mat4 view;
+   mat4 proj;
+   vec3 viewPos;
+} camera;
+
+layout(push_constant) uniform DrawData {
+   mat4 model;
+   uint firstTriangle;
+} draw;
+
+void main() {
+   gl_Position = camera.proj * camera.view * (draw.model * vec4(inPosition, 1.0));
+}
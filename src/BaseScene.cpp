@@ -6,13 +6,31 @@
 #include "core/resource/ResourceManager.hpp"
 
 #include "core/scene/MeshLoaderHelper.hpp"
+#include "core/scene/SceneStreamer.hpp"
 
 #include "core/scene/components/LightComponent.hpp"
 #include "core/scene/components/ParticleSystemComponent.hpp"
+#include "core/scene/components/RendererComponent.hpp"
+
+#include <cmath>
+#include <filesystem>
+#include <random>
 
 void LoadSponzaGeometry(Scene& scene, ResourceManager& resourceManager);
+std::vector<MaterialHandle> LoadSponzaMaterials(ResourceManager& resourceManager);
+void AddSunLight(Scene& scene);
+void SetupParticleSystem(ParticleSystemComponent* particles, const uint32_t maxParticles,
+                         std::mt19937& gen);
+void CloneChildren(Scene& scene, const Node* source, Node* target);
+
+// Approximate extent of the scaled model around its origin and the distance between copies
+constexpr glm::vec3 SPONZA_EXTENT(20.0f, 15.0f, 13.0f);
+constexpr glm::vec3 SPONZA_SPACING(40.0f, 0.0f, 30.0f);
+constexpr const char* SPONZA_MODEL_PATH = "resources/meshes/sponza.fbx";
+// Bump whenever the scenes built in this file change, older snapshots are then rebuilt
+constexpr uint64_t SCENE_CODE_VERSION = 1;
 
-// TODO: This is a test scene, add a serialization/deserialization system
+// Builds the benchmark scene from code and FBX, main.cpp caches the result as a SceneSnapshot
 void LoadBaseScene(Scene& scene, ResourceManager& resourceManager, const GraphicsAPI api,
                    const size_t lightCount, const size_t seed) {
    LoadSponzaGeometry(scene, resourceManager);
@@ -63,76 +81,146 @@ void AddParticles(Scene& scene, const size_t particleCount, const size_t seed) {
    // Setup seeded randomness
    std::seed_seq seq{seed};
    std::mt19937 gen(seq);
-   std::uniform_real_distribution<float> colorDist(0.3f, 1.0f);
    if (particleCount == 1) {
       Node* particlesNode = scene.CreateNode("particles");
       particlesNode->GetComponent<TransformComponent>()->SetPosition(glm::vec3(0.0f, 2.0f, 0.0f));
-      ParticleSystemComponent* particles = particlesNode->AddComponent<ParticleSystemComponent>();
-      particles->SetMaxParticles(100000);
-      auto emSet = particles->GetEmissionSettings();
-      auto phSet = particles->GetPhysicsSettings();
-      auto reSet = particles->GetRenderSettings();
-      emSet.emissionRate = 8000;
-      emSet.emissionCone = glm::radians(70.0f);
-      emSet.initialSpeedMin = 1.0f;
-      emSet.initialSpeedMax = 7.0f;
-      phSet.damping = 0.995f;
-      phSet.collisionEnabled = true;
-      phSet.bounciness = 0.75f;
-      reSet.sizeOverLifetime = true;
-      reSet.endSizeMultiplier = 0.99f;
-      reSet.startColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 1.0f);
-      reSet.endColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 0.0f);
-      particles->SetEmissionSettings(emSet);
-      particles->SetPhysicsSettings(phSet);
-      particles->SetRenderSettings(reSet);
+      SetupParticleSystem(particlesNode->AddComponent<ParticleSystemComponent>(), 100000, gen);
       return;
    }
    Node* particlesNode0 = scene.CreateNode("particles_0");
    particlesNode0->GetComponent<TransformComponent>()->SetPosition(glm::vec3(-7.0f, 2.0f, 0.0f));
-   ParticleSystemComponent* particles0 = particlesNode0->AddComponent<ParticleSystemComponent>();
-   particles0->SetMaxParticles(100000);
-   auto emSet0 = particles0->GetEmissionSettings();
-   auto phSet0 = particles0->GetPhysicsSettings();
-   auto reSet0 = particles0->GetRenderSettings();
-   emSet0.emissionRate = 8000;
-   emSet0.emissionCone = glm::radians(70.0f);
-   emSet0.initialSpeedMin = 1.0f;
-   emSet0.initialSpeedMax = 7.0f;
-   phSet0.damping = 0.995f;
-   phSet0.collisionEnabled = true;
-   phSet0.bounciness = 0.75f;
-   reSet0.sizeOverLifetime = true;
-   reSet0.endSizeMultiplier = 0.99f;
-   reSet0.startColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 1.0f);
-   reSet0.endColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 0.0f);
-   particles0->SetEmissionSettings(emSet0);
-   particles0->SetPhysicsSettings(phSet0);
-   particles0->SetRenderSettings(reSet0);
+   SetupParticleSystem(particlesNode0->AddComponent<ParticleSystemComponent>(), 100000, gen);
    Node* particlesNode1 = scene.CreateNode("particles_1");
    particlesNode1->GetComponent<TransformComponent>()->SetPosition(glm::vec3(7.0f, 2.0f, 0.0f));
-   ParticleSystemComponent* particles1 = particlesNode1->AddComponent<ParticleSystemComponent>();
-   particles1->SetMaxParticles(100000);
-   auto emSet1 = particles1->GetEmissionSettings();
-   auto phSet1 = particles1->GetPhysicsSettings();
-   auto reSet1 = particles1->GetRenderSettings();
-   emSet1.emissionRate = 8000;
-   emSet1.emissionCone = glm::radians(70.0f);
-   emSet1.initialSpeedMin = 1.0f;
-   emSet1.initialSpeedMax = 7.0f;
-   phSet1.damping = 0.995f;
-   phSet1.collisionEnabled = true;
-   phSet1.bounciness = 0.75f;
-   reSet1.sizeOverLifetime = true;
-   reSet1.endSizeMultiplier = 0.99f;
-   reSet1.startColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 1.0f);
-   reSet1.endColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 0.0f);
-   particles1->SetEmissionSettings(emSet1);
-   particles1->SetPhysicsSettings(phSet1);
-   particles1->SetRenderSettings(reSet1);
+   SetupParticleSystem(particlesNode1->AddComponent<ParticleSystemComponent>(), 100000, gen);
+}
+
+void LoadScalableScene(Scene& scene, ResourceManager& resourceManager,
+                       const ScalableSceneDesc& desc) {
+   LoadSponzaGeometry(scene, resourceManager);
+   const size_t instanceCount = std::max<size_t>(desc.instanceCount, 1);
+   const size_t gridSize =
+      static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(instanceCount))));
+   // The first copy is the loaded model itself, the others rebuild its hierarchy
+   const Node* sponzaNode = scene.FindNode("sponza");
+   for (size_t i = 1; i < instanceCount; ++i) {
+      Node* copy = scene.CreateNode("sponza_" + std::to_string(i));
+      TransformComponent* transform = copy->GetComponent<TransformComponent>();
+      transform->SetPosition(
+         SPONZA_SPACING * glm::vec3(static_cast<float>(i % gridSize), 0.0f,
+                                    static_cast<float>(i / gridSize)));
+      transform->SetScale(glm::vec3(0.01f));
+      CloneChildren(scene, sponzaNode, copy);
+   }
+   // Setup seeded randomness
+   std::seed_seq seq{desc.seed};
+   std::mt19937 gen(seq);
+   const glm::vec3 gridMin = -SPONZA_EXTENT;
+   const glm::vec3 gridMax =
+      SPONZA_SPACING * glm::vec3(static_cast<float>(gridSize - 1), 0.0f,
+                                 static_cast<float>((instanceCount - 1) / gridSize)) +
+      SPONZA_EXTENT;
+   std::uniform_real_distribution<float> xDist(gridMin.x, gridMax.x);
+   std::uniform_real_distribution<float> yDist(0.5f, SPONZA_EXTENT.y);
+   std::uniform_real_distribution<float> zDist(gridMin.z, gridMax.z);
+   // Lights, same parameter ranges as the base scene
+   std::uniform_int_distribution<uint16_t> typeDist(1, 2);
+   std::uniform_real_distribution<float> colorDist(0.3f, 1.0f);
+   std::uniform_real_distribution<float> intensityDistSpot(0.8f, 2.5f);
+   std::uniform_real_distribution<float> intensityDistPoint(0.6f, 1.0f);
+   std::uniform_real_distribution<float> coneDist(10.f, 50.f);
+   std::uniform_real_distribution<float> yawDist(0.0f, 360.0f);
+   Node* lightsNode = scene.CreateNode("lights");
+   for (size_t i = 0; i < desc.lightCount; ++i) {
+      Node* n = scene.CreateChildNode(lightsNode, "light_object");
+      TransformComponent* transform = n->GetComponent<TransformComponent>();
+      transform->SetPosition(glm::vec3(xDist(gen), yDist(gen), zDist(gen)));
+      LightComponent* light = n->AddComponent<LightComponent>();
+      light->SetType(static_cast<LightComponent::LightType>(typeDist(gen)));
+      light->SetColor(glm::vec3(colorDist(gen), colorDist(gen), colorDist(gen)));
+      light->SetIntensity(intensityDistPoint(gen));
+      if (light->GetType() == LightComponent::LightType::Spot) {
+         // Pointed down at the floor
+         transform->SetRotation(glm::vec3(-90.0f, yawDist(gen), 0.0f));
+         const float baseCone = coneDist(gen);
+         light->SetIntensity(intensityDistSpot(gen));
+         light->SetInnerCone(glm::radians(baseCone + 10.f));
+         light->SetOuterCone(glm::radians(baseCone));
+      }
+   }
+   // Particle systems
+   for (size_t i = 0; i < desc.particleSystemCount; ++i) {
+      Node* particlesNode = scene.CreateNode("particles_" + std::to_string(i));
+      particlesNode->GetComponent<TransformComponent>()->SetPosition(
+         glm::vec3(xDist(gen), 2.0f, zDist(gen)));
+      SetupParticleSystem(particlesNode->AddComponent<ParticleSystemComponent>(),
+                          desc.particlesPerSystem, gen);
+   }
+}
+
+uint64_t GetSceneContentKey(const uint8_t sceneIndex,
+                            const ScalableSceneDesc* const generatedScene) {
+   // FNV-1a over 64 bit words
+   uint64_t key = 14695981039346656037ull;
+   const auto mix = [&key](const uint64_t value) { key = (key ^ value) * 1099511628211ull; };
+   mix(SCENE_CODE_VERSION);
+   if (generatedScene) {
+      mix(generatedScene->instanceCount);
+      mix(generatedScene->lightCount);
+      mix(generatedScene->particleSystemCount);
+      mix(generatedScene->particlesPerSystem);
+      mix(generatedScene->seed);
+   } else {
+      // Keeps fixed scenes apart from a generated scene with matching numbers
+      mix(UINT64_MAX);
+      mix(sceneIndex);
+   }
+   // A missing model hashes as empty, building the scene reports it
+   std::error_code error;
+   const uintmax_t modelSize = std::filesystem::file_size(SPONZA_MODEL_PATH, error);
+   mix(error ? 0 : modelSize);
+   const auto modelTime = std::filesystem::last_write_time(SPONZA_MODEL_PATH, error);
+   mix(error ? 0 : static_cast<uint64_t>(modelTime.time_since_epoch().count()));
+   return key;
+}
+
+void LoadStreamingScene(Scene& scene, ResourceManager& resourceManager,
+                        SceneStreamer& streamer, const size_t gridSize) {
+   // Materials are shared by every copy, so only the geometry is streamed per cell
+   std::vector<StreamingMaterialDesc> materials;
+   for (const MaterialHandle& material : LoadSponzaMaterials(resourceManager)) {
+      materials.push_back(
+         {.name = std::string(resourceManager.GetResourceName(material.GetId()).GetString())});
+   }
+   for (size_t x = 0; x < gridSize; ++x) {
+      for (size_t z = 0; z < gridSize; ++z) {
+         const glm::vec3 center =
+            SPONZA_SPACING * glm::vec3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+         Transform transform;
+         transform.SetPosition(center);
+         transform.SetScale(0.01f);
+         streamer.AddCell({.name = "sponza_" + std::to_string(x) + "_" + std::to_string(z),
+                           .modelFilepath = SPONZA_MODEL_PATH,
+                           .transform = transform,
+                           .boundsMin = center - glm::vec3(SPONZA_EXTENT.x, 0.0f, SPONZA_EXTENT.z),
+                           .boundsMax = center + SPONZA_EXTENT,
+                           .materials = materials});
+      }
+   }
+   AddSunLight(scene);
 }
 
 void LoadSponzaGeometry(Scene& scene, ResourceManager& resourceManager) {
+   const std::vector<MaterialHandle> materials = LoadSponzaMaterials(resourceManager);
+   // Load the main model
+   Node* sponzaNode =
+      MeshLoaderHelper::LoadSceneAsChildNode(scene, scene.GetRootNode(), resourceManager,
+                                             "sponza", SPONZA_MODEL_PATH, {}, materials);
+   sponzaNode->GetTransform()->SetScale(glm::vec3(0.01f));
+   AddSunLight(scene);
+}
+
+std::vector<MaterialHandle> LoadSponzaMaterials(ResourceManager& resourceManager) {
    const auto t1 = resourceManager.LoadTexture(
       "col_head_2ndfloor_03_BaseColor", "resources/textures/col_head_2ndfloor_03_BaseColor.png");
    const auto t2 = resourceManager.LoadTexture(
@@ -671,13 +759,13 @@ void LoadSponzaGeometry(Scene& scene, ResourceManager& resourceManager) {
       mat->SetTexture("roughnessTexture", t72);
       mat->SetTexture("metallicTexture", t31);
    }
-   // Load the main model
-   Node* sponzaNode = MeshLoaderHelper::LoadSceneAsChildNode(
-      scene, scene.GetRootNode(), resourceManager, "sponza", "resources/meshes/sponza.fbx", {},
-      {m1,  m2,  m3,  m4,  m5,  m6,  m7,  m8,  m9,  m10, m11, m12, m13, m14, m15,
-       m16, m17, m18, m19, m20, m21, m22, m23, m24, m25, m26, m27, m28, m29, m30,
-       m31, m32, m33, m34, m35, m36, m37, m38, m39, m40, m41, m42, m43, m44, m45});
-   sponzaNode->GetTransform()->SetScale(glm::vec3(0.01f));
+   // Indexed by the model's material index
+   return {m1,  m2,  m3,  m4,  m5,  m6,  m7,  m8,  m9,  m10, m11, m12, m13, m14, m15,
+           m16, m17, m18, m19, m20, m21, m22, m23, m24, m25, m26, m27, m28, m29, m30,
+           m31, m32, m33, m34, m35, m36, m37, m38, m39, m40, m41, m42, m43, m44, m45};
+}
+
+void AddSunLight(Scene& scene) {
    // Add a directional light for sun
    Node* sunNode = scene.CreateNode("light_sun");
    TransformComponent* sunTransform = sunNode->GetComponent<TransformComponent>();
@@ -687,3 +775,41 @@ void LoadSponzaGeometry(Scene& scene, ResourceManager& resourceManager) {
    lightSun->SetColor(glm::vec3(1.0f, 1.0f, 0.95f));
    lightSun->SetIntensity(.3f);
 }
+
+void SetupParticleSystem(ParticleSystemComponent* particles, const uint32_t maxParticles,
+                         std::mt19937& gen) {
+   std::uniform_real_distribution<float> colorDist(0.3f, 1.0f);
+   particles->SetMaxParticles(maxParticles);
+   auto emSet = particles->GetEmissionSettings();
+   auto phSet = particles->GetPhysicsSettings();
+   auto reSet = particles->GetRenderSettings();
+   emSet.emissionRate = 8000;
+   emSet.emissionCone = glm::radians(70.0f);
+   emSet.initialSpeedMin = 1.0f;
+   emSet.initialSpeedMax = 7.0f;
+   phSet.damping = 0.995f;
+   phSet.collisionEnabled = true;
+   phSet.bounciness = 0.75f;
+   reSet.sizeOverLifetime = true;
+   reSet.endSizeMultiplier = 0.99f;
+   reSet.startColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 1.0f);
+   reSet.endColor = glm::vec4(colorDist(gen), colorDist(gen), colorDist(gen), 0.0f);
+   particles->SetEmissionSettings(emSet);
+   particles->SetPhysicsSettings(phSet);
+   particles->SetRenderSettings(reSet);
+}
+
+// Copies source's subtree under target, the copies share the source's mesh and material handles
+void CloneChildren(Scene& scene, const Node* source, Node* target) {
+   for (const Node* child = source->GetFirstChild(); child; child = child->GetNextSibling()) {
+      Node* copy = scene.CreateChildNode(target, child->GetName());
+      const Transform* from = child->GetTransform();
+      Transform* to = copy->GetTransform();
+      to->SetPosition(from->GetPosition());
+      to->SetRotation(from->GetRotation());
+      to->SetScale(from->GetScale());
+      if (const auto* renderer = child->GetComponent<RendererComponent>(); renderer)
+         copy->AddComponent<RendererComponent>(renderer->GetMesh(), renderer->GetMaterial());
+      CloneChildren(scene, child, copy);
+   }
+}
@@ -1,13 +1,39 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include "core/GraphicsAPI.hpp"
 
 class Scene;
 class ResourceManager;
+class SceneStreamer;
 
 void LoadBaseScene(Scene& scene, ResourceManager& resourceManager, const GraphicsAPI api,
                    const size_t lightCount = 21, const size_t seed = 42);
 
+// gridSize x gridSize copies of the base geometry as streamed cells, lights are left out
+void LoadStreamingScene(Scene& scene, ResourceManager& resourceManager, SceneStreamer& streamer,
+                        const size_t gridSize);
+
+// Benchmark scene of arbitrary size for scaling measurements
+struct ScalableSceneDesc final {
+   // Copies of the base geometry in a square grid, all sharing the same meshes and materials
+   size_t instanceCount{1};
+   // Point and spot lights scattered over the grid, on top of the sun
+   size_t lightCount{0};
+   size_t particleSystemCount{0};
+   uint32_t particlesPerSystem{100000};
+   size_t seed{42};
+};
+
+void LoadScalableScene(Scene& scene, ResourceManager& resourceManager,
+                       const ScalableSceneDesc& desc);
+
 void AddParticles(Scene& scene, const size_t particleCount, const size_t seed = 42);
+
+// Hash of everything a scene snapshot of the given scene is built from: the scene index or
+// generator settings, the source model's size and modification time and the version of the
+// code above. Snapshots saved under another key are stale and rebuilt.
+[[nodiscard]] uint64_t GetSceneContentKey(const uint8_t sceneIndex,
+                                          const ScalableSceneDesc* const generatedScene);
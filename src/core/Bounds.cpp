@@ -0,0 +1,69 @@
+#include "core/Bounds.hpp"
+
+#include <cmath>
+
+BoundingBox BoundingBox::Transformed(const glm::mat4& matrix) const noexcept {
+   if (IsEmpty())
+      return *this;
+   // Arvo's method: each output axis sums the smaller and larger products per input axis
+   BoundingBox result{.min = glm::vec3(matrix[3]), .max = glm::vec3(matrix[3])};
+   for (int32_t column = 0; column < 3; ++column) {
+      const glm::vec3 axis(matrix[column]);
+      const glm::vec3 a = axis * min[column];
+      const glm::vec3 b = axis * max[column];
+      result.min += glm::min(a, b);
+      result.max += glm::max(a, b);
+   }
+   return result;
+}
+
+BoundingBox BoundingBox::FromVertices(const std::span<const Vertex> vertices) noexcept {
+   BoundingBox box;
+   for (const Vertex& vertex : vertices)
+      box.Expand(vertex.position);
+   return box;
+}
+
+Frustum Frustum::FromMatrix(const glm::mat4& viewProjection, const bool depthZeroToOne) noexcept {
+   // Gribb/Hartmann extraction, rows of the matrix combined per clip plane
+   const glm::mat4 m = glm::transpose(viewProjection);
+   Frustum frustum;
+   frustum.planes[Left] = m[3] + m[0];
+   frustum.planes[Right] = m[3] - m[0];
+   frustum.planes[Bottom] = m[3] + m[1];
+   frustum.planes[Top] = m[3] - m[1];
+   frustum.planes[Near] = depthZeroToOne ? m[2] : m[3] + m[2];
+   frustum.planes[Far] = m[3] - m[2];
+   for (glm::vec4& plane : frustum.planes)
+      plane /= glm::length(glm::vec3(plane));
+   return frustum;
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const noexcept {
+   bool inside = false;
+   return Classify(box, inside);
+}
+
+bool Frustum::Intersects(const glm::vec3& center, const float radius) const noexcept {
+   for (const glm::vec4& plane : planes) {
+      if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+         return false;
+   }
+   return true;
+}
+
+bool Frustum::Classify(const BoundingBox& box, bool& inside) const noexcept {
+   const glm::vec3 center = box.GetCenter();
+   const glm::vec3 extents = box.GetExtents();
+   inside = true;
+   for (const glm::vec4& plane : planes) {
+      const glm::vec3 normal(plane);
+      const float distance = glm::dot(normal, center) + plane.w;
+      const float radius = glm::dot(extents, glm::abs(normal));
+      if (distance < -radius)
+         return false;
+      if (distance < radius)
+         inside = false;
+   }
+   return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/Vertex.hpp"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// Axis aligned box, empty (min > max) when default constructed
+struct BoundingBox final {
+   glm::vec3 min{std::numeric_limits<float>::max()};
+   glm::vec3 max{std::numeric_limits<float>::lowest()};
+
+   [[nodiscard]] constexpr bool IsEmpty() const noexcept {
+      return min.x > max.x || min.y > max.y || min.z > max.z;
+   }
+   [[nodiscard]] glm::vec3 GetCenter() const noexcept { return (min + max) * 0.5f; }
+   [[nodiscard]] glm::vec3 GetExtents() const noexcept { return (max - min) * 0.5f; }
+
+   void Expand(const glm::vec3& point) noexcept {
+      min = glm::min(min, point);
+      max = glm::max(max, point);
+   }
+   void Expand(const BoundingBox& other) noexcept {
+      min = glm::min(min, other.min);
+      max = glm::max(max, other.max);
+   }
+   [[nodiscard]] bool Contains(const BoundingBox& other) const noexcept {
+      return glm::all(glm::lessThanEqual(min, other.min)) &&
+             glm::all(glm::greaterThanEqual(max, other.max));
+   }
+
+   // Box around the transformed corners, empty stays empty
+   [[nodiscard]] BoundingBox Transformed(const glm::mat4& matrix) const noexcept;
+
+   [[nodiscard]] static BoundingBox FromVertices(const std::span<const Vertex> vertices) noexcept;
+   // Contains any scene, for things whose extent is not known. Finite so that extents and
+   // plane distances stay well defined.
+   [[nodiscard]] static BoundingBox Infinite() noexcept {
+      return {.min = glm::vec3(-1e30f), .max = glm::vec3(1e30f)};
+   }
+};
+
+// Six inward facing planes (xyz normal, w distance) of a view volume
+struct Frustum final {
+   enum Plane : uint8_t { Left, Right, Bottom, Top, Near, Far };
+
+   std::array<glm::vec4, 6> planes{};
+
+   // From a projection * view matrix, depthZeroToOne for clip spaces with z in [0, 1]
+   [[nodiscard]] static Frustum FromMatrix(const glm::mat4& viewProjection,
+                                           const bool depthZeroToOne) noexcept;
+
+   [[nodiscard]] bool Intersects(const BoundingBox& box) const noexcept;
+   [[nodiscard]] bool Intersects(const glm::vec3& center, const float radius) const noexcept;
+   // Like Intersects(), also reporting whether the box lies entirely inside
+   [[nodiscard]] bool Classify(const BoundingBox& box, bool& inside) const noexcept;
+};
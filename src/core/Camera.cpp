@@ -14,7 +14,8 @@ Camera::Camera(const GraphicsAPI api, const Transform& transform, const glm::vec
       m_camera(1.0f),
       m_viewDirty(true),
       m_projDirty(true),
-      m_cameraDirty(true) {}
+      m_cameraDirty(true),
+      m_frustumDirty(true) {}
 
 glm::vec3 Camera::GetViewDirection() const noexcept { return m_transform.GetForward(); }
 glm::vec3 Camera::GetRightVector() const noexcept { return m_transform.GetRight(); }
@@ -23,11 +24,15 @@ glm::vec3 Camera::GetUpVector() const noexcept { return m_transform.GetUp(); }
 void Camera::SetFOV(const float newFov) noexcept {
    m_fov = newFov;
    m_projDirty = true;
+   m_cameraDirty = true;
+   m_frustumDirty = true;
 }
 
 void Camera::SetAspectRatio(const float newRatio) noexcept {
    m_aspectRatio = newRatio;
    m_projDirty = true;
+   m_cameraDirty = true;
+   m_frustumDirty = true;
 }
 
 const glm::mat4& Camera::GetViewMatrix() {
@@ -54,6 +59,15 @@ const glm::mat4& Camera::GetCameraMatrix() {
    return m_camera;
 }
 
+const Frustum& Camera::GetFrustum() {
+   if (m_frustumDirty) {
+      // Vulkan projections map depth to [0, 1]
+      m_frustum = Frustum::FromMatrix(GetCameraMatrix(), m_api == GraphicsAPI::Vulkan);
+      m_frustumDirty = false;
+   }
+   return m_frustum;
+}
+
 void Camera::RecalculateView() noexcept { m_view = glm::inverse(m_transform.GetTransformMatrix()); }
 
 static const glm::mat4 GL_TO_VK_CLIP = glm::mat4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f,
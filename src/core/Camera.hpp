@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/Bounds.hpp"
 #include "core/Transform.hpp"
 #include "core/GraphicsAPI.hpp"
 
@@ -17,15 +18,21 @@ class Camera final {
 
    void SetAspectRatio(const float newRatio) noexcept;
 
+   [[nodiscard]] constexpr float GetNearPlane() const noexcept { return m_near; }
+   [[nodiscard]] constexpr float GetFarPlane() const noexcept { return m_far; }
+
    [[nodiscard]] const glm::mat4& GetViewMatrix();
    [[nodiscard]] const glm::mat4& GetProjectionMatrix();
    [[nodiscard]] const glm::mat4& GetCameraMatrix();
+   // World space view volume, follows the camera matrix
+   [[nodiscard]] const Frustum& GetFrustum();
 
    [[nodiscard]] constexpr const Transform& GetTransform() const noexcept { return m_transform; }
 
    constexpr Transform& GetMutableTransform() noexcept {
       m_viewDirty = true;
       m_cameraDirty = true;
+      m_frustumDirty = true;
       return m_transform;
    }
 
@@ -47,8 +54,10 @@ class Camera final {
    glm::mat4 m_view;
    glm::mat4 m_proj;
    glm::mat4 m_camera;
+   Frustum m_frustum;
 
    bool m_viewDirty;
    bool m_projDirty;
    bool m_cameraDirty;
+   bool m_frustumDirty;
 };
@@ -0,0 +1,38 @@
+#include "core/DynamicResolution.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+DynamicResolution::DynamicResolution() noexcept : DynamicResolution(Settings{}) {}
+
+DynamicResolution::DynamicResolution(const Settings& settings) noexcept
+    : m_settings(settings), m_scale(settings.maxScale) {}
+
+float DynamicResolution::Update(const float frameCostMs, const float targetMs) noexcept {
+   if (frameCostMs <= 0.0f || targetMs <= 0.0f)
+      return m_scale;
+   m_smoothedMs = m_smoothedMs > 0.0f
+                     ? m_smoothedMs + (frameCostMs - m_smoothedMs) * m_settings.smoothing
+                     : frameCostMs;
+   const float ratio = targetMs / m_smoothedMs;
+   if (std::abs(ratio - 1.0f) <= m_settings.deadBand)
+      return m_scale;
+   // Pixel count goes with the square of the scale
+   const float step = std::clamp(std::sqrt(ratio), 1.0f - m_settings.maxStep,
+                                 1.0f + m_settings.maxStep);
+   const float scale = std::clamp(m_scale * step, m_settings.minScale, m_settings.maxScale);
+   // The smoothed cost would lag the change, so it is moved to what the new scale should cost
+   m_smoothedMs *= (scale * scale) / (m_scale * m_scale);
+   m_scale = scale;
+   return m_scale;
+}
+
+void DynamicResolution::Reset() noexcept {
+   m_scale = m_settings.maxScale;
+   m_smoothedMs = 0.0f;
+}
+
+uint32_t DynamicResolution::Scale(const uint32_t extent) const noexcept {
+   const auto scaled = static_cast<uint32_t>(std::lround(static_cast<float>(extent) * m_scale));
+   return std::max<uint32_t>(std::min(scaled, extent), 1);
+}
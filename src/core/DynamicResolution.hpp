@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+// Picks the fraction of the window the scene passes render at, so that the measured frame cost
+// settles at a target. The cost of the scene passes grows roughly with their pixel count, so the
+// scale moves by the square root of how far the smoothed cost is from the target. A dead band
+// and a per-frame step limit keep single spikes from making the resolution oscillate.
+class DynamicResolution final {
+  public:
+   struct Settings final {
+      float minScale{0.5f};
+      float maxScale{1.0f};
+      // Weight of the newest sample in the smoothed cost
+      float smoothing{0.1f};
+      // Relative distance from the target within which the scale is left alone
+      float deadBand{0.05f};
+      // Largest relative change of the scale per frame
+      float maxStep{0.05f};
+   };
+
+   DynamicResolution() noexcept;
+   explicit DynamicResolution(const Settings& settings) noexcept;
+
+   // Feeds the last frame's cost and returns the scale of the next frame
+   float Update(const float frameCostMs, const float targetMs) noexcept;
+   // Back to the largest scale, e.g. when scaling is switched off
+   void Reset() noexcept;
+
+   [[nodiscard]] constexpr float GetScale() const noexcept { return m_scale; }
+   // The extent the scene passes render at, at least one pixel
+   [[nodiscard]] uint32_t Scale(const uint32_t extent) const noexcept;
+
+  private:
+   Settings m_settings;
+   float m_scale;
+   // Zero until the first sample
+   float m_smoothedMs{0.0f};
+};
@@ -1,8 +1,172 @@
 #include "core/IRenderer.hpp"
 
-IRenderer::IRenderer(Window* window) noexcept
-    : m_window(window), m_activeCamera(nullptr), m_activeScene(nullptr) {}
+#include "core/Camera.hpp"
+#include "core/RenderGraph.hpp"
+#include "core/scene/OcclusionCuller.hpp"
+#include "core/scene/PotentiallyVisibleSet.hpp"
+#include "core/scene/Scene.hpp"
+#include "core/scene/SceneStreamer.hpp"
+#include "core/scene/TransformHierarchy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+IRenderer::IRenderer(Window* window)
+    : m_window(window), m_threadPool(std::max(1u, std::thread::hardware_concurrency())),
+      m_activeCamera(nullptr), m_activeScene(nullptr), m_lightClusterer(m_threadPool),
+      m_particleSorter(m_threadPool) {}
+
+IRenderer::~IRenderer() = default;
 
 void IRenderer::SetActiveCamera(Camera* cam) noexcept { m_activeCamera = cam; }
 
-void IRenderer::SetActiveScene(Scene* scene) noexcept { m_activeScene = scene; }
+void IRenderer::SetActiveScene(Scene* scene) noexcept {
+   if (m_activeScene != scene) {
+      m_renderWorld.Reset();
+   }
+   m_activeScene = scene;
+}
+
+void IRenderer::SetSceneStreamer(SceneStreamer* streamer) noexcept { m_sceneStreamer = streamer; }
+
+void IRenderer::SetPotentiallyVisibleSet(const PotentiallyVisibleSet* pvs) noexcept {
+   m_pvs = pvs;
+   m_pvsGeneration = UINT64_MAX;
+}
+
+void IRenderer::UpdateActiveScene(const float deltaTime) {
+   if (!m_activeScene) [[unlikely]] {
+      m_renderWorld.Reset();
+      m_lightClusterer.BuildUnclustered({});
+      m_particleSorter.Clear();
+      return;
+   }
+   // Streamed cells join the scene before it updates, so they are drawn the frame they arrive
+   if (m_sceneStreamer && m_activeCamera)
+      m_sceneStreamer->Update(m_activeCamera->GetTransform().GetPosition());
+   m_activeScene->UpdateScene(deltaTime);
+   const auto extractStart = std::chrono::high_resolution_clock::now();
+   // Without a camera nothing is culled
+   const Frustum* frustum = m_activeCamera ? &m_activeCamera->GetFrustum() : nullptr;
+   m_renderWorld.Extract(*m_activeScene, *GetResourceManager(), frustum);
+   // A baked list already accounts for occlusion, so runtime occlusion only runs without one
+   const bool pvsApplied = CullPotentiallyVisible();
+   if (!pvsApplied && m_settings.occlusionCulling && m_activeCamera) {
+      if (!m_occlusionCuller)
+         m_occlusionCuller = std::make_unique<OcclusionCuller>(m_threadPool);
+      m_renderWorld.CullOccluded(*m_occlusionCuller, *GetResourceManager(),
+                                 m_activeCamera->GetCameraMatrix(),
+                                 m_activeCamera->GetTransform().GetPosition());
+   }
+   const auto extractEnd = std::chrono::high_resolution_clock::now();
+   m_renderExtractMs = std::chrono::duration<float, std::milli>(extractEnd - extractStart).count();
+   BuildLightClusters();
+   SortParticles();
+}
+
+void IRenderer::BuildLightClusters() {
+   if (!m_activeCamera) {
+      m_lightClusterer.BuildUnclustered(m_renderWorld.GetLightProxies());
+      return;
+   }
+   m_lightClusterer.Build(m_renderWorld.GetLightProxies(), m_activeCamera->GetViewMatrix(),
+                          m_activeCamera->GetProjectionMatrix(), m_activeCamera->GetNearPlane(),
+                          m_activeCamera->GetFarPlane());
+}
+
+void IRenderer::SortParticles() {
+   if (!m_settings.particleSorting || !m_activeCamera) {
+      m_particleSorter.Clear();
+      return;
+   }
+   m_particleSorter.Sort(m_renderWorld.GetParticleProxies(),
+                         m_renderWorld.GetParticleInstanceCount(),
+                         m_activeCamera->GetTransform().GetPosition(),
+                         m_activeCamera->GetViewDirection());
+}
+
+bool IRenderer::CullPotentiallyVisible() {
+   m_pvsCell = PotentiallyVisibleSet::INVALID_CELL;
+   if (!m_pvs || !m_settings.potentiallyVisibleSet || !m_activeCamera)
+      return false;
+   if (m_renderWorld.GetMeshGeneration() != m_pvsGeneration) {
+      m_pvsGeneration = m_renderWorld.GetMeshGeneration();
+      m_pvsMatches = m_pvs->Matches(m_renderWorld);
+   }
+   if (!m_pvsMatches)
+      return false;
+   m_pvsCell = m_pvs->FindCell(m_activeCamera->GetTransform().GetPosition());
+   if (m_pvsCell == PotentiallyVisibleSet::INVALID_CELL)
+      return false;
+   m_renderWorld.CullPotentiallyVisible(m_pvs->GetCellMeshes(m_pvsCell));
+   return true;
+}
+
+void IRenderer::CollectSceneMetrics() noexcept {
+   if (!m_activeScene) [[unlikely]]
+      return;
+   const auto transformStats = m_activeScene->GetTransformHierarchy()->ConsumeUpdateStats();
+   m_currentFrameMetrics.transformNodesVisited = transformStats.nodesVisited;
+   m_currentFrameMetrics.transformMatricesRecomputed = transformStats.matricesRecomputed;
+   const SystemScheduler* const scheduler = m_activeScene->GetSystemScheduler();
+   const auto& timings = scheduler->GetTimings();
+   const size_t timingCount = std::min(timings.size(), PerformanceMetrics::MAX_SYSTEM_TIMINGS);
+   std::copy_n(timings.begin(), timingCount, m_currentFrameMetrics.systemTimings.begin());
+   m_currentFrameMetrics.systemTimingCount = static_cast<uint32_t>(timingCount);
+   m_currentFrameMetrics.systemUpdateMs = scheduler->GetLastUpdateMs();
+   const RenderWorldStats& renderStats = m_renderWorld.GetStats();
+   m_currentFrameMetrics.renderExtractMs = m_renderExtractMs;
+   m_currentFrameMetrics.meshProxies = renderStats.meshProxies;
+   m_currentFrameMetrics.meshProxiesUpdated = renderStats.meshProxiesUpdated;
+   m_currentFrameMetrics.meshesVisible = renderStats.meshProxiesVisible;
+   m_currentFrameMetrics.meshesCulled = renderStats.meshProxies - renderStats.meshProxiesVisible -
+                                        renderStats.meshProxiesOccluded -
+                                        renderStats.meshProxiesPvsCulled;
+   m_currentFrameMetrics.meshesOccluded = renderStats.meshProxiesOccluded;
+   m_currentFrameMetrics.meshesPvsCulled = renderStats.meshProxiesPvsCulled;
+   m_currentFrameMetrics.pvsCell = m_pvsCell == PotentiallyVisibleSet::INVALID_CELL
+                                      ? -1
+                                      : static_cast<int32_t>(m_pvsCell);
+   m_currentFrameMetrics.lightsVisible = renderStats.lightProxies;
+   m_currentFrameMetrics.lightsCulled = renderStats.lightsCulled;
+   m_currentFrameMetrics.particleSystemsVisible = renderStats.particleProxies;
+   m_currentFrameMetrics.particleSystemsCulled = renderStats.particleSystemsCulled;
+   m_currentFrameMetrics.bvhNodesRefit = renderStats.bvhNodesRefit;
+   const LightClusterStats& clusterStats = m_lightClusterer.GetStats();
+   m_currentFrameMetrics.lightClusterMs = clusterStats.buildMs;
+   m_currentFrameMetrics.clusterLightIndices = clusterStats.lightIndices;
+   m_currentFrameMetrics.clusterMaxLights = clusterStats.maxClusterLights;
+   const ParticleSortStats& sortStats = m_particleSorter.GetStats();
+   m_currentFrameMetrics.particleSortMs = sortStats.sortMs;
+   m_currentFrameMetrics.particlesSorted = sortStats.particles;
+   // Zeroed while disabled, the setting can be toggled at runtime
+   const OcclusionStats occlusionStats = m_occlusionCuller && m_settings.occlusionCulling
+                                            ? m_occlusionCuller->GetStats()
+                                            : OcclusionStats{};
+   m_currentFrameMetrics.occluders = occlusionStats.occluders;
+   m_currentFrameMetrics.occluderTriangles = occlusionStats.occluderTriangles;
+   m_currentFrameMetrics.occlusionRasterMs = occlusionStats.rasterMs;
+   m_currentFrameMetrics.occlusionTestMs = occlusionStats.testMs;
+   if (m_sceneStreamer) {
+      const StreamingStats& streamingStats = m_sceneStreamer->GetStats();
+      m_currentFrameMetrics.streamingCells = streamingStats.cellCount;
+      m_currentFrameMetrics.streamingResidentCells = streamingStats.residentCells;
+      m_currentFrameMetrics.streamingLoadingCells = streamingStats.loadingCells;
+      m_currentFrameMetrics.streamingStalledCells = streamingStats.stalledCells;
+      m_currentFrameMetrics.streamingBytesInFlight = streamingStats.bytesInFlight;
+      m_currentFrameMetrics.streamingResidentBytes = streamingStats.residentBytes;
+      m_currentFrameMetrics.streamingBudgetBytes = streamingStats.budgetBytes;
+      m_currentFrameMetrics.streamingUploadMs = streamingStats.uploadMs;
+   }
+}
+
+void IRenderer::CollectRenderGraphMetrics(const RenderGraphStats& stats) noexcept {
+   m_currentFrameMetrics.renderGraphPasses = stats.passes;
+   m_currentFrameMetrics.renderGraphPassesCulled = stats.passesCulled;
+   m_currentFrameMetrics.renderGraphBarriers = stats.barriers;
+   m_currentFrameMetrics.transientBytes = stats.transientBytes;
+   m_currentFrameMetrics.transientReusedBytes = stats.reusedBytes;
+   m_currentFrameMetrics.transientFramesInFlightSavedBytes = stats.framesInFlightSavedBytes;
+   m_currentFrameMetrics.transientLazilySavedBytes = stats.lazilySavedBytes;
+}
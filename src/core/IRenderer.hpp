@@ -1,15 +1,26 @@
 #pragma once
 
+#include "core/RenderSettings.hpp"
+#include "core/ThreadPool.hpp"
+#include "core/scene/LightClusterer.hpp"
+#include "core/scene/ParticleSorter.hpp"
+#include "core/scene/RenderWorld.hpp"
 #include "core/system/PerformanceMetrics.hpp"
 
+#include <memory>
+
 class Window;
 class Camera;
 class Scene;
 class ResourceManager;
+class SceneStreamer;
+class OcclusionCuller;
+class PotentiallyVisibleSet;
+struct RenderGraphStats;
 
 class IRenderer {
   public:
-   virtual ~IRenderer() = default;
+   virtual ~IRenderer();
 
    IRenderer(const IRenderer&) = delete;
    IRenderer& operator=(const IRenderer&) = delete;
@@ -20,22 +31,62 @@ class IRenderer {
 
    void SetActiveCamera(Camera* cam) noexcept;
    void SetActiveScene(Scene* scene) noexcept;
+   // Updated with the active camera's position before each scene update, null detaches it
+   void SetSceneStreamer(SceneStreamer* streamer) noexcept;
+   // Baked visibility for the active scene, ignored while it does not match the proxies. Null
+   // detaches it, the set must outlive the renderer's use of it.
+   void SetPotentiallyVisibleSet(const PotentiallyVisibleSet* pvs) noexcept;
 
    [[nodiscard]] virtual ResourceManager* GetResourceManager() const noexcept = 0;
+   // Shared by the renderer's parallel work and the scenes it draws, one worker per hardware
+   // thread. Tasks must not wait on it themselves.
+   [[nodiscard]] constexpr ThreadPool& GetThreadPool() noexcept { return m_threadPool; }
+
+   // Read every frame, so changes apply from the next RenderFrame()
+   [[nodiscard]] constexpr RenderSettings& GetRenderSettings() noexcept { return m_settings; }
 
    [[nodiscard]] constexpr const PerformanceMetrics& GetCurrentFrameMetrics() const noexcept {
       return m_currentFrameMetrics;
    }
 
   protected:
-   explicit IRenderer(Window* window) noexcept;
+   explicit IRenderer(Window* window);
    virtual void SetupImgui() = 0;
    virtual void RenderImgui() = 0;
    virtual void DestroyImgui() = 0;
+   // Update the active scene and extract the render world the passes draw from
+   void UpdateActiveScene(const float deltaTime);
+   // Returns false if no baked list applies to the camera this frame
+   [[nodiscard]] bool CullPotentiallyVisible();
+   // Bins the extracted lights into the active camera's clusters for the lighting pass
+   void BuildLightClusters();
+   // Orders the extracted particles back to front for the particle pass, if enabled
+   void SortParticles();
+   // Copy the active scene's transform, system and extraction stats into the frame metrics
+   void CollectSceneMetrics() noexcept;
+   // Copy the frame's render graph stats into the frame metrics
+   void CollectRenderGraphMetrics(const RenderGraphStats& stats) noexcept;
 
   protected:
    Window* m_window{nullptr};
+   // Declared before the subsystems that hold a reference to it, so they are destroyed first
+   ThreadPool m_threadPool;
    Camera* m_activeCamera{nullptr};
    Scene* m_activeScene{nullptr};
+   SceneStreamer* m_sceneStreamer{nullptr};
+   RenderWorld m_renderWorld;
+   // Created on first use, so disabling it never allocates its depth buffer
+   std::unique_ptr<OcclusionCuller> m_occlusionCuller;
+   const PotentiallyVisibleSet* m_pvs{nullptr};
+   // Mesh generation the set was last matched against, so the check runs once per rebuild
+   uint64_t m_pvsGeneration{UINT64_MAX};
+   bool m_pvsMatches{false};
+   uint32_t m_pvsCell{UINT32_MAX};
+   // Lights and cluster lists the lighting pass reads, rebuilt every frame
+   LightClusterer m_lightClusterer;
+   // Empty while sorting is disabled, the particle pass then uploads the systems' ranges as is
+   ParticleSorter m_particleSorter;
+   RenderSettings m_settings;
+   float m_renderExtractMs{0.0f};
    PerformanceMetrics m_currentFrameMetrics;
 };
@@ -0,0 +1,357 @@
+#include "core/RenderGraph.hpp"
+
+#include "core/resource/ResourceManager.hpp"
+
+#include <algorithm>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+[[nodiscard]] constexpr bool IsDepthFormat(const ITexture::Format format) noexcept {
+   return format == ITexture::Format::Depth24 || format == ITexture::Format::Depth32F;
+}
+
+[[nodiscard]] constexpr size_t BytesPerPixel(const ITexture::Format format) noexcept {
+   switch (format) {
+      case ITexture::Format::R8:
+         return 1;
+      case ITexture::Format::RG8:
+         return 2;
+      case ITexture::Format::RGB8:
+         return 3;
+      case ITexture::Format::RGBA8:
+      case ITexture::Format::SRGB8_ALPHA8:
+      case ITexture::Format::Depth24:
+      case ITexture::Format::Depth32F:
+      case ITexture::Format::R32UI:
+         return 4;
+      case ITexture::Format::RGBA16F:
+         return 8;
+      case ITexture::Format::RGBA32F:
+         return 16;
+   }
+   std::unreachable();
+}
+
+[[nodiscard]] constexpr size_t GetTextureBytes(const RenderGraph::TextureDesc& desc) noexcept {
+   return static_cast<size_t>(desc.width) * desc.height * BytesPerPixel(desc.format);
+}
+
+} // namespace
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, const uint32_t pass) noexcept
+    : m_graph(graph), m_pass(pass) {}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Read(const TextureId texture,
+                                                         const RenderGraphAccess access) {
+   return Use(texture, access, true, false);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Write(const TextureId texture,
+                                                          const RenderGraphAccess access) {
+   return Use(texture, access, false, true);
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::SideEffect() noexcept {
+   m_graph.m_passes[m_pass].sideEffect = true;
+   return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::Use(const TextureId texture,
+                                                        const RenderGraphAccess access,
+                                                        const bool read, const bool write) {
+   if (texture >= m_graph.m_textures.size())
+      throw std::out_of_range("Render graph pass " +
+                              std::string(m_graph.m_passes[m_pass].name.GetString()) +
+                              " uses an undeclared texture");
+   std::vector<TextureUse>& uses = m_graph.m_passes[m_pass].uses;
+   const auto it = std::ranges::find(uses, texture, &TextureUse::texture);
+   if (it == uses.end()) {
+      uses.push_back(
+         TextureUse{.texture = texture, .access = access, .read = read, .write = write});
+      return *this;
+   }
+   if (it->access != access)
+      throw std::logic_error("Render graph pass " +
+                             std::string(m_graph.m_passes[m_pass].name.GetString()) + " uses " +
+                             std::string(m_graph.m_textures[texture].name.GetString()) +
+                             " in two ways");
+   it->read |= read;
+   it->write |= write;
+   return *this;
+}
+
+RenderGraph::RenderGraph(ResourceManager& resourceManager, const uint32_t framesInFlight)
+    : m_resourceManager(resourceManager), m_framesInFlight(std::max(framesInFlight, 1u)) {}
+
+// The pool belongs to the resource manager, which may already be gone here
+RenderGraph::~RenderGraph() = default;
+
+void RenderGraph::Reset() {
+   m_passCount = 0;
+   m_textures.clear();
+   m_finalBarriers.clear();
+}
+
+RenderGraph::TextureId RenderGraph::CreateTexture(const StringId name, const TextureDesc& desc) {
+   m_textures.push_back(VirtualTexture{.name = name, .desc = desc});
+   return static_cast<TextureId>(m_textures.size() - 1);
+}
+
+RenderGraph::TextureId RenderGraph::ImportTexture(const StringId name,
+                                                  const TextureHandle& handle,
+                                                  const RenderGraphAccess initialAccess,
+                                                  const RenderGraphAccess finalAccess) {
+   m_textures.push_back(VirtualTexture{.name = name,
+                                       .imported = true,
+                                       .handle = handle,
+                                       .initialAccess = initialAccess,
+                                       .finalAccess = finalAccess});
+   return static_cast<TextureId>(m_textures.size() - 1);
+}
+
+RenderGraph::PassBuilder RenderGraph::AddPass(const StringId name, ExecuteFn execute) {
+   if (m_passCount == m_passes.size())
+      m_passes.emplace_back();
+   Pass& pass = m_passes[m_passCount];
+   pass.name = name;
+   pass.execute = std::move(execute);
+   pass.uses.clear();
+   pass.barriers.clear();
+   pass.sideEffect = false;
+   pass.culled = false;
+   return PassBuilder(*this, m_passCount++);
+}
+
+void RenderGraph::SetTextureCreatedCallback(TextureCreatedFn callback) {
+   m_textureCreated = std::move(callback);
+}
+
+void RenderGraph::Compile() {
+   ++m_frame;
+   m_stats = {};
+   CullPasses();
+   AllocateTransients();
+   ComputeBarriers();
+   ReleaseUnusedPhysicals();
+}
+
+void RenderGraph::ReleaseTransients() {
+   for (const PhysicalTexture& physical : m_physicals) {
+      if (physical.handle.IsValid())
+         m_resourceManager.UnloadTexture(physical.handle);
+   }
+   m_physicals.clear();
+   m_placements.clear();
+   for (VirtualTexture& texture : m_textures)
+      texture.physical = UINT32_MAX;
+   ++m_version;
+}
+
+TextureHandle RenderGraph::GetTexture(const TextureId texture) const {
+   if (texture >= m_textures.size())
+      return {};
+   const VirtualTexture& virtualTexture = m_textures[texture];
+   if (virtualTexture.imported)
+      return virtualTexture.handle;
+   return virtualTexture.physical < m_physicals.size()
+             ? m_physicals[virtualTexture.physical].handle
+             : TextureHandle{};
+}
+
+bool RenderGraph::IsPassCulled(const StringId name) const {
+   const auto passes = std::span(m_passes).first(m_passCount);
+   const auto it = std::ranges::find(passes, name, &Pass::name);
+   return it != passes.end() && it->culled;
+}
+
+void RenderGraph::CullPasses() {
+   // Walks back from the passes with visible results, a write ends the need for what it
+   // replaces and a read starts the need for what came before
+   const std::span<Pass> passes = std::span(m_passes).first(m_passCount);
+   m_needed.assign(m_textures.size(), 0);
+   for (Pass& pass : passes | std::views::reverse) {
+      pass.culled = !pass.sideEffect && std::ranges::none_of(pass.uses, [&](const TextureUse& use) {
+         return use.write && (m_needed[use.texture] || m_textures[use.texture].imported);
+      });
+      if (pass.culled) {
+         ++m_stats.passesCulled;
+         continue;
+      }
+      ++m_stats.passes;
+      for (const TextureUse& use : pass.uses) {
+         if (use.write && !use.read)
+            m_needed[use.texture] = 0;
+      }
+      for (const TextureUse& use : pass.uses) {
+         if (use.read)
+            m_needed[use.texture] = 1;
+      }
+   }
+   for (uint32_t passIndex = 0; passIndex < passes.size(); ++passIndex) {
+      if (passes[passIndex].culled)
+         continue;
+      for (const TextureUse& use : passes[passIndex].uses) {
+         VirtualTexture& texture = m_textures[use.texture];
+         texture.firstPass = std::min(texture.firstPass, passIndex);
+         texture.lastPass = std::max(texture.lastPass, passIndex);
+      }
+   }
+}
+
+void RenderGraph::AllocateTransients() {
+   for (PhysicalTexture& physical : m_physicals)
+      physical.assigned = false;
+   m_transients.clear();
+   for (TextureId id = 0; id < m_textures.size(); ++id) {
+      if (!m_textures[id].imported && m_textures[id].firstPass != UINT32_MAX)
+         m_transients.push_back(id);
+   }
+   // Insertion sort, stable and allocation free, there are only a handful of transients
+   for (size_t i = 1; i < m_transients.size(); ++i) {
+      const TextureId id = m_transients[i];
+      size_t j = i;
+      for (; j > 0 && m_textures[m_transients[j - 1]].firstPass > m_textures[id].firstPass; --j)
+         m_transients[j] = m_transients[j - 1];
+      m_transients[j] = id;
+   }
+   for (const TextureId id : m_transients) {
+      VirtualTexture& texture = m_textures[id];
+      // A pooled texture is free once the transient placed in it last was used for the last
+      // time, the one this transient had last frame is preferred so views stay valid
+      uint32_t chosen = UINT32_MAX;
+      for (uint32_t i = 0; i < m_physicals.size(); ++i) {
+         const PhysicalTexture& physical = m_physicals[i];
+         if (!physical.handle.IsValid() || physical.desc != texture.desc)
+            continue;
+         if (physical.assigned && physical.busyUntil >= texture.firstPass)
+            continue;
+         if (chosen == UINT32_MAX)
+            chosen = i;
+         if (physical.owner == texture.name) {
+            chosen = i;
+            break;
+         }
+      }
+      if (chosen == UINT32_MAX)
+         chosen = CreatePhysical(texture.desc);
+      PhysicalTexture& physical = m_physicals[chosen];
+      physical.assigned = true;
+      physical.busyUntil = texture.lastPass;
+      physical.owner = texture.name;
+      physical.lastFrame = m_frame;
+      texture.physical = chosen;
+      const auto [it, inserted] = m_placements.try_emplace(texture.name, chosen);
+      if (inserted || it->second != chosen) {
+         it->second = chosen;
+         ++m_version;
+      }
+      ++m_stats.transientTextures;
+      m_stats.transientBytes += GetTextureBytes(texture.desc);
+   }
+   for (const PhysicalTexture& physical : m_physicals) {
+      if (!physical.assigned)
+         continue;
+      ++m_stats.physicalTextures;
+      const size_t bytes = GetTextureBytes(physical.desc);
+      m_stats.allocatedBytes += bytes;
+      if (physical.desc.transientAttachment) {
+         const ITexture* const texture = m_resourceManager.GetTexture(physical.handle);
+         m_stats.lazilySavedBytes += bytes - std::min(texture->GetMemoryUsage(), bytes);
+      }
+   }
+   m_stats.reusedBytes = m_stats.transientBytes - std::min(m_stats.allocatedBytes,
+                                                          m_stats.transientBytes);
+   m_stats.framesInFlightSavedBytes = m_stats.allocatedBytes * (m_framesInFlight - 1);
+}
+
+void RenderGraph::ComputeBarriers() {
+   // Imports start where their owner left them, transients where the last frame left their
+   // pooled texture, so transients sharing one also wait for the one placed there before them
+   std::vector<AccessState>& importStates = m_importStates;
+   std::vector<AccessState>& physicalStates = m_physicalStates;
+   importStates.resize(m_textures.size());
+   physicalStates.resize(m_physicals.size());
+   for (TextureId id = 0; id < m_textures.size(); ++id)
+      importStates[id] = AccessState{m_textures[id].initialAccess, false};
+   for (uint32_t i = 0; i < m_physicals.size(); ++i)
+      physicalStates[i] = AccessState{m_physicals[i].access, m_physicals[i].written};
+   m_used.assign(m_textures.size(), 0);
+   for (Pass& pass : std::span(m_passes).first(m_passCount)) {
+      pass.barriers.clear();
+      if (pass.culled)
+         continue;
+      for (const TextureUse& use : pass.uses) {
+         const VirtualTexture& texture = m_textures[use.texture];
+         AccessState& state =
+            texture.imported ? importStates[use.texture] : physicalStates[texture.physical];
+         // A transient's contents are undefined until its first pass writes them
+         const bool firstUse = !texture.imported && !m_used[use.texture];
+         m_used[use.texture] = 1;
+         // Only reads of an unchanged access may run without waiting for each other
+         if (firstUse || state.access != use.access || state.written || use.write) {
+            pass.barriers.push_back(Barrier{.texture = use.texture,
+                                            .before = state.access,
+                                            .after = use.access,
+                                            .discard = firstUse || !use.read});
+         }
+         state = AccessState{use.access, use.write};
+      }
+      m_stats.barriers += static_cast<uint32_t>(pass.barriers.size());
+   }
+   for (TextureId id = 0; id < m_textures.size(); ++id) {
+      const VirtualTexture& texture = m_textures[id];
+      if (!texture.imported || texture.finalAccess == RenderGraphAccess::None)
+         continue;
+      if (importStates[id].access == texture.finalAccess && !importStates[id].written)
+         continue;
+      m_finalBarriers.push_back(Barrier{.texture = id,
+                                        .before = importStates[id].access,
+                                        .after = texture.finalAccess,
+                                        .discard = false});
+   }
+   m_stats.barriers += static_cast<uint32_t>(m_finalBarriers.size());
+   for (uint32_t i = 0; i < m_physicals.size(); ++i) {
+      m_physicals[i].access = physicalStates[i].access;
+      m_physicals[i].written = physicalStates[i].written;
+   }
+}
+
+void RenderGraph::ReleaseUnusedPhysicals() {
+   // Frames still in flight may use a pooled texture for this many frames after its last use
+   for (uint32_t i = 0; i < m_physicals.size(); ++i) {
+      PhysicalTexture& physical = m_physicals[i];
+      if (!physical.handle.IsValid() || physical.assigned ||
+          m_frame - physical.lastFrame <= m_framesInFlight)
+         continue;
+      m_resourceManager.UnloadTexture(physical.handle);
+      physical = PhysicalTexture{};
+      std::erase_if(m_placements, [i](const auto& placement) { return placement.second == i; });
+      ++m_version;
+   }
+}
+
+uint32_t RenderGraph::CreatePhysical(const TextureDesc& desc) {
+   const std::string name = "rendergraph_" + std::to_string(m_createdCount++);
+   const TextureHandle handle =
+      IsDepthFormat(desc.format)
+         ? m_resourceManager.CreateDepthTexture(name, desc.width, desc.height, desc.format)
+         : m_resourceManager.CreateRenderTarget(name, desc.width, desc.height, desc.format, 1,
+                                                desc.transientAttachment);
+   if (!handle.IsValid())
+      throw std::runtime_error("Failed to create render graph texture " + name);
+   if (m_textureCreated)
+      m_textureCreated(handle);
+   // Released slots are reused before the pool grows
+   const auto freeSlot = std::ranges::find_if(
+      m_physicals, [](const PhysicalTexture& physical) { return !physical.handle.IsValid(); });
+   const auto index = static_cast<uint32_t>(freeSlot - m_physicals.begin());
+   if (freeSlot == m_physicals.end())
+      m_physicals.emplace_back();
+   m_physicals[index] = PhysicalTexture{.desc = desc, .handle = handle};
+   ++m_version;
+   return index;
+}
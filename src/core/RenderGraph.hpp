@@ -0,0 +1,287 @@
+#pragma once
+
+#include "core/StringId.hpp"
+#include "core/resource/ITexture.hpp"
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ResourceManager;
+
+// How a pass uses a texture, backends map it to layouts, stages and access masks
+enum class RenderGraphAccess : uint8_t {
+   // Contents undefined, only valid as the initial access of an import
+   None,
+   ColorAttachment,
+   DepthAttachment,
+   // Depth tested against while the same pass samples it
+   DepthAttachmentSampled,
+   Sampled,
+   // Handed to the presentation engine
+   Present
+};
+
+struct RenderGraphStats final {
+   uint32_t passes{0};
+   uint32_t passesCulled{0};
+   uint32_t barriers{0};
+   // Transient textures the kept passes use, and the pooled textures backing them
+   uint32_t transientTextures{0};
+   uint32_t physicalTextures{0};
+   // What the transients would take with a texture each, and what the pool holds for them
+   size_t transientBytes{0};
+   size_t allocatedBytes{0};
+   // Not allocated because transients with the same description and disjoint lifetimes reuse
+   // one pooled texture
+   size_t reusedBytes{0};
+   // Not allocated because the frames in flight share the pool instead of each having a copy
+   size_t framesInFlightSavedBytes{0};
+   // Allocated for transient attachments but not committed, as the device backs them lazily
+   size_t lazilySavedBytes{0};
+};
+
+// Passes are declared every frame with the textures they read and write. Compile() culls the
+// passes nothing depends on, computes the barriers between uses and places the transient
+// textures in a pool, where textures with the same description share one allocation once their
+// lifetimes no longer overlap. Passes run in declaration order, which already satisfies every
+// dependency a pass can declare. Pooled textures are shared by the frames in flight, the
+// barriers order each frame's uses after the previous frame's.
+// Passes and textures are named by StringId and referred to by index, pass callbacks are stored
+// in place and every per-frame array keeps its capacity, so rebuilding the graph each frame
+// does not allocate once it reached its largest shape.
+class RenderGraph final {
+  public:
+   using TextureId = uint32_t;
+   static constexpr TextureId INVALID_TEXTURE = UINT32_MAX;
+
+   struct TextureDesc final {
+      uint32_t width{0};
+      uint32_t height{0};
+      ITexture::Format format{ITexture::Format::RGBA8};
+      // Only an attachment within one render pass that never stores it, which lets tile-based
+      // GPUs keep it in tile memory instead of committing any for it
+      bool transientAttachment{false};
+
+      [[nodiscard]] bool operator==(const TextureDesc&) const = default;
+   };
+
+   // Moves a texture from one access to the next, discard means its contents are not needed
+   struct Barrier final {
+      TextureId texture;
+      RenderGraphAccess before;
+      RenderGraphAccess after;
+      bool discard;
+   };
+
+   // Pass callback, a void() callable stored in place instead of on the heap
+   class ExecuteFn final {
+     public:
+      static constexpr size_t CAPACITY = 128;
+
+      ExecuteFn() noexcept = default;
+      template <typename Fn>
+         requires(!std::same_as<std::remove_cvref_t<Fn>, ExecuteFn> &&
+                  std::invocable<std::decay_t<Fn>&>)
+      ExecuteFn(Fn&& fn) {
+         using Stored = std::decay_t<Fn>;
+         static_assert(sizeof(Stored) <= CAPACITY, "Pass callback captures too much");
+         static_assert(alignof(Stored) <= alignof(std::max_align_t));
+         static_assert(std::is_nothrow_move_constructible_v<Stored>);
+         ::new (static_cast<void*>(m_storage)) Stored(std::forward<Fn>(fn));
+         m_invoke = [](void* const storage) { (*static_cast<Stored*>(storage))(); };
+         // Moves the callable to another storage, or only destroys it if there is none
+         m_relocate = [](void* const from, void* const to) noexcept {
+            if (to)
+               ::new (to) Stored(std::move(*static_cast<Stored*>(from)));
+            static_cast<Stored*>(from)->~Stored();
+         };
+      }
+      ExecuteFn(ExecuteFn&& other) noexcept { MoveFrom(other); }
+      ExecuteFn& operator=(ExecuteFn&& other) noexcept {
+         if (this != &other) {
+            Destroy();
+            MoveFrom(other);
+         }
+         return *this;
+      }
+      ExecuteFn(const ExecuteFn&) = delete;
+      ExecuteFn& operator=(const ExecuteFn&) = delete;
+      ~ExecuteFn() { Destroy(); }
+
+      [[nodiscard]] explicit operator bool() const noexcept { return m_invoke != nullptr; }
+      void operator()() { m_invoke(m_storage); }
+
+     private:
+      void MoveFrom(ExecuteFn& other) noexcept {
+         if (!other.m_invoke)
+            return;
+         other.m_relocate(other.m_storage, m_storage);
+         m_invoke = std::exchange(other.m_invoke, nullptr);
+         m_relocate = std::exchange(other.m_relocate, nullptr);
+      }
+      void Destroy() noexcept {
+         if (!m_invoke)
+            return;
+         m_relocate(m_storage, nullptr);
+         m_invoke = nullptr;
+         m_relocate = nullptr;
+      }
+
+      alignas(std::max_align_t) std::byte m_storage[CAPACITY];
+      void (*m_invoke)(void*){nullptr};
+      void (*m_relocate)(void*, void*) noexcept {nullptr};
+   };
+
+   // Called for every pooled texture the graph creates, e.g. to set its sampler
+   using TextureCreatedFn = std::function<void(const TextureHandle&)>;
+
+   // Declares the textures of the pass AddPass() returned
+   class PassBuilder final {
+     public:
+      // Reading and writing the same texture keeps its contents, a write alone discards them
+      PassBuilder& Read(const TextureId texture, const RenderGraphAccess access);
+      PassBuilder& Write(const TextureId texture, const RenderGraphAccess access);
+      // Keeps the pass even if nothing reads what it writes
+      PassBuilder& SideEffect() noexcept;
+
+     private:
+      friend class RenderGraph;
+      PassBuilder(RenderGraph& graph, const uint32_t pass) noexcept;
+      PassBuilder& Use(const TextureId texture, const RenderGraphAccess access, const bool read,
+                       const bool write);
+
+      RenderGraph& m_graph;
+      uint32_t m_pass;
+   };
+
+   // framesInFlight is how many frames may still use a pooled texture after it was last used
+   explicit RenderGraph(ResourceManager& resourceManager, const uint32_t framesInFlight = 1);
+   ~RenderGraph();
+
+   RenderGraph(const RenderGraph&) = delete;
+   RenderGraph& operator=(const RenderGraph&) = delete;
+   RenderGraph(RenderGraph&&) = delete;
+   RenderGraph& operator=(RenderGraph&&) = delete;
+
+   // Drops the previous frame's passes and textures, the pool and all capacity are kept
+   void Reset();
+   // The name keeps a transient in the same pooled texture from frame to frame
+   TextureId CreateTexture(const StringId name, const TextureDesc& desc);
+   // A texture owned elsewhere, e.g. the swapchain image, which may have an invalid handle.
+   // finalAccess is the access it is left in after the last pass, None leaves it as used.
+   TextureId ImportTexture(const StringId name, const TextureHandle& handle,
+                           const RenderGraphAccess initialAccess,
+                           const RenderGraphAccess finalAccess = RenderGraphAccess::None);
+   PassBuilder AddPass(const StringId name, ExecuteFn execute);
+   void SetTextureCreatedCallback(TextureCreatedFn callback);
+
+   void Compile();
+   // Runs the kept passes, each after its barriers, then the barriers into the final accesses.
+   // barrierFn is called with a std::span<const Barrier>.
+   template <typename BarrierFn>
+   void Execute(BarrierFn&& barrierFn) {
+      for (Pass& pass : std::span(m_passes).first(m_passCount)) {
+         if (pass.culled)
+            continue;
+         if (!pass.barriers.empty())
+            barrierFn(std::span<const Barrier>(pass.barriers));
+         if (pass.execute)
+            pass.execute();
+      }
+      if (!m_finalBarriers.empty())
+         barrierFn(std::span<const Barrier>(m_finalBarriers));
+   }
+   // Destroys the pool, e.g. when the targets are resized. The caller waits for the GPU first.
+   void ReleaseTransients();
+
+   // The texture backing a virtual texture, valid after Compile()
+   [[nodiscard]] TextureHandle GetTexture(const TextureId texture) const;
+   [[nodiscard]] bool IsPassCulled(const StringId name) const;
+   // Incremented whenever a transient moves to another pooled texture, so views of them can
+   // be re-pointed
+   [[nodiscard]] constexpr uint64_t GetVersion() const noexcept { return m_version; }
+   [[nodiscard]] constexpr const RenderGraphStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   struct TextureUse final {
+      TextureId texture;
+      RenderGraphAccess access;
+      bool read;
+      bool write;
+   };
+   // Slots are reused from frame to frame, so the use and barrier arrays keep their capacity
+   struct Pass final {
+      StringId name;
+      ExecuteFn execute;
+      std::vector<TextureUse> uses;
+      std::vector<Barrier> barriers;
+      bool sideEffect{false};
+      bool culled{false};
+   };
+   struct VirtualTexture final {
+      StringId name;
+      TextureDesc desc;
+      bool imported{false};
+      TextureHandle handle;
+      RenderGraphAccess initialAccess{RenderGraphAccess::None};
+      RenderGraphAccess finalAccess{RenderGraphAccess::None};
+      // Index into the pool, transients only
+      uint32_t physical{UINT32_MAX};
+      uint32_t firstPass{UINT32_MAX};
+      uint32_t lastPass{0};
+   };
+   struct PhysicalTexture final {
+      TextureDesc desc;
+      TextureHandle handle;
+      // Where the last frame that used it left it
+      RenderGraphAccess access{RenderGraphAccess::None};
+      bool written{false};
+      // The transient it held last, preferred when it asks again
+      StringId owner;
+      uint64_t lastFrame{0};
+      // Last pass of the transient currently placed in it, this frame
+      uint32_t busyUntil{0};
+      bool assigned{false};
+   };
+   struct AccessState final {
+      RenderGraphAccess access;
+      bool written;
+   };
+
+   void CullPasses();
+   void AllocateTransients();
+   void ComputeBarriers();
+   void ReleaseUnusedPhysicals();
+   [[nodiscard]] uint32_t CreatePhysical(const TextureDesc& desc);
+
+  private:
+   ResourceManager& m_resourceManager;
+   uint32_t m_framesInFlight;
+   // Only the first m_passCount slots belong to this frame
+   std::vector<Pass> m_passes;
+   uint32_t m_passCount{0};
+   std::vector<VirtualTexture> m_textures;
+   std::vector<Barrier> m_finalBarriers;
+   std::vector<PhysicalTexture> m_physicals;
+   // Pooled texture each transient name was placed in last frame
+   std::unordered_map<StringId, uint32_t> m_placements;
+   // Scratch arrays of Compile(), members so they keep their capacity
+   std::vector<uint8_t> m_needed;
+   std::vector<TextureId> m_transients;
+   std::vector<AccessState> m_importStates;
+   std::vector<AccessState> m_physicalStates;
+   std::vector<uint8_t> m_used;
+   TextureCreatedFn m_textureCreated;
+   uint64_t m_frame{0};
+   uint64_t m_version{0};
+   uint32_t m_createdCount{0};
+   RenderGraphStats m_stats{};
+};
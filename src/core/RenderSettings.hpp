@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+
+// How the opaque geometry is shaded, every pipeline reads the same clustered light lists
+enum class RenderPipeline : uint8_t {
+   // Geometry pass into the G-buffer, then a full-screen lighting pass
+   Deferred,
+   // Depth prepass, then a forward pass shading each mesh against its clusters' lights
+   ForwardPlus,
+   // Triangle ids and depth only, then materials are resolved per pixel into the G-buffer
+   // before the deferred lighting pass
+   VisibilityBuffer,
+   Count
+};
+
+[[nodiscard]] constexpr const char* GetRenderPipelineName(const RenderPipeline pipeline) noexcept {
+   switch (pipeline) {
+      case RenderPipeline::Deferred:
+         return "Deferred";
+      case RenderPipeline::ForwardPlus:
+         return "Forward+";
+      case RenderPipeline::VisibilityBuffer:
+         return "Visibility Buffer";
+      case RenderPipeline::Count:
+         return "Unknown";
+   }
+   std::unreachable();
+}
+
+// Renderer features that can be switched while running, from the command line or the overlay
+struct RenderSettings final {
+   RenderPipeline pipeline{RenderPipeline::Deferred};
+   // Software occlusion culling of the frustum visible meshes
+   bool occlusionCulling{false};
+   // Baked cell visibility, replaces occlusion culling while the camera is inside a baked cell
+   bool potentiallyVisibleSet{false};
+   // Back to front ordering of the visible particles, so their blending is correct
+   bool particleSorting{true};
+   // Compute culling and indirect count draws for the geometry pass, Vulkan and deferred only
+   bool gpuDrivenGeometry{false};
+   // Set by the renderer, false when the device lacks indirect count draws
+   bool gpuDrivenGeometryAvailable{false};
+   // Geometry and lighting as two subpasses of one render pass, reading the G-buffer as input
+   // attachments that are never stored, Vulkan and deferred only
+   bool gBufferSubpasses{false};
+   // Set by renderers that implement the G-buffer subpasses
+   bool gBufferSubpassesAvailable{false};
+   // Position-only depth pass before the deferred geometry pass, which then shades each pixel
+   // once with an equal depth test. Ignored with GPU-driven geometry or G-buffer subpasses.
+   bool depthPrepass{false};
+   // Replaces the lit image with how many fragments the opaque shading pass shades per pixel
+   bool overdrawView{false};
+   // Scene passes render into part of their attachments, scaled so their GPU time stays near
+   // targetFrameTimeMs, and are upscaled to the window
+   bool dynamicResolution{false};
+   float targetFrameTimeMs{16.6f};
+   // Set by renderers that implement dynamic resolution, the others always render at scale 1
+   bool dynamicResolutionAvailable{false};
+   // Set by renderers that implement the visibility buffer, the others draw it as deferred
+   bool visibilityBufferAvailable{false};
+
+   [[nodiscard]] constexpr bool IsAvailable(const RenderPipeline candidate) const noexcept {
+      return candidate != RenderPipeline::VisibilityBuffer || visibilityBufferAvailable;
+   }
+   // The selected pipeline, or deferred if this renderer cannot draw it
+   [[nodiscard]] constexpr RenderPipeline GetActivePipeline() const noexcept {
+      return IsAvailable(pipeline) ? pipeline : RenderPipeline::Deferred;
+   }
+};
@@ -0,0 +1,43 @@
+#include "core/StringId.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Node-based map, so interned strings never move once inserted
+struct InternTable final {
+   std::shared_mutex mutex;
+   std::unordered_map<uint64_t, std::string> strings;
+};
+
+InternTable& GetInternTable() {
+   static InternTable s_table;
+   return s_table;
+}
+
+} // namespace
+
+StringId StringId::Intern(const std::string_view str) {
+   StringId id(str);
+   InternTable& table = GetInternTable();
+   std::unique_lock lock(table.mutex);
+   const auto [it, inserted] = table.strings.try_emplace(id.m_hash, str);
+   // Literal ids are hashed at compile time and never reach this table, so registration is the
+   // only place a collision can be caught
+   if (!inserted && it->second != str) [[unlikely]] {
+      throw std::runtime_error("StringId hash collision between \"" + it->second + "\" and \"" +
+                               std::string(str) + "\"");
+   }
+   id.m_str = it->second.c_str();
+   return id;
+}
+
+const char* StringId::Resolve(const uint64_t hash) noexcept {
+   InternTable& table = GetInternTable();
+   std::shared_lock lock(table.mutex);
+   const auto it = table.strings.find(hash);
+   return it != table.strings.end() ? it->second.c_str() : "";
+}
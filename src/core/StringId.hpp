@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+// Hashed name used as a lookup key. String literals are hashed at compile time and runtime strings
+// are only hashed, so comparing or hashing an id never touches its characters again. Names that
+// are registered under an id go through Intern(), which keeps the string for GetString() and
+// rejects hash collisions, so equal hashes mean equal strings.
+class StringId final {
+  public:
+   constexpr StringId() noexcept = default;
+
+   template <size_t N>
+   consteval StringId(const char (&str)[N]) noexcept
+       : m_hash(Hash(std::string_view(str, N - 1))), m_str(str) {}
+   // Lookup key, hashes the string without storing it
+   constexpr StringId(const std::string_view str) noexcept : m_hash(Hash(str)), m_str(nullptr) {}
+   constexpr StringId(const std::string& str) noexcept : StringId(std::string_view(str)) {}
+
+   // Key that a name is registered under. Keeps the string for the rest of the program and
+   // throws std::runtime_error if a different string was interned with the same hash
+   [[nodiscard]] static StringId Intern(const std::string_view str);
+
+   [[nodiscard]] static constexpr uint64_t Hash(const std::string_view str) noexcept {
+      uint64_t hash = FNV_OFFSET_BASIS;
+      for (const char c : str) {
+         hash ^= static_cast<uint8_t>(c);
+         hash *= FNV_PRIME;
+      }
+      return hash;
+   }
+
+   [[nodiscard]] constexpr uint64_t GetHash() const noexcept { return m_hash; }
+   [[nodiscard]] constexpr bool IsEmpty() const noexcept { return m_hash == FNV_OFFSET_BASIS; }
+   // Null-terminated and alive for the rest of the program. Lookup keys resolve their string
+   // through the intern table and are empty if it was never interned
+   [[nodiscard]] const char* CStr() const noexcept { return m_str ? m_str : Resolve(m_hash); }
+   [[nodiscard]] std::string_view GetString() const noexcept { return CStr(); }
+
+   [[nodiscard]] constexpr bool operator==(const StringId& other) const noexcept {
+      return m_hash == other.m_hash;
+   }
+
+  private:
+   // 64-bit FNV-1a
+   static constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+   static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+   [[nodiscard]] static const char* Resolve(const uint64_t hash) noexcept;
+
+   uint64_t m_hash{FNV_OFFSET_BASIS};
+   // Null for lookup keys, see CStr()
+   const char* m_str{""};
+};
+
+template <>
+struct std::hash<StringId> {
+   [[nodiscard]] constexpr size_t operator()(const StringId& id) const noexcept {
+      return static_cast<size_t>(id.GetHash());
+   }
+};
@@ -1,5 +1,13 @@
 #include "core/ThreadPool.hpp"
 #include <atomic>
+#include <stdexcept>
+
+namespace {
+
+// Pool the calling thread works for, if any
+thread_local const ThreadPool* t_workerPool = nullptr;
+
+} // namespace
 
 ThreadPool::ThreadPool() : ThreadPool(1) {}
 
@@ -33,16 +41,36 @@ void ThreadPool::Submit(const std::function<void()> task) {
          throw std::runtime_error("Cannot submit task to stopped ThreadPool");
       }
       m_activeTasks.fetch_add(1, std::memory_order_release);
-      m_tasks.emplace(std::move(task));
+      m_tasks.push({.function = std::move(task), .group = nullptr});
+   }
+   m_condition.notify_one();
+}
+
+void ThreadPool::Submit(TaskGroup& group, const std::function<void()> task) {
+   if (IsWorkerThread()) {
+      task();
+      return;
+   }
+   {
+      std::unique_lock<std::mutex> lock(m_queueMutex);
+      if (m_stop.load(std::memory_order_relaxed)) {
+         throw std::runtime_error("Cannot submit task to stopped ThreadPool");
+      }
+      m_activeTasks.fetch_add(1, std::memory_order_release);
+      group.m_pending.fetch_add(1, std::memory_order_release);
+      m_tasks.push({.function = std::move(task), .group = &group});
    }
    m_condition.notify_one();
 }
 
 size_t ThreadPool::GetThreadCount() const noexcept { return m_threads.size(); }
 
+bool ThreadPool::IsWorkerThread() const noexcept { return t_workerPool == this; }
+
 void ThreadPool::WorkerThread() {
+   t_workerPool = this;
    while (true) {
-      std::function<void()> task;
+      QueuedTask task{};
       {
          std::unique_lock<std::mutex> lock(m_queueMutex);
          m_condition.wait(
@@ -55,8 +83,13 @@ void ThreadPool::WorkerThread() {
             m_tasks.pop();
          }
       }
-      if (task) {
-         task();
+      if (task.function) {
+         task.function();
+         if (task.group && task.group->m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Under the lock, so a waiter cannot miss it between its check and its wait
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_waitCondition.notify_all();
+         }
          const size_t remaining = m_activeTasks.fetch_sub(1, std::memory_order_acq_rel) - 1;
          if (remaining == 0) {
             m_waitCondition.notify_all();
@@ -70,3 +103,9 @@ void ThreadPool::WaitForAll() {
    m_waitCondition.wait(lock,
                         [this]() { return m_activeTasks.load(std::memory_order_acquire) == 0; });
 }
+
+void ThreadPool::Wait(TaskGroup& group) {
+   std::unique_lock<std::mutex> lock(m_queueMutex);
+   m_waitCondition.wait(
+      lock, [&group]() { return group.m_pending.load(std::memory_order_acquire) == 0; });
+}
@@ -10,6 +10,21 @@
 
 class ThreadPool {
   public:
+   // Counts the tasks one caller submitted, so waiting on it ignores everyone else's work.
+   // Must be waited on before it goes out of scope.
+   class TaskGroup final {
+     public:
+      TaskGroup() = default;
+      TaskGroup(const TaskGroup&) = delete;
+      TaskGroup& operator=(const TaskGroup&) = delete;
+      TaskGroup(TaskGroup&&) = delete;
+      TaskGroup& operator=(TaskGroup&&) = delete;
+
+     private:
+      friend class ThreadPool;
+      std::atomic<size_t> m_pending{0};
+   };
+
    ThreadPool();
    explicit ThreadPool(const size_t numThreads);
    ~ThreadPool();
@@ -20,15 +35,26 @@ class ThreadPool {
    ThreadPool& operator=(ThreadPool&&) = delete;
 
    void Submit(const std::function<void()> task);
+   // Called from one of this pool's own workers the task runs inline, since waiting for it
+   // there could mean waiting for the worker's own task
+   void Submit(TaskGroup& group, const std::function<void()> task);
 
    [[nodiscard]] size_t GetThreadCount() const noexcept;
+   [[nodiscard]] bool IsWorkerThread() const noexcept;
    void WaitForAll();
+   // Blocks until every task submitted with the group has finished
+   void Wait(TaskGroup& group);
 
   private:
+   struct QueuedTask final {
+      std::function<void()> function;
+      TaskGroup* group;
+   };
+
    void WorkerThread();
 
    std::vector<std::thread> m_threads;
-   std::queue<std::function<void()>> m_tasks;
+   std::queue<QueuedTask> m_tasks;
 
    std::mutex m_queueMutex;
    std::condition_variable m_condition;
@@ -1,5 +1,7 @@
 #include "core/Transform.hpp"
 
+#include "core/TransformBatch.hpp"
+
 #include <glm/gtx/matrix_decompose.hpp>
 
 Transform::Transform(const glm::vec3& position, const glm::quat& rotation,
@@ -31,6 +33,7 @@ Transform& Transform::operator=(const Transform& other) noexcept {
       m_scl = other.m_scl;
       m_matrix = other.m_matrix;
       m_dirty = other.m_dirty;
+      NotifyListener();
    }
    return *this;
 }
@@ -49,6 +52,7 @@ Transform& Transform::operator=(Transform&& other) noexcept {
       m_scl = std::move(other.m_scl);
       m_matrix = std::move(other.m_matrix);
       m_dirty = other.m_dirty;
+      NotifyListener();
    }
    return *this;
 }
@@ -155,13 +159,26 @@ glm::vec3 Transform::GetUp() const noexcept {
 
 glm::vec3 Transform::GetEulerAngles() const noexcept { return glm::eulerAngles(m_rot); }
 
-void Transform::MarkDirty() noexcept { m_dirty = true; }
+void Transform::SetListener(ITransformListener* const listener, const uint32_t slot) noexcept {
+   m_listener = listener;
+   m_listenerSlot = slot;
+   m_changeNotified = false;
+}
+
+void Transform::MarkDirty() noexcept {
+   m_dirty = true;
+   NotifyListener();
+}
+
+void Transform::NotifyListener() noexcept {
+   if (m_listener && !m_changeNotified) {
+      m_changeNotified = true;
+      m_listener->OnTransformChanged(m_listenerSlot);
+   }
+}
 
 void Transform::RecalculateMatrix() const noexcept {
-   const glm::mat4 translation = glm::translate(glm::mat4(1.0f), m_pos);
-   const glm::mat4 rotation = glm::toMat4(m_rot);
-   const glm::mat4 scaling = glm::scale(glm::mat4(1.0f), m_scl);
-   m_matrix = translation * rotation * scaling;
+   TransformBatch::ComposeTRS(&m_pos, &m_rot, &m_scl, &m_matrix, 1);
 }
 
 bool Transform::DecomposeMatrix(const glm::mat4& matrix, glm::vec3& position, glm::quat& rotation,
@@ -4,6 +4,15 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/quaternion.hpp>
 
+#include <cstdint>
+
+// Notified the first time a transform changes after its last acknowledged change
+class ITransformListener {
+  public:
+   virtual ~ITransformListener() = default;
+   virtual void OnTransformChanged(const uint32_t slot) noexcept = 0;
+};
+
 class Transform final {
   public:
    explicit Transform(const glm::vec3& position = glm::vec3(0.0f),
@@ -49,8 +58,13 @@ class Transform final {
    [[nodiscard]] glm::vec3 GetUp() const noexcept;
    [[nodiscard]] glm::vec3 GetEulerAngles() const noexcept;
 
+   // Change notification, the listener is not copied along with the transform
+   void SetListener(ITransformListener* const listener, const uint32_t slot) noexcept;
+   constexpr void AcknowledgeChange() const noexcept { m_changeNotified = false; }
+
   private:
    void MarkDirty() noexcept;
+   void NotifyListener() noexcept;
    void RecalculateMatrix() const noexcept;
    [[nodiscard]] bool DecomposeMatrix(const glm::mat4& matrix, glm::vec3& position,
                                       glm::quat& rotation, glm::vec3& scale) const noexcept;
@@ -62,4 +76,8 @@ class Transform final {
 
    mutable glm::mat4 m_matrix;
    mutable bool m_dirty;
+
+   ITransformListener* m_listener{nullptr};
+   uint32_t m_listenerSlot{0};
+   mutable bool m_changeNotified{false};
 };
@@ -0,0 +1,384 @@
+#include "core/TransformBatch.hpp"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TRANSFORM_BATCH_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TRANSFORM_BATCH_AVX2_TARGET
+#else
+#define TRANSFORM_BATCH_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace TransformBatch {
+
+namespace {
+
+using ComposeFn = void (*)(const glm::vec3*, const glm::quat*, const glm::vec3*, glm::mat4*,
+                           size_t) noexcept;
+using MultiplyFn = void (*)(const glm::mat4*, const uint32_t*, const glm::mat4*, glm::mat4*,
+                            size_t) noexcept;
+using TranslationScaleFn = void (*)(const glm::vec3*, const float*, size_t, glm::mat4*, size_t,
+                                    size_t) noexcept;
+
+struct Kernels final {
+   SimdLevel level;
+   ComposeFn compose;
+   MultiplyFn multiply;
+   TranslationScaleFn translationScale;
+};
+
+template <typename T>
+[[nodiscard]] inline T& AtStride(T* const base, const size_t stride, const size_t index) noexcept {
+   using Byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
+   return *reinterpret_cast<T*>(reinterpret_cast<Byte*>(base) + stride * index);
+}
+
+// Scalar kernels, also used for the tails of the SIMD loops
+
+[[nodiscard]] inline glm::mat4 ComposeOne(const glm::vec3& p, const glm::quat& q,
+                                          const glm::vec3& s) noexcept {
+   const float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+   const float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+   const float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+   const float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+   return glm::mat4(
+      glm::vec4((1.0f - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0.0f),
+      glm::vec4((xy - wz) * s.y, (1.0f - (xx + zz)) * s.y, (yz + wx) * s.y, 0.0f),
+      glm::vec4((xz + wy) * s.z, (yz - wx) * s.z, (1.0f - (xx + yy)) * s.z, 0.0f),
+      glm::vec4(p, 1.0f));
+}
+
+void ComposeTRSScalar(const glm::vec3* const positions, const glm::quat* const rotations,
+                      const glm::vec3* const scales, glm::mat4* const out,
+                      const size_t count) noexcept {
+   for (size_t i = 0; i < count; ++i) {
+      out[i] = ComposeOne(positions[i], rotations[i], scales[i]);
+   }
+}
+
+[[maybe_unused]] void MultiplyParentLocalScalar(const glm::mat4* const matrices,
+                                                const uint32_t* const parentIndices,
+                                                const glm::mat4* const locals,
+                                                glm::mat4* const out, const size_t count) noexcept {
+   for (size_t i = 0; i < count; ++i) {
+      out[i] = matrices[parentIndices[i]] * locals[i];
+   }
+}
+
+[[maybe_unused]] void ComposeTranslationScaleScalar(const glm::vec3* const positions,
+                                                    const float* const scales,
+                                                    const size_t inStride, glm::mat4* const out,
+                                                    const size_t outStride,
+                                                    const size_t count) noexcept {
+   for (size_t i = 0; i < count; ++i) {
+      const float s = AtStride(scales, inStride, i);
+      const glm::vec3& p = AtStride(positions, inStride, i);
+      AtStride(out, outStride, i) =
+         glm::mat4(glm::vec4(s, 0.0f, 0.0f, 0.0f), glm::vec4(0.0f, s, 0.0f, 0.0f),
+                   glm::vec4(0.0f, 0.0f, s, 0.0f), glm::vec4(p, 1.0f));
+   }
+}
+
+#ifdef TRANSFORM_BATCH_X64
+
+// SSE2 is part of the x86-64 baseline, so these need no target attributes
+
+template <typename Getter>
+[[nodiscard]] inline __m128 Gather4(const size_t i, const Getter& get) noexcept {
+   return _mm_set_ps(get(i + 3), get(i + 2), get(i + 1), get(i));
+}
+
+// Registers hold one matrix element per lane; transpose them into one column per matrix
+inline void StoreColumn4(__m128 r0, __m128 r1, __m128 r2, __m128 r3, glm::mat4* const out,
+                         const glm::length_t column) noexcept {
+   _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+   _mm_storeu_ps(&out[0][column].x, r0);
+   _mm_storeu_ps(&out[1][column].x, r1);
+   _mm_storeu_ps(&out[2][column].x, r2);
+   _mm_storeu_ps(&out[3][column].x, r3);
+}
+
+void ComposeTRSSse(const glm::vec3* const positions, const glm::quat* const rotations,
+                   const glm::vec3* const scales, glm::mat4* const out,
+                   const size_t count) noexcept {
+   const __m128 one = _mm_set1_ps(1.0f);
+   const __m128 zero = _mm_setzero_ps();
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4) {
+      const __m128 qx = Gather4(i, [rotations](const size_t k) { return rotations[k].x; });
+      const __m128 qy = Gather4(i, [rotations](const size_t k) { return rotations[k].y; });
+      const __m128 qz = Gather4(i, [rotations](const size_t k) { return rotations[k].z; });
+      const __m128 qw = Gather4(i, [rotations](const size_t k) { return rotations[k].w; });
+      const __m128 sx = Gather4(i, [scales](const size_t k) { return scales[k].x; });
+      const __m128 sy = Gather4(i, [scales](const size_t k) { return scales[k].y; });
+      const __m128 sz = Gather4(i, [scales](const size_t k) { return scales[k].z; });
+      const __m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+      const __m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+      const __m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+      const __m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+      StoreColumn4(_mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx),
+                   _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero,
+                   out + i, 0);
+      StoreColumn4(_mm_mul_ps(_mm_sub_ps(xy, wz), sy),
+                   _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy),
+                   _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero, out + i, 1);
+      StoreColumn4(_mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz),
+                   _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero, out + i, 2);
+      StoreColumn4(Gather4(i, [positions](const size_t k) { return positions[k].x; }),
+                   Gather4(i, [positions](const size_t k) { return positions[k].y; }),
+                   Gather4(i, [positions](const size_t k) { return positions[k].z; }), one,
+                   out + i, 3);
+   }
+   ComposeTRSScalar(positions + i, rotations + i, scales + i, out + i, count - i);
+}
+
+// Inverse of StoreColumn4: element k of the column, taken from four matrices, lands in rows[k]
+inline void LoadColumn4(const glm::mat4& m0, const glm::mat4& m1, const glm::mat4& m2,
+                        const glm::mat4& m3, const glm::length_t column,
+                        __m128 (&rows)[4]) noexcept {
+   __m128 r0 = _mm_loadu_ps(&m0[column].x);
+   __m128 r1 = _mm_loadu_ps(&m1[column].x);
+   __m128 r2 = _mm_loadu_ps(&m2[column].x);
+   __m128 r3 = _mm_loadu_ps(&m3[column].x);
+   _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+   rows[0] = r0;
+   rows[1] = r1;
+   rows[2] = r2;
+   rows[3] = r3;
+}
+
+// Single product with broadcast columns, for the tail of the batched loop
+inline void MultiplyOneSse(const glm::mat4& parent, const glm::mat4& local,
+                           glm::mat4& out) noexcept {
+   const __m128 a0 = _mm_loadu_ps(&parent[0].x);
+   const __m128 a1 = _mm_loadu_ps(&parent[1].x);
+   const __m128 a2 = _mm_loadu_ps(&parent[2].x);
+   const __m128 a3 = _mm_loadu_ps(&parent[3].x);
+   for (glm::length_t c = 0; c < 4; ++c) {
+      const glm::vec4& b = local[c];
+      const __m128 r = _mm_add_ps(
+         _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b.x)), _mm_mul_ps(a1, _mm_set1_ps(b.y))),
+         _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(b.z)), _mm_mul_ps(a3, _mm_set1_ps(b.w))));
+      _mm_storeu_ps(&out[c].x, r);
+   }
+}
+
+// Four products per iteration, each register holds one element of all four matrices
+void MultiplyParentLocalSse(const glm::mat4* const matrices, const uint32_t* const parentIndices,
+                            const glm::mat4* const locals, glm::mat4* const out,
+                            const size_t count) noexcept {
+   size_t i = 0;
+   for (; i + 4 <= count; i += 4) {
+      __m128 a[4][4];
+      __m128 b[4][4];
+      for (glm::length_t c = 0; c < 4; ++c) {
+         LoadColumn4(matrices[parentIndices[i]], matrices[parentIndices[i + 1]],
+                     matrices[parentIndices[i + 2]], matrices[parentIndices[i + 3]], c, a[c]);
+         LoadColumn4(locals[i], locals[i + 1], locals[i + 2], locals[i + 3], c, b[c]);
+      }
+      // (parent * local)[c][r] = sum over k of parent[k][r] * local[c][k]
+      for (glm::length_t c = 0; c < 4; ++c) {
+         __m128 r[4];
+         for (size_t row = 0; row < 4; ++row) {
+            r[row] = _mm_add_ps(
+               _mm_add_ps(_mm_mul_ps(a[0][row], b[c][0]), _mm_mul_ps(a[1][row], b[c][1])),
+               _mm_add_ps(_mm_mul_ps(a[2][row], b[c][2]), _mm_mul_ps(a[3][row], b[c][3])));
+         }
+         StoreColumn4(r[0], r[1], r[2], r[3], out + i, c);
+      }
+   }
+   for (; i < count; ++i) {
+      MultiplyOneSse(matrices[parentIndices[i]], locals[i], out[i]);
+   }
+}
+
+// Not batched: the output is strided, so each matrix is written as four plain column stores
+void ComposeTranslationScaleStores(const glm::vec3* const positions, const float* const scales,
+                                   const size_t inStride, glm::mat4* const out,
+                                   const size_t outStride, const size_t count) noexcept {
+   for (size_t i = 0; i < count; ++i) {
+      const float s = AtStride(scales, inStride, i);
+      const glm::vec3& p = AtStride(positions, inStride, i);
+      glm::mat4& m = AtStride(out, outStride, i);
+      _mm_storeu_ps(&m[0].x, _mm_set_ps(0.0f, 0.0f, 0.0f, s));
+      _mm_storeu_ps(&m[1].x, _mm_set_ps(0.0f, 0.0f, s, 0.0f));
+      _mm_storeu_ps(&m[2].x, _mm_set_ps(0.0f, s, 0.0f, 0.0f));
+      _mm_storeu_ps(&m[3].x, _mm_set_ps(1.0f, p.z, p.y, p.x));
+   }
+}
+
+// AVX2 + FMA kernels, only called once the CPU has been checked for support
+
+template <typename Getter>
+[[nodiscard]] TRANSFORM_BATCH_AVX2_TARGET inline __m256 Gather8(const size_t i,
+                                                                const Getter& get) noexcept {
+   return _mm256_set_ps(get(i + 7), get(i + 6), get(i + 5), get(i + 4), get(i + 3), get(i + 2),
+                        get(i + 1), get(i));
+}
+
+TRANSFORM_BATCH_AVX2_TARGET inline void StoreColumn8(const __m256 r0, const __m256 r1,
+                                                     const __m256 r2, const __m256 r3,
+                                                     glm::mat4* const out,
+                                                     const glm::length_t column) noexcept {
+   StoreColumn4(_mm256_castps256_ps128(r0), _mm256_castps256_ps128(r1),
+                _mm256_castps256_ps128(r2), _mm256_castps256_ps128(r3), out, column);
+   StoreColumn4(_mm256_extractf128_ps(r0, 1), _mm256_extractf128_ps(r1, 1),
+                _mm256_extractf128_ps(r2, 1), _mm256_extractf128_ps(r3, 1), out + 4, column);
+}
+
+TRANSFORM_BATCH_AVX2_TARGET void ComposeTRSAvx2(const glm::vec3* const positions,
+                                                const glm::quat* const rotations,
+                                                const glm::vec3* const scales,
+                                                glm::mat4* const out, const size_t count) noexcept {
+   const __m256 one = _mm256_set1_ps(1.0f);
+   const __m256 zero = _mm256_setzero_ps();
+   size_t i = 0;
+   for (; i + 8 <= count; i += 8) {
+      const __m256 qx = Gather8(i, [rotations](const size_t k) { return rotations[k].x; });
+      const __m256 qy = Gather8(i, [rotations](const size_t k) { return rotations[k].y; });
+      const __m256 qz = Gather8(i, [rotations](const size_t k) { return rotations[k].z; });
+      const __m256 qw = Gather8(i, [rotations](const size_t k) { return rotations[k].w; });
+      const __m256 sx = Gather8(i, [scales](const size_t k) { return scales[k].x; });
+      const __m256 sy = Gather8(i, [scales](const size_t k) { return scales[k].y; });
+      const __m256 sz = Gather8(i, [scales](const size_t k) { return scales[k].z; });
+      const __m256 x2 = _mm256_add_ps(qx, qx), y2 = _mm256_add_ps(qy, qy);
+      const __m256 z2 = _mm256_add_ps(qz, qz);
+      const __m256 xx = _mm256_mul_ps(qx, x2), yy = _mm256_mul_ps(qy, y2);
+      const __m256 zz = _mm256_mul_ps(qz, z2);
+      // Off-diagonal pairs fused as a*b +/- c*d
+      const __m256 xyPlusWz = _mm256_fmadd_ps(qx, y2, _mm256_mul_ps(qw, z2));
+      const __m256 xyMinusWz = _mm256_fmsub_ps(qx, y2, _mm256_mul_ps(qw, z2));
+      const __m256 xzPlusWy = _mm256_fmadd_ps(qx, z2, _mm256_mul_ps(qw, y2));
+      const __m256 xzMinusWy = _mm256_fmsub_ps(qx, z2, _mm256_mul_ps(qw, y2));
+      const __m256 yzPlusWx = _mm256_fmadd_ps(qy, z2, _mm256_mul_ps(qw, x2));
+      const __m256 yzMinusWx = _mm256_fmsub_ps(qy, z2, _mm256_mul_ps(qw, x2));
+      StoreColumn8(_mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+                   _mm256_mul_ps(xyPlusWz, sx), _mm256_mul_ps(xzMinusWy, sx), zero, out + i, 0);
+      StoreColumn8(_mm256_mul_ps(xyMinusWz, sy),
+                   _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+                   _mm256_mul_ps(yzPlusWx, sy), zero, out + i, 1);
+      StoreColumn8(_mm256_mul_ps(xzPlusWy, sz), _mm256_mul_ps(yzMinusWx, sz),
+                   _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero, out + i,
+                   2);
+      StoreColumn8(Gather8(i, [positions](const size_t k) { return positions[k].x; }),
+                   Gather8(i, [positions](const size_t k) { return positions[k].y; }),
+                   Gather8(i, [positions](const size_t k) { return positions[k].z; }), one,
+                   out + i, 3);
+   }
+   ComposeTRSSse(positions + i, rotations + i, scales + i, out + i, count - i);
+}
+
+// Two matrices per iteration, one in each 128-bit lane
+TRANSFORM_BATCH_AVX2_TARGET void MultiplyParentLocalAvx2(const glm::mat4* const matrices,
+                                                         const uint32_t* const parentIndices,
+                                                         const glm::mat4* const locals,
+                                                         glm::mat4* const out,
+                                                         const size_t count) noexcept {
+   size_t i = 0;
+   for (; i + 2 <= count; i += 2) {
+      const glm::mat4& pa = matrices[parentIndices[i]];
+      const glm::mat4& pb = matrices[parentIndices[i + 1]];
+      const __m256 a0 = _mm256_set_m128(_mm_loadu_ps(&pb[0].x), _mm_loadu_ps(&pa[0].x));
+      const __m256 a1 = _mm256_set_m128(_mm_loadu_ps(&pb[1].x), _mm_loadu_ps(&pa[1].x));
+      const __m256 a2 = _mm256_set_m128(_mm_loadu_ps(&pb[2].x), _mm_loadu_ps(&pa[2].x));
+      const __m256 a3 = _mm256_set_m128(_mm_loadu_ps(&pb[3].x), _mm_loadu_ps(&pa[3].x));
+      for (glm::length_t c = 0; c < 4; ++c) {
+         const __m256 b =
+            _mm256_set_m128(_mm_loadu_ps(&locals[i + 1][c].x), _mm_loadu_ps(&locals[i][c].x));
+         __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(b, 0x00));
+         r = _mm256_fmadd_ps(a1, _mm256_permute_ps(b, 0x55), r);
+         r = _mm256_fmadd_ps(a2, _mm256_permute_ps(b, 0xAA), r);
+         r = _mm256_fmadd_ps(a3, _mm256_permute_ps(b, 0xFF), r);
+         _mm_storeu_ps(&out[i][c].x, _mm256_castps256_ps128(r));
+         _mm_storeu_ps(&out[i + 1][c].x, _mm256_extractf128_ps(r, 1));
+      }
+   }
+   MultiplyParentLocalSse(matrices, parentIndices + i, locals + i, out + i, count - i);
+}
+
+[[nodiscard]] bool CpuSupportsAvx2() noexcept {
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info[4] = {0};
+   __cpuid(info, 1);
+   const bool osxsave = (info[2] & (1 << 27)) != 0;
+   const bool fma = (info[2] & (1 << 12)) != 0;
+   if (!osxsave || !fma)
+      return false;
+   // The OS has to save the YMM registers on context switches
+   if ((_xgetbv(0) & 0x6) != 0x6)
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   __builtin_cpu_init();
+   return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+}
+
+#endif // TRANSFORM_BATCH_X64
+
+[[nodiscard]] Kernels SelectKernels() noexcept {
+#ifdef TRANSFORM_BATCH_X64
+   if (CpuSupportsAvx2()) {
+      return {.level = SimdLevel::AVX2,
+              .compose = ComposeTRSAvx2,
+              .multiply = MultiplyParentLocalAvx2,
+              .translationScale = ComposeTranslationScaleStores};
+   }
+   return {.level = SimdLevel::SSE,
+           .compose = ComposeTRSSse,
+           .multiply = MultiplyParentLocalSse,
+           .translationScale = ComposeTranslationScaleStores};
+#else
+   return {.level = SimdLevel::Scalar,
+           .compose = ComposeTRSScalar,
+           .multiply = MultiplyParentLocalScalar,
+           .translationScale = ComposeTranslationScaleScalar};
+#endif
+}
+
+[[nodiscard]] const Kernels& GetKernels() noexcept {
+   static const Kernels kernels = SelectKernels();
+   return kernels;
+}
+
+} // namespace
+
+SimdLevel GetSimdLevel() noexcept { return GetKernels().level; }
+
+const char* GetSimdLevelName() noexcept {
+   switch (GetKernels().level) {
+      case SimdLevel::AVX2:
+         return "AVX2";
+      case SimdLevel::SSE:
+         return "SSE";
+      case SimdLevel::Scalar:
+         return "Scalar";
+   }
+   std::unreachable();
+}
+
+void ComposeTRS(const glm::vec3* const positions, const glm::quat* const rotations,
+                const glm::vec3* const scales, glm::mat4* const out, const size_t count) noexcept {
+   GetKernels().compose(positions, rotations, scales, out, count);
+}
+
+void MultiplyParentLocal(const glm::mat4* const matrices, const uint32_t* const parentIndices,
+                         const glm::mat4* const locals, glm::mat4* const out,
+                         const size_t count) noexcept {
+   GetKernels().multiply(matrices, parentIndices, locals, out, count);
+}
+
+void ComposeTranslationScale(const glm::vec3* const positions, const float* const scales,
+                             const size_t inStride, glm::mat4* const out, const size_t outStride,
+                             const size_t count) noexcept {
+   GetKernels().translationScale(positions, scales, inStride, out, outStride, count);
+}
+
+} // namespace TransformBatch
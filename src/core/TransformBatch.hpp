@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+// Batched matrix kernels. The widest instruction set supported by the running CPU is picked on
+// first use (AVX2 composes 8 transforms per iteration, SSE 4), with a scalar fallback elsewhere.
+// Parent*local products run 4 per SSE iteration or 2 per AVX2 iteration.
+namespace TransformBatch {
+
+enum class SimdLevel : uint8_t { Scalar, SSE, AVX2 };
+
+[[nodiscard]] SimdLevel GetSimdLevel() noexcept;
+[[nodiscard]] const char* GetSimdLevelName() noexcept;
+
+// out[i] = T(positions[i]) * R(rotations[i]) * S(scales[i])
+void ComposeTRS(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+                glm::mat4* out, const size_t count) noexcept;
+
+// out[i] = matrices[parentIndices[i]] * locals[i], parents may live in the same array as out
+void MultiplyParentLocal(const glm::mat4* matrices, const uint32_t* parentIndices,
+                         const glm::mat4* locals, glm::mat4* out, const size_t count) noexcept;
+
+// out[i] = T(positions[i]) * S(scales[i]) with byte strides, for interleaved instance buffers
+void ComposeTranslationScale(const glm::vec3* positions, const float* scales,
+                             const size_t inStride, glm::mat4* out, const size_t outStride,
+                             const size_t count) noexcept;
+
+} // namespace TransformBatch
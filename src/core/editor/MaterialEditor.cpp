@@ -209,7 +209,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
       switch (desc.type) {
          case ParameterDescriptor::Type::Float: {
             float val = std::get<float>(param);
-            if (ImGui::SliderFloat(paramName.c_str(), &val, 0.0f, 1.0f)) {
+            if (ImGui::SliderFloat(desc.name.c_str(), &val, 0.0f, 1.0f)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -217,7 +217,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          }
          case ParameterDescriptor::Type::Int: {
             int32_t val = std::get<int32_t>(param);
-            if (ImGui::InputInt(paramName.c_str(), &val)) {
+            if (ImGui::InputInt(desc.name.c_str(), &val)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -225,7 +225,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          }
          case ParameterDescriptor::Type::UInt: {
             uint32_t val = std::get<uint32_t>(param);
-            if (ImGui::InputScalar(paramName.c_str(), ImGuiDataType_U32, &val)) {
+            if (ImGui::InputScalar(desc.name.c_str(), ImGuiDataType_U32, &val)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -233,7 +233,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          }
          case ParameterDescriptor::Type::Vec2: {
             glm::vec2 val = std::get<glm::vec2>(param);
-            if (ImGui::DragFloat2(paramName.c_str(), &val.x, 0.01f)) {
+            if (ImGui::DragFloat2(desc.name.c_str(), &val.x, 0.01f)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -241,7 +241,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          }
          case ParameterDescriptor::Type::Vec3: {
             glm::vec3 val = std::get<glm::vec3>(param);
-            if (ImGui::ColorEdit3(paramName.c_str(), &val.x)) {
+            if (ImGui::ColorEdit3(desc.name.c_str(), &val.x)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -249,7 +249,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          }
          case ParameterDescriptor::Type::Vec4: {
             glm::vec4 val = std::get<glm::vec4>(param);
-            if (ImGui::ColorEdit4(paramName.c_str(), &val.x)) {
+            if (ImGui::ColorEdit4(desc.name.c_str(), &val.x)) {
                material->SetParameter(paramName, val);
                material->UpdateUBO();
             }
@@ -258,7 +258,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
          case ParameterDescriptor::Type::Mat2: {
             glm::mat2 val = std::get<glm::mat2>(param);
             std::array<float, 4> matValues{val[0][0], val[0][1], val[1][0], val[1][1]};
-            if (ImGui::InputFloat4(paramName.c_str(), matValues.data())) {
+            if (ImGui::InputFloat4(desc.name.c_str(), matValues.data())) {
                val[0][0] = matValues[0];
                val[0][1] = matValues[1];
                val[1][0] = matValues[2];
@@ -278,7 +278,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
             }
             const std::string row2Label = std::format("{}_row2", paramName);
             const std::string row3Label = std::format("{}_row3", paramName);
-            bool changed = ImGui::InputFloat3(paramName.c_str(), matValues.data());
+            bool changed = ImGui::InputFloat3(desc.name.c_str(), matValues.data());
             changed |= ImGui::InputFloat3(row2Label.c_str(), matValues.data() + 3);
             changed |= ImGui::InputFloat3(row3Label.c_str(), matValues.data() + 6);
             if (changed) {
@@ -303,7 +303,7 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
             const std::string row2Label = std::format("{}_row2", paramName);
             const std::string row3Label = std::format("{}_row3", paramName);
             const std::string row4Label = std::format("{}_row4", paramName);
-            bool changed = ImGui::InputFloat4(paramName.c_str(), matValues.data());
+            bool changed = ImGui::InputFloat4(desc.name.c_str(), matValues.data());
             changed |= ImGui::InputFloat4(row2Label.c_str(), matValues.data() + 4);
             changed |= ImGui::InputFloat4(row3Label.c_str(), matValues.data() + 8);
             changed |= ImGui::InputFloat4(row4Label.c_str(), matValues.data() + 12);
@@ -330,17 +330,17 @@ void MaterialEditor::DrawMaterialParameterEditor(IMaterial* const material) cons
 }
 
 void MaterialEditor::DrawTextureSlotEditor(IMaterial* const material,
-                                           const std::string_view textureName,
+                                           const StringId textureName,
                                            const std::string_view displayName) const {
    if (!material->HasTexture(textureName)) [[unlikely]]
       return;
    const TextureHandle currentTex = material->GetTexture(textureName);
    const ITexture* const texture = m_resourceManager->GetTexture(currentTex);
    ImGui::Text("%s:", displayName.data());
-   ImGui::PushID(textureName.data());
+   ImGui::PushID(textureName.CStr());
    if (texture) {
       const ImTextureID texIdPtr = GetTextureId(texture);
-      ImGui::ImageButton(textureName.data(), texIdPtr, {kImageButtonSize.x, kImageButtonSize.y});
+      ImGui::ImageButton(textureName.CStr(), texIdPtr, {kImageButtonSize.x, kImageButtonSize.y});
       // Find texture name for payload (cached lookup would be better)
       const std::string texNameForPayload =
          currentTex.IsValid() ? FindTextureName(currentTex) : "Unknown";
@@ -382,8 +382,7 @@ void MaterialEditor::DrawTextureSlotEditor(IMaterial* const material,
          });
          if (templateIt != availableTemplates.end()) {
             const auto& textureDescs = templateIt->first.GetTextures();
-            const std::string textureNameStr{textureName};
-            if (const auto texIt = textureDescs.find(textureNameStr); texIt != textureDescs.end()) {
+            if (const auto texIt = textureDescs.find(textureName); texIt != textureDescs.end()) {
                material->SetTexture(textureName, texIt->second.defaultTexture);
             }
          }
@@ -36,7 +36,7 @@ class MaterialEditor final {
 
   private:
    void DrawMaterialParameterEditor(IMaterial* const material) const;
-   void DrawTextureSlotEditor(IMaterial* const material, const std::string_view textureName,
+   void DrawTextureSlotEditor(IMaterial* const material, const StringId textureName,
                               const std::string_view displayName) const;
 
    void DrawTexturePreview(const ITexture* const texture,
@@ -1,7 +1,9 @@
 #include "core/editor/PerformanceGUI.hpp"
 
+#include "core/RenderSettings.hpp"
 #include "core/resource/ResourceManager.hpp"
 #include "core/scene/Scene.hpp"
+#include "core/scene/TransformHierarchy.hpp"
 
 #include <imgui.h>
 #include <algorithm>
@@ -25,7 +27,8 @@ FrameTimeHistory<1024> PerformanceGUI::s_history{};
 
 void PerformanceGUI::RenderPerformanceGUI(const ResourceManager& resourceManager,
                                           const Scene& scene,
-                                          const PerformanceMetrics& currentMetrics) noexcept {
+                                          const PerformanceMetrics& currentMetrics,
+                                          RenderSettings& settings) noexcept {
    ImGui::SetNextWindowPos(kWindowPosition, ImGuiCond_Always);
    if (ImGui::Begin("Performance Overlay", nullptr, kOverlayWindowFlags)) {
       // Update statistics
@@ -46,7 +49,10 @@ void PerformanceGUI::RenderPerformanceGUI(const ResourceManager& resourceManager
       ImGui::Text("GPU: %.3f ms", currentMetrics.gpuTimeMs);
       ImGui::Separator();
       DrawMemoryInfo(resourceManager, currentMetrics);
-      DrawSceneInfo(scene);
+      DrawSceneInfo(scene, currentMetrics);
+      if (ImGui::CollapsingHeader("Render Settings")) {
+         DrawRenderSettings(settings);
+      }
       // Performance graph
       if (ImGui::CollapsingHeader("Performance Graph")) {
          DrawPerformanceGraph();
@@ -72,6 +78,39 @@ constexpr float PerformanceGUI::CalculateMemoryUsageMB(const size_t memoryUsage)
    return static_cast<float>(memoryUsage) / kMemoryMBDivisor;
 }
 
+void PerformanceGUI::DrawRenderSettings(RenderSettings& settings) noexcept {
+   // Shows what is drawn, an unavailable pipeline requested from the command line is not
+   const RenderPipeline active = settings.GetActivePipeline();
+   if (ImGui::BeginCombo("Pipeline", GetRenderPipelineName(active))) {
+      for (uint8_t i = 0; i < static_cast<uint8_t>(RenderPipeline::Count); ++i) {
+         const auto pipeline = static_cast<RenderPipeline>(i);
+         const ImGuiSelectableFlags flags =
+            settings.IsAvailable(pipeline) ? 0 : ImGuiSelectableFlags_Disabled;
+         if (ImGui::Selectable(GetRenderPipelineName(pipeline), pipeline == active, flags))
+            settings.pipeline = pipeline;
+      }
+      ImGui::EndCombo();
+   }
+   ImGui::Checkbox("Occlusion Culling", &settings.occlusionCulling);
+   ImGui::Checkbox("Potentially Visible Set", &settings.potentiallyVisibleSet);
+   ImGui::Checkbox("Particle Sorting", &settings.particleSorting);
+   ImGui::Checkbox("Depth Prepass", &settings.depthPrepass);
+   ImGui::Checkbox("Overdraw View", &settings.overdrawView);
+   ImGui::BeginDisabled(!settings.gpuDrivenGeometryAvailable);
+   ImGui::Checkbox("GPU-Driven Geometry", &settings.gpuDrivenGeometry);
+   ImGui::EndDisabled();
+   ImGui::BeginDisabled(!settings.gBufferSubpassesAvailable);
+   ImGui::Checkbox("G-Buffer Subpasses", &settings.gBufferSubpasses);
+   ImGui::EndDisabled();
+   ImGui::BeginDisabled(!settings.dynamicResolutionAvailable);
+   ImGui::Checkbox("Dynamic Resolution", &settings.dynamicResolution);
+   ImGui::SliderFloat("Target Scene GPU Time (ms)", &settings.targetFrameTimeMs, 2.0f, 50.0f,
+                      "%.1f");
+   ImGui::EndDisabled();
+   if (!settings.dynamicResolutionAvailable)
+      ImGui::TextDisabled("Not implemented by this renderer, the scale is always 100%%");
+}
+
 void PerformanceGUI::DrawPerformanceGraph() noexcept {
    const auto& history = s_history.GetHistory();
    auto validFrameTimes = history | std::views::filter([](float ft) { return ft > 0.0f; });
@@ -115,16 +154,98 @@ void PerformanceGUI::DrawMemoryInfo(const ResourceManager& resourceManager,
    }
 }
 
-void PerformanceGUI::DrawSceneInfo(const Scene& scene) noexcept {
+void PerformanceGUI::DrawSceneInfo(const Scene& scene,
+                                   const PerformanceMetrics& metrics) noexcept {
    const size_t nodeCount = scene.GetNodeCount();
    ImGui::Text("Scene Nodes: %zu", nodeCount);
+   ImGui::Text("Transforms: %u visited, %u recomputed", metrics.transformNodesVisited,
+               metrics.transformMatricesRecomputed);
+   if (TransformHierarchy* const hierarchy = scene.GetTransformHierarchy()) {
+      using UpdateMode = TransformHierarchy::UpdateMode;
+      bool incremental = hierarchy->GetUpdateMode() == UpdateMode::Incremental;
+      if (ImGui::Checkbox("Incremental Transforms", &incremental)) {
+         hierarchy->SetUpdateMode(incremental ? UpdateMode::Incremental : UpdateMode::Full);
+      }
+      using ExecutionMode = TransformHierarchy::ExecutionMode;
+      bool parallel = hierarchy->GetExecutionMode() == ExecutionMode::Parallel;
+      if (ImGui::Checkbox("Parallel Transforms", &parallel)) {
+         hierarchy->SetExecutionMode(parallel ? ExecutionMode::Parallel : ExecutionMode::Serial);
+      }
+   }
+   ImGui::Text("Render World: %.3f ms, %u mesh proxies, %u updated", metrics.renderExtractMs,
+               metrics.meshProxies, metrics.meshProxiesUpdated);
+   ImGui::Text("Culling: %u/%u meshes, %u lights, %u particle systems visible",
+               metrics.meshesVisible, metrics.meshProxies, metrics.lightsVisible,
+               metrics.particleSystemsVisible);
+   ImGui::Text("  %u meshes, %u lights, %u particle systems culled, %u BVH nodes refit",
+               metrics.meshesCulled, metrics.lightsCulled, metrics.particleSystemsCulled,
+               metrics.bvhNodesRefit);
+   ImGui::Text("Light Clusters: %.3f ms, %u light indices, max %u per cluster",
+               metrics.lightClusterMs, metrics.clusterLightIndices, metrics.clusterMaxLights);
+   ImGui::Text("Particle Sort: %.3f ms, %u particles", metrics.particleSortMs,
+               metrics.particlesSorted);
+   ImGui::Text("Occlusion: %u meshes occluded by %u occluders (%u tris)", metrics.meshesOccluded,
+               metrics.occluders, metrics.occluderTriangles);
+   ImGui::Text("  raster %.3f ms, test %.3f ms", metrics.occlusionRasterMs,
+               metrics.occlusionTestMs);
+   if (metrics.pvsCell >= 0) {
+      ImGui::Text("PVS: cell %d, %u meshes culled", metrics.pvsCell, metrics.meshesPvsCulled);
+   }
+   ImGui::Text("Geometry Recording: %.3f ms, %u draw calls", metrics.geometryRecordMs,
+               metrics.geometryDrawCalls);
+   if (metrics.streamingCells > 0) {
+      ImGui::Text("Streaming: %u/%u cells resident, %u loading, %u stalled",
+                  metrics.streamingResidentCells, metrics.streamingCells,
+                  metrics.streamingLoadingCells, metrics.streamingStalledCells);
+      ImGui::Text("  %.1f / %.1f MB, %.1f MB in flight, upload %.3f ms",
+                  CalculateMemoryUsageMB(metrics.streamingResidentBytes),
+                  CalculateMemoryUsageMB(metrics.streamingBudgetBytes),
+                  CalculateMemoryUsageMB(metrics.streamingBytesInFlight), metrics.streamingUploadMs);
+   }
+   ImGui::Text("Render Graph: %u passes, %u culled, %u barriers", metrics.renderGraphPasses,
+               metrics.renderGraphPassesCulled, metrics.renderGraphBarriers);
+   ImGui::Text("  transients %.1f MB, %.1f MB reused, %.1f MB shared by frames in flight",
+               CalculateMemoryUsageMB(metrics.transientBytes),
+               CalculateMemoryUsageMB(metrics.transientReusedBytes),
+               CalculateMemoryUsageMB(metrics.transientFramesInFlightSavedBytes));
+   if (metrics.transientLazilySavedBytes > 0) {
+      ImGui::Text("  %.1f MB of transient attachments never committed",
+                  CalculateMemoryUsageMB(metrics.transientLazilySavedBytes));
+   }
+   ImGui::Separator();
+   ImGui::Text("Systems: %.3f ms", metrics.systemUpdateMs);
+   for (uint32_t i = 0; i < metrics.systemTimingCount; ++i) {
+      const SystemTiming& timing = metrics.systemTimings[i];
+      ImGui::Text("  %s: %.3f ms CPU, %u entities", timing.name.CStr(), timing.cpuTimeMs,
+                  timing.entityCount);
+   }
+   if (SystemScheduler* const scheduler = scene.GetSystemScheduler()) {
+      using ExecutionMode = SystemScheduler::ExecutionMode;
+      bool parallel = scheduler->GetExecutionMode() == ExecutionMode::Parallel;
+      if (ImGui::Checkbox("Parallel Systems", &parallel)) {
+         scheduler->SetExecutionMode(parallel ? ExecutionMode::Parallel : ExecutionMode::Serial);
+      }
+   }
 }
 
 void PerformanceGUI::DrawRenderPassTimings(const PerformanceMetrics& metrics) noexcept {
+   ImGui::Text("Pipeline:  %s%s", GetRenderPipelineName(metrics.pipeline),
+               metrics.gBufferSubpasses ? " (G-buffer subpasses)" : "");
+   ImGui::Text("Scale:     %.0f%%", metrics.resolutionScale * 100.0f);
+   ImGui::Text("Overdraw:  %.2f shaded fragments per pixel%s", metrics.shadingOverdraw,
+               metrics.deferredDepthPrepass ? " (depth prepass)" : "");
    ImGui::Text("Geometry:  %.3f ms (%.1f%%)", metrics.geometryPassMs,
                (metrics.geometryPassMs / metrics.frameTimeMs) * 100.0f);
    ImGui::Text("Lighting:  %.3f ms (%.1f%%)", metrics.lightingPassMs,
                (metrics.lightingPassMs / metrics.frameTimeMs) * 100.0f);
+   ImGui::Text("Prepass:   %.3f ms (%.1f%%)", metrics.depthPrepassMs,
+               (metrics.depthPrepassMs / metrics.frameTimeMs) * 100.0f);
+   ImGui::Text("Forward:   %.3f ms (%.1f%%)", metrics.forwardPassMs,
+               (metrics.forwardPassMs / metrics.frameTimeMs) * 100.0f);
+   ImGui::Text("VisBuffer: %.3f ms (%.1f%%)", metrics.visibilityPassMs,
+               (metrics.visibilityPassMs / metrics.frameTimeMs) * 100.0f);
+   ImGui::Text("Resolve:   %.3f ms (%.1f%%)", metrics.materialResolveMs,
+               (metrics.materialResolveMs / metrics.frameTimeMs) * 100.0f);
    ImGui::Text("Gizmos:    %.3f ms (%.1f%%)", metrics.gizmoPassMs,
                (metrics.gizmoPassMs / metrics.frameTimeMs) * 100.0f);
    ImGui::Text("Particles: %.3f ms (%.1f%%)", metrics.particlePassMs,
@@ -148,6 +269,10 @@ void PerformanceGUI::DrawRenderPassTimings(const PerformanceMetrics& metrics) no
    };
    drawPassBar("Geometry", metrics.geometryPassMs, ImVec4(1.0f, 0.3f, 0.3f, 1.0f));
    drawPassBar("Lighting", metrics.lightingPassMs, ImVec4(0.3f, 1.0f, 0.3f, 1.0f));
+   drawPassBar("Prepass", metrics.depthPrepassMs, ImVec4(0.6f, 0.6f, 0.6f, 1.0f));
+   drawPassBar("Forward", metrics.forwardPassMs, ImVec4(0.3f, 1.0f, 1.0f, 1.0f));
+   drawPassBar("VisBuffer", metrics.visibilityPassMs, ImVec4(0.8f, 0.4f, 1.0f, 1.0f));
+   drawPassBar("Resolve", metrics.materialResolveMs, ImVec4(1.0f, 0.4f, 0.8f, 1.0f));
    drawPassBar("Gizmos", metrics.gizmoPassMs, ImVec4(0.3f, 0.3f, 1.0f, 1.0f));
    drawPassBar("Particles", metrics.particlePassMs, ImVec4(1.0f, 1.0f, 0.3f, 1.0f));
    drawPassBar("ImGui", metrics.imguiPassMs, ImVec4(1.0f, 0.5f, 0.2f, 1.0f));
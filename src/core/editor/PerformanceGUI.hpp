@@ -2,6 +2,8 @@
 
 #include "core/system/PerformanceMetrics.hpp"
 
+struct RenderSettings;
+
 class ResourceManager;
 class Scene;
 
@@ -9,7 +11,8 @@ class PerformanceGUI final {
   public:
    PerformanceGUI() = delete;
    static void RenderPerformanceGUI(const ResourceManager& resourceManager, const Scene& scene,
-                                    const PerformanceMetrics& currentMetrics) noexcept;
+                                    const PerformanceMetrics& currentMetrics,
+                                    RenderSettings& settings) noexcept;
    static void ResetStats() noexcept;
 
   private:
@@ -26,7 +29,8 @@ class PerformanceGUI final {
    [[nodiscard]] static constexpr float CalculateMemoryUsageMB(const size_t memoryUsage) noexcept;
    static void DrawMemoryInfo(const ResourceManager& resourceManager,
                               const PerformanceMetrics& metrics) noexcept;
-   static void DrawSceneInfo(const Scene& scene) noexcept;
+   static void DrawSceneInfo(const Scene& scene, const PerformanceMetrics& metrics) noexcept;
+   static void DrawRenderSettings(RenderSettings& settings) noexcept;
    static void DrawPerformanceGraph() noexcept;
    static void DrawRenderPassTimings(const PerformanceMetrics& metrics) noexcept;
 };
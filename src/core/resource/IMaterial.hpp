@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/StringId.hpp"
 #include "core/resource/IResource.hpp"
 #include "core/resource/ITexture.hpp"
 
@@ -26,14 +27,14 @@ class IMaterial : public IResource {
    ~IMaterial() override = default;
 
    // Parameter management
-   virtual void SetParameter(const std::string_view name, const MaterialParam& value) = 0;
-   [[nodiscard]] virtual MaterialParam GetParameter(const std::string_view name) const = 0;
-   [[nodiscard]] virtual bool HasParameter(const std::string_view name) const noexcept = 0;
+   virtual void SetParameter(const StringId name, const MaterialParam& value) = 0;
+   [[nodiscard]] virtual MaterialParam GetParameter(const StringId name) const = 0;
+   [[nodiscard]] virtual bool HasParameter(const StringId name) const noexcept = 0;
 
    // Texture management
-   virtual void SetTexture(const std::string_view name, const TextureHandle texture) = 0;
-   [[nodiscard]] virtual TextureHandle GetTexture(const std::string_view name) const = 0;
-   [[nodiscard]] virtual bool HasTexture(const std::string_view name) const noexcept = 0;
+   virtual void SetTexture(const StringId name, const TextureHandle texture) = 0;
+   [[nodiscard]] virtual TextureHandle GetTexture(const StringId name) const = 0;
+   [[nodiscard]] virtual bool HasTexture(const StringId name) const noexcept = 0;
 
    // Binding
    virtual void Bind(const uint32_t bindingPoint, const ResourceManager& resourceManager) = 0;
@@ -1,8 +1,21 @@
 #pragma once
 
+#include "core/Bounds.hpp"
 #include "core/resource/IResource.hpp"
 #include "core/resource/ResourceHandle.hpp"
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// CPU copy of a mesh's triangles for software occlusion culling
+struct OccluderGeometry final {
+   std::vector<glm::vec3> positions;
+   std::vector<uint32_t> indices;
+};
+
 class IMesh : public IResource {
   public:
    virtual ~IMesh() = default;
@@ -10,6 +23,22 @@ class IMesh : public IResource {
    [[nodiscard]] virtual size_t GetVertexCount() const = 0;
    [[nodiscard]] virtual size_t GetIndexCount() const = 0;
    [[nodiscard]] virtual void* GetNativeHandle() const = 0;
+
+   // Object space bounds of the vertices, set by ResourceManager when the mesh is created
+   [[nodiscard]] constexpr const BoundingBox& GetBounds() const noexcept { return m_bounds; }
+   void SetBounds(const BoundingBox& bounds) noexcept { m_bounds = bounds; }
+
+   // Only kept for meshes small enough to rasterize on the CPU, null otherwise
+   [[nodiscard]] const OccluderGeometry* GetOccluderGeometry() const noexcept {
+      return m_occluder.get();
+   }
+   void SetOccluderGeometry(std::unique_ptr<OccluderGeometry> occluder) noexcept {
+      m_occluder = std::move(occluder);
+   }
+
+  private:
+   BoundingBox m_bounds{};
+   std::unique_ptr<OccluderGeometry> m_occluder{};
 };
 
 using MeshHandle = ResourceHandle<IMesh>;
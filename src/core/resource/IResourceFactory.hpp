@@ -4,10 +4,12 @@
 
 #include "core/resource/IMaterial.hpp"
 #include "core/resource/ITexture.hpp"
+#include "core/resource/ImageData.hpp"
 #include "core/resource/IMesh.hpp"
 
 #include "core/resource/MaterialTemplate.hpp"
 
+#include <span>
 #include <vector>
 #include <memory>
 
@@ -21,15 +23,22 @@ class IResourceFactory {
    virtual std::unique_ptr<ITexture> CreateTextureFromFile(const std::string_view filepath,
                                                            const bool generateMipmaps = true,
                                                            const bool sRGB = true) = 0;
+   // Upload pixels decoded ahead of time, e.g. by a streaming worker
+   virtual std::unique_ptr<ITexture> CreateTextureFromImage(const ImageData& image,
+                                                            const bool generateMipmaps = true,
+                                                            const bool sRGB = true) = 0;
    virtual std::unique_ptr<ITexture> CreateDepthTexture(
       const uint32_t width, const uint32_t height,
       const ITexture::Format format = ITexture::Format::Depth24) = 0;
+   // A transient attachment is only ever an attachment of the render pass that writes it and
+   // is never stored, backends without such a notion create a plain render target
    virtual std::unique_ptr<ITexture> CreateRenderTarget(
       const uint32_t width, const uint32_t height,
-      const ITexture::Format format = ITexture::Format::RGBA8, const uint32_t samples = 1) = 0;
+      const ITexture::Format format = ITexture::Format::RGBA8, const uint32_t samples = 1,
+      const bool transientAttachment = false) = 0;
    // Material creation methods
    virtual std::unique_ptr<IMaterial> CreateMaterial(const MaterialTemplate& matTemplate) = 0;
    // Mesh creation methods
-   virtual std::unique_ptr<IMesh> CreateMesh(const std::vector<Vertex>& vertices,
-                                             const std::vector<uint32_t>& indices) = 0;
+   virtual std::unique_ptr<IMesh> CreateMesh(const std::span<const Vertex> vertices,
+                                             const std::span<const uint32_t> indices) = 0;
 };
@@ -7,7 +7,19 @@
 
 class ITexture : public IResource {
   public:
-   enum class Format { RGBA8, RGBA16F, RGBA32F, SRGB8_ALPHA8, Depth24, Depth32F, R8, RG8, RGB8 };
+   // R32UI holds ids rather than colors, it is only sampled unfiltered
+   enum class Format {
+      RGBA8,
+      RGBA16F,
+      RGBA32F,
+      SRGB8_ALPHA8,
+      Depth24,
+      Depth32F,
+      R8,
+      RG8,
+      RGB8,
+      R32UI
+   };
 
    enum class FilterMode { Nearest, Linear, LinearMipmapLinear, NearestMipmapNearest };
    enum class WrapMode { Repeat, ClampToEdge, ClampToBorder, MirroredRepeat };
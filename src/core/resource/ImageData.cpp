@@ -0,0 +1,20 @@
+#include "core/resource/ImageData.hpp"
+
+#include <stb_image.h>
+
+#include <string>
+
+void ImageData::PixelDeleter::operator()(uint8_t* const pixels) const noexcept {
+   stbi_image_free(pixels);
+}
+
+ImageData ImageData::LoadFromFile(const std::string_view filepath) {
+   int32_t width = 0, height = 0, channels = 0;
+   ImageData image;
+   image.pixels.reset(stbi_load(std::string{filepath}.c_str(), &width, &height, &channels, 4));
+   if (image.pixels) {
+      image.width = static_cast<uint32_t>(width);
+      image.height = static_cast<uint32_t>(height);
+   }
+   return image;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+// Decoded RGBA8 pixels of an image file. Decoding needs no graphics context, so it can run on
+// worker threads and leave only the upload to the thread owning the context.
+struct ImageData final {
+   struct PixelDeleter final {
+      void operator()(uint8_t* const pixels) const noexcept;
+   };
+
+   std::unique_ptr<uint8_t, PixelDeleter> pixels;
+   uint32_t width{0};
+   uint32_t height{0};
+
+   [[nodiscard]] bool IsEmpty() const noexcept { return !pixels; }
+   [[nodiscard]] constexpr size_t GetSizeBytes() const noexcept {
+      return static_cast<size_t>(width) * height * 4;
+   }
+
+   // Empty if the file is missing or cannot be decoded
+   [[nodiscard]] static ImageData LoadFromFile(const std::string_view filepath);
+};
@@ -26,40 +26,40 @@ size_t MaterialInstance::GetMemoryUsage() const noexcept {
    return m_uboData.size() + (m_parameters.size() * 32) + (m_textures.size() * 16);
 }
 
-void MaterialInstance::SetParameter(const std::string_view name, const MaterialParam& value) {
-   if (auto it = m_parameters.find(std::string(name)); it != m_parameters.end()) {
+void MaterialInstance::SetParameter(const StringId name, const MaterialParam& value) {
+   if (auto it = m_parameters.find(name); it != m_parameters.end()) {
       it->second = value;
       WriteParamToUBO(name, value);
       m_uboDirty = true;
    }
 }
 
-MaterialParam MaterialInstance::GetParameter(const std::string_view name) const {
-   if (auto it = m_parameters.find(std::string(name)); it != m_parameters.end()) {
+MaterialParam MaterialInstance::GetParameter(const StringId name) const {
+   if (auto it = m_parameters.find(name); it != m_parameters.end()) {
       return it->second;
    }
    return {};
 }
 
-bool MaterialInstance::HasParameter(const std::string_view name) const noexcept {
-   return m_parameters.contains(std::string(name));
+bool MaterialInstance::HasParameter(const StringId name) const noexcept {
+   return m_parameters.contains(name);
 }
 
-void MaterialInstance::SetTexture(const std::string_view name, const TextureHandle texture) {
-   if (auto it = m_textures.find(std::string(name)); it != m_textures.end()) {
+void MaterialInstance::SetTexture(const StringId name, const TextureHandle texture) {
+   if (auto it = m_textures.find(name); it != m_textures.end()) {
       it->second = texture;
    }
 }
 
-TextureHandle MaterialInstance::GetTexture(const std::string_view name) const {
-   if (auto it = m_textures.find(std::string(name)); it != m_textures.end()) {
+TextureHandle MaterialInstance::GetTexture(const StringId name) const {
+   if (auto it = m_textures.find(name); it != m_textures.end()) {
       return it->second;
    }
    return {};
 }
 
-bool MaterialInstance::HasTexture(const std::string_view name) const noexcept {
-   return m_textures.contains(std::string(name));
+bool MaterialInstance::HasTexture(const StringId name) const noexcept {
+   return m_textures.contains(name);
 }
 
 std::string_view MaterialInstance::GetTemplateName() const noexcept {
@@ -77,9 +77,9 @@ void MaterialInstance::UpdateUBOData() {
    m_uboDirty = false;
 }
 
-void MaterialInstance::WriteParamToUBO(const std::string_view name, const MaterialParam& value) {
+void MaterialInstance::WriteParamToUBO(const StringId name, const MaterialParam& value) {
    const auto& params = m_template->GetParameters();
-   if (auto paramIt = params.find(std::string(name)); paramIt != params.end()) {
+   if (auto paramIt = params.find(name); paramIt != params.end()) {
       const auto& desc = paramIt->second;
       const auto target = std::span{m_uboData}.subspan(desc.offset);
       std::visit(
@@ -21,13 +21,13 @@ class MaterialInstance : public IMaterial {
    [[nodiscard]] constexpr bool IsValid() const noexcept override { return m_template != nullptr; }
 
    // IMaterial implementation
-   void SetParameter(const std::string_view name, const MaterialParam& value) override;
-   [[nodiscard]] MaterialParam GetParameter(const std::string_view name) const override;
-   [[nodiscard]] bool HasParameter(const std::string_view name) const noexcept override;
+   void SetParameter(const StringId name, const MaterialParam& value) override;
+   [[nodiscard]] MaterialParam GetParameter(const StringId name) const override;
+   [[nodiscard]] bool HasParameter(const StringId name) const noexcept override;
 
-   void SetTexture(const std::string_view name, const TextureHandle texture) override;
-   [[nodiscard]] TextureHandle GetTexture(const std::string_view name) const override;
-   [[nodiscard]] bool HasTexture(const std::string_view name) const noexcept override;
+   void SetTexture(const StringId name, const TextureHandle texture) override;
+   [[nodiscard]] TextureHandle GetTexture(const StringId name) const override;
+   [[nodiscard]] bool HasTexture(const StringId name) const noexcept override;
 
    [[nodiscard]] std::string_view GetTemplateName() const noexcept override;
 
@@ -42,11 +42,11 @@ class MaterialInstance : public IMaterial {
 
   protected:
    const MaterialTemplate* m_template{};
-   std::unordered_map<std::string, MaterialParam> m_parameters;
-   std::unordered_map<std::string, TextureHandle> m_textures;
+   std::unordered_map<StringId, MaterialParam> m_parameters;
+   std::unordered_map<StringId, TextureHandle> m_textures;
    std::vector<std::byte> m_uboData;
    mutable bool m_uboDirty{true};
 
    void UpdateUBOData();
-   void WriteParamToUBO(const std::string_view name, const MaterialParam& value);
+   void WriteParamToUBO(const StringId name, const MaterialParam& value);
 };
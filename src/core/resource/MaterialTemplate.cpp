@@ -18,7 +18,7 @@ void MaterialTemplate::AddParameter(const std::string_view name,
       .offset = 0,
       .size = GetTypeSize(type),
    };
-   m_parameters.emplace(desc.name, std::move(desc));
+   m_parameters.emplace(StringId::Intern(desc.name), std::move(desc));
 }
 
 void MaterialTemplate::AddTexture(const std::string_view name, const uint32_t bindingSlot,
@@ -33,7 +33,7 @@ void MaterialTemplate::AddTexture(const std::string_view name, const uint32_t bi
       .samplerName = std::string(samplerName),
       .defaultTexture = defaultTexture,
    };
-   m_textures.emplace(desc.name, std::move(desc));
+   m_textures.emplace(StringId::Intern(desc.name), std::move(desc));
 }
 
 void MaterialTemplate::Finalize() noexcept {
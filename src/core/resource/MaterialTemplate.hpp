@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/StringId.hpp"
 #include "core/resource/IMaterial.hpp"
 
 #include <unordered_map>
@@ -47,8 +48,8 @@ class MaterialTemplate final {
 
   private:
    std::string m_name;
-   std::unordered_map<std::string, ParameterDescriptor> m_parameters;
-   std::unordered_map<std::string, TextureDescriptor> m_textures;
+   std::unordered_map<StringId, ParameterDescriptor> m_parameters;
+   std::unordered_map<StringId, TextureDescriptor> m_textures;
    uint32_t m_uboSize = 0;
    bool m_finalized = false;
 
@@ -83,6 +83,7 @@ MeshLoader::MeshData MeshLoader::LoadSingleMesh(std::string_view filepath) {
       std::ranges::copy(offsetIndices, std::back_inserter(combinedMesh.indices));
       vertexOffset += static_cast<uint32_t>(meshVertices.size());
    }
+   combinedMesh.bounds = BoundingBox::FromVertices(combinedMesh.vertices);
    return combinedMesh;
 }
 
@@ -130,6 +131,7 @@ MeshLoader::MeshData MeshLoader::ProcessMesh(const aiScene* scene, const aiMesh*
    // Extract vertex and index data
    ExtractVertexData(mesh, meshData.vertices);
    ExtractIndexData(mesh, meshData.indices);
+   meshData.bounds = BoundingBox::FromVertices(meshData.vertices);
    // Set mesh name
    if (mesh->mName.length > 0) {
       meshData.name = std::string(mesh->mName.C_Str());
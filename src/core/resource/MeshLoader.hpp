@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/Bounds.hpp"
 #include "core/Vertex.hpp"
 
 #include <glm/glm.hpp>
@@ -22,6 +23,8 @@ class MeshLoader final {
       std::string name;
       uint32_t materialIndex{0};
       glm::mat4 transform{glm::mat4(1.0f)};
+      // Object space, i.e. before transform is applied
+      BoundingBox bounds{};
 
       size_t GetVertexCount() const noexcept;
       size_t GetIndexCount() const noexcept;
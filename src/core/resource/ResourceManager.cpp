@@ -7,6 +7,23 @@
 #include <ranges>
 #include <stdexcept>
 
+namespace {
+
+// Null for meshes too large to rasterize on the CPU every frame
+[[nodiscard]] std::unique_ptr<OccluderGeometry> CreateOccluderGeometry(
+   const std::span<const Vertex> vertices, const std::span<const uint32_t> indices) {
+   if (indices.empty() || indices.size() / 3 > ResourceManager::MAX_OCCLUDER_TRIANGLES)
+      return nullptr;
+   auto occluder = std::make_unique<OccluderGeometry>();
+   occluder->positions.reserve(vertices.size());
+   for (const Vertex& vertex : vertices)
+      occluder->positions.push_back(vertex.position);
+   occluder->indices.assign(indices.begin(), indices.end());
+   return occluder;
+}
+
+} // namespace
+
 ResourceManager::ResourceManager(std::unique_ptr<IResourceFactory> factory)
     : m_factory(std::move(factory)), m_nextId(1) {
    if (!m_factory) {
@@ -27,9 +44,9 @@ ResourceHandle<T> ResourceManager::RegisterResource(const std::string_view name,
       return ResourceHandle<T>{};
    }
    std::unique_lock lock(m_mutex);
-   const std::string nameStr{name};
+   const StringId nameId = StringId::Intern(name);
    // Check if resource with this name already exists
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(nameId); nameIt != m_nameToId.end()) {
       // Replace existing resource
       const uint64_t existingId = nameIt->second;
       if (auto resourceIt = m_resources.find(existingId); resourceIt != m_resources.end()) {
@@ -42,11 +59,11 @@ ResourceHandle<T> ResourceManager::RegisterResource(const std::string_view name,
    const uint64_t id = GetNextId();
    auto entry = std::make_unique<ResourceEntry>();
    entry->resource = std::move(resource);
-   entry->name = nameStr;
+   entry->name = nameId;
    entry->filepath = filepath;
    entry->id = id;
    m_resources[id] = std::move(entry);
-   m_nameToId[nameStr] = id;
+   m_nameToId[nameId] = id;
    return ResourceHandle<T>(id);
 }
 
@@ -54,7 +71,19 @@ TextureHandle ResourceManager::LoadTexture(const std::string_view name,
                                            const std::string_view filepath,
                                            const bool generateMipmaps, const bool sRGB) {
    auto texture = m_factory->CreateTextureFromFile(filepath, generateMipmaps, sRGB);
-   return RegisterResource<ITexture>(name, std::move(texture), filepath);
+   const TextureHandle handle = RegisterResource<ITexture>(name, std::move(texture), filepath);
+   SetTextureSource(handle, generateMipmaps, sRGB);
+   return handle;
+}
+
+TextureHandle ResourceManager::CreateTextureFromImage(const std::string_view name,
+                                                      const ImageData& image,
+                                                      const bool generateMipmaps, const bool sRGB,
+                                                      const std::string_view filepath) {
+   auto texture = m_factory->CreateTextureFromImage(image, generateMipmaps, sRGB);
+   const TextureHandle handle = RegisterResource<ITexture>(name, std::move(texture), filepath);
+   SetTextureSource(handle, generateMipmaps, sRGB);
+   return handle;
 }
 
 TextureHandle ResourceManager::CreateTexture(const std::string_view name,
@@ -80,36 +109,69 @@ TextureHandle ResourceManager::CreateDepthTexture(const std::string_view name, c
 TextureHandle ResourceManager::CreateRenderTarget(const std::string_view name, const uint32_t width,
                                                   const uint32_t height,
                                                   const ITexture::Format format,
-                                                  const uint32_t samples) {
-   auto texture = m_factory->CreateRenderTarget(width, height, format, samples);
+                                                  const uint32_t samples,
+                                                  const bool transientAttachment) {
+   auto texture =
+      m_factory->CreateRenderTarget(width, height, format, samples, transientAttachment);
    return RegisterResource<ITexture>(name, std::move(texture));
 }
 
 MaterialHandle ResourceManager::CreateMaterial(const std::string_view name,
                                                const std::string_view templateName) {
-   if (!m_materialTemplates.contains(std::string{templateName}))
+   const auto templateIt = m_materialTemplates.find(StringId(templateName));
+   if (templateIt == m_materialTemplates.end())
       throw std::runtime_error("The material template " + std::string{templateName} +
                                " does not exist.");
-   const MaterialTemplate* templ = m_materialTemplates.at(std::string{templateName}).get();
+   const MaterialTemplate* templ = templateIt->second.get();
    auto material = m_factory->CreateMaterial(*templ);
    return RegisterResource<IMaterial>(name, std::move(material));
 }
 
 MeshHandle ResourceManager::LoadMesh(const std::string_view name,
-                                     const std::vector<Vertex>& vertices,
-                                     const std::vector<uint32_t>& indices) {
+                                     const std::span<const Vertex> vertices,
+                                     const std::span<const uint32_t> indices,
+                                     const std::optional<BoundingBox>& bounds) {
    auto mesh = m_factory->CreateMesh(vertices, indices);
-   return RegisterResource<IMesh>(name, std::move(mesh));
+   if (mesh) {
+      mesh->SetBounds(bounds ? *bounds : BoundingBox::FromVertices(vertices));
+      mesh->SetOccluderGeometry(CreateOccluderGeometry(vertices, indices));
+   }
+   const MeshHandle handle = RegisterResource<IMesh>(name, std::move(mesh));
+   if (handle.IsValid()) {
+      std::unique_lock lock(m_mutex);
+      ResourceEntry& entry = *m_resources.at(handle.GetId());
+      entry.meshData.reset();
+      if (m_retainMeshData) {
+         entry.meshData = std::make_unique<MeshLoader::MeshData>();
+         entry.meshData->vertices.assign(vertices.begin(), vertices.end());
+         entry.meshData->indices.assign(indices.begin(), indices.end());
+         entry.meshData->name = name;
+      }
+   }
+   return handle;
 }
 
 MeshHandle ResourceManager::LoadSingleMeshFromFile(const std::string_view name,
                                                    const std::string_view filepath) {
-   const MeshLoader::MeshData meshData = MeshLoader::LoadSingleMesh(filepath);
+   MeshLoader::MeshData meshData = MeshLoader::LoadSingleMesh(filepath);
    if (meshData.IsEmpty()) {
       return MeshHandle{};
    }
    auto mesh = m_factory->CreateMesh(meshData.vertices, meshData.indices);
-   return RegisterResource<IMesh>(name, std::move(mesh), filepath);
+   if (mesh) {
+      mesh->SetBounds(meshData.bounds);
+      mesh->SetOccluderGeometry(CreateOccluderGeometry(meshData.vertices, meshData.indices));
+   }
+   const MeshHandle handle = RegisterResource<IMesh>(name, std::move(mesh), filepath);
+   if (handle.IsValid()) {
+      std::unique_lock lock(m_mutex);
+      ResourceEntry& entry = *m_resources.at(handle.GetId());
+      entry.meshData.reset();
+      if (m_retainMeshData) {
+         entry.meshData = std::make_unique<MeshLoader::MeshData>(std::move(meshData));
+      }
+   }
+   return handle;
 }
 
 MeshLoader::SceneData ResourceManager::LoadSceneData(const std::string_view filepath) {
@@ -146,10 +208,9 @@ IMesh* ResourceManager::GetMesh(const MeshHandle& handle) const {
    return nullptr;
 }
 
-ITexture* ResourceManager::GetTexture(const std::string_view name) const {
+ITexture* ResourceManager::GetTexture(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return static_cast<ITexture*>(resourceIt->second->resource.get());
       }
@@ -157,10 +218,9 @@ ITexture* ResourceManager::GetTexture(const std::string_view name) const {
    return nullptr;
 }
 
-IMaterial* ResourceManager::GetMaterial(const std::string_view name) const {
+IMaterial* ResourceManager::GetMaterial(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return static_cast<IMaterial*>(resourceIt->second->resource.get());
       }
@@ -168,20 +228,17 @@ IMaterial* ResourceManager::GetMaterial(const std::string_view name) const {
    return nullptr;
 }
 
-MaterialTemplate* ResourceManager::GetMaterialTemplate(const std::string_view name) const {
+MaterialTemplate* ResourceManager::GetMaterialTemplate(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto templateIt = m_materialTemplates.find(nameStr);
-       templateIt != m_materialTemplates.end()) {
+   if (auto templateIt = m_materialTemplates.find(name); templateIt != m_materialTemplates.end()) {
       return static_cast<MaterialTemplate*>(templateIt->second.get());
    }
    return nullptr;
 }
 
-IMesh* ResourceManager::GetMesh(const std::string_view name) const {
+IMesh* ResourceManager::GetMesh(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return static_cast<IMesh*>(resourceIt->second->resource.get());
       }
@@ -189,10 +246,9 @@ IMesh* ResourceManager::GetMesh(const std::string_view name) const {
    return nullptr;
 }
 
-TextureHandle ResourceManager::GetTextureHandle(const std::string_view name) const {
+TextureHandle ResourceManager::GetTextureHandle(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return TextureHandle(resourceIt->second->id);
       }
@@ -200,10 +256,9 @@ TextureHandle ResourceManager::GetTextureHandle(const std::string_view name) con
    return TextureHandle{};
 }
 
-MaterialHandle ResourceManager::GetMaterialHandle(const std::string_view name) const {
+MaterialHandle ResourceManager::GetMaterialHandle(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return MaterialHandle(resourceIt->second->id);
       }
@@ -211,10 +266,9 @@ MaterialHandle ResourceManager::GetMaterialHandle(const std::string_view name) c
    return MaterialHandle{};
 }
 
-MeshHandle ResourceManager::GetMeshHandle(const std::string_view name) const {
+MeshHandle ResourceManager::GetMeshHandle(const StringId name) const {
    std::shared_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       if (auto resourceIt = m_resources.find(nameIt->second); resourceIt != m_resources.end()) {
          return MeshHandle(resourceIt->second->id);
       }
@@ -222,6 +276,54 @@ MeshHandle ResourceManager::GetMeshHandle(const std::string_view name) const {
    return MeshHandle{};
 }
 
+StringId ResourceManager::GetResourceName(const uint64_t id) const {
+   std::shared_lock lock(m_mutex);
+   if (auto it = m_resources.find(id); it != m_resources.end()) {
+      return it->second->name;
+   }
+   return StringId{};
+}
+
+ResourceManager::TextureSource ResourceManager::GetTextureSource(
+   const TextureHandle& handle) const {
+   std::shared_lock lock(m_mutex);
+   if (auto it = m_resources.find(handle.GetId()); it != m_resources.end()) {
+      const ResourceEntry& entry = *it->second;
+      return TextureSource{.filepath = entry.filepath,
+                           .generateMipmaps = entry.generateMipmaps,
+                           .sRGB = entry.sRGB};
+   }
+   return TextureSource{.filepath = {}, .generateMipmaps = false, .sRGB = false};
+}
+
+void ResourceManager::SetRetainMeshData(const bool retain) {
+   std::unique_lock lock(m_mutex);
+   m_retainMeshData = retain;
+   if (!retain) {
+      for (const auto& entry : m_resources | std::views::values) {
+         entry->meshData.reset();
+      }
+   }
+}
+
+const MeshLoader::MeshData* ResourceManager::GetMeshData(const MeshHandle& handle) const {
+   std::shared_lock lock(m_mutex);
+   if (auto it = m_resources.find(handle.GetId()); it != m_resources.end()) {
+      return it->second->meshData.get();
+   }
+   return nullptr;
+}
+
+void ResourceManager::SetTextureSource(const TextureHandle& handle, const bool generateMipmaps,
+                                       const bool sRGB) {
+   if (!handle.IsValid())
+      return;
+   std::unique_lock lock(m_mutex);
+   ResourceEntry& entry = *m_resources.at(handle.GetId());
+   entry.generateMipmaps = generateMipmaps;
+   entry.sRGB = sRGB;
+}
+
 void ResourceManager::RemoveResource(const uint64_t id) {
    if (auto it = m_resources.find(id); it != m_resources.end()) {
       m_nameToId.erase(it->second->name);
@@ -250,26 +352,23 @@ void ResourceManager::UnloadMesh(const MeshHandle& handle) {
    RemoveResource(handle.GetId());
 }
 
-void ResourceManager::UnloadTexture(const std::string_view name) {
+void ResourceManager::UnloadTexture(const StringId name) {
    std::unique_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       RemoveResource(nameIt->second);
    }
 }
 
-void ResourceManager::UnloadMaterial(const std::string_view name) {
+void ResourceManager::UnloadMaterial(const StringId name) {
    std::unique_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       RemoveResource(nameIt->second);
    }
 }
 
-void ResourceManager::UnloadMesh(const std::string_view name) {
+void ResourceManager::UnloadMesh(const StringId name) {
    std::unique_lock lock(m_mutex);
-   const std::string nameStr{name};
-   if (auto nameIt = m_nameToId.find(nameStr); nameIt != m_nameToId.end()) {
+   if (auto nameIt = m_nameToId.find(name); nameIt != m_nameToId.end()) {
       RemoveResource(nameIt->second);
    }
 }
@@ -302,7 +401,8 @@ std::vector<std::pair<ITexture*, std::string>> ResourceManager::GetAllTexturesNa
          return entry && entry->resource && entry->resource->GetType() == ResourceType::Texture;
       }) |
       std::views::transform([](const auto& entry) {
-         return std::make_pair(static_cast<ITexture*>(entry->resource.get()), entry->name);
+         return std::make_pair(static_cast<ITexture*>(entry->resource.get()),
+                               std::string(entry->name.GetString()));
       });
    std::ranges::copy(textureEntries, std::back_inserter(textures));
    return textures;
@@ -316,7 +416,8 @@ std::vector<std::pair<IMaterial*, std::string>> ResourceManager::GetAllMaterials
          return entry && entry->resource && entry->resource->GetType() == ResourceType::Material;
       }) |
       std::views::transform([](const auto& entry) {
-         return std::make_pair(static_cast<IMaterial*>(entry->resource.get()), entry->name);
+         return std::make_pair(static_cast<IMaterial*>(entry->resource.get()),
+                               std::string(entry->name.GetString()));
       });
    std::ranges::copy(materialEntries, std::back_inserter(materials));
    return materials;
@@ -329,7 +430,7 @@ ResourceManager::GetAllMaterialTemplatesNamed() {
    templates.reserve(m_materialTemplates.size());
    for (const auto& [name, templatePtr] : m_materialTemplates) {
       if (templatePtr && templatePtr->IsFinalized()) {
-         templates.emplace_back(*templatePtr, name);
+         templates.emplace_back(*templatePtr, std::string(name.GetString()));
       }
    }
    return templates;
@@ -343,7 +444,8 @@ std::vector<std::pair<IMesh*, std::string>> ResourceManager::GetAllMeshesNamed()
          return entry && entry->resource && entry->resource->GetType() == ResourceType::Mesh;
       }) |
       std::views::transform([](const auto& entry) {
-         return std::make_pair(static_cast<IMesh*>(entry->resource.get()), entry->name);
+         return std::make_pair(static_cast<IMesh*>(entry->resource.get()),
+                               std::string(entry->name.GetString()));
       });
    std::ranges::copy(meshEntries, std::back_inserter(meshes));
    return meshes;
@@ -374,7 +476,7 @@ void ResourceManager::SetupMaterialTemplates() {
    pbrTemplate->AddTexture("aoTexture", 4, "aoSampler", defAO);
    // Add the PBR material template
    pbrTemplate->Finalize();
-   m_materialTemplates[std::string{pbrTemplate->GetName()}] = std::move(pbrTemplate);
+   m_materialTemplates[StringId::Intern(pbrTemplate->GetName())] = std::move(pbrTemplate);
 }
 
 template ResourceHandle<ITexture> ResourceManager::RegisterResource<ITexture>(
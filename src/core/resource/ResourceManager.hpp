@@ -1,15 +1,27 @@
 #pragma once
 
+#include "core/StringId.hpp"
 #include "core/resource/IResourceFactory.hpp"
 #include "core/resource/ResourceHandle.hpp"
 #include "core/resource/MaterialTemplate.hpp"
 #include "core/resource/MeshLoader.hpp"
 
+#include <optional>
 #include <shared_mutex>
+#include <span>
 #include <unordered_map>
 
 class ResourceManager final {
   public:
+   static constexpr size_t MAX_OCCLUDER_TRIANGLES = 8192;
+
+   // How a texture was loaded from disk, filepath is empty for textures created in code
+   struct TextureSource final {
+      std::string_view filepath;
+      bool generateMipmaps;
+      bool sRGB;
+   };
+
    explicit ResourceManager(std::unique_ptr<IResourceFactory> factory);
    ~ResourceManager();
 
@@ -19,6 +31,10 @@ class ResourceManager final {
    // Texture management
    TextureHandle LoadTexture(const std::string_view name, const std::string_view filepath,
                              const bool generateMipmaps = true, const bool sRGB = true);
+   // Same as LoadTexture() with the file already decoded, filepath is only recorded
+   TextureHandle CreateTextureFromImage(const std::string_view name, const ImageData& image,
+                                        const bool generateMipmaps = true, const bool sRGB = true,
+                                        const std::string_view filepath = {});
    TextureHandle CreateTexture(const std::string_view name, const ITexture::CreateInfo& info);
    TextureHandle CreateTextureColor(const std::string_view name, const ITexture::Format format,
                                     const glm::vec4& color);
@@ -28,13 +44,17 @@ class ResourceManager final {
    TextureHandle CreateRenderTarget(const std::string_view name, const uint32_t width,
                                     const uint32_t height,
                                     const ITexture::Format format = ITexture::Format::RGBA8,
-                                    const uint32_t samples = 1);
+                                    const uint32_t samples = 1,
+                                    const bool transientAttachment = false);
    // Material management
    MaterialHandle CreateMaterial(const std::string_view name, const std::string_view templateName);
 
    // Mesh management
-   MeshHandle LoadMesh(const std::string_view name, const std::vector<Vertex>& vertices,
-                       const std::vector<uint32_t>& indices);
+   // Bounds are computed from the vertices unless given. Meshes of at most
+   // MAX_OCCLUDER_TRIANGLES triangles also keep their positions and indices for occlusion culling.
+   MeshHandle LoadMesh(const std::string_view name, const std::span<const Vertex> vertices,
+                       const std::span<const uint32_t> indices,
+                       const std::optional<BoundingBox>& bounds = std::nullopt);
    MeshHandle LoadSingleMeshFromFile(const std::string_view name, const std::string_view filepath);
 
    // Scene data loading
@@ -46,21 +66,30 @@ class ResourceManager final {
    IMesh* GetMesh(const MeshHandle& handle) const;
 
    // Resource access by name
-   ITexture* GetTexture(const std::string_view name) const;
-   IMaterial* GetMaterial(const std::string_view name) const;
-   MaterialTemplate* GetMaterialTemplate(const std::string_view name) const;
-   IMesh* GetMesh(const std::string_view name) const;
-   TextureHandle GetTextureHandle(const std::string_view name) const;
-   MaterialHandle GetMaterialHandle(const std::string_view name) const;
-   MeshHandle GetMeshHandle(const std::string_view name) const;
+   ITexture* GetTexture(const StringId name) const;
+   IMaterial* GetMaterial(const StringId name) const;
+   MaterialTemplate* GetMaterialTemplate(const StringId name) const;
+   IMesh* GetMesh(const StringId name) const;
+   TextureHandle GetTextureHandle(const StringId name) const;
+   MaterialHandle GetMaterialHandle(const StringId name) const;
+   MeshHandle GetMeshHandle(const StringId name) const;
+   StringId GetResourceName(const uint64_t id) const;
+
+   // Where a resource came from, used to write it back out (e.g. into scene snapshots)
+   TextureSource GetTextureSource(const TextureHandle& handle) const;
+   // While enabled, meshes loaded afterwards keep a CPU copy of their geometry.
+   // Disabling drops every copy kept so far.
+   void SetRetainMeshData(const bool retain);
+   // Null unless the mesh was loaded while retention was enabled
+   const MeshLoader::MeshData* GetMeshData(const MeshHandle& handle) const;
 
    // Resource management
    void UnloadTexture(const TextureHandle& handle);
    void UnloadMaterial(const MaterialHandle& handle);
    void UnloadMesh(const MeshHandle& handle);
-   void UnloadTexture(const std::string_view name);
-   void UnloadMaterial(const std::string_view name);
-   void UnloadMesh(const std::string_view name);
+   void UnloadTexture(const StringId name);
+   void UnloadMaterial(const StringId name);
+   void UnloadMesh(const StringId name);
 
    // Utility methods
    void UnloadAll();
@@ -77,23 +106,29 @@ class ResourceManager final {
    ResourceHandle<T> RegisterResource(const std::string_view name, std::unique_ptr<T> resource,
                                       const std::string_view filepath = {});
 
+   void SetTextureSource(const TextureHandle& handle, const bool generateMipmaps,
+                         const bool sRGB);
    void RemoveResource(const uint64_t id);
    void SetupMaterialTemplates();
 
   private:
    struct ResourceEntry {
       std::unique_ptr<IResource> resource;
-      std::string name;
+      StringId name;
       std::string filepath;
       uint64_t id;
       size_t refCount;
+      bool generateMipmaps{false};
+      bool sRGB{false};
+      std::unique_ptr<MeshLoader::MeshData> meshData;
    };
 
    std::unique_ptr<IResourceFactory> m_factory;
    std::unordered_map<uint64_t, std::unique_ptr<ResourceEntry>> m_resources;
-   std::unordered_map<std::string, std::unique_ptr<MaterialTemplate>> m_materialTemplates;
-   std::unordered_map<std::string, uint64_t> m_nameToId;
+   std::unordered_map<StringId, std::unique_ptr<MaterialTemplate>> m_materialTemplates;
+   std::unordered_map<StringId, uint64_t> m_nameToId;
 
    mutable std::shared_mutex m_mutex;
    uint64_t m_nextId;
+   bool m_retainMeshData{false};
 };
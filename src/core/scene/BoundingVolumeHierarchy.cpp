@@ -0,0 +1,97 @@
+#include "core/scene/BoundingVolumeHierarchy.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+
+void BoundingVolumeHierarchy::Build(const std::span<const BoundingBox> bounds) {
+   Clear();
+   if (bounds.empty())
+      return;
+   const uint32_t itemCount = static_cast<uint32_t>(bounds.size());
+   m_itemBounds.assign(bounds.begin(), bounds.end());
+   m_items.resize(itemCount);
+   std::iota(m_items.begin(), m_items.end(), 0u);
+   m_itemLeaves.assign(itemCount, INVALID_INDEX);
+   // A binary tree with at most MAX_LEAF_ITEMS per leaf stays below this
+   m_nodes.reserve(2 * (itemCount / MAX_LEAF_ITEMS + 1));
+   (void)BuildNode(0, itemCount, INVALID_INDEX);
+   m_nodeDirty.assign(m_nodes.size(), 0);
+}
+
+void BoundingVolumeHierarchy::Clear() noexcept {
+   m_nodes.clear();
+   m_items.clear();
+   m_itemBounds.clear();
+   m_itemLeaves.clear();
+   m_dirtyNodes.clear();
+   m_nodeDirty.clear();
+}
+
+void BoundingVolumeHierarchy::Update(const uint32_t item, const BoundingBox& bounds) {
+   m_itemBounds[item] = bounds;
+   // Queue the leaf and every ancestor not queued yet, ancestors of queued nodes already are
+   for (uint32_t node = m_itemLeaves[item]; node != INVALID_INDEX && !m_nodeDirty[node];
+        node = m_nodes[node].parent) {
+      m_nodeDirty[node] = 1;
+      m_dirtyNodes.push_back(node);
+   }
+}
+
+uint32_t BoundingVolumeHierarchy::Refit() {
+   // Children come after their parents in pre-order, so descending order refits bottom up
+   std::ranges::sort(m_dirtyNodes, std::greater{});
+   for (const uint32_t index : m_dirtyNodes) {
+      RecomputeNode(m_nodes[index]);
+      m_nodeDirty[index] = 0;
+   }
+   const uint32_t refit = static_cast<uint32_t>(m_dirtyNodes.size());
+   m_dirtyNodes.clear();
+   return refit;
+}
+
+uint32_t BoundingVolumeHierarchy::BuildNode(const uint32_t firstItem, const uint32_t itemCount,
+                                            const uint32_t parent) {
+   const uint32_t index = static_cast<uint32_t>(m_nodes.size());
+   m_nodes.push_back(BvhNode{.bounds = {},
+                             .firstItem = firstItem,
+                             .itemCount = itemCount,
+                             .parent = parent,
+                             .rightChild = INVALID_INDEX});
+   const auto items = std::span(m_items).subspan(firstItem, itemCount);
+   if (itemCount <= MAX_LEAF_ITEMS) {
+      for (const uint32_t item : items)
+         m_itemLeaves[item] = index;
+      RecomputeNode(m_nodes[index]);
+      return index;
+   }
+   // Split at the median centroid along the axis where the centroids spread the most
+   BoundingBox centroids;
+   for (const uint32_t item : items)
+      centroids.Expand(m_itemBounds[item].GetCenter());
+   const glm::vec3 spread = centroids.max - centroids.min;
+   const int32_t axis = spread.x > spread.y ? (spread.x > spread.z ? 0 : 2)
+                                            : (spread.y > spread.z ? 1 : 2);
+   const uint32_t half = itemCount / 2;
+   std::ranges::nth_element(items, items.begin() + half, {}, [this, axis](const uint32_t item) {
+      return m_itemBounds[item].GetCenter()[axis];
+   });
+   (void)BuildNode(firstItem, half, index);
+   const uint32_t right = BuildNode(firstItem + half, itemCount - half, index);
+   // Children may have reallocated m_nodes
+   m_nodes[index].rightChild = right;
+   RecomputeNode(m_nodes[index]);
+   return index;
+}
+
+void BoundingVolumeHierarchy::RecomputeNode(BvhNode& node) noexcept {
+   node.bounds = {};
+   if (node.rightChild == INVALID_INDEX) {
+      for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+         node.bounds.Expand(m_itemBounds[m_items[i]]);
+      return;
+   }
+   const uint32_t index = static_cast<uint32_t>(&node - m_nodes.data());
+   node.bounds.Expand(m_nodes[index + 1].bounds);
+   node.bounds.Expand(m_nodes[node.rightChild].bounds);
+}
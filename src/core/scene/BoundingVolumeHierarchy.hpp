@@ -0,0 +1,99 @@
+#pragma once
+
+#include "core/Bounds.hpp"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Binary AABB tree over a fixed set of items, e.g. the render world's mesh proxies. Built top
+// down with median splits; when items move only their leaves and the ancestors above them are
+// refit, so the tree is rebuilt only when the item set changes. Nodes are stored in pre-order,
+// a node's left child directly follows it and every subtree owns a contiguous run of items.
+class BoundingVolumeHierarchy final {
+  public:
+   static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+   static constexpr uint32_t MAX_LEAF_ITEMS = 4;
+
+   BoundingVolumeHierarchy() = default;
+   ~BoundingVolumeHierarchy() = default;
+
+   BoundingVolumeHierarchy(const BoundingVolumeHierarchy&) = delete;
+   BoundingVolumeHierarchy& operator=(const BoundingVolumeHierarchy&) = delete;
+   BoundingVolumeHierarchy(BoundingVolumeHierarchy&&) = default;
+   BoundingVolumeHierarchy& operator=(BoundingVolumeHierarchy&&) = default;
+
+   // Item i gets bounds[i], items must not be empty boxes
+   void Build(const std::span<const BoundingBox> bounds);
+   void Clear() noexcept;
+
+   // Takes effect on the next Refit()
+   void Update(const uint32_t item, const BoundingBox& bounds);
+   // Recompute the nodes above updated items, returns how many were recomputed
+   uint32_t Refit();
+
+   // Calls func(item) for every item whose bounds intersect the frustum, in no particular order
+   template <typename Func>
+   void Query(const Frustum& frustum, Func&& func) const;
+
+   [[nodiscard]] constexpr size_t GetItemCount() const noexcept { return m_itemBounds.size(); }
+   [[nodiscard]] constexpr size_t GetNodeCount() const noexcept { return m_nodes.size(); }
+
+  private:
+   struct BvhNode final {
+      BoundingBox bounds;
+      // Subtree's run in m_items
+      uint32_t firstItem;
+      uint32_t itemCount;
+      uint32_t parent;
+      // INVALID_INDEX for leaves, the left child is always the next node
+      uint32_t rightChild;
+   };
+
+   // Pre-order DFS depth never gets near this with median splits
+   static constexpr size_t MAX_DEPTH = 64;
+
+   uint32_t BuildNode(const uint32_t firstItem, const uint32_t itemCount, const uint32_t parent);
+   void RecomputeNode(BvhNode& node) noexcept;
+
+  private:
+   std::vector<BvhNode> m_nodes;
+   // Item indices, permuted so each leaf's items are contiguous
+   std::vector<uint32_t> m_items;
+   std::vector<BoundingBox> m_itemBounds;
+   std::vector<uint32_t> m_itemLeaves;
+   // Nodes waiting for Refit(), with a flag per node so each is queued once
+   std::vector<uint32_t> m_dirtyNodes;
+   std::vector<uint8_t> m_nodeDirty;
+};
+
+template <typename Func>
+void BoundingVolumeHierarchy::Query(const Frustum& frustum, Func&& func) const {
+   if (m_nodes.empty())
+      return;
+   std::array<uint32_t, MAX_DEPTH> stack;
+   size_t stackSize = 0;
+   stack[stackSize++] = 0;
+   while (stackSize > 0) {
+      const BvhNode& node = m_nodes[stack[--stackSize]];
+      bool inside = false;
+      if (!frustum.Classify(node.bounds, inside))
+         continue;
+      // Nothing below a fully contained node needs testing
+      if (inside) {
+         for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i)
+            func(m_items[i]);
+         continue;
+      }
+      if (node.rightChild == INVALID_INDEX) {
+         for (uint32_t i = node.firstItem; i < node.firstItem + node.itemCount; ++i) {
+            if (frustum.Intersects(m_itemBounds[m_items[i]]))
+               func(m_items[i]);
+         }
+         continue;
+      }
+      stack[stackSize++] = node.rightChild;
+      stack[stackSize++] = static_cast<uint32_t>(&node - m_nodes.data()) + 1;
+   }
+}
@@ -0,0 +1,110 @@
+#include "core/scene/ComponentRegistry.hpp"
+
+#include "core/scene/Node.hpp"
+
+void ComponentPool::Insert(const uint32_t entity, Node* const owner, Component* const component) {
+   if (entity >= m_sparse.size()) {
+      m_sparse.resize(entity + 1, INVALID_INDEX);
+   }
+   if (const uint32_t dense = m_sparse[entity]; dense != INVALID_INDEX) {
+      m_owners[dense] = owner;
+      m_components[dense] = component;
+      return;
+   }
+   m_sparse[entity] = static_cast<uint32_t>(m_components.size());
+   m_entities.push_back(entity);
+   m_owners.push_back(owner);
+   m_components.push_back(component);
+}
+
+void ComponentPool::Remove(const uint32_t entity) noexcept {
+   if (entity >= m_sparse.size() || m_sparse[entity] == INVALID_INDEX)
+      return;
+   // Swap the last element into the hole to keep the dense arrays packed
+   const uint32_t dense = m_sparse[entity];
+   const uint32_t last = static_cast<uint32_t>(m_components.size() - 1);
+   if (dense != last) {
+      m_entities[dense] = m_entities[last];
+      m_owners[dense] = m_owners[last];
+      m_components[dense] = m_components[last];
+      m_sparse[m_entities[dense]] = dense;
+   }
+   m_entities.pop_back();
+   m_owners.pop_back();
+   m_components.pop_back();
+   m_sparse[entity] = INVALID_INDEX;
+}
+
+void ComponentPool::Clear() noexcept {
+   m_sparse.clear();
+   m_entities.clear();
+   m_owners.clear();
+   m_components.clear();
+}
+
+ComponentRegistry::ComponentRegistry(Node* const root) {
+   if (root) {
+      root->SetRegistry(this);
+   }
+}
+
+NodeHandle ComponentRegistry::CreateEntity(Node* const owner) {
+   uint32_t index;
+   if (!m_freeEntities.empty()) {
+      index = m_freeEntities.back();
+      m_freeEntities.pop_back();
+   } else {
+      index = static_cast<uint32_t>(m_slots.size());
+      m_slots.emplace_back();
+   }
+   m_slots[index].node = owner;
+   return NodeHandle(index, m_slots[index].generation);
+}
+
+void ComponentRegistry::DestroyEntity(const NodeHandle handle) {
+   if (!Resolve(handle))
+      return;
+   EntitySlot& slot = m_slots[handle.GetIndex()];
+   slot.node = nullptr;
+   ++slot.generation;
+   m_freeEntities.push_back(handle.GetIndex());
+   MarkChanged();
+}
+
+void ComponentRegistry::Clear() noexcept {
+   m_freeEntities.clear();
+   // Reverse order so the lowest slots are reused first
+   for (size_t i = m_slots.size(); i-- > 0;) {
+      EntitySlot& slot = m_slots[i];
+      if (slot.node) {
+         slot.node = nullptr;
+         ++slot.generation;
+      }
+      m_freeEntities.push_back(static_cast<uint32_t>(i));
+   }
+   for (const auto& pool : m_pools) {
+      if (pool) {
+         pool->Clear();
+      }
+   }
+   MarkChanged();
+}
+
+void ComponentRegistry::Insert(const uint32_t typeId, const uint32_t entity, Node* const owner,
+                               Component* const component) {
+   if (typeId >= m_pools.size()) {
+      m_pools.resize(typeId + 1);
+   }
+   if (!m_pools[typeId]) {
+      m_pools[typeId] = std::make_unique<ComponentPool>();
+   }
+   m_pools[typeId]->Insert(entity, owner, component);
+   MarkChanged();
+}
+
+void ComponentRegistry::Remove(const uint32_t typeId, const uint32_t entity) noexcept {
+   if (typeId < m_pools.size() && m_pools[typeId]) {
+      m_pools[typeId]->Remove(entity);
+      MarkChanged();
+   }
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include "core/scene/NodeHandle.hpp"
+#include "core/scene/components/Component.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+class Node;
+
+// Sparse set of one component type: entity ids index into dense arrays that iterate linearly
+class ComponentPool final {
+  public:
+   static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+   // Inserting an entity that is already present replaces its component
+   void Insert(const uint32_t entity, Node* const owner, Component* const component);
+   void Remove(const uint32_t entity) noexcept;
+   void Clear() noexcept;
+
+   [[nodiscard]] constexpr Component* Get(const uint32_t entity) const noexcept {
+      if (entity >= m_sparse.size() || m_sparse[entity] == INVALID_INDEX)
+         return nullptr;
+      return m_components[m_sparse[entity]];
+   }
+   [[nodiscard]] constexpr size_t GetSize() const noexcept { return m_components.size(); }
+   [[nodiscard]] constexpr uint32_t GetEntity(const size_t index) const noexcept {
+      return m_entities[index];
+   }
+   [[nodiscard]] constexpr Node* GetOwner(const size_t index) const noexcept {
+      return m_owners[index];
+   }
+   [[nodiscard]] constexpr Component* GetComponent(const size_t index) const noexcept {
+      return m_components[index];
+   }
+
+  private:
+   std::vector<uint32_t> m_sparse;
+   std::vector<uint32_t> m_entities;
+   std::vector<Node*> m_owners;
+   std::vector<Component*> m_components;
+};
+
+// Entities owning every one of Ts, walked along the densest of the involved pools.
+// Iterating yields std::tuple<Node*, Ts*...>, so structured bindings work in range-for loops.
+template <ComponentType... Ts>
+class ComponentView final {
+  public:
+   using Pools = std::array<const ComponentPool*, sizeof...(Ts)>;
+   using Value = std::tuple<Node*, Ts*...>;
+
+   class Iterator final {
+     public:
+      using value_type = Value;
+      using difference_type = std::ptrdiff_t;
+
+      Iterator() = default;
+      Iterator(const ComponentView* const view, const size_t index) noexcept
+          : m_view(view), m_index(index) {
+         SkipUnmatched();
+      }
+
+      [[nodiscard]] Value operator*() const noexcept { return m_view->Fetch(m_index); }
+      Iterator& operator++() noexcept {
+         ++m_index;
+         SkipUnmatched();
+         return *this;
+      }
+      Iterator operator++(int) noexcept {
+         Iterator previous = *this;
+         ++*this;
+         return previous;
+      }
+      [[nodiscard]] bool operator==(const Iterator& other) const noexcept {
+         return m_index == other.m_index;
+      }
+
+     private:
+      void SkipUnmatched() noexcept {
+         while (m_index < m_view->m_size && !m_view->Matches(m_index)) {
+            ++m_index;
+         }
+      }
+
+      const ComponentView* m_view{nullptr};
+      size_t m_index{0};
+   };
+
+   explicit ComponentView(const Pools& pools) noexcept : m_pools(pools) {
+      for (const ComponentPool* const pool : m_pools) {
+         if (!pool) {
+            // A type that was never registered matches nothing
+            m_driver = nullptr;
+            m_size = 0;
+            return;
+         }
+         if (!m_driver || pool->GetSize() < m_driver->GetSize()) {
+            m_driver = pool;
+         }
+      }
+      m_size = m_driver ? m_driver->GetSize() : 0;
+   }
+
+   [[nodiscard]] Iterator begin() const noexcept { return Iterator(this, 0); }
+   [[nodiscard]] Iterator end() const noexcept { return Iterator(this, m_size); }
+
+   template <typename Func>
+   void ForEach(Func&& func) const {
+      for (size_t i = 0; i < m_size; ++i) {
+         if (Matches(i)) {
+            std::apply(func, Fetch(i));
+         }
+      }
+   }
+
+  private:
+   [[nodiscard]] bool Matches(const size_t index) const noexcept {
+      const uint32_t entity = m_driver->GetEntity(index);
+      for (const ComponentPool* const pool : m_pools) {
+         if (pool != m_driver && !pool->Get(entity))
+            return false;
+      }
+      return true;
+   }
+
+   [[nodiscard]] Value Fetch(const size_t index) const noexcept {
+      return Fetch(index, std::index_sequence_for<Ts...>{});
+   }
+
+   template <size_t... I>
+   [[nodiscard]] Value Fetch(const size_t index, std::index_sequence<I...>) const noexcept {
+      const uint32_t entity = m_driver->GetEntity(index);
+      return Value{m_driver->GetOwner(index), static_cast<Ts*>(m_pools[I]->Get(entity))...};
+   }
+
+  private:
+   Pools m_pools;
+   const ComponentPool* m_driver{nullptr};
+   size_t m_size{0};
+};
+
+// Entity slots and per-type component pools for every node attached to a scene. Nodes keep owning
+// their components; the pools index them by entity so systems can query them without walking the
+// tree. Slots are generational, so a stale NodeHandle never resolves to the slot's next node.
+class ComponentRegistry final {
+  public:
+   static constexpr uint32_t INVALID_ENTITY = NodeHandle::INVALID_INDEX;
+
+   explicit ComponentRegistry(Node* root);
+   ~ComponentRegistry() = default;
+
+   ComponentRegistry(const ComponentRegistry&) = delete;
+   ComponentRegistry& operator=(const ComponentRegistry&) = delete;
+   ComponentRegistry(ComponentRegistry&&) = delete;
+   ComponentRegistry& operator=(ComponentRegistry&&) = delete;
+
+   [[nodiscard]] NodeHandle CreateEntity(Node* const owner);
+   // Stale handles are ignored, so destroying after Clear() is harmless
+   void DestroyEntity(const NodeHandle handle);
+   // Invalidates every entity and empties every pool in one go
+   void Clear() noexcept;
+
+   [[nodiscard]] constexpr Node* Resolve(const NodeHandle handle) const noexcept {
+      const uint32_t index = handle.GetIndex();
+      if (index >= m_slots.size() || m_slots[index].generation != handle.GetGeneration())
+         return nullptr;
+      return m_slots[index].node;
+   }
+
+   void Insert(const uint32_t typeId, const uint32_t entity, Node* const owner,
+               Component* const component);
+   void Remove(const uint32_t typeId, const uint32_t entity) noexcept;
+
+   [[nodiscard]] const ComponentPool* GetPool(const uint32_t typeId) const noexcept {
+      return typeId < m_pools.size() ? m_pools[typeId].get() : nullptr;
+   }
+
+   template <ComponentType... Ts>
+   [[nodiscard]] ComponentView<Ts...> View() const noexcept {
+      return ComponentView<Ts...>({GetPool(GetComponentTypeId<Ts>())...});
+   }
+
+   [[nodiscard]] constexpr size_t GetEntityCount() const noexcept {
+      return m_slots.size() - m_freeEntities.size();
+   }
+
+   // Bumped whenever an entity or component comes or goes, or a node's active state flips
+   [[nodiscard]] constexpr uint64_t GetVersion() const noexcept { return m_version; }
+   constexpr void MarkChanged() noexcept { ++m_version; }
+
+  private:
+   struct EntitySlot final {
+      Node* node{nullptr};
+      uint32_t generation{0};
+   };
+
+   // Indexed by component type id, boxed so views stay valid when new types appear
+   std::vector<std::unique_ptr<ComponentPool>> m_pools;
+   std::vector<EntitySlot> m_slots;
+   std::vector<uint32_t> m_freeEntities;
+   uint64_t m_version{0};
+};
@@ -0,0 +1,234 @@
+#include "core/scene/LightClusterer.hpp"
+
+#include "core/ThreadPool.hpp"
+#include "core/scene/RenderWorld.hpp"
+#include "core/scene/components/LightComponent.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Directional and unbounded lights reach every pixel, so they are never binned
+[[nodiscard]] bool IsGlobalLight(const LightProxy& light) noexcept {
+   return light.lightType == static_cast<uint32_t>(LightComponent::LightType::Directional) ||
+          light.range == RenderWorld::UNBOUNDED_RANGE;
+}
+
+[[nodiscard]] glm::uvec2 TileOf(const glm::vec2& ndc) noexcept {
+   const glm::vec2 grid(LightClusterer::GRID_X, LightClusterer::GRID_Y);
+   const glm::vec2 tile = glm::clamp(glm::floor((ndc * 0.5f + 0.5f) * grid), glm::vec2(0.0f),
+                                     grid - 1.0f);
+   return glm::uvec2(tile);
+}
+
+} // namespace
+
+LightClusterer::LightClusterer(ThreadPool& threadPool) : LightClusterer(threadPool, Settings{}) {}
+
+LightClusterer::LightClusterer(ThreadPool& threadPool, const Settings& settings)
+    : m_settings(settings),
+      m_ownedThreadPool(settings.threadCount > 0
+                           ? std::make_unique<ThreadPool>(settings.threadCount)
+                           : nullptr),
+      m_threadPool(m_ownedThreadPool ? *m_ownedThreadPool : threadPool) {
+   m_header.gridSize = glm::uvec4(GRID_X, GRID_Y, GRID_Z, 0);
+   m_clusters.assign(CLUSTER_COUNT, glm::uvec2(0));
+   m_sliceIndices.resize(GRID_Z);
+   m_sliceCandidates.resize(GRID_Z);
+}
+
+LightClusterer::~LightClusterer() = default;
+
+void LightClusterer::Build(std::span<const LightProxy> lights, const glm::mat4& view,
+                           const glm::mat4& projection, const float near, const float far) {
+   const auto start = std::chrono::high_resolution_clock::now();
+   m_stats = LightClusterStats{};
+   FillLights(lights, true);
+   UpdateClusterBounds(projection, near, far);
+   // Bound every clustered light in view space, in the order FillLights() placed them
+   m_boundedLights.clear();
+   uint32_t lightIndex = m_header.gridSize.w;
+   for (const LightProxy& light : lights) {
+      if (IsGlobalLight(light))
+         continue;
+      BoundedLight bounded{.center = glm::vec3(view * glm::vec4(light.position, 1.0f)),
+                           .radius = light.range,
+                           .index = lightIndex++,
+                           .minTile = glm::uvec2(0),
+                           .maxTile = glm::uvec2(GRID_X - 1, GRID_Y - 1),
+                           .minSlice = 0,
+                           .maxSlice = 0};
+      const float depth = -bounded.center.z;
+      if (depth + bounded.radius < near || depth - bounded.radius > far)
+         continue;
+      bounded.minSlice = SliceOf(std::max(depth - bounded.radius, near));
+      bounded.maxSlice = SliceOf(std::min(depth + bounded.radius, far));
+      // A sphere crossing the near plane may cover the whole screen, otherwise its view space
+      // box is in front of the camera and the box's projected corners bound it on screen
+      if (depth - bounded.radius > near) {
+         glm::vec2 ndcMin(std::numeric_limits<float>::max());
+         glm::vec2 ndcMax(std::numeric_limits<float>::lowest());
+         for (uint32_t corner = 0; corner < 8; ++corner) {
+            const glm::vec3 sign((corner & 1) ? 1.0f : -1.0f, (corner & 2) ? 1.0f : -1.0f,
+                                 (corner & 4) ? 1.0f : -1.0f);
+            const glm::vec4 clip =
+               projection * glm::vec4(bounded.center + sign * bounded.radius, 1.0f);
+            const glm::vec2 ndc = glm::vec2(clip) / clip.w;
+            ndcMin = glm::min(ndcMin, ndc);
+            ndcMax = glm::max(ndcMax, ndc);
+         }
+         if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+            continue;
+         bounded.minTile = TileOf(ndcMin);
+         bounded.maxTile = TileOf(ndcMax);
+      }
+      m_boundedLights.push_back(bounded);
+   }
+   // Slices are independent, each worker writes its own index list
+   if (m_boundedLights.size() >= m_settings.parallelThreshold) {
+      ThreadPool::TaskGroup group;
+      for (uint32_t slice = 0; slice < GRID_Z; ++slice)
+         m_threadPool.Submit(group, [this, slice]() { BinSlice(slice); });
+      m_threadPool.Wait(group);
+   } else {
+      for (uint32_t slice = 0; slice < GRID_Z; ++slice)
+         BinSlice(slice);
+   }
+   // Concatenate the slices, their cluster offsets were relative to the slice's own list
+   m_lightIndices.clear();
+   constexpr uint32_t SLICE_CLUSTERS = GRID_X * GRID_Y;
+   for (uint32_t slice = 0; slice < GRID_Z; ++slice) {
+      const uint32_t base = static_cast<uint32_t>(m_lightIndices.size());
+      for (uint32_t i = slice * SLICE_CLUSTERS; i < (slice + 1) * SLICE_CLUSTERS; ++i) {
+         m_clusters[i].x += base;
+         m_stats.maxClusterLights = std::max(m_stats.maxClusterLights, m_clusters[i].y);
+      }
+      m_lightIndices.insert(m_lightIndices.end(), m_sliceIndices[slice].begin(),
+                            m_sliceIndices[slice].end());
+   }
+   m_stats.clusteredLights = static_cast<uint32_t>(m_boundedLights.size());
+   m_stats.globalLights = m_header.gridSize.w;
+   m_stats.lightIndices = static_cast<uint32_t>(m_lightIndices.size());
+   const auto end = std::chrono::high_resolution_clock::now();
+   m_stats.buildMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void LightClusterer::BuildUnclustered(std::span<const LightProxy> lights) {
+   m_stats = LightClusterStats{};
+   FillLights(lights, false);
+   // Slice 0 everywhere, every cluster is empty. The next Build() recomputes the slicing.
+   m_header.depthSlicing = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+   m_boundsNear = 0.0f;
+   std::ranges::fill(m_clusters, glm::uvec2(0));
+   m_lightIndices.clear();
+   m_stats.globalLights = m_header.gridSize.w;
+}
+
+void LightClusterer::FillLights(std::span<const LightProxy> lights, const bool clustered) {
+   m_lights.clear();
+   m_lights.reserve(lights.size());
+   const auto append = [this](const LightProxy& light) {
+      m_lights.push_back(GPULight{.lightType = light.lightType,
+                                  .position = light.position,
+                                  .direction = light.direction,
+                                  .color = light.color,
+                                  .intensity = light.intensity,
+                                  .constant = light.constant,
+                                  .linear = light.linear,
+                                  .quadratic = light.quadratic,
+                                  .innerCone = light.innerCone,
+                                  .outerCone = light.outerCone});
+   };
+   for (const LightProxy& light : lights) {
+      if (!clustered || IsGlobalLight(light))
+         append(light);
+   }
+   m_header.gridSize.w = static_cast<uint32_t>(m_lights.size());
+   if (!clustered)
+      return;
+   for (const LightProxy& light : lights) {
+      if (!IsGlobalLight(light))
+         append(light);
+   }
+}
+
+void LightClusterer::UpdateClusterBounds(const glm::mat4& projection, const float near,
+                                         const float far) {
+   if (projection == m_boundsProjection && near == m_boundsNear && far == m_boundsFar)
+      return;
+   m_boundsProjection = projection;
+   m_boundsNear = near;
+   m_boundsFar = far;
+   const float logRatio = std::log(far / near);
+   m_header.depthSlicing = glm::vec4(near, far, GRID_Z / logRatio,
+                                     -static_cast<float>(GRID_Z) * std::log(near) / logRatio);
+   // View space rays through the tile corners, scaled to unit depth. Depth 1 is the far plane
+   // in both APIs' clip spaces.
+   const glm::mat4 inverseProjection = glm::inverse(projection);
+   std::vector<glm::vec3> cornerRays((GRID_X + 1) * (GRID_Y + 1));
+   for (uint32_t y = 0; y <= GRID_Y; ++y) {
+      for (uint32_t x = 0; x <= GRID_X; ++x) {
+         const glm::vec2 ndc = glm::vec2(x, y) / glm::vec2(GRID_X, GRID_Y) * 2.0f - 1.0f;
+         const glm::vec4 point = inverseProjection * glm::vec4(ndc, 1.0f, 1.0f);
+         const glm::vec3 viewPoint = glm::vec3(point) / point.w;
+         cornerRays[y * (GRID_X + 1) + x] = viewPoint / -viewPoint.z;
+      }
+   }
+   m_clusterBounds.resize(CLUSTER_COUNT);
+   for (uint32_t slice = 0; slice < GRID_Z; ++slice) {
+      const float sliceNear = near * std::pow(far / near, static_cast<float>(slice) / GRID_Z);
+      const float sliceFar = near * std::pow(far / near, static_cast<float>(slice + 1) / GRID_Z);
+      for (uint32_t y = 0; y < GRID_Y; ++y) {
+         for (uint32_t x = 0; x < GRID_X; ++x) {
+            ClusterBounds bounds{.min = glm::vec3(std::numeric_limits<float>::max()),
+                                 .max = glm::vec3(std::numeric_limits<float>::lowest())};
+            for (uint32_t corner = 0; corner < 4; ++corner) {
+               const glm::vec3& ray =
+                  cornerRays[(y + (corner >> 1)) * (GRID_X + 1) + x + (corner & 1)];
+               bounds.min = glm::min(bounds.min, glm::min(ray * sliceNear, ray * sliceFar));
+               bounds.max = glm::max(bounds.max, glm::max(ray * sliceNear, ray * sliceFar));
+            }
+            m_clusterBounds[x + GRID_X * (y + GRID_Y * slice)] = bounds;
+         }
+      }
+   }
+}
+
+uint32_t LightClusterer::SliceOf(const float depth) const noexcept {
+   const float slice = std::log(depth) * m_header.depthSlicing.z + m_header.depthSlicing.w;
+   return static_cast<uint32_t>(std::clamp(slice, 0.0f, static_cast<float>(GRID_Z - 1)));
+}
+
+void LightClusterer::BinSlice(const uint32_t slice) {
+   // Narrow the lights down to the ones reaching this slice before testing each cluster
+   std::vector<uint32_t>& candidates = m_sliceCandidates[slice];
+   candidates.clear();
+   for (uint32_t i = 0; i < m_boundedLights.size(); ++i) {
+      if (m_boundedLights[i].minSlice <= slice && slice <= m_boundedLights[i].maxSlice)
+         candidates.push_back(i);
+   }
+   std::vector<uint32_t>& indices = m_sliceIndices[slice];
+   indices.clear();
+   for (uint32_t y = 0; y < GRID_Y; ++y) {
+      for (uint32_t x = 0; x < GRID_X; ++x) {
+         const uint32_t cluster = x + GRID_X * (y + GRID_Y * slice);
+         const ClusterBounds& bounds = m_clusterBounds[cluster];
+         const uint32_t offset = static_cast<uint32_t>(indices.size());
+         for (const uint32_t candidate : candidates) {
+            const BoundedLight& light = m_boundedLights[candidate];
+            if (x < light.minTile.x || x > light.maxTile.x || y < light.minTile.y ||
+                y > light.maxTile.y)
+               continue;
+            const glm::vec3 offsetToBox =
+               glm::clamp(light.center, bounds.min, bounds.max) - light.center;
+            if (glm::dot(offsetToBox, offsetToBox) <= light.radius * light.radius)
+               indices.push_back(light.index);
+         }
+         m_clusters[cluster] =
+            glm::uvec2(offset, static_cast<uint32_t>(indices.size()) - offset);
+      }
+   }
+}
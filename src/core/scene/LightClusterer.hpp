@@ -0,0 +1,132 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+struct LightProxy;
+
+struct LightClusterStats final {
+   // Lights binned into clusters, the rest reach every pixel
+   uint32_t clusteredLights{0};
+   uint32_t globalLights{0};
+   // Entries in the light index list, summed over all clusters
+   uint32_t lightIndices{0};
+   uint32_t maxClusterLights{0};
+   float buildMs{0.0f};
+};
+
+// Clustered light culling. The view volume is split into screen tiles and exponential depth
+// slices, and every light with a finite range is binned into the clusters its bounding sphere
+// touches. The lighting shaders find their pixel's cluster and only evaluate the lights listed
+// for it, plus the global ones (directional or unbounded) that reach everything. Slices are
+// binned in parallel, and nothing limits the number of lights.
+class LightClusterer final {
+  public:
+   static constexpr uint32_t GRID_X = 16;
+   static constexpr uint32_t GRID_Y = 9;
+   static constexpr uint32_t GRID_Z = 24;
+   static constexpr uint32_t CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+   // Matches the lighting shaders' std430 LightData
+   struct GPULight final {
+      alignas(4) uint32_t lightType;
+      alignas(16) glm::vec3 position;
+      alignas(16) glm::vec3 direction;
+      alignas(16) glm::vec3 color;
+      alignas(4) float intensity;
+      alignas(4) float constant;
+      alignas(4) float linear;
+      alignas(4) float quadratic;
+      alignas(4) float innerCone;
+      alignas(4) float outerCone;
+   };
+
+   // Matches the start of the lighting shaders' ClusterData, the clusters follow it
+   struct GridHeader final {
+      // Cluster counts, w is the number of global lights at the front of the light list
+      glm::uvec4 gridSize;
+      // Near plane, far plane, then slice = log(depth) * scale + bias
+      glm::vec4 depthSlicing;
+   };
+
+   struct Settings final {
+      // Below this many clustered lights the slices are binned on the calling thread
+      uint32_t parallelThreshold{64};
+      // 0 shares the pool passed in, anything larger gets a pool of its own
+      uint32_t threadCount{0};
+   };
+
+   // threadPool must outlive the clusterer
+   explicit LightClusterer(ThreadPool& threadPool);
+   LightClusterer(ThreadPool& threadPool, const Settings& settings);
+   ~LightClusterer();
+
+   LightClusterer(const LightClusterer&) = delete;
+   LightClusterer& operator=(const LightClusterer&) = delete;
+   LightClusterer(LightClusterer&&) = delete;
+   LightClusterer& operator=(LightClusterer&&) = delete;
+
+   // Bins the lights for one view, near and far are the projection's planes
+   void Build(std::span<const LightProxy> lights, const glm::mat4& view,
+              const glm::mat4& projection, const float near, const float far);
+   // Without a view every light is global and the clusters stay empty
+   void BuildUnclustered(std::span<const LightProxy> lights);
+
+   // Global lights first, the light indices refer to this list
+   [[nodiscard]] std::span<const GPULight> GetLights() const noexcept { return m_lights; }
+   [[nodiscard]] constexpr const GridHeader& GetHeader() const noexcept { return m_header; }
+   // Offset into the light indices and count, per cluster in x, y, then slice order
+   [[nodiscard]] std::span<const glm::uvec2> GetClusters() const noexcept { return m_clusters; }
+   [[nodiscard]] std::span<const uint32_t> GetLightIndices() const noexcept {
+      return m_lightIndices;
+   }
+   [[nodiscard]] constexpr const LightClusterStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   // A clustered light in view space, with the tiles and slices its sphere may touch
+   struct BoundedLight final {
+      glm::vec3 center;
+      float radius;
+      uint32_t index;
+      glm::uvec2 minTile;
+      glm::uvec2 maxTile;
+      uint32_t minSlice;
+      uint32_t maxSlice;
+   };
+
+   // View space bounds of one cluster
+   struct ClusterBounds final {
+      glm::vec3 min;
+      glm::vec3 max;
+   };
+
+   // Global lights first, every light is global if clustered is false
+   void FillLights(std::span<const LightProxy> lights, const bool clustered);
+   void UpdateClusterBounds(const glm::mat4& projection, const float near, const float far);
+   [[nodiscard]] uint32_t SliceOf(const float depth) const noexcept;
+   void BinSlice(const uint32_t slice);
+
+  private:
+   Settings m_settings;
+   GridHeader m_header{};
+   std::vector<GPULight> m_lights;
+   std::vector<glm::uvec2> m_clusters;
+   std::vector<uint32_t> m_lightIndices;
+   std::vector<BoundedLight> m_boundedLights;
+   // Per slice, filled by the workers and concatenated afterwards
+   std::vector<std::vector<uint32_t>> m_sliceIndices;
+   std::vector<std::vector<uint32_t>> m_sliceCandidates;
+   // Only change with the projection
+   std::vector<ClusterBounds> m_clusterBounds;
+   glm::mat4 m_boundsProjection{0.0f};
+   float m_boundsNear{0.0f};
+   float m_boundsFar{0.0f};
+   LightClusterStats m_stats{};
+   std::unique_ptr<ThreadPool> m_ownedThreadPool;
+   ThreadPool& m_threadPool;
+};
@@ -42,7 +42,17 @@ Node* MeshLoaderHelper::LoadSceneAsChildNode(Scene& scene, Node* parent,
    }
    // Load the scene data
    const MeshLoader::SceneData sceneData = resourceManager.LoadSceneData(filepath);
-   if (sceneData.IsEmpty()) {
+   return InstantiateSceneData(scene, parent, resourceManager, sceneName, sceneData, options,
+                               materials);
+}
+
+Node* MeshLoaderHelper::InstantiateSceneData(Scene& scene, Node* parent,
+                                             ResourceManager& resourceManager,
+                                             const std::string& sceneName,
+                                             const MeshLoader::SceneData& sceneData,
+                                             const MeshLoadOptions& options,
+                                             const std::vector<MaterialHandle>& materials) {
+   if (!parent || sceneData.IsEmpty()) {
       return nullptr;
    }
    // Create a child node to group the scene
@@ -110,11 +120,12 @@ Node* MeshLoaderHelper::CreateSceneHierarchy(Scene& scene, Node* parentNode,
             continue;
          }
          // Create unique mesh name
-         const std::string meshName =
-            GenerateUniqueMeshName(sceneNode.name + "_" + meshData.name, meshIndex);
+         const std::string meshName = GenerateUniqueMeshName(
+            options.meshPrefix + sceneNode.name + "_" + meshData.name, meshIndex);
          // Create the mesh resource
          const MeshHandle meshHandle =
-            resourceManager.LoadMesh(meshName, meshData.vertices, meshData.indices);
+            resourceManager.LoadMesh(meshName, meshData.vertices, meshData.indices,
+                                     meshData.bounds);
          if (!meshHandle.IsValid()) {
             continue;
          }
@@ -11,6 +11,8 @@ class MeshLoaderHelper final {
   public:
    struct MeshLoadOptions final {
       std::string nodePrefix{""};
+      // Keeps mesh resource names unique when one file is instantiated more than once
+      std::string meshPrefix{""};
       bool preserveHierarchy{true};
       bool applyTransforms{true};
    };
@@ -27,6 +29,13 @@ class MeshLoaderHelper final {
                                      const MeshLoadOptions& options,
                                      const std::vector<MaterialHandle>& materials = {});
 
+   // Instantiate scene data that was already loaded, e.g. parsed on a worker thread
+   static Node* InstantiateSceneData(Scene& scene, Node* parent, ResourceManager& resourceManager,
+                                     const std::string& sceneName,
+                                     const MeshLoader::SceneData& sceneData,
+                                     const MeshLoadOptions& options,
+                                     const std::vector<MaterialHandle>& materials = {});
+
    // Load as single combined mesh
    static Node* LoadMeshIntoScene(Scene& scene, ResourceManager& resourceManager,
                                   const std::string& meshName, const std::string& filepath,
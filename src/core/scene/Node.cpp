@@ -1,75 +1,118 @@
 #include "core/scene/Node.hpp"
 
+#include "core/scene/ComponentRegistry.hpp"
+#include "core/scene/NodeAllocator.hpp"
+#include "core/scene/TransformHierarchy.hpp"
 #include "core/scene/components/Component.hpp"
 
 #include <algorithm>
+#include <utility>
 
 Node::Node(const std::string name)
     : m_name(std::move(name)),
       m_active(true),
       m_parent(nullptr),
+      m_firstChild(nullptr),
+      m_lastChild(nullptr),
+      m_prevSibling(nullptr),
+      m_nextSibling(nullptr),
+      m_childCount(0),
+      m_registry(nullptr),
       m_localTransform(nullptr),
+      m_hierarchy(nullptr),
+      m_hierarchyIndex(TransformHierarchy::INVALID_INDEX),
+      m_detachedWorldMatrix(1.0f),
       m_worldTransform(nullptr),
-      m_worldTransformDirty(true) {}
+      m_worldTransformGeneration(0) {}
 
 Node::~Node() {
    RemoveAllChildren();
    if (m_parent) {
-      m_parent->RemoveChild(this);
+      m_parent->UnlinkChild(this);
+      m_parent->InvalidateHierarchy();
    }
+   SetRegistry(nullptr);
+}
+
+void* Node::operator new(const size_t size) { return NodeAllocator::Allocate(size); }
+
+void Node::operator delete(void* const ptr, const size_t size) noexcept {
+   NodeAllocator::Deallocate(ptr, size);
 }
 
 void Node::AddChild(std::unique_ptr<Node> child) {
    if (!child)
       return;
-   // Remove from previous parent if any
-   if (child->m_parent) {
-      child->m_parent->RemoveChild(child.get());
+   // Unlink from the previous parent if any, the node itself moves over
+   if (Node* const oldParent = child->m_parent) {
+      oldParent->UnlinkChild(child.get());
+      oldParent->InvalidateHierarchy();
    }
    child->SetParent(this);
-   m_children.emplace_back(std::move(child));
+   child->SetHierarchy(m_hierarchy);
+   child->SetRegistry(m_registry);
+   Node* const node = child.release();
+   node->m_prevSibling = m_lastChild;
+   if (m_lastChild) {
+      m_lastChild->m_nextSibling = node;
+   } else {
+      m_firstChild = node;
+   }
+   m_lastChild = node;
+   ++m_childCount;
+   InvalidateHierarchy();
 }
 
 bool Node::RemoveChild(const Node* const child) {
-   if (!child)
+   if (!child || child->m_parent != this)
       return false;
-   const auto it =
-      std::ranges::find_if(m_children, [child](const auto& ptr) { return ptr.get() == child; });
-   if (it != m_children.end()) {
-      (*it)->SetParent(nullptr);
-      m_children.erase(it);
-      return true;
-   }
-   return false;
+   Node* const removed = const_cast<Node*>(child);
+   UnlinkChild(removed);
+   removed->SetParent(nullptr);
+   removed->SetHierarchy(nullptr);
+   removed->SetRegistry(nullptr);
+   delete removed;
+   InvalidateHierarchy();
+   return true;
 }
 
 void Node::RemoveAllChildren() {
-   for (const auto& child : m_children) {
-      if (child) {
-         child->SetParent(nullptr);
-      }
+   Node* child = m_firstChild;
+   while (child) {
+      Node* const next = child->m_nextSibling;
+      child->m_prevSibling = nullptr;
+      child->m_nextSibling = nullptr;
+      child->SetParent(nullptr);
+      child->SetHierarchy(nullptr);
+      child->SetRegistry(nullptr);
+      delete child;
+      child = next;
    }
-   m_children.clear();
+   m_firstChild = nullptr;
+   m_lastChild = nullptr;
+   m_childCount = 0;
+   InvalidateHierarchy();
 }
 
 std::vector<Node*> Node::GetChildrenRaw() const {
    std::vector<Node*> result;
-   result.reserve(m_children.size());
-   std::ranges::transform(m_children, std::back_inserter(result),
-                          [](const auto& child) { return child.get(); });
+   result.reserve(m_childCount);
+   for (Node* child = m_firstChild; child; child = child->m_nextSibling) {
+      result.push_back(child);
+   }
    return result;
 }
 
 Node* Node::FindChild(const std::string_view name, const bool recursive) const {
    // Check direct children first
-   for (const auto& child : m_children) {
+   for (Node* child = m_firstChild; child; child = child->m_nextSibling) {
       if (child->GetName() == name) {
-         return child.get();
+         return child;
       }
    }
    // Recursive search
    if (recursive) {
-      for (const auto& child : m_children) {
+      for (const Node* child = m_firstChild; child; child = child->m_nextSibling) {
          if (Node* const found = child->FindChild(name, true)) {
             return found;
          }
@@ -79,7 +122,13 @@ Node* Node::FindChild(const std::string_view name, const bool recursive) const {
 }
 
 Node* Node::FindChildByIndex(const size_t index) const noexcept {
-   return index < m_children.size() ? m_children[index].get() : nullptr;
+   if (index >= m_childCount)
+      return nullptr;
+   Node* child = m_firstChild;
+   for (size_t i = 0; i < index; ++i) {
+      child = child->m_nextSibling;
+   }
+   return child;
 }
 
 size_t Node::GetDepth() const noexcept {
@@ -109,20 +158,22 @@ const Node* Node::GetRoot() const noexcept {
 }
 
 void Node::ForEachChild(const std::function<void(Node*)>& func, const bool recursive) {
-   for (const auto& child : m_children) {
-      func(child.get());
+   for (Node* child = m_firstChild; child;) {
+      // Read ahead, func may remove the child
+      Node* const next = child->m_nextSibling;
+      func(child);
       if (recursive) {
          child->ForEachChild(func, true);
       }
+      child = next;
    }
 }
 
 void Node::ForEachChild(const std::function<void(const Node*)>& func, const bool recursive) const {
-   for (const auto& child : m_children) {
-      func(child.get());
+   for (const Node* child = m_firstChild; child; child = child->m_nextSibling) {
+      func(child);
       if (recursive) {
-         const Node* constChild = child.get();
-         constChild->ForEachChild(func, true);
+         child->ForEachChild(func, true);
       }
    }
 }
@@ -132,17 +183,19 @@ bool Node::RemoveComponent(const Component* const component) {
       return false;
    const auto it = std::ranges::find_if(
       m_components, [component](const auto& ptr) { return ptr.get() == component; });
-   if (it != m_components.end()) {
-      // Clear transform cache if removing transform component
-      if (m_localTransform && dynamic_cast<const TransformComponent*>(it->get())) {
-         m_localTransform = nullptr;
-         MarkTransformDirty();
-      }
-      m_components.erase(it);
-      UpdateComponentLookup();
-      return true;
+   if (it == m_components.end())
+      return false;
+   const auto typeIt = m_componentTypes.begin() + (it - m_components.begin());
+   const uint32_t typeId = *typeIt;
+   // Clear transform cache if removing transform component
+   if (m_localTransform && typeId == GetComponentTypeId<TransformComponent>()) {
+      m_localTransform = nullptr;
+      InvalidateHierarchy();
    }
-   return false;
+   m_components.erase(it);
+   m_componentTypes.erase(typeIt);
+   RefreshComponentLookup(typeId);
+   return true;
 }
 
 Transform* Node::GetTransform() const {
@@ -154,80 +207,184 @@ Transform* Node::GetTransform() const {
    return m_localTransform;
 }
 
-Transform* Node::GetWorldTransform() const {
-   if (m_worldTransformDirty) {
-      const_cast<Node*>(this)->UpdateWorldTransform();
+const glm::mat4& Node::GetWorldMatrix() const {
+   if (m_hierarchy) [[likely]] {
+      m_hierarchy->Refresh();
+      return m_hierarchy->GetWorldMatrix(m_hierarchyIndex);
    }
-   return m_worldTransform.get();
+   // Nodes outside of a scene resolve their parent chain on the fly
+   const Transform* const localTransform = GetTransform();
+   const glm::mat4 localMatrix =
+      localTransform ? localTransform->GetTransformMatrix() : glm::mat4(1.0f);
+   m_detachedWorldMatrix = m_parent ? m_parent->GetWorldMatrix() * localMatrix : localMatrix;
+   return m_detachedWorldMatrix;
 }
 
-void Node::UpdateWorldTransform(const bool force) {
-   if (!m_worldTransformDirty && !force)
-      return;
-   const Transform* const localTransform = GetTransform();
-   if (!localTransform) {
-      m_worldTransformDirty = false;
-      return;
-   }
+Transform* Node::GetWorldTransform() const {
+   if (!GetTransform())
+      return nullptr;
+   const glm::mat4& worldMatrix = GetWorldMatrix();
+   const uint64_t generation =
+      m_hierarchy ? m_hierarchy->GetWorldGeneration(m_hierarchyIndex) : 0;
    if (!m_worldTransform) {
-      m_worldTransform = std::make_unique<Transform>();
+      m_worldTransform = std::make_unique<Transform>(worldMatrix);
+   } else if (!m_hierarchy || m_worldTransformGeneration != generation) {
+      *m_worldTransform = Transform(worldMatrix);
    }
-   if (m_parent) {
-      if (const Transform* const parentWorldTransform = m_parent->GetWorldTransform()) {
-         // Combine parent world transform with local transform
-         const auto parentMatrix = parentWorldTransform->GetTransformMatrix();
-         const auto localMatrix = localTransform->GetTransformMatrix();
-         const auto worldMatrix = parentMatrix * localMatrix;
-         *m_worldTransform = Transform(worldMatrix);
-      } else {
-         *m_worldTransform = *localTransform;
-      }
-   } else {
-      *m_worldTransform = *localTransform;
-   }
-   m_worldTransformDirty = false;
-   UpdateChildrenWorldTransforms();
+   m_worldTransformGeneration = generation;
+   return m_worldTransform.get();
 }
 
-void Node::MarkTransformDirty() { InvalidateWorldTransform(); }
+void Node::MarkTransformDirty() {
+   if (m_hierarchy) {
+      m_hierarchy->MarkDirty(m_hierarchyIndex);
+   }
+}
 
-void Node::SetName(const std::string name) { m_name = std::move(name); }
+void Node::SetName(const std::string name) {
+   m_name = std::move(name);
+}
 
 void Node::SetActive(const bool active) noexcept {
    if (m_active != active) {
       m_active = active;
+      if (m_registry) {
+         m_registry->MarkChanged();
+      }
    }
 }
 
 void Node::SetParent(Node* const parent) {
    if (m_parent != parent) {
       m_parent = parent;
-      MarkTransformDirty();
+      InvalidateHierarchy();
    }
 }
 
-void Node::UpdateComponentLookup() {
-   m_componentLookup.clear();
-   for (const auto& component : m_components) {
-      const std::type_index typeIndex(typeid(*component));
-      m_componentLookup[typeIndex] = component.get();
+void Node::SetHierarchy(TransformHierarchy* const hierarchy) noexcept {
+   if (m_hierarchy == hierarchy)
+      return;
+   m_hierarchy = hierarchy;
+   m_hierarchyIndex = TransformHierarchy::INVALID_INDEX;
+   if (Transform* const localTransform = GetTransform(); !hierarchy && localTransform) {
+      localTransform->SetListener(nullptr, 0);
+   }
+   for (Node* child = m_firstChild; child; child = child->m_nextSibling) {
+      child->SetHierarchy(hierarchy);
    }
 }
 
-void Node::InvalidateWorldTransform() {
-   if (m_worldTransformDirty)
+void Node::SetRegistry(ComponentRegistry* const registry) {
+   if (m_registry == registry)
       return;
-   m_worldTransformDirty = true;
-   // Propagate to children
-   for (const auto& child : m_children) {
-      child->InvalidateWorldTransform();
+   if (m_registry) {
+      for (uint32_t typeId = 0; typeId < m_componentLookup.size(); ++typeId) {
+         if (m_componentLookup[typeId]) {
+            m_registry->Remove(typeId, m_handle.GetIndex());
+         }
+      }
+      m_registry->DestroyEntity(m_handle);
+      m_handle = NodeHandle();
+   }
+   m_registry = registry;
+   if (m_registry) {
+      m_handle = m_registry->CreateEntity(this);
+      for (uint32_t typeId = 0; typeId < m_componentLookup.size(); ++typeId) {
+         if (Component* const component = m_componentLookup[typeId]) {
+            m_registry->Insert(typeId, m_handle.GetIndex(), this, component);
+         }
+      }
+   }
+   for (Node* child = m_firstChild; child; child = child->m_nextSibling) {
+      child->SetRegistry(registry);
    }
 }
 
-void Node::UpdateChildrenWorldTransforms() {
-   for (const auto& child : m_children) {
-      if (child->m_worldTransformDirty) {
-         child->UpdateWorldTransform();
+void Node::AttachComponent(const uint32_t typeId, std::unique_ptr<Component> component) {
+   Component* const ptr = component.get();
+   m_components.emplace_back(std::move(component));
+   m_componentTypes.push_back(typeId);
+   if (typeId >= m_componentLookup.size()) {
+      m_componentLookup.resize(typeId + 1, nullptr);
+   }
+   m_componentLookup[typeId] = ptr;
+   if (m_registry) {
+      m_registry->Insert(typeId, m_handle.GetIndex(), this, ptr);
+   }
+}
+
+void Node::RefreshComponentLookup(const uint32_t typeId) {
+   Component* newest = nullptr;
+   for (size_t i = m_components.size(); i-- > 0;) {
+      if (m_componentTypes[i] == typeId) {
+         newest = m_components[i].get();
+         break;
       }
    }
+   m_componentLookup[typeId] = newest;
+   if (m_registry) {
+      if (newest) {
+         m_registry->Insert(typeId, m_handle.GetIndex(), this, newest);
+      } else {
+         m_registry->Remove(typeId, m_handle.GetIndex());
+      }
+   }
+}
+
+void Node::InvalidateHierarchy() noexcept {
+   if (m_hierarchy) {
+      m_hierarchy->MarkStructureDirty();
+   }
+}
+
+void Node::UnlinkChild(Node* const child) noexcept {
+   if (child->m_prevSibling) {
+      child->m_prevSibling->m_nextSibling = child->m_nextSibling;
+   } else {
+      m_firstChild = child->m_nextSibling;
+   }
+   if (child->m_nextSibling) {
+      child->m_nextSibling->m_prevSibling = child->m_prevSibling;
+   } else {
+      m_lastChild = child->m_prevSibling;
+   }
+   child->m_prevSibling = nullptr;
+   child->m_nextSibling = nullptr;
+   --m_childCount;
+}
+
+void Node::ResetChildren() {
+   // Frees the subtree leaves first in one pass over the links. Every node is unhooked before it
+   // is destroyed, so its destructor neither unregisters nor unlinks anything and only frees its
+   // own name and components
+   Node* node = m_firstChild;
+   while (node) {
+      if (node->m_firstChild) {
+         node = node->m_firstChild;
+         continue;
+      }
+      // Always the first remaining child of its parent
+      Node* const parent = node->m_parent;
+      Node* const next = node->m_nextSibling;
+      node->m_parent = nullptr;
+      node->m_nextSibling = nullptr;
+      node->m_registry = nullptr;
+      node->m_hierarchy = nullptr;
+      node->m_handle = NodeHandle();
+      delete node;
+      parent->m_firstChild = next;
+      if (next) {
+         next->m_prevSibling = nullptr;
+         node = next;
+      } else {
+         parent->m_lastChild = nullptr;
+         parent->m_childCount = 0;
+         node = parent != this ? parent : nullptr;
+      }
+   }
+   InvalidateHierarchy();
+   if (ComponentRegistry* const registry = std::exchange(m_registry, nullptr)) {
+      m_handle = NodeHandle();
+      SetRegistry(registry);
+   }
 }
@@ -1,14 +1,17 @@
 #pragma once
 
+#include "core/scene/NodeHandle.hpp"
 #include "core/scene/components/TransformComponent.hpp"
 
 #include <functional>
-#include <typeindex>
 #include <memory>
-#include <ranges>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 class Transform;
+class TransformHierarchy;
+class ComponentRegistry;
 class Component;
 
 class Node final {
@@ -18,25 +21,31 @@ class Node final {
 
    Node(const Node&) = delete;
    Node& operator=(const Node&) = delete;
-   Node(Node&&) = default;
-   Node& operator=(Node&&) = default;
+   // Children and siblings point back at a node, so it stays where it was allocated
+   Node(Node&&) = delete;
+   Node& operator=(Node&&) = delete;
+
+   // Nodes come from a pooled block allocator
+   [[nodiscard]] static void* operator new(const size_t size);
+   static void operator delete(void* ptr, const size_t size) noexcept;
 
    // Hierarchy management
    void AddChild(std::unique_ptr<Node> child);
    [[nodiscard]] bool RemoveChild(const Node* child);
    void RemoveAllChildren();
 
-   // Parent-child relationships
+   // Parent-child relationships, children are iterated from the first child along the siblings
    [[nodiscard]] constexpr Node* GetParent() const noexcept { return m_parent; }
-   [[nodiscard]] constexpr const std::vector<std::unique_ptr<Node>>& GetChildren() const noexcept {
-      return m_children;
-   }
+   [[nodiscard]] constexpr Node* GetFirstChild() const noexcept { return m_firstChild; }
+   [[nodiscard]] constexpr Node* GetNextSibling() const noexcept { return m_nextSibling; }
+   [[nodiscard]] constexpr Node* GetPrevSibling() const noexcept { return m_prevSibling; }
    [[nodiscard]] std::vector<Node*> GetChildrenRaw() const;
 
    // Tree traversal
    [[nodiscard]] Node* FindChild(const std::string_view name, const bool recursive = false) const;
+   // Walks the sibling list, O(index)
    [[nodiscard]] Node* FindChildByIndex(const size_t index) const noexcept;
-   [[nodiscard]] constexpr size_t GetChildCount() const noexcept { return m_children.size(); }
+   [[nodiscard]] constexpr size_t GetChildCount() const noexcept { return m_childCount; }
    [[nodiscard]] size_t GetDepth() const noexcept;
 
    // Hierarchy queries
@@ -47,18 +56,28 @@ class Node final {
    void ForEachChild(const std::function<void(Node*)>& func, const bool recursive = false);
    void ForEachChild(const std::function<void(const Node*)>& func,
                      const bool recursive = false) const;
+   // Pre-order depth-first walk over this node and its subtree. Steps along the sibling links
+   // instead of keeping a stack, so it never allocates. If func returns
+   // bool, false skips that node's children; skipInactive prunes inactive subtrees entirely.
+   template <typename Func>
+   void Traverse(Func&& func, const bool skipInactive = false) {
+      TraverseImpl(this, func, skipInactive);
+   }
+   template <typename Func>
+   void Traverse(Func&& func, const bool skipInactive = false) const {
+      TraverseImpl(this, func, skipInactive);
+   }
 
    // Component management
    template <ComponentType T, typename... Args>
    [[nodiscard]] T* AddComponent(Args&&... args) {
       auto component = std::make_unique<T>(std::forward<Args>(args)...);
       T* const ptr = component.get();
-      m_components.emplace_back(std::move(component));
-      UpdateComponentLookup();
+      AttachComponent(GetComponentTypeId<T>(), std::move(component));
       // Cache transform component for quick access
       if constexpr (std::same_as<T, TransformComponent>) {
          m_localTransform = &ptr->GetMutableTransform();
-         MarkTransformDirty();
+         InvalidateHierarchy();
       }
       return ptr;
    }
@@ -67,22 +86,20 @@ class Node final {
 
    template <ComponentType T>
    [[nodiscard]] T* GetComponent() const noexcept {
-      const std::type_index typeIndex(typeid(T));
-      if (const auto it = m_componentLookup.find(typeIndex); it != m_componentLookup.end()) {
-         return static_cast<T*>(it->second);
-      }
-      return nullptr;
+      const uint32_t typeId = GetComponentTypeId<T>();
+      return typeId < m_componentLookup.size() ? static_cast<T*>(m_componentLookup[typeId])
+                                               : nullptr;
    }
 
    template <ComponentType T>
    [[nodiscard]] std::vector<T*> GetComponents() const {
       std::vector<T*> result;
-      const auto componentView =
-         m_components | std::ranges::views::transform([](const auto& comp) { return comp.get(); }) |
-         std::ranges::views::filter(
-            [](const Component* const comp) { return dynamic_cast<const T*>(comp) != nullptr; }) |
-         std::ranges::views::transform([](Component* const comp) { return static_cast<T*>(comp); });
-      std::ranges::copy(componentView, std::back_inserter(result));
+      const uint32_t typeId = GetComponentTypeId<T>();
+      for (size_t i = 0; i < m_components.size(); ++i) {
+         if (m_componentTypes[i] == typeId) {
+            result.push_back(static_cast<T*>(m_components[i].get()));
+         }
+      }
       return result;
    }
 
@@ -93,22 +110,63 @@ class Node final {
 
    // Transform access
    [[nodiscard]] Transform* GetTransform() const;
+   [[nodiscard]] const glm::mat4& GetWorldMatrix() const;
+   // Decomposed world transform, only rebuilt when the world matrix changed
    [[nodiscard]] Transform* GetWorldTransform() const;
-   void UpdateWorldTransform(const bool force = false);
    void MarkTransformDirty();
+   // Slot in the scene's TransformHierarchy, valid until its layout changes
+   [[nodiscard]] constexpr uint32_t GetHierarchyIndex() const noexcept { return m_hierarchyIndex; }
 
    // Utility
    [[nodiscard]] constexpr const std::string& GetName() const noexcept { return m_name; }
    void SetName(const std::string name);
 
+   // Valid while the node is attached to a scene
+   [[nodiscard]] constexpr NodeHandle GetHandle() const noexcept { return m_handle; }
+
    [[nodiscard]] constexpr bool IsActive() const noexcept { return m_active; }
    void SetActive(const bool active) noexcept;
 
   private:
+   friend class TransformHierarchy;
+   friend class ComponentRegistry;
+   friend class Scene;
+
    void SetParent(Node* parent);
-   void UpdateComponentLookup();
-   void InvalidateWorldTransform();
-   void UpdateChildrenWorldTransforms();
+   void SetHierarchy(TransformHierarchy* hierarchy) noexcept;
+   void SetRegistry(ComponentRegistry* registry);
+   void AttachComponent(const uint32_t typeId, std::unique_ptr<Component> component);
+   // Point the lookup (and the registry pool) at the newest remaining component of a type
+   void RefreshComponentLookup(const uint32_t typeId);
+   void InvalidateHierarchy() noexcept;
+   // Takes child out of the sibling list without destroying it
+   void UnlinkChild(Node* child) noexcept;
+   // Drops all children once the registry was cleared wholesale, then re-registers this node
+   void ResetChildren();
+
+   template <typename NodeT, typename Func>
+   static void TraverseImpl(NodeT* const root, Func& func, const bool skipInactive) {
+      NodeT* node = root;
+      while (node) {
+         bool descend = !skipInactive || node->m_active;
+         if (descend) {
+            if constexpr (std::is_convertible_v<std::invoke_result_t<Func&, NodeT*>, bool>) {
+               descend = func(node);
+            } else {
+               func(node);
+            }
+         }
+         if (descend && node->m_firstChild) {
+            node = node->m_firstChild;
+            continue;
+         }
+         // Climb until a node below the root has a next sibling
+         while (node != root && !node->m_nextSibling) {
+            node = node->m_parent;
+         }
+         node = node != root ? node->m_nextSibling : nullptr;
+      }
+   }
 
   private:
    // Identity and state
@@ -116,12 +174,23 @@ class Node final {
    bool m_active;
    // Hierarchy
    Node* m_parent;
-   std::vector<std::unique_ptr<Node>> m_children;
-   // Components
+   // Owned children as an intrusive list in insertion order, unlinking one is O(1)
+   Node* m_firstChild;
+   Node* m_lastChild;
+   Node* m_prevSibling;
+   Node* m_nextSibling;
+   size_t m_childCount;
+   // Components, their type ids, and the newest component of each type indexed by type id
    std::vector<std::unique_ptr<Component>> m_components;
-   std::unordered_map<std::type_index, Component*> m_componentLookup;
+   std::vector<uint32_t> m_componentTypes;
+   std::vector<Component*> m_componentLookup;
+   ComponentRegistry* m_registry;
+   NodeHandle m_handle;
    // Transform caching
    mutable Transform* m_localTransform;
+   TransformHierarchy* m_hierarchy;
+   uint32_t m_hierarchyIndex;
+   mutable glm::mat4 m_detachedWorldMatrix;
    mutable std::unique_ptr<Transform> m_worldTransform;
-   mutable bool m_worldTransformDirty;
+   mutable uint64_t m_worldTransformGeneration;
 };
@@ -0,0 +1,117 @@
+#include "core/scene/NodeAllocator.hpp"
+
+#include "core/scene/Node.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr size_t BLOCK_ALIGNMENT = std::max(alignof(Node), alignof(void*));
+constexpr size_t BLOCK_SIZE =
+   (sizeof(Node) + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+
+struct FreeBlock final {
+   FreeBlock* next;
+};
+
+struct ChunkDeleter final {
+   void operator()(std::byte* const chunk) const noexcept {
+      ::operator delete(chunk, std::align_val_t{BLOCK_ALIGNMENT});
+   }
+};
+
+struct BlockPool final {
+   std::mutex mutex;
+   std::vector<std::unique_ptr<std::byte, ChunkDeleter>> chunks;
+   FreeBlock* freeList{nullptr};
+
+   void Grow() {
+      auto* const chunk = static_cast<std::byte*>(::operator new(
+         BLOCK_SIZE * NodeAllocator::NODES_PER_CHUNK, std::align_val_t{BLOCK_ALIGNMENT}));
+      chunks.emplace_back(chunk);
+      // Thread the new blocks onto the free list so the lowest addresses are handed out first
+      for (size_t i = NodeAllocator::NODES_PER_CHUNK; i-- > 0;) {
+         auto* const block = reinterpret_cast<FreeBlock*>(chunk + i * BLOCK_SIZE);
+         block->next = freeList;
+         freeList = block;
+      }
+   }
+};
+
+BlockPool& GetPool() {
+   static BlockPool s_pool;
+   return s_pool;
+}
+
+} // namespace
+
+void* NodeAllocator::Allocate(const size_t size) {
+   if (size > BLOCK_SIZE) [[unlikely]] {
+      return ::operator new(size);
+   }
+   BlockPool& pool = GetPool();
+   std::lock_guard<std::mutex> lock(pool.mutex);
+   if (!pool.freeList) {
+      pool.Grow();
+   }
+   FreeBlock* const block = pool.freeList;
+   pool.freeList = block->next;
+   return block;
+}
+
+void NodeAllocator::Deallocate(void* const ptr, const size_t size) noexcept {
+   if (!ptr)
+      return;
+   if (size > BLOCK_SIZE) [[unlikely]] {
+      ::operator delete(ptr);
+      return;
+   }
+   BlockPool& pool = GetPool();
+   std::lock_guard<std::mutex> lock(pool.mutex);
+   auto* const block = static_cast<FreeBlock*>(ptr);
+   block->next = pool.freeList;
+   pool.freeList = block;
+}
+
+void NodeAllocator::Trim() {
+   BlockPool& pool = GetPool();
+   std::lock_guard<std::mutex> lock(pool.mutex);
+   if (pool.chunks.empty())
+      return;
+   // Sorted by address, so the chunk owning a block is found by binary search
+   const auto chunkBegin = [](const auto& chunk) -> const std::byte* { return chunk.get(); };
+   std::ranges::sort(pool.chunks, std::less{}, chunkBegin);
+   const auto chunkOf = [&pool, &chunkBegin](const FreeBlock* const block) {
+      const auto it = std::ranges::upper_bound(
+         pool.chunks, reinterpret_cast<const std::byte*>(block), std::less{}, chunkBegin);
+      return static_cast<size_t>(it - pool.chunks.begin()) - 1;
+   };
+   std::vector<size_t> freeCounts(pool.chunks.size(), 0);
+   for (const FreeBlock* block = pool.freeList; block; block = block->next) {
+      ++freeCounts[chunkOf(block)];
+   }
+   // Unlink the blocks of fully free chunks, the rest keep their order
+   FreeBlock** link = &pool.freeList;
+   while (*link) {
+      if (freeCounts[chunkOf(*link)] == NODES_PER_CHUNK) {
+         *link = (*link)->next;
+      } else {
+         link = &(*link)->next;
+      }
+   }
+   size_t kept = 0;
+   for (size_t i = 0; i < pool.chunks.size(); ++i) {
+      if (freeCounts[i] == NODES_PER_CHUNK)
+         continue;
+      if (kept != i) {
+         pool.chunks[kept] = std::move(pool.chunks[i]);
+      }
+      ++kept;
+   }
+   pool.chunks.resize(kept);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+
+// Fixed-size block pool backing every Node allocation. Blocks are carved out of large chunks and
+// recycled through a free list, so creating and destroying many nodes stays O(1) and never
+// fragments the general-purpose heap. Chunks are kept for reuse until Trim() is called.
+class NodeAllocator final {
+  public:
+   static constexpr size_t NODES_PER_CHUNK = 1024;
+
+   NodeAllocator() = delete;
+
+   [[nodiscard]] static void* Allocate(const size_t size);
+   static void Deallocate(void* ptr, const size_t size) noexcept;
+
+   // Returns every chunk that holds no live node to the system
+   static void Trim();
+};
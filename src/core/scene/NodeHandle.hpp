@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Weak reference to a node inside a scene. The slot index is recycled once its node is destroyed,
+// and the generation tells a stale handle apart from the slot's new occupant.
+class NodeHandle final {
+  public:
+   static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+   constexpr NodeHandle() noexcept = default;
+   constexpr NodeHandle(const uint32_t index, const uint32_t generation) noexcept
+       : m_index(index), m_generation(generation) {}
+
+   [[nodiscard]] constexpr bool IsValid() const noexcept { return m_index != INVALID_INDEX; }
+   [[nodiscard]] constexpr uint32_t GetIndex() const noexcept { return m_index; }
+   [[nodiscard]] constexpr uint32_t GetGeneration() const noexcept { return m_generation; }
+
+   [[nodiscard]] constexpr bool operator==(const NodeHandle& other) const noexcept = default;
+
+  private:
+   uint32_t m_index{INVALID_INDEX};
+   uint32_t m_generation{0};
+};
@@ -0,0 +1,321 @@
+#include "core/scene/OcclusionCuller.hpp"
+
+#include "core/ThreadPool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OCCLUSION_CULLER_X64 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Geometry closer than this in clip space w is clipped, keeps projected coordinates bounded
+constexpr float MIN_CLIP_W = 0.01f;
+
+// Up to four vertices, a triangle clipped by a single plane
+struct ClipPolygon final {
+   std::array<glm::vec4, 4> vertices;
+   uint32_t count{0};
+};
+
+[[nodiscard]] ClipPolygon ClipNear(const glm::vec4& a, const glm::vec4& b,
+                                   const glm::vec4& c) noexcept {
+   const std::array<glm::vec4, 3> input{a, b, c};
+   ClipPolygon output;
+   for (uint32_t i = 0; i < 3; ++i) {
+      const glm::vec4& current = input[i];
+      const glm::vec4& next = input[(i + 1) % 3];
+      const bool currentInside = current.w >= MIN_CLIP_W;
+      const bool nextInside = next.w >= MIN_CLIP_W;
+      if (currentInside)
+         output.vertices[output.count++] = current;
+      if (currentInside != nextInside) {
+         const float t = (MIN_CLIP_W - current.w) / (next.w - current.w);
+         output.vertices[output.count++] = glm::mix(current, next, t);
+      }
+   }
+   return output;
+}
+
+} // namespace
+
+OcclusionCuller::OcclusionCuller(ThreadPool& threadPool)
+    : OcclusionCuller(threadPool, Settings{}) {}
+
+OcclusionCuller::OcclusionCuller(ThreadPool& threadPool, const Settings& settings)
+    : m_settings(settings) {
+   if (m_settings.threadCount == 0) {
+      m_threadPool = &threadPool;
+   } else if (m_settings.threadCount > 1) {
+      m_ownedThreadPool = std::make_unique<ThreadPool>(m_settings.threadCount);
+      m_threadPool = m_ownedThreadPool.get();
+   }
+   m_tilesX = std::max((m_settings.width + TILE_WIDTH - 1) / TILE_WIDTH, 1u);
+   m_tilesY = std::max((m_settings.height + TILE_HEIGHT - 1) / TILE_HEIGHT, 1u);
+   m_settings.width = m_tilesX * TILE_WIDTH;
+   m_settings.height = m_tilesY * TILE_HEIGHT;
+   m_depth.assign(static_cast<size_t>(m_settings.width) * m_settings.height, 0.0f);
+   m_tileDepth.assign(static_cast<size_t>(m_tilesX) * m_tilesY, 0.0f);
+}
+
+OcclusionCuller::~OcclusionCuller() = default;
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection) {
+   m_viewProjection = viewProjection;
+   m_occluders.clear();
+   m_stats = OcclusionStats{};
+   std::ranges::fill(m_depth, 0.0f);
+   std::ranges::fill(m_tileDepth, 0.0f);
+}
+
+void OcclusionCuller::AddOccluder(const glm::mat4& worldMatrix, const OccluderGeometry& geometry) {
+   m_occluders.push_back({.modelViewProjection = m_viewProjection * worldMatrix,
+                          .geometry = &geometry});
+}
+
+void OcclusionCuller::Rasterize() {
+   const auto start = std::chrono::high_resolution_clock::now();
+   // Transform and clip every occluder on the workers, each into its own triangle list
+   m_triangles.resize(m_occluders.size());
+   const auto transform = [this](const size_t i) {
+      m_triangles[i].clear();
+      TransformOccluder(m_occluders[i], m_triangles[i]);
+   };
+   ThreadPool::TaskGroup group;
+   for (size_t i = 0; i < m_occluders.size(); ++i) {
+      if (m_threadPool) {
+         m_threadPool->Submit(group, [&transform, i]() { transform(i); });
+      } else {
+         transform(i);
+      }
+   }
+   if (m_threadPool)
+      m_threadPool->Wait(group);
+   m_stats.occluders = static_cast<uint32_t>(m_occluders.size());
+   for (const auto& triangles : m_triangles)
+      m_stats.occluderTriangles += static_cast<uint32_t>(triangles.size());
+   // Bands of whole tile rows never share pixels, so they need no synchronization
+   if (!m_threadPool) {
+      RasterizeBand(0, m_settings.height);
+   } else {
+      const uint32_t bandCount = std::min<uint32_t>(
+         static_cast<uint32_t>(m_threadPool->GetThreadCount()), m_tilesY);
+      const uint32_t tileRowsPerBand = (m_tilesY + bandCount - 1) / bandCount;
+      for (uint32_t tileRow = 0; tileRow < m_tilesY; tileRow += tileRowsPerBand) {
+         const uint32_t tileRows = std::min(tileRowsPerBand, m_tilesY - tileRow);
+         m_threadPool->Submit(group, [this, tileRow, tileRows]() {
+            RasterizeBand(tileRow * TILE_HEIGHT, tileRows * TILE_HEIGHT);
+         });
+      }
+      m_threadPool->Wait(group);
+   }
+   const auto end = std::chrono::high_resolution_clock::now();
+   m_stats.rasterMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+bool OcclusionCuller::IsVisible(const BoundingBox& worldBounds) const noexcept {
+   if (worldBounds.IsEmpty())
+      return true;
+   const float width = static_cast<float>(m_settings.width);
+   const float height = static_cast<float>(m_settings.height);
+   glm::vec2 screenMin(std::numeric_limits<float>::max());
+   glm::vec2 screenMax(std::numeric_limits<float>::lowest());
+   // 1/w is largest at the box's nearest corner
+   float nearestDepth = 0.0f;
+   for (uint32_t i = 0; i < 8; ++i) {
+      const glm::vec3 corner((i & 1) ? worldBounds.max.x : worldBounds.min.x,
+                             (i & 2) ? worldBounds.max.y : worldBounds.min.y,
+                             (i & 4) ? worldBounds.max.z : worldBounds.min.z);
+      const glm::vec4 clip = m_viewProjection * glm::vec4(corner, 1.0f);
+      // Crosses the near plane, keep it rather than deal with the projection flipping
+      if (clip.w < MIN_CLIP_W)
+         return true;
+      const float invW = 1.0f / clip.w;
+      const glm::vec2 screen((clip.x * invW * 0.5f + 0.5f) * width,
+                             (clip.y * invW * 0.5f + 0.5f) * height);
+      screenMin = glm::min(screenMin, screen);
+      screenMax = glm::max(screenMax, screen);
+      nearestDepth = std::max(nearestDepth, invW);
+   }
+   // Off screen boxes are the frustum test's business
+   if (screenMax.x < 0.0f || screenMax.y < 0.0f || screenMin.x >= width ||
+       screenMin.y >= height)
+      return true;
+   const uint32_t x0 = static_cast<uint32_t>(std::max(screenMin.x, 0.0f));
+   const uint32_t y0 = static_cast<uint32_t>(std::max(screenMin.y, 0.0f));
+   const uint32_t x1 = static_cast<uint32_t>(std::min(screenMax.x, width - 1.0f));
+   const uint32_t y1 = static_cast<uint32_t>(std::min(screenMax.y, height - 1.0f));
+   for (uint32_t tileY = y0 / TILE_HEIGHT; tileY <= y1 / TILE_HEIGHT; ++tileY) {
+      for (uint32_t tileX = x0 / TILE_WIDTH; tileX <= x1 / TILE_WIDTH; ++tileX) {
+         // Even the tile's farthest pixel is in front of the box
+         if (m_tileDepth[tileY * m_tilesX + tileX] > nearestDepth)
+            continue;
+         const uint32_t px0 = std::max(x0, tileX * TILE_WIDTH);
+         const uint32_t py0 = std::max(y0, tileY * TILE_HEIGHT);
+         const uint32_t px1 = std::min(x1, tileX * TILE_WIDTH + TILE_WIDTH - 1);
+         const uint32_t py1 = std::min(y1, tileY * TILE_HEIGHT + TILE_HEIGHT - 1);
+         if (AnyPixelBehind(px0, py0, px1, py1, nearestDepth))
+            return true;
+      }
+   }
+   return false;
+}
+
+void OcclusionCuller::RecordTests(const uint32_t tested, const uint32_t occluded,
+                                  const float testMs) noexcept {
+   m_stats.tested += tested;
+   m_stats.occluded += occluded;
+   m_stats.testMs += testMs;
+}
+
+void OcclusionCuller::TransformOccluder(const PendingOccluder& occluder,
+                                        std::vector<ScreenTriangle>& triangles) const {
+   const std::vector<glm::vec3>& positions = occluder.geometry->positions;
+   const std::vector<uint32_t>& indices = occluder.geometry->indices;
+   // Reused by whichever occluders this worker gets
+   thread_local std::vector<glm::vec4> clip;
+   clip.resize(positions.size());
+   for (size_t i = 0; i < positions.size(); ++i)
+      clip[i] = occluder.modelViewProjection * glm::vec4(positions[i], 1.0f);
+   const float width = static_cast<float>(m_settings.width);
+   const float height = static_cast<float>(m_settings.height);
+   const auto toScreen = [width, height](const glm::vec4& v) {
+      const float invW = 1.0f / v.w;
+      return glm::vec3((v.x * invW * 0.5f + 0.5f) * width, (v.y * invW * 0.5f + 0.5f) * height,
+                       invW);
+   };
+   for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+      if (indices[i] >= clip.size() || indices[i + 1] >= clip.size() ||
+          indices[i + 2] >= clip.size()) [[unlikely]]
+         continue;
+      const glm::vec4& a = clip[indices[i]];
+      const glm::vec4& b = clip[indices[i + 1]];
+      const glm::vec4& c = clip[indices[i + 2]];
+      // Entirely outside one side of the view volume
+      if ((a.x > a.w && b.x > b.w && c.x > c.w) || (a.x < -a.w && b.x < -b.w && c.x < -c.w) ||
+          (a.y > a.w && b.y > b.w && c.y > c.w) || (a.y < -a.w && b.y < -b.w && c.y < -c.w) ||
+          (a.w < MIN_CLIP_W && b.w < MIN_CLIP_W && c.w < MIN_CLIP_W))
+         continue;
+      if (a.w >= MIN_CLIP_W && b.w >= MIN_CLIP_W && c.w >= MIN_CLIP_W) {
+         triangles.push_back({toScreen(a), toScreen(b), toScreen(c)});
+         continue;
+      }
+      const ClipPolygon polygon = ClipNear(a, b, c);
+      for (uint32_t v = 2; v < polygon.count; ++v) {
+         triangles.push_back({toScreen(polygon.vertices[0]), toScreen(polygon.vertices[v - 1]),
+                              toScreen(polygon.vertices[v])});
+      }
+   }
+}
+
+void OcclusionCuller::RasterizeBand(const uint32_t firstRow, const uint32_t rowCount) noexcept {
+   const uint32_t endRow = firstRow + rowCount;
+   for (const auto& triangles : m_triangles) {
+      for (const ScreenTriangle& triangle : triangles)
+         RasterizeTriangle(triangle, firstRow, endRow);
+   }
+   UpdateTiles(firstRow, rowCount);
+}
+
+void OcclusionCuller::RasterizeTriangle(const ScreenTriangle& triangle, const uint32_t firstRow,
+                                        const uint32_t endRow) noexcept {
+   const glm::vec3& v0 = triangle.v0;
+   const glm::vec3& v1 = triangle.v1;
+   const glm::vec3& v2 = triangle.v2;
+   const float minYf = std::min({v0.y, v1.y, v2.y});
+   const float maxYf = std::max({v0.y, v1.y, v2.y});
+   if (maxYf < static_cast<float>(firstRow) || minYf >= static_cast<float>(endRow))
+      return;
+   const float minXf = std::min({v0.x, v1.x, v2.x});
+   const float maxXf = std::max({v0.x, v1.x, v2.x});
+   const float width = static_cast<float>(m_settings.width);
+   if (maxXf < 0.0f || minXf >= width)
+      return;
+   const float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+   if (std::abs(area) < 1e-6f)
+      return;
+   // Barycentric weight of each vertex as a plane a*x + b*y + c, from the opposite edge
+   const float invArea = 1.0f / area;
+   const auto edge = [invArea](const glm::vec3& from, const glm::vec3& to) {
+      return glm::vec3(-(to.y - from.y) * invArea, (to.x - from.x) * invArea,
+                       ((to.y - from.y) * from.x - (to.x - from.x) * from.y) * invArea);
+   };
+   const glm::vec3 e0 = edge(v1, v2);
+   const glm::vec3 e1 = edge(v2, v0);
+   const glm::vec3 e2 = edge(v0, v1);
+   const glm::vec3 depth = e0 * v0.z + e1 * v1.z + e2 * v2.z;
+   const uint32_t x0 = static_cast<uint32_t>(std::max(minXf, 0.0f));
+   const uint32_t x1 = static_cast<uint32_t>(std::min(maxXf, width - 1.0f));
+   const uint32_t y0 = std::max(static_cast<uint32_t>(std::max(minYf, 0.0f)), firstRow);
+   const uint32_t y1 = std::min(static_cast<uint32_t>(std::max(maxYf, 0.0f)), endRow - 1);
+   // Rows are a multiple of four wide, so starting on a group of four never overruns
+   const uint32_t xStart = x0 & ~3u;
+   for (uint32_t y = y0; y <= y1; ++y) {
+      const float py = static_cast<float>(y) + 0.5f;
+      float* const row = m_depth.data() + static_cast<size_t>(y) * m_settings.width;
+      const float rowE0 = e0.y * py + e0.z;
+      const float rowE1 = e1.y * py + e1.z;
+      const float rowE2 = e2.y * py + e2.z;
+      const float rowDepth = depth.y * py + depth.z;
+#ifdef OCCLUSION_CULLER_X64
+      const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+      const __m128 zero = _mm_setzero_ps();
+      for (uint32_t x = xStart; x <= x1; x += 4) {
+         const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+         const __m128 w0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e0.x), px), _mm_set1_ps(rowE0));
+         const __m128 w1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e1.x), px), _mm_set1_ps(rowE1));
+         const __m128 w2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(e2.x), px), _mm_set1_ps(rowE2));
+         const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)),
+                                          _mm_cmpge_ps(w2, zero));
+         if (_mm_movemask_ps(inside) == 0)
+            continue;
+         const __m128 z =
+            _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depth.x), px), _mm_set1_ps(rowDepth));
+         // Stored depths are never negative, so masked out lanes (0) keep the old value
+         const __m128 old = _mm_loadu_ps(row + x);
+         _mm_storeu_ps(row + x, _mm_max_ps(old, _mm_and_ps(inside, z)));
+      }
+#else
+      for (uint32_t x = xStart; x <= x1; ++x) {
+         const float px = static_cast<float>(x) + 0.5f;
+         if (e0.x * px + rowE0 >= 0.0f && e1.x * px + rowE1 >= 0.0f &&
+             e2.x * px + rowE2 >= 0.0f) {
+            row[x] = std::max(row[x], depth.x * px + rowDepth);
+         }
+      }
+#endif
+   }
+}
+
+void OcclusionCuller::UpdateTiles(const uint32_t firstRow, const uint32_t rowCount) noexcept {
+   for (uint32_t tileY = firstRow / TILE_HEIGHT; tileY < (firstRow + rowCount) / TILE_HEIGHT;
+        ++tileY) {
+      for (uint32_t tileX = 0; tileX < m_tilesX; ++tileX) {
+         float farthest = std::numeric_limits<float>::max();
+         for (uint32_t y = tileY * TILE_HEIGHT; y < (tileY + 1) * TILE_HEIGHT; ++y) {
+            const float* const row =
+               m_depth.data() + static_cast<size_t>(y) * m_settings.width + tileX * TILE_WIDTH;
+            farthest = std::min(farthest, *std::min_element(row, row + TILE_WIDTH));
+         }
+         m_tileDepth[tileY * m_tilesX + tileX] = farthest;
+      }
+   }
+}
+
+bool OcclusionCuller::AnyPixelBehind(const uint32_t x0, const uint32_t y0, const uint32_t x1,
+                                     const uint32_t y1, const float depth) const noexcept {
+   for (uint32_t y = y0; y <= y1; ++y) {
+      const float* const row = m_depth.data() + static_cast<size_t>(y) * m_settings.width;
+      for (uint32_t x = x0; x <= x1; ++x) {
+         if (row[x] <= depth)
+            return true;
+      }
+   }
+   return false;
+}
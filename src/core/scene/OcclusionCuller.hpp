@@ -0,0 +1,105 @@
+#pragma once
+
+#include "core/Bounds.hpp"
+#include "core/resource/IMesh.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+struct OcclusionStats final {
+   uint32_t occluders{0};
+   uint32_t occluderTriangles{0};
+   uint32_t tested{0};
+   uint32_t occluded{0};
+   float rasterMs{0.0f};
+   float testMs{0.0f};
+};
+
+// Software occlusion culler. A few large occluders are rasterized into a low resolution depth
+// buffer holding 1/w per pixel (0 where nothing was drawn, larger is closer), so depth is the
+// same for both APIs' clip spaces. Occluders are transformed in parallel, then the buffer is
+// split into bands of tiles that workers rasterize four pixels at a time. Each tile also keeps
+// its farthest depth, so most bounds are accepted or rejected per tile without touching pixels.
+class OcclusionCuller final {
+  public:
+   static constexpr uint32_t TILE_WIDTH = 8;
+   static constexpr uint32_t TILE_HEIGHT = 8;
+
+   struct Settings final {
+      // Rounded up to whole tiles
+      uint32_t width{320};
+      uint32_t height{192};
+      // Largest on-screen candidates are picked first
+      uint32_t maxOccluders{48};
+      // 0 shares the pool passed in, 1 rasterizes on the calling thread and anything larger
+      // gets a pool of its own
+      uint32_t threadCount{0};
+   };
+
+   // threadPool must outlive the culler
+   explicit OcclusionCuller(ThreadPool& threadPool);
+   OcclusionCuller(ThreadPool& threadPool, const Settings& settings);
+   ~OcclusionCuller();
+
+   OcclusionCuller(const OcclusionCuller&) = delete;
+   OcclusionCuller& operator=(const OcclusionCuller&) = delete;
+   OcclusionCuller(OcclusionCuller&&) = delete;
+   OcclusionCuller& operator=(OcclusionCuller&&) = delete;
+
+   // Clears the buffer and the queued occluders, viewProjection is used until the next call
+   void BeginFrame(const glm::mat4& viewProjection);
+   // Geometry must stay alive until Rasterize() returns
+   void AddOccluder(const glm::mat4& worldMatrix, const OccluderGeometry& geometry);
+   void Rasterize();
+   // False only if every pixel the box covers has an occluder in front of it
+   [[nodiscard]] bool IsVisible(const BoundingBox& worldBounds) const noexcept;
+   // Counts a tested batch for the stats, testMs is the time spent on it
+   void RecordTests(const uint32_t tested, const uint32_t occluded, const float testMs) noexcept;
+
+   [[nodiscard]] constexpr const Settings& GetSettings() const noexcept { return m_settings; }
+   [[nodiscard]] constexpr const OcclusionStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   // Screen space triangle, depth as 1/w
+   struct ScreenTriangle final {
+      glm::vec3 v0;
+      glm::vec3 v1;
+      glm::vec3 v2;
+   };
+
+   struct PendingOccluder final {
+      glm::mat4 modelViewProjection;
+      const OccluderGeometry* geometry;
+   };
+
+   void TransformOccluder(const PendingOccluder& occluder,
+                          std::vector<ScreenTriangle>& triangles) const;
+   void RasterizeBand(const uint32_t firstRow, const uint32_t rowCount) noexcept;
+   void RasterizeTriangle(const ScreenTriangle& triangle, const uint32_t firstRow,
+                          const uint32_t endRow) noexcept;
+   void UpdateTiles(const uint32_t firstRow, const uint32_t rowCount) noexcept;
+   // Whether any pixel in the inclusive rectangle is farther than depth
+   [[nodiscard]] bool AnyPixelBehind(const uint32_t x0, const uint32_t y0, const uint32_t x1,
+                                     const uint32_t y1, const float depth) const noexcept;
+
+  private:
+   Settings m_settings;
+   uint32_t m_tilesX{0};
+   uint32_t m_tilesY{0};
+   glm::mat4 m_viewProjection{1.0f};
+   std::vector<float> m_depth;
+   // Smallest 1/w per tile, i.e. its farthest pixel
+   std::vector<float> m_tileDepth;
+   std::vector<PendingOccluder> m_occluders;
+   // Per occluder, filled by the workers
+   std::vector<std::vector<ScreenTriangle>> m_triangles;
+   OcclusionStats m_stats{};
+   std::unique_ptr<ThreadPool> m_ownedThreadPool;
+   // Null when rasterizing on the calling thread
+   ThreadPool* m_threadPool{nullptr};
+};
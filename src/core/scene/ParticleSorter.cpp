@@ -0,0 +1,140 @@
+#include "core/scene/ParticleSorter.hpp"
+
+#include "core/ThreadPool.hpp"
+#include "core/scene/RenderWorld.hpp"
+#include "core/scene/components/ParticleSystemComponent.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace {
+
+// Unsigned key that orders like the float, inverted so the farthest particle sorts first
+[[nodiscard]] uint32_t BackToFrontKey(const float depth) noexcept {
+   const uint32_t bits = std::bit_cast<uint32_t>(depth);
+   const uint32_t ascending = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+   return ~ascending;
+}
+
+} // namespace
+
+ParticleSorter::ParticleSorter(ThreadPool& threadPool) : ParticleSorter(threadPool, Settings{}) {}
+
+ParticleSorter::ParticleSorter(ThreadPool& threadPool, const Settings& settings)
+    : m_settings(settings),
+      m_ownedThreadPool(settings.threadCount > 0
+                           ? std::make_unique<ThreadPool>(settings.threadCount)
+                           : nullptr),
+      m_threadPool(m_ownedThreadPool ? *m_ownedThreadPool : threadPool) {}
+
+ParticleSorter::~ParticleSorter() = default;
+
+void ParticleSorter::Sort(std::span<const ParticleProxy> systems, const uint32_t instanceCount,
+                          const glm::vec3& eye, const glm::vec3& viewDirection) {
+   const auto start = std::chrono::high_resolution_clock::now();
+   m_stats = ParticleSortStats{};
+   m_count = instanceCount;
+   m_sorted.resize(m_count);
+   if (m_count == 0)
+      return;
+   m_chunkCount = m_count >= m_settings.parallelThreshold
+                     ? static_cast<uint32_t>(m_threadPool.GetThreadCount())
+                     : 1u;
+   m_keys.resize(m_count);
+   m_indices.resize(m_count);
+   m_keysScratch.resize(m_count);
+   m_indicesScratch.resize(m_count);
+   m_sources.resize(m_count);
+   m_digitCounts.resize(m_chunkCount);
+   ForEachChunk([&](const uint32_t chunk) { ComputeKeys(systems, chunk, eye, viewDirection); });
+   for (uint32_t pass = 0; pass < PASS_COUNT; ++pass) {
+      const uint32_t shift = pass * RADIX_BITS;
+      ForEachChunk([this, shift](const uint32_t chunk) { CountDigits(chunk, shift); });
+      // Exclusive prefix over digits, then chunks, so each chunk scatters stably into its slots
+      uint32_t offset = 0;
+      bool singleDigit = false;
+      for (uint32_t digit = 0; digit < RADIX; ++digit) {
+         const uint32_t digitStart = offset;
+         for (std::array<uint32_t, RADIX>& counts : m_digitCounts) {
+            const uint32_t count = counts[digit];
+            counts[digit] = offset;
+            offset += count;
+         }
+         singleDigit |= offset - digitStart == m_count;
+      }
+      // Depths close to each other share their high bits, so those passes would be copies
+      if (singleDigit)
+         continue;
+      ForEachChunk([this, shift](const uint32_t chunk) { Scatter(chunk, shift); });
+      m_keys.swap(m_keysScratch);
+      m_indices.swap(m_indicesScratch);
+      ++m_stats.passes;
+   }
+   ForEachChunk([this](const uint32_t chunk) {
+      for (uint32_t i = ChunkBegin(chunk); i < ChunkBegin(chunk + 1); ++i)
+         m_sorted[i] = *m_sources[m_indices[i]];
+   });
+   m_stats.particles = m_count;
+   const auto end = std::chrono::high_resolution_clock::now();
+   m_stats.sortMs = std::chrono::duration<float, std::milli>(end - start).count();
+}
+
+void ParticleSorter::Clear() noexcept {
+   m_count = 0;
+   m_sorted.clear();
+   m_stats = ParticleSortStats{};
+}
+
+std::span<const ParticleInstanceData> ParticleSorter::GetSortedInstances() const noexcept {
+   return m_sorted;
+}
+
+void ParticleSorter::ForEachChunk(const std::function<void(uint32_t)>& job) {
+   if (m_chunkCount == 1) {
+      job(0);
+      return;
+   }
+   ThreadPool::TaskGroup group;
+   for (uint32_t chunk = 0; chunk < m_chunkCount; ++chunk)
+      m_threadPool.Submit(group, [&job, chunk]() { job(chunk); });
+   m_threadPool.Wait(group);
+}
+
+uint32_t ParticleSorter::ChunkBegin(const uint32_t chunk) const noexcept {
+   return static_cast<uint32_t>(static_cast<uint64_t>(m_count) * chunk / m_chunkCount);
+}
+
+void ParticleSorter::ComputeKeys(std::span<const ParticleProxy> systems, const uint32_t chunk,
+                                 const glm::vec3& eye, const glm::vec3& viewDirection) {
+   const uint32_t begin = ChunkBegin(chunk);
+   const uint32_t end = ChunkBegin(chunk + 1);
+   // Systems are packed in firstInstance order, start at the one holding this chunk's first index
+   auto system = std::ranges::upper_bound(systems, begin, {}, &ParticleProxy::firstInstance);
+   --system;
+   for (uint32_t i = begin; i < end; ++i) {
+      while (i >= system->firstInstance + system->instanceCount)
+         ++system;
+      const ParticleInstanceData* instance = system->instances + (i - system->firstInstance);
+      const float depth = glm::dot(glm::vec3(instance->transform[3]) - eye, viewDirection);
+      m_keys[i] = BackToFrontKey(depth);
+      m_indices[i] = i;
+      m_sources[i] = instance;
+   }
+}
+
+void ParticleSorter::CountDigits(const uint32_t chunk, const uint32_t shift) {
+   std::array<uint32_t, RADIX>& counts = m_digitCounts[chunk];
+   counts.fill(0);
+   for (uint32_t i = ChunkBegin(chunk); i < ChunkBegin(chunk + 1); ++i)
+      ++counts[(m_keys[i] >> shift) & (RADIX - 1)];
+}
+
+void ParticleSorter::Scatter(const uint32_t chunk, const uint32_t shift) {
+   std::array<uint32_t, RADIX>& offsets = m_digitCounts[chunk];
+   for (uint32_t i = ChunkBegin(chunk); i < ChunkBegin(chunk + 1); ++i) {
+      const uint32_t slot = offsets[(m_keys[i] >> shift) & (RADIX - 1)]++;
+      m_keysScratch[slot] = m_keys[i];
+      m_indicesScratch[slot] = m_indices[i];
+   }
+}
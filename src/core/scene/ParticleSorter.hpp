@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+struct ParticleProxy;
+struct ParticleInstanceData;
+
+struct ParticleSortStats final {
+   uint32_t particles{0};
+   // Radix passes run, passes whose digit is the same for every key are skipped
+   uint32_t passes{0};
+   float sortMs{0.0f};
+};
+
+// Orders the visible particles back to front for alpha blending. Every system's instances are
+// sorted together by view depth with an LSD radix sort on 32-bit keys, split into chunks that
+// are histogrammed and scattered in parallel, then packed into one list the particle pass
+// uploads in place of the per-system ranges.
+class ParticleSorter final {
+  public:
+   static constexpr uint32_t RADIX_BITS = 8;
+   static constexpr uint32_t RADIX = 1u << RADIX_BITS;
+   static constexpr uint32_t PASS_COUNT = 32 / RADIX_BITS;
+
+   struct Settings final {
+      // Below this many particles the sort runs on the calling thread
+      uint32_t parallelThreshold{16384};
+      // 0 shares the pool passed in, anything larger gets a pool of its own
+      uint32_t threadCount{0};
+   };
+
+   // threadPool must outlive the sorter
+   explicit ParticleSorter(ThreadPool& threadPool);
+   ParticleSorter(ThreadPool& threadPool, const Settings& settings);
+   ~ParticleSorter();
+
+   ParticleSorter(const ParticleSorter&) = delete;
+   ParticleSorter& operator=(const ParticleSorter&) = delete;
+   ParticleSorter(ParticleSorter&&) = delete;
+   ParticleSorter& operator=(ParticleSorter&&) = delete;
+
+   // Packs the systems' instances farthest first along viewDirection, seen from eye.
+   // instanceCount is the sum of the systems' instance counts.
+   void Sort(std::span<const ParticleProxy> systems, const uint32_t instanceCount,
+             const glm::vec3& eye, const glm::vec3& viewDirection);
+   // Drops the sorted list, the particle pass then uploads the systems' own ranges
+   void Clear() noexcept;
+
+   // Empty unless the last call was a Sort() with particles
+   [[nodiscard]] std::span<const ParticleInstanceData> GetSortedInstances() const noexcept;
+   [[nodiscard]] constexpr const ParticleSortStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   // Runs job once per chunk, on the workers if there is more than one chunk
+   void ForEachChunk(const std::function<void(uint32_t)>& job);
+   [[nodiscard]] uint32_t ChunkBegin(const uint32_t chunk) const noexcept;
+   void ComputeKeys(std::span<const ParticleProxy> systems, const uint32_t chunk,
+                    const glm::vec3& eye, const glm::vec3& viewDirection);
+   void CountDigits(const uint32_t chunk, const uint32_t shift);
+   void Scatter(const uint32_t chunk, const uint32_t shift);
+
+  private:
+   Settings m_settings;
+   uint32_t m_count{0};
+   uint32_t m_chunkCount{1};
+   // Sort key and particle index pairs, ping-ponged with the scratch arrays between passes
+   std::vector<uint32_t> m_keys;
+   std::vector<uint32_t> m_indices;
+   std::vector<uint32_t> m_keysScratch;
+   std::vector<uint32_t> m_indicesScratch;
+   // Instance each particle index refers to
+   std::vector<const ParticleInstanceData*> m_sources;
+   // Per chunk digit counts, turned into scatter offsets in place
+   std::vector<std::array<uint32_t, RADIX>> m_digitCounts;
+   std::vector<ParticleInstanceData> m_sorted;
+   ParticleSortStats m_stats{};
+   std::unique_ptr<ThreadPool> m_ownedThreadPool;
+   ThreadPool& m_threadPool;
+};
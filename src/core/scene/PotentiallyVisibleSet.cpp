@@ -0,0 +1,324 @@
+#include "core/scene/PotentiallyVisibleSet.hpp"
+
+#include "core/Bounds.hpp"
+#include "core/ThreadPool.hpp"
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/OcclusionCuller.hpp"
+#include "core/scene/RenderWorld.hpp"
+#include "core/system/MappedFile.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC{'S', 'C', 'N', 'P', 'V', 'S', '\0', '\0'};
+// Bounds beyond this are the infinite placeholder, they do not size the grid
+constexpr float MAX_FINITE_EXTENT = 1e20f;
+constexpr float CUBE_NEAR = 0.05f;
+
+struct FileHeader final {
+   std::array<char, 8> magic;
+   uint32_t version;
+   uint32_t meshCount;
+   uint64_t signature;
+   glm::vec3 origin;
+   float cellSize;
+   glm::uvec3 cellCounts;
+   uint32_t indexCount;
+};
+
+// Direction and up vector of each cube face
+constexpr std::array<std::pair<glm::vec3, glm::vec3>, 6> CUBE_FACES{{
+   {glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)},
+   {glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f)},
+   {glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)},
+   {glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)},
+   {glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f)},
+   {glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f)},
+}};
+
+// Corners of a tetrahedron inside the unit cube, spread out so samples cover the cell
+constexpr std::array<glm::vec3, 4> SAMPLE_PATTERN{{
+   glm::vec3(0.25f, 0.25f, 0.25f),
+   glm::vec3(0.25f, -0.25f, -0.25f),
+   glm::vec3(-0.25f, 0.25f, -0.25f),
+   glm::vec3(-0.25f, -0.25f, 0.25f),
+}};
+
+[[nodiscard]] bool IsFinite(const BoundingBox& box) noexcept {
+   const glm::vec3 limit(MAX_FINITE_EXTENT);
+   return !box.IsEmpty() && glm::all(glm::lessThan(glm::abs(box.min), limit)) &&
+          glm::all(glm::lessThan(glm::abs(box.max), limit));
+}
+
+[[nodiscard]] bool Overlaps(const BoundingBox& a, const BoundingBox& b) noexcept {
+   return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+}
+
+[[nodiscard]] uint64_t HashCombine(const uint64_t hash, const uint64_t value) noexcept {
+   // FNV-1a over the value's bytes
+   uint64_t result = hash;
+   for (uint32_t i = 0; i < 8; ++i) {
+      result ^= (value >> (i * 8)) & 0xFF;
+      result *= 0x100000001B3ull;
+   }
+   return result;
+}
+
+} // namespace
+
+PotentiallyVisibleSet PotentiallyVisibleSet::Bake(const RenderWorld& renderWorld,
+                                                  const ResourceManager& resourceManager,
+                                                  ThreadPool& threadPool) {
+   return Bake(renderWorld, resourceManager, threadPool, Settings{});
+}
+
+PotentiallyVisibleSet PotentiallyVisibleSet::Bake(const RenderWorld& renderWorld,
+                                                  const ResourceManager& resourceManager,
+                                                  ThreadPool& threadPool,
+                                                  const Settings& settings) {
+   const std::span<const MeshProxy> proxies = renderWorld.GetMeshProxies();
+   const std::span<const BoundingBox> localBounds = renderWorld.GetMeshBounds();
+   PotentiallyVisibleSet pvs;
+   pvs.m_meshCount = static_cast<uint32_t>(proxies.size());
+   pvs.m_signature = ComputeSignature(renderWorld);
+   std::vector<BoundingBox> bounds(proxies.size());
+   BoundingBox sceneBounds;
+   for (size_t i = 0; i < proxies.size(); ++i) {
+      bounds[i] = localBounds[i].Transformed(proxies[i].worldMatrix);
+      if (IsFinite(bounds[i]))
+         sceneBounds.Expand(bounds[i]);
+   }
+   if (sceneBounds.IsEmpty()) {
+      pvs.m_cellOffsets.assign(1, 0);
+      return pvs;
+   }
+   // Grid covering the scene, cells grow rather than exceed the per axis limit
+   const glm::vec3 sceneSize = sceneBounds.max - sceneBounds.min;
+   const float largestAxis = std::max({sceneSize.x, sceneSize.y, sceneSize.z});
+   const float minCellSize =
+      largestAxis / static_cast<float>(std::max(settings.maxCellsPerAxis, 1u));
+   pvs.m_cellSize = std::max({settings.cellSize, minCellSize, 1e-3f});
+   pvs.m_origin = sceneBounds.min;
+   pvs.m_cellCounts = glm::max(glm::uvec3(glm::ceil(sceneSize / pvs.m_cellSize)), glm::uvec3(1));
+   const uint32_t cellCount = pvs.m_cellCounts.x * pvs.m_cellCounts.y * pvs.m_cellCounts.z;
+   const float farPlane = glm::length(sceneSize) + pvs.m_cellSize * 2.0f;
+   // Explicit -1..1 depth, the culler works on 1/w and the frustum is built to match
+   const glm::mat4 projection =
+      glm::perspectiveRH_NO(glm::radians(90.0f), 1.0f, CUBE_NEAR, farPlane);
+   std::vector<uint32_t> occluders;
+   for (uint32_t i = 0; i < proxies.size(); ++i) {
+      const IMesh* const mesh = resourceManager.GetMesh(proxies[i].mesh);
+      if (mesh && mesh->GetOccluderGeometry())
+         occluders.push_back(i);
+   }
+   const uint32_t sampleCount =
+      std::clamp(settings.samplesPerCell, 1u, static_cast<uint32_t>(SAMPLE_PATTERN.size()));
+   std::unique_ptr<ThreadPool> ownedThreadPool;
+   if (settings.threadCount > 0)
+      ownedThreadPool = std::make_unique<ThreadPool>(settings.threadCount);
+   ThreadPool& bakePool = ownedThreadPool ? *ownedThreadPool : threadPool;
+   const size_t workerCount = bakePool.GetThreadCount();
+   std::vector<std::vector<uint32_t>> cellMeshes(cellCount);
+   std::atomic<uint32_t> nextCell{0};
+   ThreadPool::TaskGroup group;
+   for (size_t worker = 0; worker < workerCount; ++worker) {
+      bakePool.Submit(group, [&]() {
+         // Each worker owns a single threaded culler, cells are the unit of parallelism
+         OcclusionCuller culler(bakePool,
+                                OcclusionCuller::Settings{.width = settings.faceResolution,
+                                                          .height = settings.faceResolution,
+                                                          .maxOccluders = settings.maxOccluders,
+                                                          .threadCount = 1});
+         std::vector<uint8_t> visible(proxies.size());
+         std::vector<std::pair<float, uint32_t>> candidates;
+         for (uint32_t cell = nextCell++; cell < cellCount; cell = nextCell++) {
+            const glm::uvec3 coords(cell % pvs.m_cellCounts.x,
+                                    (cell / pvs.m_cellCounts.x) % pvs.m_cellCounts.y,
+                                    cell / (pvs.m_cellCounts.x * pvs.m_cellCounts.y));
+            const glm::vec3 cellMin = pvs.m_origin + glm::vec3(coords) * pvs.m_cellSize;
+            const BoundingBox cellBounds{.min = cellMin, .max = cellMin + pvs.m_cellSize};
+            // Anything reaching into the cell can be right next to the camera
+            for (size_t i = 0; i < proxies.size(); ++i)
+               visible[i] = Overlaps(bounds[i], cellBounds) ? 1 : 0;
+            for (uint32_t sample = 0; sample < sampleCount; ++sample) {
+               const glm::vec3 eye =
+                  cellBounds.GetCenter() + SAMPLE_PATTERN[sample] * pvs.m_cellSize;
+               for (const auto& [direction, up] : CUBE_FACES) {
+                  const glm::mat4 viewProjection =
+                     projection * glm::lookAt(eye, eye + direction, up);
+                  const Frustum frustum = Frustum::FromMatrix(viewProjection, false);
+                  // Same ranking as runtime occlusion culling, projected size over distance
+                  candidates.clear();
+                  for (const uint32_t occluder : occluders) {
+                     if (!frustum.Intersects(bounds[occluder]))
+                        continue;
+                     const glm::vec3 extents = bounds[occluder].GetExtents();
+                     const glm::vec3 offset = bounds[occluder].GetCenter() - eye;
+                     const float distanceSquared = std::max(glm::dot(offset, offset), 1e-4f);
+                     candidates.emplace_back(-glm::dot(extents, extents) / distanceSquared,
+                                             occluder);
+                  }
+                  const size_t occluderCount =
+                     std::min<size_t>(candidates.size(), settings.maxOccluders);
+                  std::partial_sort(candidates.begin(), candidates.begin() + occluderCount,
+                                    candidates.end());
+                  culler.BeginFrame(viewProjection);
+                  for (size_t i = 0; i < occluderCount; ++i) {
+                     const MeshProxy& proxy = proxies[candidates[i].second];
+                     const IMesh* const mesh = resourceManager.GetMesh(proxy.mesh);
+                     culler.AddOccluder(proxy.worldMatrix, *mesh->GetOccluderGeometry());
+                  }
+                  culler.Rasterize();
+                  for (size_t i = 0; i < proxies.size(); ++i) {
+                     if (!visible[i] && frustum.Intersects(bounds[i]) &&
+                         culler.IsVisible(bounds[i]))
+                        visible[i] = 1;
+                  }
+               }
+            }
+            for (uint32_t i = 0; i < proxies.size(); ++i) {
+               if (visible[i])
+                  cellMeshes[cell].push_back(i);
+            }
+         }
+      });
+   }
+   bakePool.Wait(group);
+   // Flatten into one array, cells in grid order
+   pvs.m_cellOffsets.reserve(cellCount + 1);
+   pvs.m_cellOffsets.push_back(0);
+   for (const std::vector<uint32_t>& meshes : cellMeshes) {
+      pvs.m_cellMeshes.insert(pvs.m_cellMeshes.end(), meshes.begin(), meshes.end());
+      pvs.m_cellOffsets.push_back(static_cast<uint32_t>(pvs.m_cellMeshes.size()));
+   }
+   return pvs;
+}
+
+void PotentiallyVisibleSet::Save(const std::filesystem::path& filepath) const {
+   const FileHeader header{.magic = MAGIC,
+                           .version = VERSION,
+                           .meshCount = m_meshCount,
+                           .signature = m_signature,
+                           .origin = m_origin,
+                           .cellSize = m_cellSize,
+                           .cellCounts = m_cellCounts,
+                           .indexCount = static_cast<uint32_t>(m_cellMeshes.size())};
+   // Write next to the target and swap it in, so a failed save never leaves a partial file
+   if (filepath.has_parent_path())
+      std::filesystem::create_directories(filepath.parent_path());
+   std::filesystem::path tempPath = filepath;
+   tempPath += ".tmp";
+   {
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file)
+         throw std::runtime_error("Failed to open " + tempPath.string() + " for writing");
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(m_cellOffsets.data()),
+                 static_cast<std::streamsize>(m_cellOffsets.size() * sizeof(uint32_t)));
+      file.write(reinterpret_cast<const char*>(m_cellMeshes.data()),
+                 static_cast<std::streamsize>(m_cellMeshes.size() * sizeof(uint32_t)));
+      if (!file)
+         throw std::runtime_error("Failed to write " + tempPath.string());
+   }
+   std::filesystem::rename(tempPath, filepath);
+}
+
+bool PotentiallyVisibleSet::Load(const std::filesystem::path& filepath) {
+   if (!std::filesystem::exists(filepath))
+      return false;
+   const MappedFile file(filepath);
+   const std::span<const std::byte> data = file.GetData();
+   FileHeader header;
+   if (data.size() < sizeof(header))
+      throw std::runtime_error(filepath.string() + " is not a visibility set");
+   std::memcpy(&header, data.data(), sizeof(header));
+   if (header.magic != MAGIC)
+      throw std::runtime_error(filepath.string() + " is not a visibility set");
+   if (header.version != VERSION)
+      return false;
+   const uint64_t cellCount =
+      static_cast<uint64_t>(header.cellCounts.x) * header.cellCounts.y * header.cellCounts.z;
+   const uint64_t expectedSize =
+      sizeof(header) + (cellCount + 1 + header.indexCount) * sizeof(uint32_t);
+   if (data.size() != expectedSize)
+      throw std::runtime_error(filepath.string() + " is truncated");
+   m_origin = header.origin;
+   m_cellSize = header.cellSize;
+   m_cellCounts = header.cellCounts;
+   m_meshCount = header.meshCount;
+   m_signature = header.signature;
+   m_cellOffsets.resize(cellCount + 1);
+   m_cellMeshes.resize(header.indexCount);
+   const std::byte* offsets = data.data() + sizeof(header);
+   std::memcpy(m_cellOffsets.data(), offsets, m_cellOffsets.size() * sizeof(uint32_t));
+   std::memcpy(m_cellMeshes.data(), offsets + m_cellOffsets.size() * sizeof(uint32_t),
+               m_cellMeshes.size() * sizeof(uint32_t));
+   const bool offsetsValid =
+      m_cellOffsets.front() == 0 && m_cellOffsets.back() == header.indexCount &&
+      std::ranges::is_sorted(m_cellOffsets);
+   const bool meshesValid = std::ranges::all_of(
+      m_cellMeshes, [this](const uint32_t mesh) { return mesh < m_meshCount; });
+   if (!offsetsValid || !meshesValid)
+      throw std::runtime_error(filepath.string() + " has out of range cells");
+   return true;
+}
+
+bool PotentiallyVisibleSet::Matches(const RenderWorld& renderWorld) const noexcept {
+   return !m_cellOffsets.empty() && renderWorld.GetMeshProxies().size() == m_meshCount &&
+          ComputeSignature(renderWorld) == m_signature;
+}
+
+uint32_t PotentiallyVisibleSet::FindCell(const glm::vec3& position) const noexcept {
+   const glm::vec3 local = (position - m_origin) / m_cellSize;
+   if (glm::any(glm::lessThan(local, glm::vec3(0.0f))) ||
+       glm::any(glm::greaterThanEqual(local, glm::vec3(m_cellCounts))))
+      return INVALID_CELL;
+   const glm::uvec3 coords(local);
+   return coords.x + m_cellCounts.x * (coords.y + m_cellCounts.y * coords.z);
+}
+
+std::span<const uint32_t> PotentiallyVisibleSet::GetCellMeshes(const uint32_t cell) const noexcept {
+   if (cell >= GetCellCount())
+      return {};
+   return std::span(m_cellMeshes)
+      .subspan(m_cellOffsets[cell], m_cellOffsets[cell + 1] - m_cellOffsets[cell]);
+}
+
+uint32_t PotentiallyVisibleSet::GetCellCount() const noexcept {
+   return m_cellOffsets.empty() ? 0 : static_cast<uint32_t>(m_cellOffsets.size() - 1);
+}
+
+float PotentiallyVisibleSet::GetAverageCellMeshes() const noexcept {
+   const uint32_t cellCount = GetCellCount();
+   return cellCount > 0 ? static_cast<float>(m_cellMeshes.size()) / static_cast<float>(cellCount)
+                        : 0.0f;
+}
+
+uint64_t PotentiallyVisibleSet::ComputeSignature(const RenderWorld& renderWorld) noexcept {
+   const std::span<const MeshProxy> proxies = renderWorld.GetMeshProxies();
+   const std::span<const BoundingBox> localBounds = renderWorld.GetMeshBounds();
+   uint64_t hash = HashCombine(0xCBF29CE484222325ull, proxies.size());
+   for (size_t i = 0; i < proxies.size(); ++i) {
+      const BoundingBox bounds = localBounds[i].Transformed(proxies[i].worldMatrix);
+      // Millimetres, clamped so the infinite placeholder stays representable
+      for (const glm::vec3& corner : {bounds.min, bounds.max}) {
+         const glm::vec3 clamped = glm::clamp(corner, glm::vec3(-1e6f), glm::vec3(1e6f));
+         for (uint32_t axis = 0; axis < 3; ++axis) {
+            const int64_t quantized = std::llround(clamped[axis] * 1000.0f);
+            hash = HashCombine(hash, static_cast<uint64_t>(quantized));
+         }
+      }
+   }
+   return hash;
+}
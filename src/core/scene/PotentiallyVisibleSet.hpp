@@ -0,0 +1,82 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+class RenderWorld;
+class ResourceManager;
+class ThreadPool;
+
+// Baked cell visibility for static scenes. The scene's bounds are split into a grid of cells, and
+// for every cell the mesh proxies visible from a few sample points inside it are found by
+// rendering cube maps of the occluder geometry with the software occlusion culler. At runtime
+// the camera's cell is a grid lookup, and its list replaces any per-frame occlusion work.
+// Lists hold mesh proxy indices, so a set only applies to a render world whose proxies match the
+// ones it was baked from; Matches() checks that against the proxies' world bounds.
+class PotentiallyVisibleSet final {
+  public:
+   // Bump whenever the file layout changes, older files are then treated as missing
+   static constexpr uint32_t VERSION = 1;
+   static constexpr uint32_t INVALID_CELL = UINT32_MAX;
+
+   struct Settings final {
+      // Grown where the scene would need more than maxCellsPerAxis cells
+      float cellSize{4.0f};
+      uint32_t maxCellsPerAxis{16};
+      // Eye positions per cell, each rendering the six faces of a cube map
+      uint32_t samplesPerCell{4};
+      // Cube face resolution of the occlusion buffer
+      uint32_t faceResolution{128};
+      // Largest on-screen occluders rasterized per face
+      uint32_t maxOccluders{64};
+      // Cells are baked in parallel, 0 shares the pool passed to Bake() and anything larger
+      // bakes on a pool of its own
+      uint32_t threadCount{0};
+   };
+
+   PotentiallyVisibleSet() = default;
+
+   // Bakes from the render world's current proxies, so the scene has to be extracted first.
+   // Blocks until every cell is done. Called from one of threadPool's workers it bakes every
+   // cell on that thread.
+   [[nodiscard]] static PotentiallyVisibleSet Bake(const RenderWorld& renderWorld,
+                                                   const ResourceManager& resourceManager,
+                                                   ThreadPool& threadPool);
+   [[nodiscard]] static PotentiallyVisibleSet Bake(const RenderWorld& renderWorld,
+                                                   const ResourceManager& resourceManager,
+                                                   ThreadPool& threadPool,
+                                                   const Settings& settings);
+   // Throws std::runtime_error if the file cannot be written
+   void Save(const std::filesystem::path& filepath) const;
+   // Returns false if the file is missing or from another version, throws std::runtime_error if
+   // it is damaged
+   [[nodiscard]] bool Load(const std::filesystem::path& filepath);
+
+   // Whether the lists index the render world's current proxies
+   [[nodiscard]] bool Matches(const RenderWorld& renderWorld) const noexcept;
+   // INVALID_CELL outside the baked grid
+   [[nodiscard]] uint32_t FindCell(const glm::vec3& position) const noexcept;
+   // Ascending mesh proxy indices
+   [[nodiscard]] std::span<const uint32_t> GetCellMeshes(const uint32_t cell) const noexcept;
+
+   [[nodiscard]] uint32_t GetCellCount() const noexcept;
+   [[nodiscard]] float GetAverageCellMeshes() const noexcept;
+
+  private:
+   // Hash of the proxy count and world bounds, quantized so float noise does not invalidate it
+   [[nodiscard]] static uint64_t ComputeSignature(const RenderWorld& renderWorld) noexcept;
+
+  private:
+   glm::vec3 m_origin{0.0f};
+   float m_cellSize{1.0f};
+   glm::uvec3 m_cellCounts{0};
+   uint32_t m_meshCount{0};
+   uint64_t m_signature{0};
+   // Cell i's meshes are m_cellMeshes[m_cellOffsets[i], m_cellOffsets[i + 1])
+   std::vector<uint32_t> m_cellOffsets;
+   std::vector<uint32_t> m_cellMeshes;
+};
@@ -0,0 +1,272 @@
+#include "core/scene/RenderWorld.hpp"
+
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/Node.hpp"
+#include "core/scene/OcclusionCuller.hpp"
+#include "core/scene/Scene.hpp"
+#include "core/scene/TransformHierarchy.hpp"
+#include "core/scene/components/LightComponent.hpp"
+#include "core/scene/components/ParticleSystemComponent.hpp"
+#include "core/scene/components/RendererComponent.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+// Contributions below this fraction of the light's peak are treated as zero
+constexpr float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+[[nodiscard]] float ComputeLightRange(const LightComponent& light) noexcept {
+   if (light.GetType() == LightComponent::LightType::Directional)
+      return RenderWorld::UNBOUNDED_RANGE;
+   const glm::vec3& color = light.GetColor();
+   const float peak = light.GetIntensity() * std::max({color.x, color.y, color.z});
+   // Solve constant + linear * d + quadratic * d^2 = peak / cutoff for d
+   const float a = light.GetQuadratic();
+   const float b = light.GetLinear();
+   const float c = light.GetConstant() - peak / LIGHT_CUTOFF;
+   if (c >= 0.0f)
+      return 0.0f;
+   if (a > 0.0f)
+      return (-b + std::sqrt(b * b - 4.0f * a * c)) / (2.0f * a);
+   if (b > 0.0f)
+      return -c / b;
+   return RenderWorld::UNBOUNDED_RANGE;
+}
+
+} // namespace
+
+void RenderWorld::Extract(const Scene& scene, const ResourceManager& resourceManager,
+                          const Frustum* frustum) {
+   m_stats = RenderWorldStats{};
+   TransformHierarchy* const hierarchy = scene.GetTransformHierarchy();
+   // Slot indices and world generations must be current before they are compared
+   hierarchy->Refresh();
+   const uint64_t registryVersion = scene.GetComponentRegistry()->GetVersion();
+   const uint64_t layoutVersion = hierarchy->GetLayoutVersion();
+   const bool stale = &scene != m_scene || registryVersion != m_registryVersion ||
+                      layoutVersion != m_layoutVersion;
+   if (stale || !RefreshMeshes(scene)) {
+      RebuildMeshes(scene, resourceManager);
+      m_scene = &scene;
+      m_registryVersion = registryVersion;
+      m_layoutVersion = layoutVersion;
+   }
+   m_stats.bvhNodesRefit = m_meshBvh.Refit();
+   CullMeshes(frustum);
+   ExtractLights(scene, frustum);
+   ExtractParticles(scene, frustum);
+   m_stats.meshProxies = static_cast<uint32_t>(m_meshes.size());
+   m_stats.meshProxiesVisible = static_cast<uint32_t>(m_visibleMeshes.size());
+   m_stats.lightProxies = static_cast<uint32_t>(m_lights.size());
+   m_stats.particleProxies = static_cast<uint32_t>(m_particles.size());
+}
+
+void RenderWorld::Reset() noexcept {
+   m_meshes.clear();
+   m_meshSources.clear();
+   m_meshBounds.clear();
+   m_meshOccluders.clear();
+   m_meshMoved.clear();
+   m_meshBvh.Clear();
+   m_visibleMeshes.clear();
+   m_lights.clear();
+   m_particles.clear();
+   m_particleInstanceCount = 0;
+   m_scene = nullptr;
+   m_registryVersion = 0;
+   m_layoutVersion = 0;
+   ++m_meshGeneration;
+   m_stats = RenderWorldStats{};
+}
+
+void RenderWorld::RebuildMeshes(const Scene& scene, const ResourceManager& resourceManager) {
+   const TransformHierarchy* const hierarchy = scene.GetTransformHierarchy();
+   m_meshes.clear();
+   m_meshSources.clear();
+   m_meshBounds.clear();
+   m_meshOccluders.clear();
+   for (const auto [node, renderer] : scene.View<RendererComponent>()) {
+      MeshSource source{.node = node,
+                        .renderer = renderer,
+                        .revision = renderer->GetRevision(),
+                        .hierarchyIndex = node->GetHierarchyIndex(),
+                        .worldGeneration = 0,
+                        .proxy = INVALID_PROXY};
+      if (source.hierarchyIndex != TransformHierarchy::INVALID_INDEX) [[likely]] {
+         source.worldGeneration = hierarchy->GetWorldGeneration(source.hierarchyIndex);
+      }
+      if (node->IsActive() && renderer->IsVisible() && renderer->HasMesh()) {
+         source.proxy = static_cast<uint32_t>(m_meshes.size());
+         m_meshes.push_back(MeshProxy{.worldMatrix = node->GetWorldMatrix(),
+                                      .mesh = renderer->GetMesh(),
+                                      .material = renderer->GetMaterial()});
+         // Meshes without known bounds are never culled
+         const IMesh* const mesh = resourceManager.GetMesh(renderer->GetMesh());
+         m_meshBounds.push_back(mesh && !mesh->GetBounds().IsEmpty() ? mesh->GetBounds()
+                                                                    : BoundingBox::Infinite());
+         m_meshOccluders.push_back(mesh && mesh->GetOccluderGeometry() ? 1 : 0);
+      }
+      m_meshSources.push_back(source);
+   }
+   m_meshMoved.assign(m_meshes.size(), 0);
+   std::vector<BoundingBox> worldBounds(m_meshes.size());
+   for (uint32_t i = 0; i < worldBounds.size(); ++i)
+      worldBounds[i] = GetWorldBounds(i);
+   m_meshBvh.Build(worldBounds);
+   m_stats.meshProxiesUpdated = static_cast<uint32_t>(m_meshes.size());
+   m_stats.rebuilt = true;
+   ++m_meshGeneration;
+}
+
+bool RenderWorld::RefreshMeshes(const Scene& scene) {
+   const TransformHierarchy* const hierarchy = scene.GetTransformHierarchy();
+   uint32_t updated = 0;
+   for (MeshSource& source : m_meshSources) {
+      if (source.renderer->GetRevision() != source.revision) [[unlikely]]
+         return false;
+      if (source.proxy == INVALID_PROXY)
+         continue;
+      if (source.hierarchyIndex == TransformHierarchy::INVALID_INDEX) [[unlikely]] {
+         m_meshes[source.proxy].worldMatrix = source.node->GetWorldMatrix();
+         m_meshMoved[source.proxy] = 1;
+         m_meshBvh.Update(source.proxy, GetWorldBounds(source.proxy));
+         ++updated;
+         continue;
+      }
+      // Only copy matrices the last hierarchy sweep actually recomputed
+      const uint64_t generation = hierarchy->GetWorldGeneration(source.hierarchyIndex);
+      if (generation != source.worldGeneration) {
+         source.worldGeneration = generation;
+         m_meshes[source.proxy].worldMatrix = hierarchy->GetWorldMatrix(source.hierarchyIndex);
+         m_meshMoved[source.proxy] = 1;
+         m_meshBvh.Update(source.proxy, GetWorldBounds(source.proxy));
+         ++updated;
+      }
+   }
+   m_stats.meshProxiesUpdated = updated;
+   return true;
+}
+
+void RenderWorld::CullMeshes(const Frustum* frustum) {
+   m_visibleMeshes.clear();
+   if (!frustum) {
+      m_visibleMeshes.resize(m_meshes.size());
+      std::iota(m_visibleMeshes.begin(), m_visibleMeshes.end(), 0u);
+      return;
+   }
+   m_meshBvh.Query(*frustum, [this](const uint32_t proxy) { m_visibleMeshes.push_back(proxy); });
+   // Proxy order keeps runs of the same material together
+   std::ranges::sort(m_visibleMeshes);
+}
+
+void RenderWorld::CullOccluded(OcclusionCuller& culler, const ResourceManager& resourceManager,
+                               const glm::mat4& viewProjection, const glm::vec3& viewPosition) {
+   culler.BeginFrame(viewProjection);
+   // Rank candidates by roughly their projected area, the bounds size over the distance squared
+   m_occluderCandidates.clear();
+   for (const uint32_t proxy : m_visibleMeshes) {
+      if (!m_meshOccluders[proxy])
+         continue;
+      const BoundingBox bounds = GetWorldBounds(proxy);
+      const glm::vec3 extents = bounds.GetExtents();
+      const glm::vec3 offset = bounds.GetCenter() - viewPosition;
+      const float distanceSquared = std::max(glm::dot(offset, offset), 1e-4f);
+      m_occluderCandidates.emplace_back(-glm::dot(extents, extents) / distanceSquared, proxy);
+   }
+   const size_t occluderCount =
+      std::min<size_t>(m_occluderCandidates.size(), culler.GetSettings().maxOccluders);
+   std::partial_sort(m_occluderCandidates.begin(), m_occluderCandidates.begin() + occluderCount,
+                     m_occluderCandidates.end());
+   for (size_t i = 0; i < occluderCount; ++i) {
+      const uint32_t proxy = m_occluderCandidates[i].second;
+      const IMesh* const mesh = resourceManager.GetMesh(m_meshes[proxy].mesh);
+      if (mesh && mesh->GetOccluderGeometry())
+         culler.AddOccluder(m_meshes[proxy].worldMatrix, *mesh->GetOccluderGeometry());
+   }
+   culler.Rasterize();
+   const auto testStart = std::chrono::high_resolution_clock::now();
+   const size_t tested = m_visibleMeshes.size();
+   // An occluder that passes its own test stays, its pixels are written with its own depth
+   std::erase_if(m_visibleMeshes, [this, &culler](const uint32_t proxy) {
+      return !culler.IsVisible(GetWorldBounds(proxy));
+   });
+   const auto testEnd = std::chrono::high_resolution_clock::now();
+   const uint32_t occluded = static_cast<uint32_t>(tested - m_visibleMeshes.size());
+   culler.RecordTests(static_cast<uint32_t>(tested), occluded,
+                      std::chrono::duration<float, std::milli>(testEnd - testStart).count());
+   m_stats.meshProxiesOccluded += occluded;
+   m_stats.meshProxiesVisible = static_cast<uint32_t>(m_visibleMeshes.size());
+}
+
+void RenderWorld::CullPotentiallyVisible(const std::span<const uint32_t> potentiallyVisible) {
+   // Both lists are ascending, so one merge-like pass keeps the visible meshes in order
+   size_t listed = 0;
+   size_t kept = 0;
+   for (const uint32_t proxy : m_visibleMeshes) {
+      while (listed < potentiallyVisible.size() && potentiallyVisible[listed] < proxy)
+         ++listed;
+      const bool baked =
+         listed < potentiallyVisible.size() && potentiallyVisible[listed] == proxy;
+      if (baked || m_meshMoved[proxy])
+         m_visibleMeshes[kept++] = proxy;
+   }
+   m_stats.meshProxiesPvsCulled += static_cast<uint32_t>(m_visibleMeshes.size() - kept);
+   m_visibleMeshes.resize(kept);
+   m_stats.meshProxiesVisible = static_cast<uint32_t>(m_visibleMeshes.size());
+}
+
+void RenderWorld::ExtractLights(const Scene& scene, const Frustum* frustum) {
+   m_lights.clear();
+   for (const auto [node, light] : scene.View<LightComponent>()) {
+      if (!node->IsActive()) [[unlikely]]
+         continue;
+      const glm::mat4& worldMatrix = node->GetWorldMatrix();
+      const float range = ComputeLightRange(*light);
+      // Lights whose range misses the view volume cannot light anything visible
+      if (frustum && range != UNBOUNDED_RANGE &&
+          !frustum->Intersects(glm::vec3(worldMatrix[3]), range)) {
+         ++m_stats.lightsCulled;
+         continue;
+      }
+      m_lights.push_back(LightProxy{.worldMatrix = worldMatrix,
+                                    .position = glm::vec3(worldMatrix[3]),
+                                    .lightType = static_cast<uint32_t>(light->GetType()),
+                                    .direction = -glm::normalize(glm::vec3(worldMatrix[2])),
+                                    .intensity = light->GetIntensity(),
+                                    .color = light->GetColor(),
+                                    .constant = light->GetConstant(),
+                                    .linear = light->GetLinear(),
+                                    .quadratic = light->GetQuadratic(),
+                                    .innerCone = light->GetInnerCone(),
+                                    .outerCone = light->GetOuterCone(),
+                                    .range = range});
+   }
+}
+
+void RenderWorld::ExtractParticles(const Scene& scene, const Frustum* frustum) {
+   m_particles.clear();
+   m_particleInstanceCount = 0;
+   for (const auto [node, particles] : scene.View<ParticleSystemComponent>()) {
+      if (!node->IsActive()) [[unlikely]]
+         continue;
+      const uint32_t count = particles->GetActiveParticleCount();
+      if (count == 0)
+         continue;
+      if (frustum && !frustum->Intersects(particles->GetBounds())) {
+         ++m_stats.particleSystemsCulled;
+         continue;
+      }
+      m_particles.push_back(ParticleProxy{.instances = particles->GetInstanceData().data(),
+                                          .firstInstance = m_particleInstanceCount,
+                                          .instanceCount = count});
+      m_particleInstanceCount += count;
+   }
+}
+
+BoundingBox RenderWorld::GetWorldBounds(const uint32_t proxy) const noexcept {
+   return m_meshBounds[proxy].Transformed(m_meshes[proxy].worldMatrix);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "core/Bounds.hpp"
+#include "core/resource/IMaterial.hpp"
+#include "core/resource/IMesh.hpp"
+#include "core/scene/BoundingVolumeHierarchy.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+class Node;
+class OcclusionCuller;
+class Scene;
+class ResourceManager;
+class RendererComponent;
+struct ParticleInstanceData;
+
+// One visible mesh draw
+struct MeshProxy final {
+   glm::mat4 worldMatrix;
+   MeshHandle mesh;
+   MaterialHandle material;
+};
+
+// Light parameters with the owner's world transform already applied
+struct LightProxy final {
+   glm::mat4 worldMatrix;
+   glm::vec3 position;
+   uint32_t lightType;
+   glm::vec3 direction;
+   float intensity;
+   glm::vec3 color;
+   float constant;
+   float linear;
+   float quadratic;
+   float innerCone;
+   float outerCone;
+   // Distance at which the light's contribution drops below 1/256, UNBOUNDED_RANGE if never
+   float range;
+};
+
+// Live instances of one particle system, packed after the previous system's range
+struct ParticleProxy final {
+   const ParticleInstanceData* instances;
+   uint32_t firstInstance;
+   uint32_t instanceCount;
+};
+
+struct RenderWorldStats final {
+   uint32_t meshProxies{0};
+   uint32_t meshProxiesUpdated{0};
+   uint32_t meshProxiesVisible{0};
+   // Passed the frustum but hidden behind occluders, already removed from the visible list
+   uint32_t meshProxiesOccluded{0};
+   // Passed the frustum but missing from the camera cell's baked visibility list
+   uint32_t meshProxiesPvsCulled{0};
+   // Visible lights and particle systems, the culled ones are not extracted at all
+   uint32_t lightProxies{0};
+   uint32_t lightsCulled{0};
+   uint32_t particleProxies{0};
+   uint32_t particleSystemsCulled{0};
+   uint32_t bvhNodesRefit{0};
+   bool rebuilt{false};
+};
+
+// Flat per-frame snapshot of everything the render passes draw, so passes walk contiguous arrays
+// instead of nodes and components. Mesh proxies persist between frames: only world matrices
+// whose hierarchy slot was recomputed are copied again, and the arrays are rebuilt only when
+// entities, components, active states, renderer properties or the hierarchy layout change.
+// Lights and particle ranges are small or change every frame, so they are re-extracted each time.
+// Given a frustum, mesh proxies are culled through a BVH over their world bounds that is refit
+// along with the copied matrices; lights and particle systems are tested while extracted.
+// CullOccluded() can then drop frustum visible meshes hidden behind the biggest occluders, or
+// CullPotentiallyVisible() the ones a baked cell visibility list excludes.
+class RenderWorld final {
+  public:
+   static constexpr float UNBOUNDED_RANGE = std::numeric_limits<float>::max();
+
+   RenderWorld() = default;
+   ~RenderWorld() = default;
+
+   RenderWorld(const RenderWorld&) = delete;
+   RenderWorld& operator=(const RenderWorld&) = delete;
+   RenderWorld(RenderWorld&&) = default;
+   RenderWorld& operator=(RenderWorld&&) = default;
+
+   // Run after the scene update, once per frame and before any pass reads the proxies. Mesh
+   // bounds come from the resource manager, a null frustum keeps everything visible.
+   void Extract(const Scene& scene, const ResourceManager& resourceManager,
+                const Frustum* frustum = nullptr);
+   // Rasterizes the largest visible meshes with occluder geometry and removes the visible meshes
+   // they hide. Run after Extract() with the same view, viewPosition ranks the occluders.
+   void CullOccluded(OcclusionCuller& culler, const ResourceManager& resourceManager,
+                     const glm::mat4& viewProjection, const glm::vec3& viewPosition);
+   // Keeps only the visible meshes in potentiallyVisible (ascending proxy indices) and the ones
+   // that moved since the proxies were built, which a baked list cannot account for
+   void CullPotentiallyVisible(const std::span<const uint32_t> potentiallyVisible);
+   // Drop everything, the next Extract() starts from scratch
+   void Reset() noexcept;
+
+   // All mesh proxies, passes draw the ones listed by GetVisibleMeshes()
+   [[nodiscard]] std::span<const MeshProxy> GetMeshProxies() const noexcept { return m_meshes; }
+   // Ascending indices into GetMeshProxies()
+   [[nodiscard]] std::span<const uint32_t> GetVisibleMeshes() const noexcept {
+      return m_visibleMeshes;
+   }
+   // Object space bounds parallel to GetMeshProxies(), infinite where the mesh has none
+   [[nodiscard]] std::span<const BoundingBox> GetMeshBounds() const noexcept {
+      return m_meshBounds;
+   }
+   // Changes whenever mesh proxies are added, removed or reordered, matrices aside
+   [[nodiscard]] constexpr uint64_t GetMeshGeneration() const noexcept { return m_meshGeneration; }
+   [[nodiscard]] std::span<const LightProxy> GetLightProxies() const noexcept {
+      return m_lights;
+   }
+   [[nodiscard]] std::span<const ParticleProxy> GetParticleProxies() const noexcept {
+      return m_particles;
+   }
+   // Sum of all particle ranges
+   [[nodiscard]] constexpr uint32_t GetParticleInstanceCount() const noexcept {
+      return m_particleInstanceCount;
+   }
+   [[nodiscard]] constexpr const RenderWorldStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   // Where a renderer component's proxy comes from, parallel to the registry's renderer pool
+   struct MeshSource final {
+      const Node* node;
+      const RendererComponent* renderer;
+      uint32_t revision;
+      uint32_t hierarchyIndex;
+      uint64_t worldGeneration;
+      // Index into m_meshes, INVALID_PROXY if the renderer draws nothing
+      uint32_t proxy;
+   };
+
+   static constexpr uint32_t INVALID_PROXY = UINT32_MAX;
+
+   void RebuildMeshes(const Scene& scene, const ResourceManager& resourceManager);
+   // Returns false if a renderer changed and the proxies have to be rebuilt
+   [[nodiscard]] bool RefreshMeshes(const Scene& scene);
+   void CullMeshes(const Frustum* frustum);
+   void ExtractLights(const Scene& scene, const Frustum* frustum);
+   void ExtractParticles(const Scene& scene, const Frustum* frustum);
+   [[nodiscard]] BoundingBox GetWorldBounds(const uint32_t proxy) const noexcept;
+
+  private:
+   std::vector<MeshProxy> m_meshes;
+   std::vector<MeshSource> m_meshSources;
+   // Object space bounds parallel to m_meshes, the BVH holds them in world space
+   std::vector<BoundingBox> m_meshBounds;
+   // Parallel to m_meshes, whether the mesh has occluder geometry
+   std::vector<uint8_t> m_meshOccluders;
+   // Parallel to m_meshes, whether the world matrix changed since the last rebuild
+   std::vector<uint8_t> m_meshMoved;
+   // Scratch for ranking occluder candidates, kept to avoid reallocating
+   std::vector<std::pair<float, uint32_t>> m_occluderCandidates;
+   BoundingVolumeHierarchy m_meshBvh;
+   std::vector<uint32_t> m_visibleMeshes;
+   std::vector<LightProxy> m_lights;
+   std::vector<ParticleProxy> m_particles;
+   uint32_t m_particleInstanceCount{0};
+   // What the mesh proxies were built from
+   const Scene* m_scene{nullptr};
+   uint64_t m_registryVersion{0};
+   uint64_t m_layoutVersion{0};
+   uint64_t m_meshGeneration{0};
+   RenderWorldStats m_stats{};
+};
@@ -2,6 +2,8 @@
 
 #include "core/editor/MaterialEditor.hpp"
 #include "core/scene/Node.hpp"
+#include "core/scene/NodeAllocator.hpp"
+#include "core/scene/TransformHierarchy.hpp"
 
 #include "core/scene/components/LightComponent.hpp"
 #include "core/scene/components/ParticleSystemComponent.hpp"
@@ -11,13 +13,25 @@
 #include <imgui.h>
 
 #include <algorithm>
-#include <queue>
+#include <functional>
 #include <string>
 
-Scene::Scene(const std::string name) : m_name(std::move(name)), m_nodeCounter(0) {
+Scene::Scene(ThreadPool& threadPool, const std::string name)
+    : m_name(std::move(name)), m_nodeCounter(0) {
    m_rootNode = std::make_unique<Node>("Root");
    m_rootNode->AddComponent<TransformComponent>();
+   m_transformHierarchy = std::make_unique<TransformHierarchy>(m_rootNode.get(), threadPool);
+   m_componentRegistry = std::make_unique<ComponentRegistry>(m_rootNode.get());
    RegisterNode(m_rootNode.get());
+   m_systemScheduler = std::make_unique<SystemScheduler>(threadPool);
+   // Each particle system is heavy on its own, so every one may get its own task
+   m_systemScheduler->AddSystem<ParticleSystemComponent, const TransformComponent>(
+      "ParticleSystems",
+      [](const Node* const node, ParticleSystemComponent* const particleSystem,
+         const TransformComponent*, const float deltaTime) {
+         particleSystem->Update(deltaTime, glm::vec3(node->GetWorldMatrix()[3]));
+      },
+      1);
 }
 
 Scene::~Scene() { Clear(); }
@@ -175,83 +189,51 @@ bool Scene::RemoveNode(const Node* const node) {
    return parent ? parent->RemoveChild(node) : false;
 }
 
-bool Scene::RemoveNode(const std::string_view name) {
+bool Scene::RemoveNode(const StringId name) {
    if (const Node* const node = FindNode(name)) {
       return RemoveNode(node);
    }
    return false;
 }
 
-Node* Scene::FindNode(const std::string_view name) const {
-   const std::string nameStr{name};
-   if (const auto it = m_nodeRegistry.find(nameStr); it != m_nodeRegistry.end()) {
+bool Scene::RemoveNode(const NodeHandle handle) { return RemoveNode(Resolve(handle)); }
+
+Node* Scene::FindNode(const StringId name) const {
+   if (const auto it = m_nodeRegistry.find(name); it != m_nodeRegistry.end()) {
       return it->second;
    }
    return nullptr;
 }
 
-std::vector<Node*> Scene::FindNodes(const std::string_view name) const {
+std::vector<Node*> Scene::FindNodes(const StringId name) const {
    std::vector<Node*> result;
-   const std::string nameStr{name};
-   const auto range = m_nodeRegistry.equal_range(nameStr);
+   const auto range = m_nodeRegistry.equal_range(name);
    std::ranges::transform(std::ranges::subrange(range.first, range.second),
                           std::back_inserter(result), [](const auto& pair) { return pair.second; });
    return result;
 }
 
-void Scene::ForEachNode(const std::function<void(Node*)>& func) {
-   if (!func || !m_rootNode)
-      return;
-   std::queue<Node*> queue;
-   queue.push(m_rootNode.get());
-   while (!queue.empty()) {
-      Node* const current = queue.front();
-      queue.pop();
-      func(current);
-      for (Node* const child : current->GetChildrenRaw()) {
-         queue.push(child);
-      }
-   }
-}
-
-void Scene::ForEachNode(const std::function<void(const Node*)>& func) const {
-   if (!func || !m_rootNode)
-      return;
-   std::queue<const Node*> queue;
-   queue.push(m_rootNode.get());
-   while (!queue.empty()) {
-      const Node* const current = queue.front();
-      queue.pop();
-      func(current);
-      for (const auto& child : current->GetChildren()) {
-         queue.push(child.get());
-      }
-   }
-}
-
 void Scene::UpdateTransforms() {
-   if (m_rootNode) {
-      m_rootNode->UpdateWorldTransform(true);
+   if (m_transformHierarchy) {
+      m_transformHierarchy->Update();
    }
 }
 
 void Scene::UpdateScene(const float deltaTime) {
    UpdateTransforms();
-   // TODO: Add component updates
-   ForEachNode([deltaTime](Node* node) {
-      auto particleComponent = node->GetComponent<ParticleSystemComponent>();
-      if (particleComponent) {
-         particleComponent->Update(deltaTime, node->GetWorldTransform()->GetPosition());
-      }
-   });
+   m_systemScheduler->Run(*m_componentRegistry, m_transformHierarchy.get(), deltaTime);
 }
 
 void Scene::Clear() {
    m_nodeRegistry.clear();
    if (m_rootNode) {
-      m_rootNode->RemoveAllChildren();
+      // Invalidate every handle and pooled component at once instead of node by node
+      m_componentRegistry->Clear();
+      m_rootNode->ResetChildren();
    }
    m_nodeCounter = 0;
+   // Hand the chunks of the destroyed nodes back instead of keeping them for the next scene
+   NodeAllocator::Trim();
 }
 
 size_t Scene::GetNodeCount() const noexcept { return m_nodeRegistry.size(); }
@@ -260,7 +242,8 @@ void Scene::SetName(std::string name) { m_name = std::move(name); }
 
 void Scene::RegisterNode(const Node* const node) {
    if (node) {
-      m_nodeRegistry.emplace(node->GetName(), const_cast<Node*>(node));
+      // Names are interned here, lookups by name only hash their query
+      m_nodeRegistry.emplace(StringId::Intern(node->GetName()), const_cast<Node*>(node));
    }
 }
 
@@ -268,7 +251,7 @@ void Scene::UnregisterNode(const Node* const node) {
    if (!node)
       return;
    // Remove all entries with this node pointer
-   const auto range = m_nodeRegistry.equal_range(node->GetName());
+   const auto range = m_nodeRegistry.equal_range(StringId(node->GetName()));
    for (auto it = range.first; it != range.second;) {
       if (it->second == node) {
          it = m_nodeRegistry.erase(it);
@@ -277,7 +260,7 @@ void Scene::UnregisterNode(const Node* const node) {
       }
    }
    // Also unregister all children
-   for (const Node* const child : node->GetChildrenRaw()) {
+   for (const Node* child = node->GetFirstChild(); child; child = child->GetNextSibling()) {
       UnregisterNode(child);
    }
 }
@@ -286,8 +269,8 @@ size_t Scene::CalculateMaxDepth(const Node* const node, const size_t currentDept
    if (!node)
       return currentDepth;
    size_t maxDepth = currentDepth;
-   for (const auto& child : node->GetChildren()) {
-      const size_t childDepth = CalculateMaxDepth(child.get(), currentDepth + 1);
+   for (const Node* child = node->GetFirstChild(); child; child = child->GetNextSibling()) {
+      const size_t childDepth = CalculateMaxDepth(child, currentDepth + 1);
       maxDepth = std::max(maxDepth, childDepth);
    }
    return maxDepth;
@@ -1,17 +1,24 @@
 #pragma once
 
-#include <functional>
+#include "core/StringId.hpp"
+#include "core/scene/ComponentRegistry.hpp"
+#include "core/scene/Node.hpp"
+#include "core/scene/SystemScheduler.hpp"
+
 #include <unordered_map>
 #include <vector>
 #include <memory>
 #include <string>
+#include <utility>
 
-class Node;
 class MaterialEditor;
+class ThreadPool;
+class TransformHierarchy;
 
 class Scene final {
   public:
-   explicit Scene(const std::string name = "Scene");
+   // Parallel transform and system updates run on threadPool, which must outlive the scene
+   explicit Scene(ThreadPool& threadPool, const std::string name = "Scene");
    ~Scene();
 
    Scene(const Scene&) = delete;
@@ -22,6 +29,22 @@ class Scene final {
    void DrawInspector(MaterialEditor& matEditor);
 
    [[nodiscard]] constexpr Node* GetRootNode() const noexcept { return m_rootNode.get(); }
+   [[nodiscard]] constexpr TransformHierarchy* GetTransformHierarchy() const noexcept {
+      return m_transformHierarchy.get();
+   }
+   [[nodiscard]] constexpr ComponentRegistry* GetComponentRegistry() const noexcept {
+      return m_componentRegistry.get();
+   }
+   // Component update systems run by UpdateScene()
+   [[nodiscard]] constexpr SystemScheduler* GetSystemScheduler() const noexcept {
+      return m_systemScheduler.get();
+   }
+
+   // Nodes owning all of Ts, e.g. for (auto [node, renderer] : View<RendererComponent>())
+   template <ComponentType... Ts>
+   [[nodiscard]] ComponentView<Ts...> View() const noexcept {
+      return m_componentRegistry->View<Ts...>();
+   }
 
    // Node management with names for quick lookup
    [[nodiscard]] Node* CreateNode(const std::string_view name = {});
@@ -30,15 +53,30 @@ class Scene final {
                                        const std::string_view childName = {});
    [[nodiscard]] bool AddNode(const std::unique_ptr<Node> node, Node* parent = nullptr);
    [[nodiscard]] bool RemoveNode(const Node* node);
-   [[nodiscard]] bool RemoveNode(const std::string_view name);
+   [[nodiscard]] bool RemoveNode(const StringId name);
+   [[nodiscard]] bool RemoveNode(const NodeHandle handle);
+
+   // Handle lookup, stale handles resolve to nullptr
+   [[nodiscard]] constexpr Node* Resolve(const NodeHandle handle) const noexcept {
+      return m_componentRegistry->Resolve(handle);
+   }
+   [[nodiscard]] constexpr bool IsValid(const NodeHandle handle) const noexcept {
+      return Resolve(handle) != nullptr;
+   }
 
    // Node lookup
-   [[nodiscard]] Node* FindNode(const std::string_view name) const;
-   [[nodiscard]] std::vector<Node*> FindNodes(const std::string_view name) const;
+   [[nodiscard]] Node* FindNode(const StringId name) const;
+   [[nodiscard]] std::vector<Node*> FindNodes(const StringId name) const;
 
-   // Scene traversal and operations
-   void ForEachNode(const std::function<void(Node*)>& func);
-   void ForEachNode(const std::function<void(const Node*)>& func) const;
+   // Pre-order traversal from the root, allocation free (see Node::Traverse)
+   template <typename Func>
+   void ForEachNode(Func&& func, const bool skipInactive = false) {
+      m_rootNode->Traverse(std::forward<Func>(func), skipInactive);
+   }
+   template <typename Func>
+   void ForEachNode(Func&& func, const bool skipInactive = false) const {
+      std::as_const(*m_rootNode).Traverse(std::forward<Func>(func), skipInactive);
+   }
 
    // Update systems
    void UpdateTransforms();
@@ -59,7 +97,11 @@ class Scene final {
 
   private:
    std::string m_name;
+   // Declared before the root so nodes are destroyed while these are still alive
+   std::unique_ptr<TransformHierarchy> m_transformHierarchy;
+   std::unique_ptr<ComponentRegistry> m_componentRegistry;
    std::unique_ptr<Node> m_rootNode;
-   std::unordered_multimap<std::string, Node*> m_nodeRegistry;
+   std::unique_ptr<SystemScheduler> m_systemScheduler;
+   std::unordered_multimap<StringId, Node*> m_nodeRegistry;
    size_t m_nodeCounter;
 };
@@ -0,0 +1,585 @@
+#include "core/scene/SceneSnapshot.hpp"
+
+#include "core/Vertex.hpp"
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/Node.hpp"
+#include "core/scene/Scene.hpp"
+#include "core/scene/components/LightComponent.hpp"
+#include "core/scene/components/ParticleSystemComponent.hpp"
+#include "core/scene/components/RendererComponent.hpp"
+#include "core/scene/components/TransformComponent.hpp"
+#include "core/system/MappedFile.hpp"
+
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr std::array<char, 8> MAGIC{'S', 'C', 'N', 'S', 'N', 'A', 'P', '\0'};
+constexpr uint32_t NONE = UINT32_MAX;
+// Keeps every record array aligned for in-place access, mapped files start page aligned
+constexpr uint64_t SECTION_ALIGNMENT = 16;
+
+enum class Section : uint32_t {
+   Strings,
+   Textures,
+   Materials,
+   MaterialParams,
+   MaterialTextures,
+   Meshes,
+   Vertices,
+   Indices,
+   Nodes,
+   Renderers,
+   Lights,
+   Particles,
+   Count
+};
+
+// Slice of the string section, strings are not null terminated
+struct StringRef final {
+   uint32_t offset;
+   uint32_t length;
+};
+
+struct SectionRange final {
+   uint64_t offset;
+   // In records, not bytes
+   uint64_t count;
+};
+
+struct FileHeader final {
+   std::array<char, 8> magic;
+   uint32_t version;
+   uint32_t layout;
+   // Caller supplied hash of whatever the scene was built from, see SceneSnapshot::Load()
+   uint64_t contentKey;
+   StringRef sceneName;
+   std::array<SectionRange, static_cast<size_t>(Section::Count)> sections;
+};
+
+struct TextureRecord final {
+   StringRef name;
+   StringRef filepath;
+   uint32_t generateMipmaps;
+   uint32_t sRGB;
+};
+
+struct MaterialRecord final {
+   StringRef name;
+   StringRef templateName;
+   uint32_t firstParam;
+   uint32_t paramCount;
+   uint32_t firstTexture;
+   uint32_t textureCount;
+};
+
+struct MaterialParamRecord final {
+   StringRef name;
+   // Index of the alternative held by the MaterialParam variant
+   uint32_t type;
+   std::array<std::byte, sizeof(glm::mat4)> value;
+};
+
+struct MaterialTextureRecord final {
+   StringRef slot;
+   StringRef texture;
+};
+
+struct MeshRecord final {
+   StringRef name;
+   uint32_t firstVertex;
+   uint32_t vertexCount;
+   uint32_t firstIndex;
+   uint32_t indexCount;
+};
+
+// Stored in pre-order, so a node's parent always comes before it
+struct NodeRecord final {
+   StringRef name;
+   // NONE for children of the scene root
+   uint32_t parent;
+   uint32_t active;
+   uint32_t hasTransform;
+   glm::vec3 position;
+   glm::quat rotation;
+   glm::vec3 scale;
+};
+
+struct RendererRecord final {
+   uint32_t node;
+   StringRef mesh;
+   StringRef material;
+   uint32_t visible;
+   uint32_t castsShadows;
+   uint32_t receivesShadows;
+};
+
+struct LightRecord final {
+   uint32_t node;
+   uint32_t type;
+   glm::vec3 color;
+   float intensity;
+   float constant;
+   float linear;
+   float quadratic;
+   float innerCone;
+   float outerCone;
+   uint32_t castsShadows;
+};
+
+struct ParticleRecord final {
+   uint32_t node;
+   uint32_t maxParticles;
+   uint32_t emissionEnabled;
+   ParticleSystemComponent::EmissionSettings emission;
+   ParticleSystemComponent::PhysicsSettings physics;
+   ParticleSystemComponent::RenderSettings render;
+};
+
+template <typename... Ts>
+constexpr uint32_t HashLayout() noexcept {
+   static_assert((std::is_trivially_copyable_v<Ts> && ...));
+   // FNV-1a over the record sizes, catches builds whose record layouts differ
+   uint32_t hash = 2166136261u;
+   ((hash = (hash ^ static_cast<uint32_t>(sizeof(Ts))) * 16777619u), ...);
+   return hash;
+}
+
+constexpr uint32_t LAYOUT =
+   HashLayout<FileHeader, TextureRecord, MaterialRecord, MaterialParamRecord,
+              MaterialTextureRecord, MeshRecord, Vertex, NodeRecord, RendererRecord, LightRecord,
+              ParticleRecord>();
+
+[[nodiscard]] MaterialParamRecord PackParam(const StringRef name, const MaterialParam& param) {
+   MaterialParamRecord record{.name = name,
+                              .type = static_cast<uint32_t>(param.index()),
+                              .value = {}};
+   std::visit(
+      [&record](const auto& value) {
+         static_assert(sizeof(value) <= sizeof(record.value));
+         std::memcpy(record.value.data(), &value, sizeof(value));
+      },
+      param);
+   return record;
+}
+
+template <size_t... I>
+[[nodiscard]] MaterialParam UnpackParam(const MaterialParamRecord& record,
+                                        std::index_sequence<I...>) {
+   MaterialParam param;
+   const bool known = ((record.type == I ? (param.emplace<I>(), true) : false) || ...);
+   if (!known) [[unlikely]]
+      throw std::runtime_error("Scene snapshot has an unknown material parameter type");
+   std::visit([&record](auto& value) { std::memcpy(&value, record.value.data(), sizeof(value)); },
+              param);
+   return param;
+}
+
+// Collects records into per-section arrays, written out in one go by Write()
+class SnapshotWriter final {
+  public:
+   [[nodiscard]] StringRef Intern(const std::string_view string) {
+      if (const auto it = m_stringRefs.find(std::string{string}); it != m_stringRefs.end())
+         return it->second;
+      const StringRef ref{.offset = static_cast<uint32_t>(m_strings.size()),
+                          .length = static_cast<uint32_t>(string.size())};
+      m_strings.append(string);
+      m_stringRefs.emplace(std::string{string}, ref);
+      return ref;
+   }
+
+   void Write(const std::filesystem::path& filepath, const uint64_t contentKey,
+              const StringRef sceneName) const {
+      FileHeader header{.magic = MAGIC,
+                        .version = SceneSnapshot::VERSION,
+                        .layout = LAYOUT,
+                        .contentKey = contentKey,
+                        .sceneName = sceneName,
+                        .sections = {}};
+      std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+      if (!file)
+         throw std::runtime_error("Failed to open " + filepath.string() + " for writing");
+      // Header goes last, once every section offset is known
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      WriteSection(file, header, Section::Strings, std::span<const char>(m_strings));
+      WriteSection(file, header, Section::Textures, std::span(textures));
+      WriteSection(file, header, Section::Materials, std::span(materials));
+      WriteSection(file, header, Section::MaterialParams, std::span(materialParams));
+      WriteSection(file, header, Section::MaterialTextures, std::span(materialTextures));
+      WriteSection(file, header, Section::Meshes, std::span(meshes));
+      WriteSection(file, header, Section::Vertices, std::span(vertices));
+      WriteSection(file, header, Section::Indices, std::span(indices));
+      WriteSection(file, header, Section::Nodes, std::span(nodes));
+      WriteSection(file, header, Section::Renderers, std::span(renderers));
+      WriteSection(file, header, Section::Lights, std::span(lights));
+      WriteSection(file, header, Section::Particles, std::span(particles));
+      file.seekp(0);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      if (!file)
+         throw std::runtime_error("Failed to write " + filepath.string());
+   }
+
+  private:
+   template <typename T>
+   static void WriteSection(std::ofstream& file, FileHeader& header, const Section section,
+                            const std::span<const T> records) {
+      static constexpr std::array<char, SECTION_ALIGNMENT> PADDING{};
+      const uint64_t position = static_cast<uint64_t>(file.tellp());
+      const uint64_t offset = (position + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+      file.write(PADDING.data(), static_cast<std::streamsize>(offset - position));
+      file.write(reinterpret_cast<const char*>(records.data()),
+                 static_cast<std::streamsize>(records.size_bytes()));
+      header.sections[static_cast<size_t>(section)] = {.offset = offset, .count = records.size()};
+   }
+
+  public:
+   std::vector<TextureRecord> textures;
+   std::vector<MaterialRecord> materials;
+   std::vector<MaterialParamRecord> materialParams;
+   std::vector<MaterialTextureRecord> materialTextures;
+   std::vector<MeshRecord> meshes;
+   std::vector<Vertex> vertices;
+   std::vector<uint32_t> indices;
+   std::vector<NodeRecord> nodes;
+   std::vector<RendererRecord> renderers;
+   std::vector<LightRecord> lights;
+   std::vector<ParticleRecord> particles;
+
+  private:
+   std::string m_strings;
+   std::unordered_map<std::string, StringRef> m_stringRefs;
+};
+
+// Bounds-checked, zero-copy access to the records of a mapped snapshot
+class SnapshotReader final {
+  public:
+   SnapshotReader(const std::span<const std::byte> data, const FileHeader& header)
+       : m_data(data), m_header(header) {
+      const std::span<const char> strings = GetSection<char>(Section::Strings);
+      m_strings = std::string_view(strings.data(), strings.size());
+   }
+
+   template <typename T>
+   [[nodiscard]] std::span<const T> GetSection(const Section section) const {
+      const SectionRange& range = m_header.sections[static_cast<size_t>(section)];
+      if (range.count == 0)
+         return {};
+      if (range.offset % alignof(T) != 0 || range.offset > m_data.size() ||
+          range.count > (m_data.size() - range.offset) / sizeof(T)) [[unlikely]] {
+         throw std::runtime_error("Scene snapshot section is out of bounds");
+      }
+      return {reinterpret_cast<const T*>(m_data.data() + range.offset),
+              static_cast<size_t>(range.count)};
+   }
+
+   [[nodiscard]] std::string_view GetString(const StringRef ref) const {
+      if (ref.offset > m_strings.size() || ref.length > m_strings.size() - ref.offset)
+         [[unlikely]] {
+         throw std::runtime_error("Scene snapshot string is out of bounds");
+      }
+      return m_strings.substr(ref.offset, ref.length);
+   }
+
+   template <typename T>
+   [[nodiscard]] static std::span<const T> Slice(const std::span<const T> records,
+                                                 const uint32_t first, const uint32_t count) {
+      if (first > records.size() || count > records.size() - first) [[unlikely]]
+         throw std::runtime_error("Scene snapshot record range is out of bounds");
+      return records.subspan(first, count);
+   }
+
+  private:
+   std::span<const std::byte> m_data;
+   const FileHeader& m_header;
+   std::string_view m_strings;
+};
+
+[[nodiscard]] Node* GetRecordNode(const std::vector<Node*>& nodes, const uint32_t index) {
+   if (index >= nodes.size()) [[unlikely]]
+      throw std::runtime_error("Scene snapshot component refers to a missing node");
+   return nodes[index];
+}
+
+} // namespace
+
+void SceneSnapshot::Save(const Scene& scene, const ResourceManager& resourceManager,
+                         const std::filesystem::path& filepath, const uint64_t contentKey) {
+   SnapshotWriter writer;
+   std::unordered_map<const Node*, uint32_t> nodeIndices;
+   std::vector<MeshHandle> meshes;
+   std::vector<MaterialHandle> materials;
+   std::unordered_set<uint64_t> seenResources;
+   const Node* const root = scene.GetRootNode();
+   const auto resourceName = [&](const uint64_t id) {
+      return writer.Intern(resourceManager.GetResourceName(id).GetString());
+   };
+
+   scene.ForEachNode([&](const Node* const node) {
+      if (node == root)
+         return;
+      const uint32_t index = static_cast<uint32_t>(writer.nodes.size());
+      nodeIndices.emplace(node, index);
+      NodeRecord record{.name = writer.Intern(node->GetName()),
+                        .parent = node->GetParent() == root ? NONE
+                                                            : nodeIndices.at(node->GetParent()),
+                        .active = node->IsActive(),
+                        .hasTransform = false,
+                        .position = glm::vec3(0.0f),
+                        .rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+                        .scale = glm::vec3(1.0f)};
+      if (const auto* const transform = node->GetComponent<TransformComponent>()) {
+         const Transform& local = transform->GetTransform();
+         record.hasTransform = true;
+         record.position = local.GetPosition();
+         record.rotation = local.GetRotation();
+         record.scale = local.GetScale();
+      }
+      writer.nodes.push_back(record);
+
+      for (const RendererComponent* const renderer : node->GetComponents<RendererComponent>()) {
+         const MeshHandle mesh = renderer->GetMesh();
+         const MaterialHandle material = renderer->GetMaterial();
+         writer.renderers.push_back(
+            {.node = index,
+             .mesh = mesh.IsValid() ? resourceName(mesh.GetId()) : StringRef{},
+             .material = material.IsValid() ? resourceName(material.GetId()) : StringRef{},
+             .visible = renderer->IsVisible(),
+             .castsShadows = renderer->CastsShadows(),
+             .receivesShadows = renderer->ReceivesShadows()});
+         if (mesh.IsValid() && seenResources.insert(mesh.GetId()).second)
+            meshes.push_back(mesh);
+         if (material.IsValid() && seenResources.insert(material.GetId()).second)
+            materials.push_back(material);
+      }
+      for (const LightComponent* const light : node->GetComponents<LightComponent>()) {
+         writer.lights.push_back({.node = index,
+                                  .type = static_cast<uint32_t>(light->GetType()),
+                                  .color = light->GetColor(),
+                                  .intensity = light->GetIntensity(),
+                                  .constant = light->GetConstant(),
+                                  .linear = light->GetLinear(),
+                                  .quadratic = light->GetQuadratic(),
+                                  .innerCone = light->GetInnerCone(),
+                                  .outerCone = light->GetOuterCone(),
+                                  .castsShadows = light->GetCastsShadows()});
+      }
+      for (ParticleSystemComponent* const particles :
+           node->GetComponents<ParticleSystemComponent>()) {
+         writer.particles.push_back({.node = index,
+                                     .maxParticles = particles->GetMaxParticles(),
+                                     .emissionEnabled = particles->IsEmissionEnabled(),
+                                     .emission = particles->GetEmissionSettings(),
+                                     .physics = particles->GetPhysicsSettings(),
+                                     .render = particles->GetRenderSettings()});
+      }
+   });
+
+   // Geometry is only available for meshes whose CPU copy was retained
+   for (const MeshHandle& mesh : meshes) {
+      const MeshLoader::MeshData* const data = resourceManager.GetMeshData(mesh);
+      if (!data)
+         continue;
+      writer.meshes.push_back({.name = resourceName(mesh.GetId()),
+                               .firstVertex = static_cast<uint32_t>(writer.vertices.size()),
+                               .vertexCount = static_cast<uint32_t>(data->vertices.size()),
+                               .firstIndex = static_cast<uint32_t>(writer.indices.size()),
+                               .indexCount = static_cast<uint32_t>(data->indices.size())});
+      writer.vertices.insert(writer.vertices.end(), data->vertices.begin(), data->vertices.end());
+      writer.indices.insert(writer.indices.end(), data->indices.begin(), data->indices.end());
+   }
+
+   std::vector<TextureHandle> textures;
+   for (const MaterialHandle& handle : materials) {
+      const IMaterial* const material = resourceManager.GetMaterial(handle);
+      const MaterialTemplate* const materialTemplate =
+         material ? resourceManager.GetMaterialTemplate(StringId(material->GetTemplateName()))
+                  : nullptr;
+      if (!materialTemplate)
+         continue;
+      MaterialRecord record{.name = resourceName(handle.GetId()),
+                            .templateName = writer.Intern(materialTemplate->GetName()),
+                            .firstParam = static_cast<uint32_t>(writer.materialParams.size()),
+                            .paramCount = 0,
+                            .firstTexture = static_cast<uint32_t>(writer.materialTextures.size()),
+                            .textureCount = 0};
+      for (const auto& [name, descriptor] : materialTemplate->GetParameters()) {
+         writer.materialParams.push_back(
+            PackParam(writer.Intern(name.GetString()), material->GetParameter(name)));
+         ++record.paramCount;
+      }
+      for (const auto& [slot, descriptor] : materialTemplate->GetTextures()) {
+         const TextureHandle texture = material->GetTexture(slot);
+         if (!texture.IsValid())
+            continue;
+         writer.materialTextures.push_back(
+            {.slot = writer.Intern(slot.GetString()), .texture = resourceName(texture.GetId())});
+         ++record.textureCount;
+         if (seenResources.insert(texture.GetId()).second)
+            textures.push_back(texture);
+      }
+      writer.materials.push_back(record);
+   }
+
+   // Textures created in code (defaults, render targets) are referenced by name only
+   for (const TextureHandle& texture : textures) {
+      const ResourceManager::TextureSource source = resourceManager.GetTextureSource(texture);
+      if (source.filepath.empty())
+         continue;
+      writer.textures.push_back({.name = resourceName(texture.GetId()),
+                                 .filepath = writer.Intern(source.filepath),
+                                 .generateMipmaps = source.generateMipmaps,
+                                 .sRGB = source.sRGB});
+   }
+
+   // Write next to the target and swap it in, so a failed save never leaves a partial file
+   if (filepath.has_parent_path())
+      std::filesystem::create_directories(filepath.parent_path());
+   std::filesystem::path tempPath = filepath;
+   tempPath += ".tmp";
+   writer.Write(tempPath, contentKey, writer.Intern(scene.GetName()));
+   std::filesystem::rename(tempPath, filepath);
+}
+
+bool SceneSnapshot::Load(const std::filesystem::path& filepath, Scene& scene,
+                         ResourceManager& resourceManager, const uint64_t contentKey) {
+   if (!std::filesystem::exists(filepath))
+      return false;
+   const MappedFile file(filepath);
+   const std::span<const std::byte> data = file.GetData();
+   if (data.size() < sizeof(FileHeader))
+      throw std::runtime_error(filepath.string() + " is not a scene snapshot");
+   FileHeader header;
+   std::memcpy(&header, data.data(), sizeof(header));
+   if (header.magic != MAGIC)
+      throw std::runtime_error(filepath.string() + " is not a scene snapshot");
+   if (header.version != VERSION || header.layout != LAYOUT || header.contentKey != contentKey)
+      return false;
+   const SnapshotReader reader(data, header);
+
+   // Resources first, anything already loaded under the same name is reused
+   for (const TextureRecord& record : reader.GetSection<TextureRecord>(Section::Textures)) {
+      const std::string_view name = reader.GetString(record.name);
+      if (resourceManager.GetTextureHandle(StringId(name)).IsValid())
+         continue;
+      resourceManager.LoadTexture(name, reader.GetString(record.filepath),
+                                  record.generateMipmaps != 0, record.sRGB != 0);
+   }
+
+   const auto params = reader.GetSection<MaterialParamRecord>(Section::MaterialParams);
+   const auto materialTextures =
+      reader.GetSection<MaterialTextureRecord>(Section::MaterialTextures);
+   for (const MaterialRecord& record : reader.GetSection<MaterialRecord>(Section::Materials)) {
+      const std::string_view name = reader.GetString(record.name);
+      if (resourceManager.GetMaterialHandle(StringId(name)).IsValid())
+         continue;
+      const MaterialHandle handle =
+         resourceManager.CreateMaterial(name, reader.GetString(record.templateName));
+      IMaterial* const material = resourceManager.GetMaterial(handle);
+      if (!material) [[unlikely]]
+         continue;
+      for (const MaterialParamRecord& param :
+           SnapshotReader::Slice(params, record.firstParam, record.paramCount)) {
+         material->SetParameter(
+            StringId(reader.GetString(param.name)),
+            UnpackParam(param, std::make_index_sequence<std::variant_size_v<MaterialParam>>{}));
+      }
+      for (const MaterialTextureRecord& texture :
+           SnapshotReader::Slice(materialTextures, record.firstTexture, record.textureCount)) {
+         material->SetTexture(
+            StringId(reader.GetString(texture.slot)),
+            resourceManager.GetTextureHandle(StringId(reader.GetString(texture.texture))));
+      }
+   }
+
+   const auto vertices = reader.GetSection<Vertex>(Section::Vertices);
+   const auto indices = reader.GetSection<uint32_t>(Section::Indices);
+   for (const MeshRecord& record : reader.GetSection<MeshRecord>(Section::Meshes)) {
+      const std::string_view name = reader.GetString(record.name);
+      if (resourceManager.GetMeshHandle(StringId(name)).IsValid())
+         continue;
+      // Uploaded straight from the mapping
+      resourceManager.LoadMesh(
+         name, SnapshotReader::Slice(vertices, record.firstVertex, record.vertexCount),
+         SnapshotReader::Slice(indices, record.firstIndex, record.indexCount));
+   }
+
+   const auto nodeRecords = reader.GetSection<NodeRecord>(Section::Nodes);
+   std::vector<Node*> nodes;
+   nodes.reserve(nodeRecords.size());
+   for (const NodeRecord& record : nodeRecords) {
+      if (record.parent != NONE && record.parent >= nodes.size()) [[unlikely]]
+         throw std::runtime_error("Scene snapshot node comes before its parent");
+      Node* const parent = record.parent == NONE ? scene.GetRootNode() : nodes[record.parent];
+      Node* node = nullptr;
+      if (record.hasTransform) {
+         node = scene.CreateChildNode(parent, reader.GetString(record.name));
+         Transform& local = node->GetComponent<TransformComponent>()->GetMutableTransform();
+         local.SetPosition(record.position);
+         local.SetRotation(record.rotation);
+         local.SetScale(record.scale);
+      } else {
+         // CreateChildNode() always adds a transform, the saved node had none
+         auto bare = std::make_unique<Node>(std::string{reader.GetString(record.name)});
+         node = bare.get();
+         if (!scene.AddNode(std::move(bare), parent)) [[unlikely]]
+            throw std::runtime_error("Failed to add scene snapshot node");
+      }
+      node->SetActive(record.active != 0);
+      nodes.push_back(node);
+   }
+
+   for (const RendererRecord& record : reader.GetSection<RendererRecord>(Section::Renderers)) {
+      const MeshHandle mesh =
+         record.mesh.length ? resourceManager.GetMeshHandle(StringId(reader.GetString(record.mesh)))
+                            : MeshHandle{};
+      const MaterialHandle material =
+         record.material.length
+            ? resourceManager.GetMaterialHandle(StringId(reader.GetString(record.material)))
+            : MaterialHandle{};
+      RendererComponent* const renderer =
+         GetRecordNode(nodes, record.node)->AddComponent<RendererComponent>(mesh, material);
+      renderer->SetVisible(record.visible != 0);
+      renderer->SetCastsShadows(record.castsShadows != 0);
+      renderer->SetReceivesShadows(record.receivesShadows != 0);
+   }
+
+   for (const LightRecord& record : reader.GetSection<LightRecord>(Section::Lights)) {
+      LightComponent* const light =
+         GetRecordNode(nodes, record.node)->AddComponent<LightComponent>();
+      light->SetType(static_cast<LightComponent::LightType>(record.type));
+      light->SetColor(record.color);
+      light->SetIntensity(record.intensity);
+      light->SetConstant(record.constant);
+      light->SetLinear(record.linear);
+      light->SetQuadratic(record.quadratic);
+      light->SetInnerCone(record.innerCone);
+      light->SetOuterCone(record.outerCone);
+      light->SetCastsShadows(record.castsShadows != 0);
+   }
+
+   for (const ParticleRecord& record : reader.GetSection<ParticleRecord>(Section::Particles)) {
+      ParticleSystemComponent* const particles =
+         GetRecordNode(nodes, record.node)
+            ->AddComponent<ParticleSystemComponent>(record.maxParticles);
+      particles->SetEmissionSettings(record.emission);
+      particles->SetPhysicsSettings(record.physics);
+      particles->SetRenderSettings(record.render);
+      particles->SetEmissionEnabled(record.emissionEnabled != 0);
+   }
+
+   scene.SetName(std::string{reader.GetString(header.sceneName)});
+   return true;
+}
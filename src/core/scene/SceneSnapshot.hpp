@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+class ResourceManager;
+class Scene;
+
+// Binary dump of a scene's node tree, transforms, renderer/light/particle components and the
+// resources they reference. Every section is an aligned array of fixed-size records, so loading
+// maps the file and walks the arrays in place: mesh geometry is uploaded straight from the
+// mapping and nothing is decoded besides the texture images themselves.
+// Snapshots are tied to the build's record layout and meant as a load cache, not an exchange
+// format; files from another version are rejected rather than converted.
+class SceneSnapshot final {
+  public:
+   // Bump whenever a record changes meaning, older files are then treated as missing
+   static constexpr uint32_t VERSION = 2;
+
+   // Saves every node below the root. Mesh geometry is only written for meshes loaded while
+   // ResourceManager::SetRetainMeshData() was on, other resources are stored by name and must
+   // exist again when loading. contentKey identifies what the scene was built from and is
+   // checked again by Load().
+   static void Save(const Scene& scene, const ResourceManager& resourceManager,
+                    const std::filesystem::path& filepath, const uint64_t contentKey);
+
+   // Appends the snapshot's nodes below the scene root, creating resources that are not loaded
+   // yet. Returns false if the file is missing, from another version or saved with another
+   // contentKey, throws std::runtime_error if it is damaged.
+   [[nodiscard]] static bool Load(const std::filesystem::path& filepath, Scene& scene,
+                                  ResourceManager& resourceManager, const uint64_t contentKey);
+};
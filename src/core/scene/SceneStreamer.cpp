@@ -0,0 +1,390 @@
+#include "core/scene/SceneStreamer.hpp"
+
+#include "core/ThreadPool.hpp"
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/MeshLoaderHelper.hpp"
+#include "core/scene/Node.hpp"
+#include "core/scene/Scene.hpp"
+#include "core/scene/components/RendererComponent.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <ranges>
+
+namespace {
+
+// Mip chains add a third on top of the base level
+constexpr size_t TextureBytes(const ImageData& image, const bool generateMipmaps) noexcept {
+   const size_t bytes = image.GetSizeBytes();
+   return generateMipmaps ? bytes + bytes / 3 : bytes;
+}
+
+constexpr size_t MeshBytes(const MeshLoader::MeshData& mesh) noexcept {
+   return mesh.vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(uint32_t);
+}
+
+}  // namespace
+
+SceneStreamer::SceneStreamer(Scene& scene, ResourceManager& resourceManager,
+                             const Settings& settings)
+    : m_scene(&scene),
+      m_resourceManager(&resourceManager),
+      m_settings(settings),
+      m_rootNode(scene.CreateNode("streamed_cells")),
+      m_threadPool(std::make_unique<ThreadPool>(std::max(settings.maxConcurrentLoads, 1u))) {
+   m_stats.budgetBytes = m_settings.memoryBudgetBytes;
+}
+
+SceneStreamer::~SceneStreamer() { m_threadPool->WaitForAll(); }
+
+uint32_t SceneStreamer::AddCell(StreamingCellDesc desc) {
+   m_cells.push_back({.desc = std::move(desc)});
+   return static_cast<uint32_t>(m_cells.size() - 1);
+}
+
+void SceneStreamer::SetSettings(const Settings& settings) noexcept {
+   // The worker count is fixed, so this only limits how many loads are started
+   m_settings = settings;
+   m_stats.budgetBytes = m_settings.memoryBudgetBytes;
+}
+
+void SceneStreamer::Update(const glm::vec3& viewerPosition) {
+   ++m_updateIndex;
+   ReleaseResources();
+   for (Cell& cell : m_cells) {
+      const glm::vec3 closest =
+         glm::clamp(viewerPosition, cell.desc.boundsMin, cell.desc.boundsMax);
+      cell.distance = glm::length(viewerPosition - closest);
+   }
+   // Nearest first, so uploads and new loads go to whatever the viewer will reach first
+   m_order.resize(m_cells.size());
+   std::iota(m_order.begin(), m_order.end(), 0u);
+   std::ranges::sort(m_order, {},
+                     [this](const uint32_t index) { return m_cells[index].distance; });
+   CollectLoadedCells();
+   const auto uploadStart = std::chrono::high_resolution_clock::now();
+   UploadCells();
+   const auto uploadEnd = std::chrono::high_resolution_clock::now();
+   RequestCells();
+   // Cells within the radius may have pushed usage over the budget, make room if possible
+   if (GetCommittedBytes() > m_settings.memoryBudgetBytes)
+      (void)MakeRoom(0);
+   // Stats
+   m_stats.cellCount = static_cast<uint32_t>(m_cells.size());
+   m_stats.residentCells = 0;
+   m_stats.loadingCells = 0;
+   m_stats.stalledCells = 0;
+   m_stats.bytesInFlight = 0;
+   for (const Cell& cell : m_cells) {
+      switch (cell.state) {
+         case CellState::Resident:
+            ++m_stats.residentCells;
+            break;
+         case CellState::Loading:
+            ++m_stats.loadingCells;
+            m_stats.bytesInFlight += cell.estimatedBytes;
+            break;
+         case CellState::Uploading:
+            ++m_stats.loadingCells;
+            m_stats.bytesInFlight += cell.payload ? cell.payload->bytes : 0;
+            break;
+         case CellState::Unloaded:
+         case CellState::Failed:
+            break;
+      }
+      if (cell.distance <= m_settings.loadRadius && cell.state != CellState::Resident &&
+          cell.state != CellState::Failed) {
+         ++m_stats.stalledCells;
+      }
+   }
+   if (m_stats.stalledCells > 0)
+      ++m_stats.stallUpdates;
+   m_stats.residentBytes = m_residentBytes;
+   m_stats.uploadMs = std::chrono::duration<float, std::milli>(uploadEnd - uploadStart).count();
+}
+
+void SceneStreamer::CollectLoadedCells() {
+   std::vector<std::pair<uint32_t, std::unique_ptr<CellPayload>>> loaded;
+   {
+      std::lock_guard lock(m_loadedMutex);
+      loaded.swap(m_loadedCells);
+   }
+   for (auto& [index, payload] : loaded) {
+      Cell& cell = m_cells[index];
+      if (!payload || payload->sceneData.IsEmpty()) {
+         cell.state = CellState::Failed;
+         continue;
+      }
+      cell.payload = std::move(payload);
+      cell.estimatedBytes = cell.payload->bytes;
+      cell.nextTexture = 0;
+      cell.state = CellState::Uploading;
+   }
+}
+
+void SceneStreamer::UploadCells() {
+   size_t budget = m_settings.uploadBytesPerUpdate;
+   for (const uint32_t index : m_order) {
+      Cell& cell = m_cells[index];
+      if (cell.state != CellState::Uploading)
+         continue;
+      if (!UploadCell(cell, budget))
+         return;
+   }
+}
+
+bool SceneStreamer::UploadCell(Cell& cell, size_t& budget) {
+   // Anything fits into an untouched budget, otherwise one oversized item would block forever
+   const auto consume = [this, &budget](const size_t bytes) {
+      if (bytes > budget && budget < m_settings.uploadBytesPerUpdate)
+         return false;
+      budget -= std::min(bytes, budget);
+      return true;
+   };
+   CellPayload& payload = *cell.payload;
+   const auto& textures = cell.desc.textures;
+   while (cell.nextTexture < textures.size()) {
+      const ImageData& image = payload.images[cell.nextTexture];
+      const size_t bytes = TextureBytes(image, textures[cell.nextTexture].generateMipmaps);
+      if (!consume(bytes))
+         return false;
+      (void)AcquireTexture(textures[cell.nextTexture], image);
+      cell.acquiredTextures.emplace_back(textures[cell.nextTexture].name);
+      payload.images[cell.nextTexture] = {};
+      payload.bytes -= std::min(bytes, payload.bytes);
+      ++cell.nextTexture;
+   }
+   if (!consume(payload.meshBytes))
+      return false;
+   std::vector<MaterialHandle> materials;
+   materials.reserve(cell.desc.materials.size());
+   for (const StreamingMaterialDesc& material : cell.desc.materials) {
+      materials.push_back(AcquireMaterial(material));
+      cell.acquiredMaterials.emplace_back(material.name);
+   }
+   // Mesh names are prefixed with the cell's, so cells loading the same file do not collide
+   const MeshLoaderHelper::MeshLoadOptions options{.meshPrefix = cell.desc.name + "/"};
+   cell.node = MeshLoaderHelper::InstantiateSceneData(*m_scene, m_rootNode, *m_resourceManager,
+                                                      cell.desc.name, payload.sceneData, options,
+                                                      materials);
+   cell.payload.reset();
+   if (!cell.node) {
+      cell.state = CellState::Failed;
+      return true;
+   }
+   Transform* const transform = cell.node->GetTransform();
+   transform->SetPosition(cell.desc.transform.GetPosition());
+   transform->SetRotation(cell.desc.transform.GetRotation());
+   transform->SetScale(cell.desc.transform.GetScale());
+   cell.meshes.clear();
+   cell.meshBytes = 0;
+   cell.node->Traverse([this, &cell](const Node* node) {
+      if (const auto* renderer = node->GetComponent<RendererComponent>(); renderer) {
+         if (const IMesh* mesh = m_resourceManager->GetMesh(renderer->GetMesh()); mesh) {
+            cell.meshes.push_back(renderer->GetMesh());
+            cell.meshBytes += mesh->GetMemoryUsage();
+         }
+      }
+   });
+   m_residentBytes += cell.meshBytes;
+   cell.state = CellState::Resident;
+   return true;
+}
+
+void SceneStreamer::RequestCells() {
+   uint32_t activeLoads = static_cast<uint32_t>(
+      std::ranges::count(m_cells, CellState::Loading, &Cell::state));
+   for (const uint32_t index : m_order) {
+      if (activeLoads >= m_settings.maxConcurrentLoads)
+         return;
+      Cell& cell = m_cells[index];
+      // Sorted by distance, nothing after this one is needed either
+      if (cell.distance > m_settings.loadRadius)
+         return;
+      if (cell.state != CellState::Unloaded)
+         continue;
+      // Reloading before the old resources are gone would hand out names about to be unloaded
+      if (std::ranges::find(m_pendingReleases, index, &PendingRelease::cellIndex) !=
+          m_pendingReleases.end())
+         continue;
+      if (!MakeRoom(cell.estimatedBytes))
+         return;
+      StartLoad(index);
+      ++activeLoads;
+   }
+}
+
+void SceneStreamer::StartLoad(const uint32_t cellIndex) {
+   Cell& cell = m_cells[cellIndex];
+   cell.state = CellState::Loading;
+   // Textures already resident are not decoded again, the upload finds them by name
+   std::vector<StreamingTextureDesc> textures;
+   textures.reserve(cell.desc.textures.size());
+   for (const StreamingTextureDesc& texture : cell.desc.textures) {
+      textures.push_back(texture);
+      if (m_resourceManager->GetTextureHandle(StringId(texture.name)).IsValid())
+         textures.back().filepath.clear();
+   }
+   m_threadPool->Submit([this, cellIndex, modelFilepath = cell.desc.modelFilepath,
+                         textures = std::move(textures)]() {
+      auto payload = std::make_unique<CellPayload>();
+      try {
+         payload->sceneData = MeshLoader::LoadScene(modelFilepath);
+         for (const MeshLoader::MeshData& mesh : payload->sceneData.meshes)
+            payload->meshBytes += MeshBytes(mesh);
+         payload->bytes = payload->meshBytes;
+         payload->images.reserve(textures.size());
+         for (const StreamingTextureDesc& texture : textures) {
+            ImageData& image = payload->images.emplace_back();
+            if (!texture.filepath.empty())
+               image = ImageData::LoadFromFile(texture.filepath);
+            payload->bytes += TextureBytes(image, texture.generateMipmaps);
+         }
+      } catch (const std::exception&) {
+         payload.reset();
+      }
+      std::lock_guard lock(m_loadedMutex);
+      m_loadedCells.emplace_back(cellIndex, std::move(payload));
+   });
+}
+
+bool SceneStreamer::MakeRoom(const size_t requiredBytes) {
+   // Order is nearest first, so walking it backwards finds the farthest cells first
+   for (const uint32_t index : m_order | std::views::reverse) {
+      if (GetCommittedBytes() + requiredBytes <= m_settings.memoryBudgetBytes)
+         return true;
+      Cell& cell = m_cells[index];
+      if (cell.distance > m_settings.loadRadius &&
+          (cell.state == CellState::Resident || cell.state == CellState::Uploading)) {
+         EvictCell(cell);
+      }
+   }
+   return GetCommittedBytes() + requiredBytes <= m_settings.memoryBudgetBytes;
+}
+
+void SceneStreamer::EvictCell(Cell& cell) {
+   const uint32_t cellIndex = static_cast<uint32_t>(&cell - m_cells.data());
+   if (cell.node)
+      (void)m_scene->RemoveNode(cell.node);
+   PendingRelease release{.releaseUpdate = m_updateIndex + m_settings.releaseDelay,
+                          .cellIndex = cellIndex,
+                          .meshes = std::move(cell.meshes),
+                          .meshBytes = cell.meshBytes};
+   m_pendingReleaseBytes += cell.meshBytes;
+   for (const StringId name : cell.acquiredMaterials)
+      ReleaseShared(m_materials, name);
+   for (const StringId name : cell.acquiredTextures)
+      ReleaseShared(m_textures, name);
+   release.materials = std::move(cell.acquiredMaterials);
+   release.textures = std::move(cell.acquiredTextures);
+   m_pendingReleases.push_back(std::move(release));
+   cell.node = nullptr;
+   cell.meshes.clear();
+   cell.meshBytes = 0;
+   cell.acquiredMaterials.clear();
+   cell.acquiredTextures.clear();
+   cell.payload.reset();
+   cell.state = CellState::Unloaded;
+   ++m_stats.evictedCells;
+}
+
+void SceneStreamer::ReleaseResources() {
+   const auto unloadUnused = [this](std::unordered_map<StringId, SharedResource>& resources,
+                                    const StringId name, const bool isTexture) {
+      const auto it = resources.find(name);
+      // Acquired again by another cell in the meantime
+      if (it == resources.end() || it->second.users > 0)
+         return;
+      if (it->second.owned) {
+         if (isTexture)
+            m_resourceManager->UnloadTexture(name);
+         else
+            m_resourceManager->UnloadMaterial(name);
+         m_residentBytes -= std::min(it->second.bytes, m_residentBytes);
+         m_pendingReleaseBytes -= std::min(it->second.bytes, m_pendingReleaseBytes);
+      }
+      resources.erase(it);
+   };
+   std::erase_if(m_pendingReleases, [&](PendingRelease& release) {
+      if (release.releaseUpdate > m_updateIndex)
+         return false;
+      for (const MeshHandle& mesh : release.meshes)
+         m_resourceManager->UnloadMesh(mesh);
+      m_residentBytes -= std::min(release.meshBytes, m_residentBytes);
+      m_pendingReleaseBytes -= std::min(release.meshBytes, m_pendingReleaseBytes);
+      // Materials first, they reference the textures
+      for (const StringId name : release.materials)
+         unloadUnused(m_materials, name, false);
+      for (const StringId name : release.textures)
+         unloadUnused(m_textures, name, true);
+      return true;
+   });
+}
+
+TextureHandle SceneStreamer::AcquireTexture(const StreamingTextureDesc& desc,
+                                            const ImageData& image) {
+   const StringId name{desc.name};
+   SharedResource& shared = AcquireShared(m_textures, name);
+   TextureHandle handle = m_resourceManager->GetTextureHandle(name);
+   // Decoding failed, materials fall back to their defaults for this slot
+   if (handle.IsValid() || image.IsEmpty())
+      return handle;
+   handle = m_resourceManager->CreateTextureFromImage(desc.name, image, desc.generateMipmaps,
+                                                      desc.sRGB, desc.filepath);
+   if (const ITexture* texture = m_resourceManager->GetTexture(handle); texture) {
+      shared.owned = true;
+      shared.bytes = texture->GetMemoryUsage();
+      m_residentBytes += shared.bytes;
+   }
+   return handle;
+}
+
+MaterialHandle SceneStreamer::AcquireMaterial(const StreamingMaterialDesc& desc) {
+   const StringId name{desc.name};
+   SharedResource& shared = AcquireShared(m_materials, name);
+   MaterialHandle handle = m_resourceManager->GetMaterialHandle(name);
+   if (handle.IsValid())
+      return handle;
+   handle = m_resourceManager->CreateMaterial(desc.name, desc.templateName);
+   if (IMaterial* const material = m_resourceManager->GetMaterial(handle); material) {
+      shared.owned = true;
+      for (const auto& [slot, textureName] : desc.textures) {
+         const TextureHandle texture = m_resourceManager->GetTextureHandle(StringId(textureName));
+         if (texture.IsValid())
+            material->SetTexture(StringId(slot), texture);
+      }
+   }
+   return handle;
+}
+
+SceneStreamer::SharedResource& SceneStreamer::AcquireShared(
+   std::unordered_map<StringId, SharedResource>& resources, const StringId name) {
+   SharedResource& shared = resources[name];
+   // Picked up again before its release delay passed, so it will not be freed after all
+   if (shared.users++ == 0 && shared.owned)
+      m_pendingReleaseBytes -= std::min(shared.bytes, m_pendingReleaseBytes);
+   return shared;
+}
+
+void SceneStreamer::ReleaseShared(std::unordered_map<StringId, SharedResource>& resources,
+                                  const StringId name) noexcept {
+   const auto it = resources.find(name);
+   if (it == resources.end() || it->second.users == 0)
+      return;
+   if (--it->second.users == 0 && it->second.owned)
+      m_pendingReleaseBytes += it->second.bytes;
+}
+
+size_t SceneStreamer::GetCommittedBytes() const noexcept {
+   // Evicted resources still occupy memory for a few updates but are already paid for, counting
+   // them would make every MakeRoom() call evict further cells
+   size_t bytes = m_residentBytes - std::min(m_pendingReleaseBytes, m_residentBytes);
+   for (const Cell& cell : m_cells) {
+      if (cell.state == CellState::Loading)
+         bytes += cell.estimatedBytes;
+      else if (cell.state == CellState::Uploading && cell.payload)
+         bytes += cell.payload->bytes;
+   }
+   return bytes;
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "core/StringId.hpp"
+#include "core/Transform.hpp"
+#include "core/resource/IMaterial.hpp"
+#include "core/resource/IMesh.hpp"
+#include "core/resource/ImageData.hpp"
+#include "core/resource/MeshLoader.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Node;
+class ResourceManager;
+class Scene;
+class ThreadPool;
+
+struct StreamingTextureDesc final {
+   std::string name;
+   std::string filepath;
+   bool generateMipmaps{true};
+   bool sRGB{true};
+};
+
+struct StreamingMaterialDesc final {
+   std::string name;
+   std::string templateName{"PBR"};
+   // Texture slot name, texture name
+   std::vector<std::pair<std::string, std::string>> textures{};
+};
+
+// One spatial cell of a streamed world: a model loaded through MeshLoaderHelper plus the
+// textures and materials it uses. Textures and materials are shared by name between cells and
+// with anything loaded outside the streamer; only the ones the streamer created get unloaded.
+struct StreamingCellDesc final {
+   std::string name;
+   std::string modelFilepath;
+   // Applied to the cell's root node
+   Transform transform;
+   // World space, the viewer's distance to these bounds decides when the cell is needed
+   glm::vec3 boundsMin{0.0f};
+   glm::vec3 boundsMax{0.0f};
+   std::vector<StreamingTextureDesc> textures{};
+   // Indexed by the model's material index
+   std::vector<StreamingMaterialDesc> materials{};
+};
+
+struct StreamingStats final {
+   uint32_t cellCount{0};
+   uint32_t residentCells{0};
+   // Decoding on a worker or waiting for upload
+   uint32_t loadingCells{0};
+   // Within the load radius but not resident, i.e. the viewer can see a hole
+   uint32_t stalledCells{0};
+   uint32_t evictedCells{0};
+   uint64_t stallUpdates{0};
+   size_t residentBytes{0};
+   size_t bytesInFlight{0};
+   size_t budgetBytes{0};
+   float uploadMs{0.0f};
+};
+
+// Partitions a world into cells that are loaded as the viewer approaches and evicted under a
+// memory budget. Workers parse models and decode textures; Update() then creates the GPU
+// resources and nodes on the calling thread, at most uploadBytesPerUpdate per call, so a cell
+// becoming ready never stalls a frame for long. When the budget is exceeded the farthest cells
+// outside the load radius are evicted; their nodes leave the scene immediately but resources
+// are unloaded only after releaseDelay updates, since frames in flight may still use them.
+class SceneStreamer final {
+  public:
+   struct Settings final {
+      // Cells whose bounds are closer than this are requested and never evicted
+      float loadRadius{60.0f};
+      // GPU memory all streamed meshes and textures together may occupy
+      size_t memoryBudgetBytes{size_t{2} << 30};
+      size_t uploadBytesPerUpdate{size_t{64} << 20};
+      // Also the worker thread count, fixed at construction
+      uint32_t maxConcurrentLoads{2};
+      uint32_t releaseDelay{3};
+   };
+
+   SceneStreamer(Scene& scene, ResourceManager& resourceManager, const Settings& settings);
+   // Waits for outstanding loads, resident cells stay in the scene
+   ~SceneStreamer();
+
+   SceneStreamer(const SceneStreamer&) = delete;
+   SceneStreamer& operator=(const SceneStreamer&) = delete;
+   SceneStreamer(SceneStreamer&&) = delete;
+   SceneStreamer& operator=(SceneStreamer&&) = delete;
+
+   uint32_t AddCell(StreamingCellDesc desc);
+
+   // Call once per frame on the thread owning the graphics context, before the scene update
+   void Update(const glm::vec3& viewerPosition);
+
+   // Radius and budgets apply from the next Update()
+   void SetSettings(const Settings& settings) noexcept;
+   [[nodiscard]] constexpr const Settings& GetSettings() const noexcept { return m_settings; }
+   [[nodiscard]] constexpr const StreamingStats& GetStats() const noexcept { return m_stats; }
+   // Parent of every cell's node
+   [[nodiscard]] constexpr Node* GetRootNode() const noexcept { return m_rootNode; }
+
+  private:
+   enum class CellState : uint8_t { Unloaded, Loading, Uploading, Resident, Failed };
+
+   // What a worker produces for one cell
+   struct CellPayload final {
+      MeshLoader::SceneData sceneData;
+      // Parallel to the cell's textures, empty where the texture was resident when requested
+      std::vector<ImageData> images;
+      size_t meshBytes{0};
+      // Not uploaded yet, shrinks as textures are created
+      size_t bytes{0};
+   };
+
+   struct Cell final {
+      StreamingCellDesc desc;
+      CellState state{CellState::Unloaded};
+      float distance{0.0f};
+      std::unique_ptr<CellPayload> payload{};
+      // Upload progress, textures go one by one, the model in a single step after them
+      size_t nextTexture{0};
+      std::vector<StringId> acquiredTextures{};
+      std::vector<StringId> acquiredMaterials{};
+      Node* node{nullptr};
+      std::vector<MeshHandle> meshes{};
+      size_t meshBytes{0};
+      // Payload size of the last load, 0 until the cell was loaded once
+      size_t estimatedBytes{0};
+   };
+
+   // Shared textures and materials, keyed by resource name
+   struct SharedResource final {
+      uint32_t users{0};
+      // Created by the streamer, so it is unloaded once unused
+      bool owned{false};
+      size_t bytes{0};
+   };
+
+   struct PendingRelease final {
+      uint64_t releaseUpdate;
+      uint32_t cellIndex;
+      std::vector<MeshHandle> meshes{};
+      size_t meshBytes;
+      std::vector<StringId> materials{};
+      std::vector<StringId> textures{};
+   };
+
+   void CollectLoadedCells();
+   void UploadCells();
+   // Returns false if the upload budget ran out before the cell was complete
+   [[nodiscard]] bool UploadCell(Cell& cell, size_t& budget);
+   void RequestCells();
+   void StartLoad(const uint32_t cellIndex);
+   // Evicts the farthest cells outside the load radius until required bytes fit the budget,
+   // bytes of evicted cells count as freed even while their release is still pending
+   [[nodiscard]] bool MakeRoom(const size_t requiredBytes);
+   void EvictCell(Cell& cell);
+   // Unloads what evicted cells left behind once their release delay passed
+   void ReleaseResources();
+
+   TextureHandle AcquireTexture(const StreamingTextureDesc& desc, const ImageData& image);
+   MaterialHandle AcquireMaterial(const StreamingMaterialDesc& desc);
+   [[nodiscard]] SharedResource& AcquireShared(
+      std::unordered_map<StringId, SharedResource>& resources, const StringId name);
+   void ReleaseShared(std::unordered_map<StringId, SharedResource>& resources,
+                      const StringId name) noexcept;
+
+   [[nodiscard]] size_t GetCommittedBytes() const noexcept;
+
+  private:
+   Scene* m_scene;
+   ResourceManager* m_resourceManager;
+   Settings m_settings;
+   Node* m_rootNode{nullptr};
+   std::vector<Cell> m_cells;
+   // Scratch for nearest-first ordering, reused every update
+   std::vector<uint32_t> m_order;
+   std::unordered_map<StringId, SharedResource> m_textures;
+   std::unordered_map<StringId, SharedResource> m_materials;
+   std::vector<PendingRelease> m_pendingReleases;
+   size_t m_residentBytes{0};
+   // Part of m_residentBytes that evicted cells will free once their release delay passed
+   size_t m_pendingReleaseBytes{0};
+   uint64_t m_updateIndex{0};
+   StreamingStats m_stats{};
+
+   std::mutex m_loadedMutex;
+   // Payloads workers finished by cell index, guarded by m_loadedMutex
+   std::vector<std::pair<uint32_t, std::unique_ptr<CellPayload>>> m_loadedCells;
+   // Last member, so workers are joined before anything they touch is destroyed
+   std::unique_ptr<ThreadPool> m_threadPool;
+};
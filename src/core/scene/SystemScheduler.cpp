@@ -0,0 +1,138 @@
+#include "core/scene/SystemScheduler.hpp"
+
+#include "core/ThreadPool.hpp"
+#include "core/scene/TransformHierarchy.hpp"
+#include "core/scene/components/TransformComponent.hpp"
+
+#include <chrono>
+
+bool ISceneSystem::ConflictsWith(const ISceneSystem& other) const noexcept {
+   // Shared reads are fine, anything written by one side must be untouched by the other
+   for (const uint32_t typeId : m_writes) {
+      if (other.Reads(typeId) || other.Writes(typeId))
+         return true;
+   }
+   for (const uint32_t typeId : other.m_writes) {
+      if (Reads(typeId))
+         return true;
+   }
+   return false;
+}
+
+SystemScheduler::SystemScheduler(ThreadPool& threadPool) : m_threadPool(threadPool) {}
+
+SystemScheduler::~SystemScheduler() = default;
+
+ISceneSystem* SystemScheduler::AddSystem(std::unique_ptr<ISceneSystem> system) {
+   if (!system) [[unlikely]]
+      return nullptr;
+   ISceneSystem* const systemPtr = system.get();
+   m_systems.push_back(std::move(system));
+   m_stagesDirty = true;
+   return systemPtr;
+}
+
+void SystemScheduler::RemoveSystem(const StringId name) {
+   if (std::erase_if(m_systems, [name](const auto& system) { return system->GetName() == name; })) {
+      m_stagesDirty = true;
+   }
+}
+
+void SystemScheduler::BuildStages() {
+   m_systemStages.assign(m_systems.size(), 0);
+   m_stageCount = 0;
+   for (size_t i = 0; i < m_systems.size(); ++i) {
+      // Run after every earlier system this one conflicts with, keeping registration order
+      uint32_t stage = 0;
+      for (size_t j = 0; j < i; ++j) {
+         if (m_systems[i]->ConflictsWith(*m_systems[j])) {
+            stage = std::max(stage, m_systemStages[j] + 1);
+         }
+      }
+      m_systemStages[i] = stage;
+      m_stageCount = std::max(m_stageCount, static_cast<size_t>(stage) + 1);
+   }
+   m_timings.resize(m_systems.size());
+   for (size_t i = 0; i < m_systems.size(); ++i) {
+      m_timings[i].name = m_systems[i]->GetName();
+   }
+   m_stagesDirty = false;
+}
+
+void SystemScheduler::Run(const ComponentRegistry& registry, TransformHierarchy* const hierarchy,
+                          const float deltaTime) {
+   const auto updateStart = std::chrono::high_resolution_clock::now();
+   if (m_stagesDirty) {
+      BuildStages();
+   }
+   const bool parallel = m_executionMode == ExecutionMode::Parallel;
+   const uint32_t transformTypeId = GetComponentTypeId<TransformComponent>();
+   for (uint32_t stage = 0; stage < m_stageCount; ++stage) {
+      m_tasks.clear();
+      bool writesTransforms = false;
+      for (uint32_t i = 0; i < m_systems.size(); ++i) {
+         if (m_systemStages[i] != stage)
+            continue;
+         ISceneSystem& system = *m_systems[i];
+         // Gathered per stage, so earlier stages' component changes are visible
+         system.Gather(registry);
+         const size_t entityCount = system.GetEntityCount();
+         m_timings[i].entityCount = static_cast<uint32_t>(entityCount);
+         m_timings[i].cpuTimeMs = 0.0f;
+         const bool ownsTransforms = system.Writes(transformTypeId);
+         writesTransforms |= ownsTransforms;
+         if (entityCount == 0)
+            continue;
+         size_t taskCount = 1;
+         if (parallel && !ownsTransforms) {
+            const size_t minPerTask = system.GetMinEntitiesPerTask();
+            taskCount = std::min(m_threadPool.GetThreadCount(),
+                                 (entityCount + minPerTask - 1) / minPerTask);
+         }
+         const size_t entitiesPerTask = (entityCount + taskCount - 1) / taskCount;
+         for (size_t begin = 0; begin < entityCount; begin += entitiesPerTask) {
+            m_tasks.push_back({
+               .system = i,
+               .begin = begin,
+               .end = std::min(begin + entitiesPerTask, entityCount),
+            });
+         }
+      }
+      RunTasks(deltaTime);
+      if (writesTransforms && hierarchy) {
+         // Later stages may read world matrices, resolve them before any task can
+         hierarchy->Refresh();
+      }
+   }
+   const auto updateEnd = std::chrono::high_resolution_clock::now();
+   m_lastUpdateMs = std::chrono::duration<float, std::milli>(updateEnd - updateStart).count();
+}
+
+void SystemScheduler::RunTasks(const float deltaTime) {
+   m_taskNanoseconds.assign(m_tasks.size(), 0);
+   if (m_executionMode == ExecutionMode::Parallel && m_tasks.size() > 1) {
+      ThreadPool::TaskGroup group;
+      for (size_t taskIndex = 0; taskIndex < m_tasks.size(); ++taskIndex) {
+         m_threadPool.Submit(group,
+                             [this, taskIndex, deltaTime]() { RunTask(taskIndex, deltaTime); });
+      }
+      m_threadPool.Wait(group);
+   } else {
+      for (size_t taskIndex = 0; taskIndex < m_tasks.size(); ++taskIndex) {
+         RunTask(taskIndex, deltaTime);
+      }
+   }
+   for (size_t taskIndex = 0; taskIndex < m_tasks.size(); ++taskIndex) {
+      m_timings[m_tasks[taskIndex].system].cpuTimeMs +=
+         static_cast<float>(m_taskNanoseconds[taskIndex]) / 1000000.0f;
+   }
+}
+
+void SystemScheduler::RunTask(const size_t taskIndex, const float deltaTime) noexcept {
+   const Task& task = m_tasks[taskIndex];
+   const auto taskStart = std::chrono::high_resolution_clock::now();
+   m_systems[task.system]->UpdateRange(task.begin, task.end, deltaTime);
+   const auto taskEnd = std::chrono::high_resolution_clock::now();
+   m_taskNanoseconds[taskIndex] = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(taskEnd - taskStart).count());
+}
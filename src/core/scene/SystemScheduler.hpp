@@ -0,0 +1,180 @@
+#pragma once
+
+#include "core/StringId.hpp"
+#include "core/scene/ComponentRegistry.hpp"
+#include "core/system/PerformanceMetrics.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class ThreadPool;
+class TransformHierarchy;
+
+// Component types may be const-qualified to declare read-only access
+template <typename T>
+concept SystemComponentType = ComponentType<std::remove_const_t<T>>;
+
+// Update pass over a set of entities. The component types it reads and writes are declared up
+// front so the scheduler knows which systems may run at the same time.
+class ISceneSystem {
+  public:
+   virtual ~ISceneSystem() = default;
+
+   ISceneSystem(const ISceneSystem&) = delete;
+   ISceneSystem& operator=(const ISceneSystem&) = delete;
+
+   // Snapshot the matching entities, called on the scheduling thread before any task starts
+   virtual void Gather(const ComponentRegistry& registry) = 0;
+   [[nodiscard]] virtual size_t GetEntityCount() const noexcept = 0;
+   // Update snapshot entries [begin, end), concurrent calls never get overlapping ranges
+   virtual void UpdateRange(const size_t begin, const size_t end, const float deltaTime) = 0;
+
+   [[nodiscard]] constexpr StringId GetName() const noexcept { return m_name; }
+   [[nodiscard]] constexpr const std::vector<uint32_t>& GetReads() const noexcept {
+      return m_reads;
+   }
+   [[nodiscard]] constexpr const std::vector<uint32_t>& GetWrites() const noexcept {
+      return m_writes;
+   }
+   [[nodiscard]] constexpr size_t GetMinEntitiesPerTask() const noexcept {
+      return m_minEntitiesPerTask;
+   }
+
+   [[nodiscard]] bool Reads(const uint32_t typeId) const noexcept {
+      return std::ranges::find(m_reads, typeId) != m_reads.end();
+   }
+   [[nodiscard]] bool Writes(const uint32_t typeId) const noexcept {
+      return std::ranges::find(m_writes, typeId) != m_writes.end();
+   }
+   [[nodiscard]] bool ConflictsWith(const ISceneSystem& other) const noexcept;
+
+  protected:
+   ISceneSystem(const StringId name, const size_t minEntitiesPerTask) noexcept
+       : m_name(name), m_minEntitiesPerTask(std::max<size_t>(minEntitiesPerTask, 1)) {}
+
+   template <SystemComponentType T>
+   void DeclareAccess() {
+      const uint32_t typeId = GetComponentTypeId<std::remove_const_t<T>>();
+      if constexpr (std::is_const_v<T>) {
+         m_reads.push_back(typeId);
+      } else {
+         m_writes.push_back(typeId);
+      }
+   }
+
+  private:
+   StringId m_name;
+   std::vector<uint32_t> m_reads;
+   std::vector<uint32_t> m_writes;
+   size_t m_minEntitiesPerTask;
+};
+
+// Calls func(Node*, Ts*..., deltaTime) for every entity owning all of Ts
+template <typename Func, SystemComponentType... Ts>
+class ComponentSystem final : public ISceneSystem {
+  public:
+   ComponentSystem(const StringId name, Func func, const size_t minEntitiesPerTask)
+       : ISceneSystem(name, minEntitiesPerTask), m_func(std::move(func)) {
+      (DeclareAccess<Ts>(), ...);
+   }
+
+   void Gather(const ComponentRegistry& registry) override {
+      // Capacity is kept between updates, so steady-state frames do not allocate
+      m_entities.clear();
+      for (const auto entry : registry.View<std::remove_const_t<Ts>...>()) {
+         m_entities.emplace_back(entry);
+      }
+   }
+
+   [[nodiscard]] size_t GetEntityCount() const noexcept override { return m_entities.size(); }
+
+   void UpdateRange(const size_t begin, const size_t end, const float deltaTime) override {
+      for (size_t i = begin; i < end; ++i) {
+         std::apply([this, deltaTime](auto... args) { m_func(args..., deltaTime); },
+                    m_entities[i]);
+      }
+   }
+
+  private:
+   Func m_func;
+   std::vector<std::tuple<Node*, Ts*...>> m_entities;
+};
+
+// Runs scene systems once per update. Systems are packed into stages in registration order; a
+// system lands in the first stage after every earlier system it conflicts with, so systems
+// sharing a stage touch disjoint data and run together, each split into entity ranges across
+// the thread pool. Systems writing TransformComponent stay on one task because transform
+// changes are reported to the shared hierarchy; systems reading world matrices must declare
+// const TransformComponent so they never overlap with such a writer.
+class SystemScheduler final {
+  public:
+   enum class ExecutionMode : uint8_t { Serial, Parallel };
+
+   static constexpr size_t DEFAULT_MIN_ENTITIES_PER_TASK = 64;
+
+   // Parallel stages run on threadPool, which must outlive the scheduler
+   explicit SystemScheduler(ThreadPool& threadPool);
+   ~SystemScheduler();
+
+   SystemScheduler(const SystemScheduler&) = delete;
+   SystemScheduler& operator=(const SystemScheduler&) = delete;
+   SystemScheduler(SystemScheduler&&) = delete;
+   SystemScheduler& operator=(SystemScheduler&&) = delete;
+
+   ISceneSystem* AddSystem(std::unique_ptr<ISceneSystem> system);
+
+   template <SystemComponentType... Ts, typename Func>
+   ISceneSystem* AddSystem(const StringId name, Func&& func,
+                           const size_t minEntitiesPerTask = DEFAULT_MIN_ENTITIES_PER_TASK) {
+      return AddSystem(std::make_unique<ComponentSystem<std::decay_t<Func>, Ts...>>(
+         name, std::forward<Func>(func), minEntitiesPerTask));
+   }
+
+   void RemoveSystem(const StringId name);
+
+   // The hierarchy, if given, is refreshed after every stage that wrote transforms
+   void Run(const ComponentRegistry& registry, TransformHierarchy* hierarchy,
+            const float deltaTime);
+
+   constexpr void SetExecutionMode(const ExecutionMode mode) noexcept { m_executionMode = mode; }
+   [[nodiscard]] constexpr ExecutionMode GetExecutionMode() const noexcept {
+      return m_executionMode;
+   }
+
+   // Results of the last Run(), in registration order
+   [[nodiscard]] constexpr const std::vector<SystemTiming>& GetTimings() const noexcept {
+      return m_timings;
+   }
+   [[nodiscard]] constexpr float GetLastUpdateMs() const noexcept { return m_lastUpdateMs; }
+   [[nodiscard]] constexpr size_t GetSystemCount() const noexcept { return m_systems.size(); }
+   [[nodiscard]] constexpr size_t GetStageCount() const noexcept { return m_stageCount; }
+
+  private:
+   struct Task final {
+      uint32_t system;
+      size_t begin;
+      size_t end;
+   };
+
+   void BuildStages();
+   void RunTasks(const float deltaTime);
+   void RunTask(const size_t taskIndex, const float deltaTime) noexcept;
+
+  private:
+   std::vector<std::unique_ptr<ISceneSystem>> m_systems;
+   std::vector<uint32_t> m_systemStages;
+   size_t m_stageCount{0};
+   bool m_stagesDirty{false};
+   ExecutionMode m_executionMode{ExecutionMode::Parallel};
+   ThreadPool& m_threadPool;
+   // Scratch reused every update, each task writes only its own duration slot
+   std::vector<Task> m_tasks;
+   std::vector<uint64_t> m_taskNanoseconds;
+   std::vector<SystemTiming> m_timings;
+   float m_lastUpdateMs{0.0f};
+};
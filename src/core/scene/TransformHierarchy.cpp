@@ -0,0 +1,242 @@
+#include "core/scene/TransformHierarchy.hpp"
+
+#include "core/ThreadPool.hpp"
+#include "core/TransformBatch.hpp"
+#include "core/scene/Node.hpp"
+
+#include <algorithm>
+#include <utility>
+
+TransformHierarchy::TransformHierarchy(Node* const root, ThreadPool& threadPool)
+    : m_root(root), m_threadPool(threadPool) {
+   if (m_root) {
+      m_root->SetHierarchy(this);
+   }
+}
+
+TransformHierarchy::~TransformHierarchy() = default;
+
+void TransformHierarchy::Update() {
+   std::lock_guard lock(m_updateMutex);
+   UpdateLocked();
+}
+
+void TransformHierarchy::UpdateLocked() {
+   // Raised before the dirty state is taken, see NeedsRefresh()
+   m_updating.store(true, std::memory_order_release);
+   ++m_generation;
+   TakePendingDirty();
+   if (m_structureDirty.load(std::memory_order_acquire)) {
+      Rebuild();
+      UpdateAll();
+   } else if (m_mode == UpdateMode::Full) {
+      UpdateAll();
+   } else if (ShouldRunParallel(m_dirtySlots.size())) {
+      // Touching this many subtrees is cheaper as one parallel sweep
+      UpdateAll();
+   } else if (!m_dirtySlots.empty()) {
+      UpdateDirty();
+   }
+   m_dirtySlots.clear();
+   m_updating.store(false, std::memory_order_release);
+}
+
+void TransformHierarchy::Refresh() {
+   if (!NeedsRefresh()) [[likely]]
+      return;
+   std::lock_guard lock(m_updateMutex);
+   // Another thread may have updated while this one waited for the lock
+   if (NeedsRefresh())
+      UpdateLocked();
+}
+
+bool TransformHierarchy::NeedsRefresh() {
+   if (m_structureDirty.load(std::memory_order_acquire))
+      return true;
+   {
+      std::lock_guard lock(m_dirtyMutex);
+      if (!m_pendingDirtySlots.empty())
+         return true;
+   }
+   // Checked last: an update that already took the pending slots is still writing matrices
+   return m_updating.load(std::memory_order_acquire);
+}
+
+TransformUpdateStats TransformHierarchy::ConsumeUpdateStats() noexcept {
+   return std::exchange(m_stats, TransformUpdateStats{});
+}
+
+void TransformHierarchy::MarkDirty(const uint32_t index) {
+   if (index < m_nodes.size()) [[likely]] {
+      std::lock_guard lock(m_dirtyMutex);
+      m_pendingDirtySlots.push_back(index);
+   } else {
+      m_structureDirty = true;
+   }
+}
+
+void TransformHierarchy::OnTransformChanged(const uint32_t slot) noexcept {
+   std::lock_guard lock(m_dirtyMutex);
+   m_pendingDirtySlots.push_back(slot);
+}
+
+void TransformHierarchy::TakePendingDirty() {
+   // Swap keeps both buffers' capacity, m_dirtySlots was cleared by the previous update
+   std::lock_guard lock(m_dirtyMutex);
+   m_dirtySlots.swap(m_pendingDirtySlots);
+}
+
+void TransformHierarchy::Rebuild() {
+   m_nodes.clear();
+   m_parents.clear();
+   m_levelOffsets.clear();
+   if (m_root) {
+      // Breadth-first walk, the node array doubles as the queue
+      m_nodes.push_back(m_root);
+      m_parents.push_back(INVALID_INDEX);
+      m_levelOffsets.push_back(0);
+      size_t levelEnd = 1;
+      for (size_t i = 0; i < m_nodes.size(); ++i) {
+         if (i == levelEnd) {
+            m_levelOffsets.push_back(static_cast<uint32_t>(i));
+            levelEnd = m_nodes.size();
+         }
+         const Node* const node = m_nodes[i];
+         for (Node* child = node->GetFirstChild(); child; child = child->GetNextSibling()) {
+            m_nodes.push_back(child);
+            m_parents.push_back(static_cast<uint32_t>(i));
+         }
+      }
+      m_levelOffsets.push_back(static_cast<uint32_t>(m_nodes.size()));
+   }
+   const size_t count = m_nodes.size();
+   m_localSources.resize(count);
+   m_firstChildren.assign(count, 0);
+   m_childCounts.assign(count, 0);
+   m_localPositions.resize(count);
+   m_localRotations.resize(count);
+   m_localScales.resize(count);
+   m_localMatrices.resize(count);
+   m_worldMatrices.resize(count);
+   m_worldGenerations.assign(count, 0);
+   for (size_t i = 0; i < count; ++i) {
+      Node* const node = m_nodes[i];
+      node->m_hierarchyIndex = static_cast<uint32_t>(i);
+      Transform* const local = node->GetTransform();
+      if (local) {
+         local->SetListener(this, static_cast<uint32_t>(i));
+      }
+      m_localSources[i] = local;
+      // Children of a node are pushed consecutively in breadth-first order
+      if (const uint32_t parent = m_parents[i]; parent != INVALID_INDEX) {
+         if (m_childCounts[parent]++ == 0) {
+            m_firstChildren[parent] = static_cast<uint32_t>(i);
+         }
+      }
+   }
+   ++m_layoutVersion;
+   m_structureDirty.store(false, std::memory_order_release);
+}
+
+void TransformHierarchy::UpdateAll() {
+   const size_t count = m_nodes.size();
+   const bool parallel = ShouldRunParallel(count);
+   // Each level only reads the one above it, so a level is one batch (or several tasks)
+   for (size_t level = 0; level < GetLevelCount(); ++level) {
+      const size_t begin = m_levelOffsets[level];
+      const size_t end = m_levelOffsets[level + 1];
+      if (parallel) {
+         RecomputeLevelParallel(begin, end);
+      } else {
+         RecomputeRange(begin, end);
+      }
+   }
+   m_stats.nodesVisited += static_cast<uint32_t>(count);
+   m_stats.matricesRecomputed += static_cast<uint32_t>(count);
+}
+
+void TransformHierarchy::RecomputeLevelParallel(const size_t begin, const size_t end) {
+   const size_t levelSize = end - begin;
+   const size_t taskCount = std::min(m_threadPool.GetThreadCount(),
+                                     (levelSize + MIN_NODES_PER_TASK - 1) / MIN_NODES_PER_TASK);
+   if (taskCount <= 1) {
+      RecomputeRange(begin, end);
+      return;
+   }
+   const size_t nodesPerTask = (levelSize + taskCount - 1) / taskCount;
+   ThreadPool::TaskGroup group;
+   for (size_t taskBegin = begin; taskBegin < end; taskBegin += nodesPerTask) {
+      const size_t taskEnd = std::min(taskBegin + nodesPerTask, end);
+      m_threadPool.Submit(group,
+                          [this, taskBegin, taskEnd]() { RecomputeRange(taskBegin, taskEnd); });
+   }
+   m_threadPool.Wait(group);
+}
+
+void TransformHierarchy::UpdateDirty() {
+   // Ancestors sort before descendants, so a subtree already refreshed this update is skipped
+   std::ranges::sort(m_dirtySlots);
+   for (const uint32_t slot : m_dirtySlots) {
+      ++m_stats.nodesVisited;
+      if (slot >= m_nodes.size() || m_worldGenerations[slot] == m_generation)
+         continue;
+      RecomputeRange(slot, slot + 1);
+      ++m_stats.matricesRecomputed;
+      m_traversalStack.push_back(slot);
+      // Siblings are contiguous and share a resolved parent, so each family is one batch
+      while (!m_traversalStack.empty()) {
+         const uint32_t index = m_traversalStack.back();
+         m_traversalStack.pop_back();
+         const uint32_t first = m_firstChildren[index];
+         const uint32_t childCount = m_childCounts[index];
+         if (childCount == 0)
+            continue;
+         RecomputeRange(first, first + childCount);
+         m_stats.nodesVisited += childCount;
+         m_stats.matricesRecomputed += childCount;
+         for (uint32_t child = first; child < first + childCount; ++child) {
+            m_traversalStack.push_back(child);
+         }
+      }
+   }
+}
+
+void TransformHierarchy::RecomputeRange(const size_t begin, const size_t end) noexcept {
+   // Every parent of the range must already be resolved and lie outside of it
+   if (begin >= end)
+      return;
+   for (size_t i = begin; i < end; ++i) {
+      GatherLocal(i);
+   }
+   TransformBatch::ComposeTRS(&m_localPositions[begin], &m_localRotations[begin],
+                              &m_localScales[begin], &m_localMatrices[begin], end - begin);
+   size_t first = begin;
+   if (m_parents[first] == INVALID_INDEX) {
+      m_worldMatrices[first] = m_localMatrices[first];
+      ++first;
+   }
+   if (first < end) {
+      TransformBatch::MultiplyParentLocal(m_worldMatrices.data(), &m_parents[first],
+                                          &m_localMatrices[first], &m_worldMatrices[first],
+                                          end - first);
+   }
+   std::fill(m_worldGenerations.begin() + static_cast<std::ptrdiff_t>(begin),
+             m_worldGenerations.begin() + static_cast<std::ptrdiff_t>(end), m_generation);
+}
+
+void TransformHierarchy::GatherLocal(const size_t index) noexcept {
+   if (const Transform* const local = m_localSources[index]) [[likely]] {
+      m_localPositions[index] = local->GetPosition();
+      m_localRotations[index] = local->GetRotation();
+      m_localScales[index] = local->GetScale();
+      local->AcknowledgeChange();
+   } else {
+      m_localPositions[index] = glm::vec3(0.0f);
+      m_localRotations[index] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+      m_localScales[index] = glm::vec3(1.0f);
+   }
+}
+
+bool TransformHierarchy::ShouldRunParallel(const size_t workSize) const noexcept {
+   return m_executionMode == ExecutionMode::Parallel && workSize >= m_parallelThreshold;
+}
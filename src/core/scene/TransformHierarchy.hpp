@@ -0,0 +1,142 @@
+#pragma once
+
+#include "core/Transform.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+class Node;
+class ThreadPool;
+
+// Work counters, accumulated until consumed
+struct TransformUpdateStats final {
+   uint32_t nodesVisited{0};
+   uint32_t matricesRecomputed{0};
+};
+
+// Flat, depth-sorted transform store owned by the scene. Parents always precede their children,
+// so world matrices are resolved by a single linear sweep over contiguous arrays.
+class TransformHierarchy final : public ITransformListener {
+  public:
+   enum class UpdateMode : uint8_t {
+      Full,       // Recompute every node each update
+      Incremental // Recompute only subtrees whose local transform changed
+   };
+
+   enum class ExecutionMode : uint8_t {
+      Serial,
+      Parallel // Split each depth level across the scene's thread pool
+   };
+
+   static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+   static constexpr size_t DEFAULT_PARALLEL_THRESHOLD = 8192;
+   static constexpr size_t MIN_NODES_PER_TASK = 512;
+
+   TransformHierarchy(Node* root, ThreadPool& threadPool);
+   ~TransformHierarchy() override;
+
+   TransformHierarchy(const TransformHierarchy&) = delete;
+   TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+   TransformHierarchy(TransformHierarchy&&) = delete;
+   TransformHierarchy& operator=(TransformHierarchy&&) = delete;
+
+   // Resolve world matrices, rebuilding the flat layout first if the tree changed
+   void Update();
+   // Update only if something was invalidated since the last sweep. Safe to call from several
+   // worker threads at once, the first one updates and the others wait for it.
+   void Refresh();
+
+   void MarkStructureDirty() noexcept { m_structureDirty.store(true, std::memory_order_release); }
+   void MarkDirty(const uint32_t index);
+   void OnTransformChanged(const uint32_t slot) noexcept override;
+
+   constexpr void SetUpdateMode(const UpdateMode mode) noexcept { m_mode = mode; }
+   [[nodiscard]] constexpr UpdateMode GetUpdateMode() const noexcept { return m_mode; }
+
+   // Parallel sweeps only kick in once the hierarchy has at least `threshold` nodes
+   constexpr void SetExecutionMode(const ExecutionMode mode) noexcept { m_executionMode = mode; }
+   [[nodiscard]] constexpr ExecutionMode GetExecutionMode() const noexcept {
+      return m_executionMode;
+   }
+   constexpr void SetParallelThreshold(const size_t threshold) noexcept {
+      m_parallelThreshold = threshold;
+   }
+   [[nodiscard]] constexpr size_t GetParallelThreshold() const noexcept {
+      return m_parallelThreshold;
+   }
+
+   [[nodiscard]] const glm::mat4& GetWorldMatrix(const uint32_t index) const noexcept {
+      return m_worldMatrices[index];
+   }
+   // Update generation in which the slot's world matrix was last recomputed
+   [[nodiscard]] uint64_t GetWorldGeneration(const uint32_t index) const noexcept {
+      return m_worldGenerations[index];
+   }
+   // Returns the counters accumulated since the previous call and resets them
+   [[nodiscard]] TransformUpdateStats ConsumeUpdateStats() noexcept;
+   // Bumped by every rebuild, slot indices from an older layout are meaningless
+   [[nodiscard]] constexpr uint64_t GetLayoutVersion() const noexcept { return m_layoutVersion; }
+   [[nodiscard]] constexpr size_t GetSize() const noexcept { return m_nodes.size(); }
+   [[nodiscard]] constexpr size_t GetLevelCount() const noexcept {
+      return m_levelOffsets.empty() ? 0 : m_levelOffsets.size() - 1;
+   }
+   [[nodiscard]] std::span<const glm::mat4> GetWorldMatrices() const noexcept {
+      return m_worldMatrices;
+   }
+
+  private:
+   // Update() with m_updateMutex held
+   void UpdateLocked();
+   [[nodiscard]] bool NeedsRefresh();
+   void Rebuild();
+   void UpdateAll();
+   void UpdateDirty();
+   void TakePendingDirty();
+   void RecomputeLevelParallel(const size_t begin, const size_t end);
+   // Batch-compose [begin, end); parents must already be resolved and lie outside the range
+   void RecomputeRange(const size_t begin, const size_t end) noexcept;
+   void GatherLocal(const size_t index) noexcept;
+   [[nodiscard]] bool ShouldRunParallel(const size_t workSize) const noexcept;
+
+  private:
+   Node* m_root;
+   UpdateMode m_mode{UpdateMode::Incremental};
+   ExecutionMode m_executionMode{ExecutionMode::Serial};
+   size_t m_parallelThreshold{DEFAULT_PARALLEL_THRESHOLD};
+   ThreadPool& m_threadPool;
+   // Node order, parent links and level boundaries (level i spans [offsets[i], offsets[i+1]))
+   std::vector<Node*> m_nodes;
+   std::vector<const Transform*> m_localSources;
+   std::vector<uint32_t> m_parents;
+   std::vector<uint32_t> m_firstChildren;
+   std::vector<uint32_t> m_childCounts;
+   std::vector<uint32_t> m_levelOffsets;
+   // Local TRS and matrices, resolved world matrices
+   std::vector<glm::vec3> m_localPositions;
+   std::vector<glm::quat> m_localRotations;
+   std::vector<glm::vec3> m_localScales;
+   std::vector<glm::mat4> m_localMatrices;
+   std::vector<glm::mat4> m_worldMatrices;
+   std::vector<uint64_t> m_worldGenerations;
+   // Slots whose local transform changed since the last update. Setters may run on worker
+   // threads, so they append to the pending list under a lock and Update() takes it over
+   std::mutex m_dirtyMutex;
+   std::vector<uint32_t> m_pendingDirtySlots;
+   std::vector<uint32_t> m_dirtySlots;
+   std::vector<uint32_t> m_traversalStack;
+   // Serializes updates, set while one is running so Refresh() never reads half-written matrices
+   std::mutex m_updateMutex;
+   std::atomic<bool> m_updating{false};
+
+   TransformUpdateStats m_stats{};
+   uint64_t m_generation{0};
+   uint64_t m_layoutVersion{0};
+   std::atomic<bool> m_structureDirty{true};
+};
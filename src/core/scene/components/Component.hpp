@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
+#include <cstdint>
 
 class Node;
 
@@ -21,3 +23,15 @@ class Component {
 
 template <typename T>
 concept ComponentType = std::derived_from<T, Component>;
+
+// Dense per-type ids, assigned on first use, used to index component pools and lookups
+[[nodiscard]] inline uint32_t NextComponentTypeId() noexcept {
+   static std::atomic<uint32_t> s_nextTypeId{0};
+   return s_nextTypeId.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <ComponentType T>
+[[nodiscard]] uint32_t GetComponentTypeId() noexcept {
+   static const uint32_t s_typeId = NextComponentTypeId();
+   return s_typeId;
+}
@@ -1,5 +1,6 @@
 #include "core/scene/components/ParticleSystemComponent.hpp"
 
+#include "core/TransformBatch.hpp"
 #include "core/scene/Node.hpp"
 
 #include <imgui.h>
@@ -125,19 +126,34 @@ void ParticleSystemComponent::UpdateParticlesCombined(const float deltaTime) noe
 }
 
 void ParticleSystemComponent::UpdateInstanceData() noexcept {
-   uint32_t active = m_activeParticles.load(std::memory_order_acquire);
+   m_bounds = {};
+   const uint32_t active = m_activeParticles.load(std::memory_order_acquire);
    if (active == 0)
       return;
-   ParticleInstanceData* instBegin = m_instanceData.data();
-   Particle* pBegin = m_particles.data();
-   std::for_each(std::execution::par_unseq, instBegin, instBegin + active,
-                 [instBegin, pBegin](ParticleInstanceData& inst) {
-                    const size_t idx = &inst - instBegin;
-                    const Particle& p = pBegin[idx];
-                    inst.transform = glm::translate(glm::mat4(1.0f), p.position) *
-                                     glm::scale(glm::mat4(1.0f), glm::vec3(p.size));
-                    inst.color = p.color;
+   ParticleInstanceData* const instBegin = m_instanceData.data();
+   const Particle* const pBegin = m_particles.data();
+   BoundingBox* const boundsBegin = m_batchBounds.data();
+   const uint32_t batchCount = (active + INSTANCE_BATCH_SIZE - 1) / INSTANCE_BATCH_SIZE;
+   // Each batch feeds the SIMD kernel a contiguous run of interleaved particles
+   std::for_each(std::execution::par, m_instanceBatches.begin(),
+                 m_instanceBatches.begin() + batchCount,
+                 [instBegin, pBegin, boundsBegin, active](const uint32_t batchBegin) {
+                    const uint32_t batchEnd = std::min(batchBegin + INSTANCE_BATCH_SIZE, active);
+                    TransformBatch::ComposeTranslationScale(
+                       &pBegin[batchBegin].position, &pBegin[batchBegin].size, sizeof(Particle),
+                       &instBegin[batchBegin].transform, sizeof(ParticleInstanceData),
+                       batchEnd - batchBegin);
+                    BoundingBox bounds;
+                    for (uint32_t i = batchBegin; i < batchEnd; ++i) {
+                       instBegin[i].color = pBegin[i].color;
+                       // Quads span size in every direction around the particle
+                       bounds.Expand(pBegin[i].position - glm::vec3(pBegin[i].size));
+                       bounds.Expand(pBegin[i].position + glm::vec3(pBegin[i].size));
+                    }
+                    boundsBegin[batchBegin / INSTANCE_BATCH_SIZE] = bounds;
                  });
+   for (uint32_t i = 0; i < batchCount; ++i)
+      m_bounds.Expand(m_batchBounds[i]);
 }
 
 void ParticleSystemComponent::RemoveDeadParticlesSwap() noexcept {
@@ -187,5 +203,11 @@ float ParticleSystemComponent::InterpolateSize(const float t) const noexcept {
 void ParticleSystemComponent::ReallocateParticles() noexcept {
    m_particles.assign(m_maxParticles, {});
    m_instanceData.assign(m_maxParticles, {});
+   m_instanceBatches.clear();
+   for (uint32_t batchBegin = 0; batchBegin < m_maxParticles; batchBegin += INSTANCE_BATCH_SIZE) {
+      m_instanceBatches.push_back(batchBegin);
+   }
+   m_batchBounds.assign(m_instanceBatches.size(), {});
+   m_bounds = {};
    m_activeParticles.store(0, std::memory_order_release);
 }
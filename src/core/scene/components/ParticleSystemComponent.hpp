@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/Bounds.hpp"
 #include "core/scene/components/Component.hpp"
 
 #include <glm/glm.hpp>
@@ -64,6 +65,8 @@ class ParticleSystemComponent final : public Component {
       return m_instanceData;
    }
    [[nodiscard]] const std::vector<Particle>& GetParticles() const noexcept { return m_particles; }
+   // World space box around the live particles as of the last Update(), empty if there are none
+   [[nodiscard]] constexpr const BoundingBox& GetBounds() const noexcept { return m_bounds; }
 
    void SetMaxParticles(const uint32_t count) noexcept {
       m_maxParticles = count;
@@ -115,8 +118,13 @@ class ParticleSystemComponent final : public Component {
    EmissionSettings m_emissionSettings;
    PhysicsSettings m_physicsSettings;
    RenderSettings m_renderSettings;
-   // Instance data for rendering
+   // Instance data for rendering, rebuilt in batches of INSTANCE_BATCH_SIZE particles
+   static constexpr uint32_t INSTANCE_BATCH_SIZE = 1024;
    std::vector<ParticleInstanceData> m_instanceData;
+   std::vector<uint32_t> m_instanceBatches;
+   // Per batch bounds, reduced into m_bounds once all batches are done
+   std::vector<BoundingBox> m_batchBounds;
+   BoundingBox m_bounds{};
    // Random number generation
    mutable std::random_device m_rd;
    mutable std::mt19937_64 m_gen{m_rd()};
@@ -17,28 +17,40 @@ void RendererComponent::DrawInspector(Node* const node) {
           "Renderer", ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_NoTreePushOnOpen)) {
       ImGui::Text("Material id: %zu", m_material.GetId());
       ImGui::Separator();
-      ImGui::Checkbox("Is Visible", &m_visible);
-      ImGui::Checkbox("Casts Shadows", &m_castsShadows);
-      ImGui::Checkbox("Receives Shadows", &m_receivesShadows);
+      bool changed = ImGui::Checkbox("Is Visible", &m_visible);
+      changed |= ImGui::Checkbox("Casts Shadows", &m_castsShadows);
+      changed |= ImGui::Checkbox("Receives Shadows", &m_receivesShadows);
+      if (changed) {
+         ++m_revision;
+      }
    }
 }
 
-void RendererComponent::SetMesh(const MeshHandle mesh) { m_mesh = std::move(mesh); }
+void RendererComponent::SetMesh(const MeshHandle mesh) {
+   m_mesh = std::move(mesh);
+   ++m_revision;
+}
 
 bool RendererComponent::HasMesh() const noexcept { return m_mesh.IsValid(); }
 
 void RendererComponent::SetMaterial(const MaterialHandle material) {
    m_material = std::move(material);
+   ++m_revision;
 }
 
 bool RendererComponent::HasMaterial() const noexcept { return m_material.IsValid(); }
 
-void RendererComponent::SetVisible(const bool visible) noexcept { m_visible = visible; }
+void RendererComponent::SetVisible(const bool visible) noexcept {
+   m_visible = visible;
+   ++m_revision;
+}
 
 void RendererComponent::SetCastsShadows(const bool castsShadows) noexcept {
    m_castsShadows = castsShadows;
+   ++m_revision;
 }
 
 void RendererComponent::SetReceivesShadows(const bool receivesShadows) noexcept {
    m_receivesShadows = receivesShadows;
+   ++m_revision;
 }
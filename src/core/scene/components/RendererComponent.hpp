@@ -31,6 +31,9 @@ class RendererComponent final : public Component {
    void SetReceivesShadows(const bool receivesShadows) noexcept;
    [[nodiscard]] constexpr bool ReceivesShadows() const noexcept { return m_receivesShadows; }
 
+   // Bumped on every property change, lets render extraction skip unchanged components
+   [[nodiscard]] constexpr uint32_t GetRevision() const noexcept { return m_revision; }
+
   private:
    MeshHandle m_mesh;
    MaterialHandle m_material;
@@ -38,4 +41,5 @@ class RendererComponent final : public Component {
    bool m_visible{true};
    bool m_castsShadows{true};
    bool m_receivesShadows{true};
+   uint32_t m_revision{0};
 };
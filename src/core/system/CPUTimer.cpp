@@ -1,11 +1,11 @@
 #include "core/system/CPUTimer.hpp"
 
-void CPUTimer::Begin(const std::string& label) {
+void CPUTimer::Begin(const StringId label) {
    m_timings[label].startTime = std::chrono::high_resolution_clock::now();
    m_timings[label].hasResult = false;
 }
 
-void CPUTimer::End(const std::string& label) {
+void CPUTimer::End(const StringId label) {
    const auto it = m_timings.find(label);
    if (it == m_timings.end())
       return;
@@ -15,14 +15,14 @@ void CPUTimer::End(const std::string& label) {
    it->second.hasResult = true;
 }
 
-float CPUTimer::GetElapsedMs(const std::string& label) {
+float CPUTimer::GetElapsedMs(const StringId label) {
    const auto it = m_timings.find(label);
    return it != m_timings.end() ? it->second.elapsedMs : 0.0f;
 }
 
 void CPUTimer::Reset() { m_timings.clear(); }
 
-bool CPUTimer::IsAvailable(const std::string& label) const {
+bool CPUTimer::IsAvailable(const StringId label) const {
    const auto it = m_timings.find(label);
    return it != m_timings.end() && it->second.hasResult;
 }
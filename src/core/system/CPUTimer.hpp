@@ -2,18 +2,17 @@
 
 #include "core/system/IGPUTimer.hpp"
 
-#include <string>
 #include <chrono>
 #include <unordered_map>
 
 // Fallback class for default GPU timer (runs on cpu)
 class CPUTimer : public IGPUTimer {
   public:
-   void Begin(const std::string& label) override;
-   void End(const std::string& label) override;
-   [[nodiscard]] float GetElapsedMs(const std::string& label) override;
+   void Begin(const StringId label) override;
+   void End(const StringId label) override;
+   [[nodiscard]] float GetElapsedMs(const StringId label) override;
    void Reset() override;
-   [[nodiscard]] bool IsAvailable(const std::string& label) const override;
+   [[nodiscard]] bool IsAvailable(const StringId label) const override;
 
   private:
    struct TimingData {
@@ -22,5 +21,5 @@ class CPUTimer : public IGPUTimer {
       bool hasResult{false};
    };
 
-   std::unordered_map<std::string, TimingData> m_timings;
+   std::unordered_map<StringId, TimingData> m_timings;
 };
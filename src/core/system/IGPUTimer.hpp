@@ -1,15 +1,15 @@
 #pragma once
 
-#include <string>
+#include "core/StringId.hpp"
 
 class IGPUTimer {
   public:
    virtual ~IGPUTimer() = default;
 
-   virtual void Begin(const std::string& label) = 0;
-   virtual void End(const std::string& label) = 0;
+   virtual void Begin(const StringId label) = 0;
+   virtual void End(const StringId label) = 0;
 
-   [[nodiscard]] virtual float GetElapsedMs(const std::string& label) = 0;
+   [[nodiscard]] virtual float GetElapsedMs(const StringId label) = 0;
    virtual void Reset() = 0;
-   [[nodiscard]] virtual bool IsAvailable(const std::string& label) const = 0;
+   [[nodiscard]] virtual bool IsAvailable(const StringId label) const = 0;
 };
@@ -0,0 +1,103 @@
+#include "core/system/MappedFile.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+   const std::string error = "Failed to map file " + path.string();
+#ifdef _WIN32
+   const HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                   OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+      throw std::runtime_error(error);
+   m_file = file;
+   LARGE_INTEGER size{};
+   if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+      Close();
+      throw std::runtime_error(error);
+   }
+   m_size = static_cast<size_t>(size.QuadPart);
+   m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   if (!m_mapping) {
+      Close();
+      throw std::runtime_error(error);
+   }
+   m_data = static_cast<const std::byte*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+   if (!m_data) {
+      Close();
+      throw std::runtime_error(error);
+   }
+#else
+   const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+   if (fd < 0)
+      throw std::runtime_error(error);
+   struct stat info{};
+   if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+      close(fd);
+      throw std::runtime_error(error);
+   }
+   void* const data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE,
+                           fd, 0);
+   // The mapping keeps its own reference to the file
+   close(fd);
+   if (data == MAP_FAILED)
+      throw std::runtime_error(error);
+   m_data = static_cast<const std::byte*>(data);
+   m_size = static_cast<size_t>(info.st_size);
+   // Files are mostly read front to back, let the kernel read ahead
+   madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0))
+#ifdef _WIN32
+      ,
+      m_file(std::exchange(other.m_file, nullptr)),
+      m_mapping(std::exchange(other.m_mapping, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+   if (this != &other) {
+      Close();
+      m_data = std::exchange(other.m_data, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+#ifdef _WIN32
+      m_file = std::exchange(other.m_file, nullptr);
+      m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif
+   }
+   return *this;
+}
+
+void MappedFile::Close() noexcept {
+#ifdef _WIN32
+   if (m_data)
+      UnmapViewOfFile(m_data);
+   if (m_mapping)
+      CloseHandle(m_mapping);
+   if (m_file)
+      CloseHandle(m_file);
+   m_file = nullptr;
+   m_mapping = nullptr;
+#else
+   if (m_data)
+      munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+   m_data = nullptr;
+   m_size = 0;
+}
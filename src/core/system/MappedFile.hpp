@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+// Read-only view of a whole file mapped into the address space. Pages are faulted in by the OS
+// on first access, so opening is cheap and only the parts actually read are loaded.
+class MappedFile final {
+  public:
+   MappedFile() = default;
+   // Throws std::runtime_error if the file cannot be opened or mapped
+   explicit MappedFile(const std::filesystem::path& path);
+   ~MappedFile();
+
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+   MappedFile(MappedFile&& other) noexcept;
+   MappedFile& operator=(MappedFile&& other) noexcept;
+
+   [[nodiscard]] constexpr bool IsOpen() const noexcept { return m_data != nullptr; }
+   [[nodiscard]] constexpr std::span<const std::byte> GetData() const noexcept {
+      return {m_data, m_size};
+   }
+   [[nodiscard]] constexpr size_t GetSize() const noexcept { return m_size; }
+
+  private:
+   void Close() noexcept;
+
+  private:
+   const std::byte* m_data{nullptr};
+   size_t m_size{0};
+#ifdef _WIN32
+   void* m_file{nullptr};
+   void* m_mapping{nullptr};
+#endif
+};
@@ -87,7 +87,30 @@ void PerformanceLogger::Flush() {
                          << "," << frame.lightingPassMs << "," << frame.gizmoPassMs << ","
                          << frame.particlePassMs << "," << frame.imguiPassMs << ","
                          << frame.vramUsageMB << "," << frame.systemMemUsageMB << ","
-                         << frame.cpuUtilization << "\n";
+                         << frame.cpuUtilization << "," << frame.transformNodesVisited << ","
+                         << frame.transformMatricesRecomputed << "," << frame.systemUpdateMs << ","
+                         << frame.renderExtractMs << "," << frame.meshProxiesUpdated << ","
+                         << frame.streamingStalledCells << "," << frame.streamingBytesInFlight
+                         << "," << frame.meshesVisible << "," << frame.meshesCulled << ","
+                         << frame.lightsVisible << "," << frame.lightsCulled << ","
+                         << frame.particleSystemsVisible << "," << frame.particleSystemsCulled
+                         << "," << frame.meshesOccluded << "," << frame.occluders << ","
+                         << frame.occlusionRasterMs << "," << frame.occlusionTestMs << ","
+                         << frame.geometryRecordMs << "," << frame.geometryDrawCalls << ","
+                         << frame.meshesPvsCulled << "," << frame.pvsCell << ","
+                         << frame.lightClusterMs << "," << frame.clusterLightIndices << ","
+                         << frame.clusterMaxLights << "," << frame.particleSortMs << ","
+                         << frame.particlesSorted << "," << GetRenderPipelineName(frame.pipeline)
+                         << "," << frame.depthPrepassMs << "," << frame.forwardPassMs << ","
+                         << frame.visibilityPassMs << "," << frame.materialResolveMs << ","
+                         << frame.renderGraphPasses << "," << frame.renderGraphPassesCulled << ","
+                         << frame.renderGraphBarriers << "," << frame.transientBytes << ","
+                         << frame.transientReusedBytes << ","
+                         << frame.transientFramesInFlightSavedBytes << ","
+                         << frame.transientLazilySavedBytes << ","
+                         << frame.gBufferSubpasses << ","
+                         << frame.resolutionScale << "," << frame.deferredDepthPrepass << ","
+                         << frame.shadingOverdraw << "\n";
    }
    m_frameMetricsFile.flush();
    m_frameBuffer.clear();
@@ -105,6 +128,10 @@ void PerformanceLogger::WriteSystemInfoCSV(const SystemInfo& info) {
    m_systemInfoFile << "API Version," << info.apiVersion << "\n";
    m_systemInfoFile << "Window Width," << info.windowWidth << "\n";
    m_systemInfoFile << "Window Height," << info.windowHeight << "\n";
+   m_systemInfoFile << "Dynamic Resolution,"
+                    << (info.dynamicResolutionAvailable ? "Available"
+                                                        : "Not implemented (scale always 1)")
+                    << "\n";
    m_systemInfoFile.flush();
 }
 
@@ -112,7 +139,23 @@ void PerformanceLogger::WriteFrameMetricsHeader() {
    m_frameMetricsFile << "Frame,FrameTime(ms),CPUTime(ms),GPUTime(ms),FPS,"
                       << "GeometryPass(ms),LightingPass(ms),GizmoPass(ms),"
                       << "ParticlePass(ms),ImGuiPass(ms),"
-                      << "VRAM(MB),SystemMem(MB),CPUUtil(%)\n";
+                      << "VRAM(MB),SystemMem(MB),CPUUtil(%),"
+                      << "TransformNodesVisited,TransformMatricesRecomputed,SystemUpdate(ms),"
+                      << "RenderExtract(ms),MeshProxiesUpdated,"
+                      << "StreamStalledCells,StreamBytesInFlight,"
+                      << "MeshesVisible,MeshesCulled,LightsVisible,LightsCulled,"
+                      << "ParticleSystemsVisible,ParticleSystemsCulled,"
+                      << "MeshesOccluded,Occluders,OcclusionRaster(ms),OcclusionTest(ms),"
+                      << "GeometryRecord(ms),GeometryDrawCalls,MeshesPvsCulled,PvsCell,"
+                      << "LightCluster(ms),ClusterLightIndices,ClusterMaxLights,"
+                      << "ParticleSort(ms),ParticlesSorted,"
+                      << "Pipeline,DepthPrepass(ms),ForwardPass(ms),"
+                      << "VisibilityPass(ms),MaterialResolve(ms),"
+                      << "GraphPasses,GraphPassesCulled,GraphBarriers,"
+                      << "TransientBytes,TransientReusedBytes,TransientFramesInFlightSavedBytes,"
+                      << "TransientLazilySavedBytes,"
+                      << "GBufferSubpasses,ResolutionScale,"
+                      << "DeferredDepthPrepass,ShadingOverdraw\n";
 }
 
 void PerformanceLogger::WriteRunSummary() {
@@ -134,11 +177,54 @@ void PerformanceLogger::WriteRunSummary() {
                  << m_stats.avgGeometryPassMs << "\n";
    m_summaryFile << "Lighting Pass," << std::fixed << std::setprecision(3)
                  << m_stats.avgLightingPassMs << "\n";
+   m_summaryFile << "Depth Prepass," << std::fixed << std::setprecision(3)
+                 << m_stats.avgDepthPrepassMs << "\n";
+   m_summaryFile << "Forward Pass," << std::fixed << std::setprecision(3)
+                 << m_stats.avgForwardPassMs << "\n";
+   m_summaryFile << "Visibility Pass," << std::fixed << std::setprecision(3)
+                 << m_stats.avgVisibilityPassMs << "\n";
+   m_summaryFile << "Material Resolve," << std::fixed << std::setprecision(3)
+                 << m_stats.avgMaterialResolveMs << "\n";
    m_summaryFile << "Gizmo Pass," << std::fixed << std::setprecision(3) << m_stats.avgGizmoPassMs
                  << "\n";
    m_summaryFile << "Particle Pass," << std::fixed << std::setprecision(3)
                  << m_stats.avgParticlePassMs << "\n";
    m_summaryFile << "ImGui Pass," << std::fixed << std::setprecision(3) << m_stats.avgImguiPassMs
                  << "\n";
+   m_summaryFile << "\nRender Graph\n";
+   m_summaryFile << "Transient Memory Reused (Average MB)," << std::fixed << std::setprecision(2)
+                 << m_stats.avgTransientReusedMB << "\n";
+   m_summaryFile << "Transient Memory Shared By Frames In Flight (Average MB)," << std::fixed
+                 << std::setprecision(2) << m_stats.avgTransientFramesInFlightSavedMB << "\n";
+   m_summaryFile << "\nDeferred Geometry + Lighting (Average ms)\n";
+   m_summaryFile << "G-Buffer Subpasses," << std::fixed << std::setprecision(3)
+                 << m_stats.avgGBufferSubpassMs << "\n";
+   m_summaryFile << "G-Buffer Subpasses Frames," << m_stats.gBufferSubpassFrames << "\n";
+   m_summaryFile << "Separate Passes," << std::fixed << std::setprecision(3)
+                 << m_stats.avgGBufferSeparateMs << "\n";
+   m_summaryFile << "Separate Passes Frames," << m_stats.gBufferSeparateFrames << "\n";
+   m_summaryFile << "\nDeferred Depth Prepass (Average ms of prepass + geometry)\n";
+   m_summaryFile << "With Prepass," << std::fixed << std::setprecision(3)
+                 << m_stats.avgDepthPrepassGeometryMs << "\n";
+   m_summaryFile << "With Prepass Overdraw," << std::fixed << std::setprecision(3)
+                 << m_stats.avgDepthPrepassOverdraw << "\n";
+   m_summaryFile << "With Prepass Frames," << m_stats.depthPrepassFrames << "\n";
+   m_summaryFile << "Without Prepass," << std::fixed << std::setprecision(3)
+                 << m_stats.avgNoDepthPrepassGeometryMs << "\n";
+   m_summaryFile << "Without Prepass Overdraw," << std::fixed << std::setprecision(3)
+                 << m_stats.avgNoDepthPrepassOverdraw << "\n";
+   m_summaryFile << "Without Prepass Frames," << m_stats.noDepthPrepassFrames << "\n";
+   // Only a run that measured both modes can tell
+   const bool bothModes = m_stats.depthPrepassFrames > 0 && m_stats.noDepthPrepassFrames > 0;
+   const bool paysOff = m_stats.avgDepthPrepassGeometryMs < m_stats.avgNoDepthPrepassGeometryMs;
+   m_summaryFile << "Prepass Pays Off," << (bothModes ? (paysOff ? "Yes" : "No") : "Unknown")
+                 << "\n";
+   m_summaryFile << "\nDynamic Resolution\n";
+   if (!m_systemInfo.dynamicResolutionAvailable)
+      m_summaryFile << "Not implemented by this renderer, every frame rendered at scale 1\n";
+   m_summaryFile << "Average Scale," << std::fixed << std::setprecision(3)
+                 << m_stats.avgResolutionScale << "\n";
+   m_summaryFile << "Minimum Scale," << std::fixed << std::setprecision(3)
+                 << m_stats.minResolutionScale << "\n";
    m_summaryFile.flush();
 }
@@ -1,11 +1,14 @@
 #include "core/system/PerformanceMetrics.hpp"
 
+#include <algorithm>
+
 [[nodiscard]] float PerformanceMetrics::GetFPS() const noexcept {
    return frameTimeMs > 0.0f ? 1000.0f / frameTimeMs : 0.0f;
 }
 
 [[nodiscard]] float PerformanceMetrics::GetTotalRenderPassTime() const noexcept {
-   return geometryPassMs + lightingPassMs + gizmoPassMs + particlePassMs + imguiPassMs;
+   return geometryPassMs + lightingPassMs + depthPrepassMs + forwardPassMs + visibilityPassMs +
+          materialResolveMs + gizmoPassMs + particlePassMs + imguiPassMs;
 }
 
 void PerformanceStatistics::Update(const PerformanceMetrics& metrics) noexcept {
@@ -25,9 +28,44 @@ void PerformanceStatistics::Update(const PerformanceMetrics& metrics) noexcept {
    avgFrameTime = avgFrameTime * (1.0f - alpha) + metrics.frameTimeMs * alpha;
    avgGeometryPassMs = avgGeometryPassMs * (1.0f - alpha) + metrics.geometryPassMs * alpha;
    avgLightingPassMs = avgLightingPassMs * (1.0f - alpha) + metrics.lightingPassMs * alpha;
+   avgDepthPrepassMs = avgDepthPrepassMs * (1.0f - alpha) + metrics.depthPrepassMs * alpha;
+   avgForwardPassMs = avgForwardPassMs * (1.0f - alpha) + metrics.forwardPassMs * alpha;
+   avgVisibilityPassMs =
+      avgVisibilityPassMs * (1.0f - alpha) + metrics.visibilityPassMs * alpha;
+   avgMaterialResolveMs =
+      avgMaterialResolveMs * (1.0f - alpha) + metrics.materialResolveMs * alpha;
    avgGizmoPassMs = avgGizmoPassMs * (1.0f - alpha) + metrics.gizmoPassMs * alpha;
    avgParticlePassMs = avgParticlePassMs * (1.0f - alpha) + metrics.particlePassMs * alpha;
    avgImguiPassMs = avgImguiPassMs * (1.0f - alpha) + metrics.imguiPassMs * alpha;
+   const float transientReusedMB =
+      static_cast<float>(metrics.transientReusedBytes) / (1024.0f * 1024.0f);
+   avgTransientReusedMB = avgTransientReusedMB * (1.0f - alpha) + transientReusedMB * alpha;
+   const float transientFramesInFlightSavedMB =
+      static_cast<float>(metrics.transientFramesInFlightSavedBytes) / (1024.0f * 1024.0f);
+   avgTransientFramesInFlightSavedMB = avgTransientFramesInFlightSavedMB * (1.0f - alpha) +
+                                       transientFramesInFlightSavedMB * alpha;
+   avgResolutionScale = avgResolutionScale * (1.0f - alpha) + metrics.resolutionScale * alpha;
+   minResolutionScale = std::min(minResolutionScale, metrics.resolutionScale);
+   if (metrics.pipeline == RenderPipeline::Deferred) {
+      uint64_t& frames = metrics.gBufferSubpasses ? gBufferSubpassFrames : gBufferSeparateFrames;
+      float& avgMs = metrics.gBufferSubpasses ? avgGBufferSubpassMs : avgGBufferSeparateMs;
+      const float modeAlpha = 1.0f / static_cast<float>(++frames);
+      avgMs = avgMs * (1.0f - modeAlpha) +
+              (metrics.geometryPassMs + metrics.lightingPassMs) * modeAlpha;
+   }
+   // Only separate passes can run the deferred prepass, so subpass frames stay out of both modes
+   if (metrics.pipeline == RenderPipeline::Deferred && !metrics.gBufferSubpasses &&
+       !metrics.overdrawView) {
+      uint64_t& frames = metrics.deferredDepthPrepass ? depthPrepassFrames : noDepthPrepassFrames;
+      float& avgMs =
+         metrics.deferredDepthPrepass ? avgDepthPrepassGeometryMs : avgNoDepthPrepassGeometryMs;
+      float& avgOverdraw =
+         metrics.deferredDepthPrepass ? avgDepthPrepassOverdraw : avgNoDepthPrepassOverdraw;
+      const float modeAlpha = 1.0f / static_cast<float>(++frames);
+      avgMs = avgMs * (1.0f - modeAlpha) +
+              (metrics.depthPrepassMs + metrics.geometryPassMs) * modeAlpha;
+      avgOverdraw = avgOverdraw * (1.0f - modeAlpha) + metrics.shadingOverdraw * modeAlpha;
+   }
 }
 
 void PerformanceStatistics::Reset() noexcept { *this = PerformanceStatistics{}; }
@@ -1,17 +1,48 @@
 #pragma once
 
+#include "core/RenderSettings.hpp"
+#include "core/StringId.hpp"
+
 #include <chrono>
 #include <string>
 #include <array>
 
+// Cost of one scene system during the last update
+struct SystemTiming final {
+   StringId name;
+   // Summed over all of the system's tasks, so it can exceed wall time when run in parallel
+   float cpuTimeMs{0.0f};
+   uint32_t entityCount{0};
+};
+
 struct PerformanceMetrics {
+   static constexpr size_t MAX_SYSTEM_TIMINGS = 16;
+
    // Frame timing
    float frameTimeMs{0.0f};
    float cpuTimeMs{0.0f};
    float gpuTimeMs{0.0f};
+   // Pipeline the frame was rendered with, its passes are timed and the others stay zero
+   RenderPipeline pipeline{RenderPipeline::Deferred};
+   // Deferred geometry and lighting ran as subpasses of one render pass, the timings below are
+   // then split at the subpass boundary
+   bool gBufferSubpasses{false};
+   // Deferred geometry pass ran after a depth prepass, whose time is then in depthPrepassMs
+   bool deferredDepthPrepass{false};
+   // Frame showed the overdraw view, whose pass is timed as the geometry pass
+   bool overdrawView{false};
+   // Fragments the geometry or forward pass shaded per pixel, counted with an occlusion query
+   // a frame or more late, zero where the device cannot count them
+   float shadingOverdraw{0.0f};
+   // Fraction of the window width and height the scene passes rendered at
+   float resolutionScale{1.0f};
    // Render pass timings
    float geometryPassMs{0.0f};
    float lightingPassMs{0.0f};
+   float depthPrepassMs{0.0f};
+   float forwardPassMs{0.0f};
+   float visibilityPassMs{0.0f};
+   float materialResolveMs{0.0f};
    float gizmoPassMs{0.0f};
    float particlePassMs{0.0f};
    float imguiPassMs{0.0f};
@@ -20,6 +51,66 @@ struct PerformanceMetrics {
    size_t systemMemUsageMB{0};
    // Utilization
    float cpuUtilization{0.0f};
+   // Scene update work
+   uint32_t transformNodesVisited{0};
+   uint32_t transformMatricesRecomputed{0};
+   // Scene systems, wall time of the whole update plus the first MAX_SYSTEM_TIMINGS systems
+   float systemUpdateMs{0.0f};
+   uint32_t systemTimingCount{0};
+   std::array<SystemTiming, MAX_SYSTEM_TIMINGS> systemTimings{};
+   // Render world extraction, proxies alive and proxies whose world matrix was copied this frame
+   float renderExtractMs{0.0f};
+   uint32_t meshProxies{0};
+   uint32_t meshProxiesUpdated{0};
+   // Frustum culling, visible counts are what the passes submit
+   uint32_t meshesVisible{0};
+   uint32_t meshesCulled{0};
+   uint32_t lightsVisible{0};
+   uint32_t lightsCulled{0};
+   uint32_t particleSystemsVisible{0};
+   uint32_t particleSystemsCulled{0};
+   uint32_t bvhNodesRefit{0};
+   // Clustered lighting, the index entries summed over all clusters and the fullest cluster
+   float lightClusterMs{0.0f};
+   uint32_t clusterLightIndices{0};
+   uint32_t clusterMaxLights{0};
+   // Back to front particle radix sort, zero while sorting is disabled
+   float particleSortMs{0.0f};
+   uint32_t particlesSorted{0};
+   // Software occlusion culling, meshes that passed the frustum but were hidden by occluders
+   uint32_t meshesOccluded{0};
+   uint32_t occluders{0};
+   uint32_t occluderTriangles{0};
+   float occlusionRasterMs{0.0f};
+   float occlusionTestMs{0.0f};
+   // Baked cell visibility, -1 while the camera is outside the baked cells or none is attached
+   uint32_t meshesPvsCulled{0};
+   int32_t pvsCell{-1};
+   // CPU time spent recording the geometry pass and the draw commands it recorded, one per
+   // visible mesh or one indirect count draw per group on the GPU-driven path
+   float geometryRecordMs{0.0f};
+   uint32_t geometryDrawCalls{0};
+   // Scene streaming, zero while no streamer is attached
+   uint32_t streamingCells{0};
+   uint32_t streamingResidentCells{0};
+   uint32_t streamingLoadingCells{0};
+   // Cells within the load radius that are not resident yet
+   uint32_t streamingStalledCells{0};
+   size_t streamingBytesInFlight{0};
+   size_t streamingResidentBytes{0};
+   size_t streamingBudgetBytes{0};
+   float streamingUploadMs{0.0f};
+   // Render graph, passes kept and culled and the barriers between them. Transient bytes are
+   // what its attachments would take with a texture each; the pool saves the reused bytes by
+   // sharing textures between disjoint lifetimes and the others by sharing frames in flight.
+   // Lazily saved bytes are transient attachments the device never had to commit memory for.
+   uint32_t renderGraphPasses{0};
+   uint32_t renderGraphPassesCulled{0};
+   uint32_t renderGraphBarriers{0};
+   size_t transientBytes{0};
+   size_t transientReusedBytes{0};
+   size_t transientFramesInFlightSavedBytes{0};
+   size_t transientLazilySavedBytes{0};
 
    [[nodiscard]] float GetFPS() const noexcept;
    [[nodiscard]] float GetTotalRenderPassTime() const noexcept;
@@ -36,6 +127,8 @@ struct SystemInfo {
    std::string apiVersion;
    uint32_t windowWidth{0};
    uint32_t windowHeight{0};
+   // Without it the logged resolution scale is always 1
+   bool dynamicResolutionAvailable{false};
 };
 
 // Statistical tracking for performance metrics
@@ -51,9 +144,31 @@ struct PerformanceStatistics {
    // Per-pass averages
    float avgGeometryPassMs{0.0f};
    float avgLightingPassMs{0.0f};
+   float avgDepthPrepassMs{0.0f};
+   float avgForwardPassMs{0.0f};
+   float avgVisibilityPassMs{0.0f};
+   float avgMaterialResolveMs{0.0f};
    float avgGizmoPassMs{0.0f};
    float avgParticlePassMs{0.0f};
    float avgImguiPassMs{0.0f};
+   float avgTransientReusedMB{0.0f};
+   float avgTransientFramesInFlightSavedMB{0.0f};
+   // Deferred geometry plus lighting per G-buffer mode, to compare the merged render pass with
+   // the separate passes within one run
+   uint64_t gBufferSubpassFrames{0};
+   uint64_t gBufferSeparateFrames{0};
+   float avgGBufferSubpassMs{0.0f};
+   float avgGBufferSeparateMs{0.0f};
+   // Deferred prepass plus geometry, or geometry alone, and the overdraw of each, to tell
+   // whether the prepass pays off in the logged scene
+   uint64_t depthPrepassFrames{0};
+   uint64_t noDepthPrepassFrames{0};
+   float avgDepthPrepassGeometryMs{0.0f};
+   float avgNoDepthPrepassGeometryMs{0.0f};
+   float avgDepthPrepassOverdraw{0.0f};
+   float avgNoDepthPrepassOverdraw{0.0f};
+   float avgResolutionScale{0.0f};
+   float minResolutionScale{1.0f};
 
    void Update(const PerformanceMetrics& metrics) noexcept;
    void Reset() noexcept;
@@ -150,9 +150,16 @@ void GLFramebuffer::BlitTo(const GLFramebuffer& target, const uint32_t srcX0, co
 
 void GLFramebuffer::BlitToScreen(const uint32_t screenWidth, const uint32_t screenHeight,
                                  const GLbitfield mask, const uint32_t filter) const noexcept {
+   BlitRegionToScreen(m_width, m_height, screenWidth, screenHeight, mask, filter);
+}
+
+void GLFramebuffer::BlitRegionToScreen(const uint32_t srcWidth, const uint32_t srcHeight,
+                                       const uint32_t screenWidth, const uint32_t screenHeight,
+                                       const GLbitfield mask,
+                                       const uint32_t filter) const noexcept {
    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_fbo);
    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-   glBlitFramebuffer(0, 0, m_width, m_height, 0, 0, screenWidth, screenHeight, mask, filter);
+   glBlitFramebuffer(0, 0, srcWidth, srcHeight, 0, 0, screenWidth, screenHeight, mask, filter);
 }
 
 GLFramebuffer::Status GLFramebuffer::CheckStatus() const noexcept {
@@ -91,6 +91,11 @@ class GLFramebuffer final {
    void BlitToScreen(const uint32_t screenWidth, const uint32_t screenHeight,
                      const GLbitfield mask = GL_COLOR_BUFFER_BIT,
                      const uint32_t filter = GL_LINEAR) const noexcept;
+   // Stretches the lower left srcWidth x srcHeight region over the screen
+   void BlitRegionToScreen(const uint32_t srcWidth, const uint32_t srcHeight,
+                           const uint32_t screenWidth, const uint32_t screenHeight,
+                           const GLbitfield mask = GL_COLOR_BUFFER_BIT,
+                           const uint32_t filter = GL_LINEAR) const noexcept;
 
   private:
    void AttachTexture(const AttachmentDesc& attachment,
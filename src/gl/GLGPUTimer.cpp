@@ -8,7 +8,7 @@ GLGPUTimer::~GLGPUTimer() {
    }
 }
 
-void GLGPUTimer::CreateQuery(const std::string& label) {
+void GLGPUTimer::CreateQuery(const StringId label) {
    auto& query = m_queries[label];
    if (query.beginQuery == 0) {
       glGenQueries(1, &query.beginQuery);
@@ -16,7 +16,7 @@ void GLGPUTimer::CreateQuery(const std::string& label) {
    }
 }
 
-void GLGPUTimer::DeleteQuery(const std::string& label) {
+void GLGPUTimer::DeleteQuery(const StringId label) {
    const auto it = m_queries.find(label);
    if (it != m_queries.end()) {
       if (it->second.beginQuery != 0) {
@@ -26,7 +26,7 @@ void GLGPUTimer::DeleteQuery(const std::string& label) {
    }
 }
 
-void GLGPUTimer::Begin(const std::string& label) {
+void GLGPUTimer::Begin(const StringId label) {
    CreateQuery(label);
    auto& query = m_queries[label];
    query.active = true;
@@ -34,7 +34,7 @@ void GLGPUTimer::Begin(const std::string& label) {
    glQueryCounter(query.beginQuery, GL_TIMESTAMP);
 }
 
-void GLGPUTimer::End(const std::string& label) {
+void GLGPUTimer::End(const StringId label) {
    const auto it = m_queries.find(label);
    if (it == m_queries.end() || !it->second.active) {
       return;
@@ -53,7 +53,7 @@ void GLGPUTimer::End(const std::string& label) {
    }
 }
 
-float GLGPUTimer::GetElapsedMs(const std::string& label) {
+float GLGPUTimer::GetElapsedMs(const StringId label) {
    auto it = m_queries.find(label);
    if (it == m_queries.end()) {
       return 0.0f;
@@ -80,7 +80,7 @@ void GLGPUTimer::Reset() {
    }
 }
 
-bool GLGPUTimer::IsAvailable(const std::string& label) const {
+bool GLGPUTimer::IsAvailable(const StringId label) const {
    const auto it = m_queries.find(label);
    if (it == m_queries.end() || it->second.active) {
       return false;
@@ -3,18 +3,17 @@
 #include "core/system/IGPUTimer.hpp"
 #include <glad/gl.h>
 #include <unordered_map>
-#include <string>
 
 class GLGPUTimer : public IGPUTimer {
   public:
    GLGPUTimer();
    ~GLGPUTimer() override;
 
-   void Begin(const std::string& label) override;
-   void End(const std::string& label) override;
-   [[nodiscard]] float GetElapsedMs(const std::string& label) override;
+   void Begin(const StringId label) override;
+   void End(const StringId label) override;
+   [[nodiscard]] float GetElapsedMs(const StringId label) override;
    void Reset() override;
-   [[nodiscard]] bool IsAvailable(const std::string& label) const override;
+   [[nodiscard]] bool IsAvailable(const StringId label) const override;
 
   private:
    struct QueryPair {
@@ -25,7 +24,7 @@ class GLGPUTimer : public IGPUTimer {
       bool hasResult{false};
    };
 
-   std::unordered_map<std::string, QueryPair> m_queries;
-   void CreateQuery(const std::string& label);
-   void DeleteQuery(const std::string& label);
+   std::unordered_map<StringId, QueryPair> m_queries;
+   void CreateQuery(const StringId label);
+   void DeleteQuery(const StringId label);
 };
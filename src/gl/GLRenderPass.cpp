@@ -29,6 +29,7 @@ void GLRenderPass::Begin() {
    m_previousState.depthTest = glIsEnabled(GL_DEPTH_TEST);
    glGetBooleanv(GL_DEPTH_WRITEMASK, reinterpret_cast<unsigned char*>(&m_previousState.depthMask));
    glGetIntegerv(GL_DEPTH_FUNC, reinterpret_cast<int32_t*>(&m_previousState.depthFunc));
+   glGetBooleanv(GL_COLOR_WRITEMASK, m_previousState.colorMask.data());
    m_previousState.cullFace = glIsEnabled(GL_CULL_FACE);
    glGetIntegerv(GL_CULL_FACE_MODE, reinterpret_cast<int32_t*>(&m_previousState.cullFaceMode));
    glGetIntegerv(GL_FRONT_FACE, reinterpret_cast<int32_t*>(&m_previousState.frontFace));
@@ -72,6 +73,8 @@ void GLRenderPass::End() {
    }
    glDepthMask(m_previousState.depthMask);
    glDepthFunc(m_previousState.depthFunc);
+   const auto& cm = m_previousState.colorMask;
+   glColorMask(cm[0], cm[1], cm[2], cm[3]);
    if (m_previousState.cullFace) {
       glEnable(GL_CULL_FACE);
    } else {
@@ -169,6 +172,8 @@ void GLRenderPass::ApplyRenderState() const {
    // Apply render state efficiently
    SetDepthTest(m_renderState.depthTest);
    glDepthMask(m_renderState.depthWrite ? GL_TRUE : GL_FALSE);
+   const GLboolean colorWrite = m_renderState.colorWrite ? GL_TRUE : GL_FALSE;
+   glColorMask(colorWrite, colorWrite, colorWrite, colorWrite);
    SetCullMode(m_renderState.cullMode);
    glFrontFace(m_renderState.frontFaceCCW ? GL_CCW : GL_CW);
    SetBlendMode(m_renderState.blendMode, m_renderState);
@@ -58,6 +58,8 @@ class GLRenderPass final {
       // Depth testing
       DepthTest depthTest{DepthTest::Less};
       bool depthWrite{true};
+      // Color writes, off for passes that only lay down depth
+      bool colorWrite{true};
       // Face culling
       CullMode cullMode{CullMode::Back};
       bool frontFaceCCW{true};
@@ -140,6 +142,7 @@ class GLRenderPass final {
       bool depthTest;
       bool depthMask;
       uint32_t depthFunc;
+      std::array<GLboolean, 4> colorMask;
       bool cullFace;
       uint32_t cullFaceMode;
       uint32_t frontFace;
@@ -2,11 +2,8 @@
 
 #include "core/Camera.hpp"
 #include "core/Window.hpp"
-#include "core/scene/Node.hpp"
 #include "core/scene/Scene.hpp"
 #include "core/scene/components/ParticleSystemComponent.hpp"
-#include "core/scene/components/RendererComponent.hpp"
-#include "core/scene/components/LightComponent.hpp"
 #include "core/editor/MaterialEditor.hpp"
 #include "core/editor/PerformanceGUI.hpp"
 #include "core/resource/ResourceManager.hpp"
@@ -19,6 +16,8 @@
 #include "gl/resource/GLMesh.hpp"
 #include "gl/resource/GLResourceFactory.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <print>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
@@ -32,24 +31,6 @@ struct CameraData {
    alignas(16) glm::vec3 viewPos;
 };
 
-struct LightData {
-   alignas(4) uint32_t lightType;
-   alignas(16) glm::vec3 position;
-   alignas(16) glm::vec3 direction;
-   alignas(16) glm::vec3 color;
-   alignas(4) float intensity;
-   alignas(4) float constant;
-   alignas(4) float linear;
-   alignas(4) float quadratic;
-   alignas(4) float innerCone;
-   alignas(4) float outerCone;
-};
-
-struct LightsData {
-   alignas(4) uint32_t lightCount;
-   std::array<LightData, GLRenderer::MAX_LIGHTS> lights;
-};
-
 GLRenderer::GLRenderer(Window* window) : IRenderer(window) {
    // Load OpenGL function pointers with error checking
    if (!gladLoadGL(reinterpret_cast<GLADloadfunc>(glfwGetProcAddress))) [[unlikely]] {
@@ -68,12 +49,15 @@ GLRenderer::GLRenderer(Window* window) : IRenderer(window) {
    m_resourceManager = std::make_unique<ResourceManager>(std::make_unique<GLResourceFactory>());
    m_materialEditor =
       std::make_unique<MaterialEditor>(m_resourceManager.get(), GraphicsAPI::OpenGL);
+   m_renderGraph = std::make_unique<RenderGraph>(*m_resourceManager);
    // Initialize subsystems
    SetupImgui();
    CreateUtilityMeshes();
    CreateDefaultMaterial();
    LoadShaders();
    CreateUBOs();
+   m_settings.dynamicResolutionAvailable = true;
+   glGenQueries(OVERDRAW_QUERY_COUNT, m_overdrawQueries.data());
    // Setup resize callback
    m_window->SetResizeCallback(
       [this](int32_t width, int32_t height) noexcept { FramebufferCallback(width, height); });
@@ -81,22 +65,249 @@ GLRenderer::GLRenderer(Window* window) : IRenderer(window) {
    FramebufferCallback(m_window->GetWidth(), m_window->GetHeight());
 }
 
-GLRenderer::~GLRenderer() { DestroyImgui(); }
+GLRenderer::~GLRenderer() {
+   glDeleteQueries(OVERDRAW_QUERY_COUNT, m_overdrawQueries.data());
+   DestroyImgui();
+}
 
 void GLRenderer::FramebufferCallback(const int32_t width, const int32_t height) noexcept {
    glViewport(0, 0, width, height);
    if (m_activeCamera) [[likely]] {
       m_activeCamera->SetAspectRatio(static_cast<float>(width) / static_cast<float>(height));
    }
-   // Recreate framebuffers and render passes
+   // The next frame allocates attachments at the new size and rebuilds the framebuffers
+   m_geometryPass.reset();
+   m_gBufferPrepass.reset();
+   m_geometryEqualPass.reset();
+   m_lightingPass.reset();
+   m_depthPrepass.reset();
+   m_forwardPass.reset();
+   m_overdrawPass.reset();
+   m_overdrawEqualPass.reset();
+   m_gizmoPass.reset();
+   m_particlePass.reset();
+   m_gBuffer.reset();
+   m_lightingFbo.reset();
+   m_renderGraph->ReleaseTransients();
+}
+
+template <typename Fn>
+auto GLRenderer::TimedPass(const StringId label, const bool geometry, Fn body) {
+   return [this, label, geometry, body = std::move(body)] {
+      const auto recordStart = std::chrono::high_resolution_clock::now();
+      m_gpuTimer.Begin(label);
+      body();
+      m_gpuTimer.End(label);
+      if (geometry) {
+         m_geometryRecordMs += std::chrono::duration<float, std::milli>(
+                                  std::chrono::high_resolution_clock::now() - recordStart)
+                                  .count();
+      }
+   };
+}
+
+void GLRenderer::BuildRenderGraph(const RenderPipeline pipeline, const bool depthPrepass,
+                                  const bool overdrawView) {
+   using Access = RenderGraphAccess;
+   RenderGraph& graph = *m_renderGraph;
+   const uint32_t width = m_window->GetWidth();
+   const uint32_t height = m_window->GetHeight();
+   graph.Reset();
+   const RenderGraph::TextureId backbuffer =
+      graph.ImportTexture("backbuffer", {}, Access::Present, Access::Present);
+   const RenderGraph::TextureId color =
+      graph.CreateTexture("lighting_color", {width, height, ITexture::Format::SRGB8_ALPHA8});
+   const RenderGraph::TextureId depth =
+      graph.CreateTexture("lighting_depth", {width, height, ITexture::Format::Depth32F});
+   RenderGraph::TextureId albedo = RenderGraph::INVALID_TEXTURE;
+   RenderGraph::TextureId normal = RenderGraph::INVALID_TEXTURE;
+   RenderGraph::TextureId gDepth = RenderGraph::INVALID_TEXTURE;
+   if (overdrawView) {
+      // Stands in for the scene passes, with the depth test the shading pass would run with
+      const bool prepass = depthPrepass || pipeline == RenderPipeline::ForwardPlus;
+      if (prepass) {
+         graph
+            .AddPass("DepthPrepass",
+                     TimedPass("DepthPrepass", false,
+                               [this] { RenderDepthPrepass(*m_depthPrepass); }))
+            .Write(color, Access::ColorAttachment)
+            .Write(depth, Access::DepthAttachment);
+      }
+      RenderGraph::PassBuilder overdraw =
+         graph.AddPass("OverdrawPass", TimedPass("OverdrawPass", false, [this, prepass] {
+                          GLRenderPass& pass = prepass ? *m_overdrawEqualPass : *m_overdrawPass;
+                          BeginOverdrawQuery();
+                          pass.Begin();
+                          RenderPositions(*m_overdrawShader);
+                          pass.End();
+                          EndOverdrawQuery();
+                       }));
+      if (prepass) {
+         overdraw.Read(color, Access::ColorAttachment)
+            .Write(color, Access::ColorAttachment)
+            .Read(depth, Access::DepthAttachment);
+      } else {
+         overdraw.Write(color, Access::ColorAttachment).Write(depth, Access::DepthAttachment);
+      }
+   } else if (pipeline == RenderPipeline::ForwardPlus) {
+      // Depth prepass and forward pass, both straight into the lighting framebuffer
+      graph
+         .AddPass("DepthPrepass", TimedPass("DepthPrepass", true,
+                                            [this] { RenderDepthPrepass(*m_depthPrepass); }))
+         .Write(color, Access::ColorAttachment)
+         .Write(depth, Access::DepthAttachment);
+      graph
+         .AddPass("ForwardPass", TimedPass("ForwardPass", true,
+                                           [this] {
+                                              BeginOverdrawQuery();
+                                              m_forwardPass->Begin();
+                                              RenderForward();
+                                              m_forwardPass->End();
+                                              EndOverdrawQuery();
+                                           }))
+         .Read(color, Access::ColorAttachment)
+         .Write(color, Access::ColorAttachment)
+         .Read(depth, Access::DepthAttachment);
+   } else {
+      albedo = graph.CreateTexture("gbuffer_color", {width, height, ITexture::Format::RGBA8});
+      normal = graph.CreateTexture("gbuffer_normals", {width, height, ITexture::Format::RGBA16F});
+      gDepth = graph.CreateTexture("gbuffer_depth", {width, height, ITexture::Format::Depth32F});
+      if (depthPrepass) {
+         // Positions only, so the geometry pass binds each visible pixel's material once
+         graph
+            .AddPass("DepthPrepass", TimedPass("DepthPrepass", true,
+                                               [this] { RenderDepthPrepass(*m_gBufferPrepass); }))
+            .Write(gDepth, Access::DepthAttachment);
+      }
+      RenderGraph::PassBuilder geometry =
+         graph.AddPass("GeometryPass", TimedPass("GeometryPass", true, [this, depthPrepass] {
+                          GLRenderPass& pass =
+                             depthPrepass ? *m_geometryEqualPass : *m_geometryPass;
+                          BeginOverdrawQuery();
+                          pass.Begin();
+                          RenderGeometry();
+                          pass.End();
+                          EndOverdrawQuery();
+                       }));
+      geometry.Write(albedo, Access::ColorAttachment).Write(normal, Access::ColorAttachment);
+      if (depthPrepass) {
+         geometry.Read(gDepth, Access::DepthAttachment);
+      } else {
+         geometry.Write(gDepth, Access::DepthAttachment);
+      }
+      // Copies the G-buffer depth so the gizmos and particles are depth tested against it
+      graph
+         .AddPass("DepthBlit",
+                  [this] {
+                     m_gBuffer->BlitTo(*m_lightingFbo, 0, 0, m_sceneWidth, m_sceneHeight, 0, 0,
+                                       m_sceneWidth, m_sceneHeight, GL_DEPTH_BUFFER_BIT,
+                                       GL_NEAREST);
+                  })
+         .Read(gDepth, Access::Sampled)
+         .Write(depth, Access::DepthAttachment);
+      graph
+         .AddPass("LightingPass", TimedPass("LightingPass", false,
+                                            [this] {
+                                               m_lightingPass->Begin();
+                                               RenderLighting();
+                                               m_lightingPass->End();
+                                            }))
+         .Read(albedo, Access::Sampled)
+         .Read(normal, Access::Sampled)
+         .Read(gDepth, Access::Sampled)
+         .Write(color, Access::ColorAttachment);
+   }
+   graph
+      .AddPass("GizmoPass", TimedPass("GizmoPass", false,
+                                      [this] {
+                                         m_gizmoPass->Begin();
+                                         RenderGizmos();
+                                         m_gizmoPass->End();
+                                      }))
+      .Read(color, Access::ColorAttachment)
+      .Write(color, Access::ColorAttachment)
+      .Read(depth, Access::DepthAttachment)
+      .Write(depth, Access::DepthAttachment);
+   graph
+      .AddPass("ParticlePass", TimedPass("ParticlePass", false,
+                                         [this] {
+                                            m_particlePass->Begin();
+                                            RenderParticles();
+                                            m_particlePass->End();
+                                         }))
+      .Read(color, Access::ColorAttachment)
+      .Write(color, Access::ColorAttachment)
+      .Read(depth, Access::DepthAttachment);
+   graph
+      .AddPass("BlitToScreen",
+               [this] {
+                  // Filtered only when the scene was rendered below the window size
+                  const uint32_t width = m_window->GetWidth();
+                  const uint32_t height = m_window->GetHeight();
+                  const bool scaled = m_sceneWidth != width || m_sceneHeight != height;
+                  m_lightingFbo->BlitRegionToScreen(m_sceneWidth, m_sceneHeight, width, height,
+                                                    GL_COLOR_BUFFER_BIT,
+                                                    scaled ? GL_LINEAR : GL_NEAREST);
+               })
+      .Read(color, Access::Sampled)
+      .Write(backbuffer, Access::ColorAttachment);
+   graph
+      .AddPass("ImGuiPass", TimedPass("ImGuiPass", false, [this] { RenderImgui(); }))
+      .Read(backbuffer, Access::ColorAttachment)
+      .Write(backbuffer, Access::ColorAttachment);
+   graph.Compile();
+   m_gAlbedoTexture = graph.GetTexture(albedo);
+   m_gNormalTexture = graph.GetTexture(normal);
+   m_gDepthTexture = graph.GetTexture(gDepth);
+   m_lightingColorTexture = graph.GetTexture(color);
+   m_lightingDepthTexture = graph.GetTexture(depth);
+}
+
+void GLRenderer::UpdateFramebuffers() {
+   // Passes keep pointers to the framebuffers, so both are rebuilt together
+   if (m_renderGraph->GetVersion() == m_framebufferVersion)
+      return;
+   m_framebufferVersion = m_renderGraph->GetVersion();
    CreateGeometryFBO();
    CreateGeometryPass();
    CreateLightingFBO();
    CreateLightingPass();
+   CreateForwardPasses();
+   CreateOverdrawPasses();
    CreateGizmoPass();
    CreateParticlePass();
 }
 
+void GLRenderer::UpdateResolutionScale() {
+   // The GPU time, unlike the frame time, is not held at the refresh interval by vsync. Frames
+   // whose queries resolved late are skipped, their times would still be those of an older
+   // frame at another scale.
+   if (m_settings.dynamicResolution) {
+      if (m_scaledPassesMs >= 0.0f)
+         m_dynamicResolution.Update(m_scaledPassesMs, m_settings.targetFrameTimeMs);
+   } else {
+      m_dynamicResolution.Reset();
+   }
+   m_sceneWidth = m_dynamicResolution.Scale(m_window->GetWidth());
+   m_sceneHeight = m_dynamicResolution.Scale(m_window->GetHeight());
+}
+
+void GLRenderer::ApplySceneViewport() {
+   // Only the viewport changes, so the attachments are never reallocated for a new scale
+   for (GLRenderPass* const pass :
+        {m_geometryPass.get(), m_gBufferPrepass.get(), m_geometryEqualPass.get(),
+         m_lightingPass.get(), m_depthPrepass.get(), m_forwardPass.get(), m_overdrawPass.get(),
+         m_overdrawEqualPass.get(), m_gizmoPass.get(), m_particlePass.get()}) {
+      if (!pass)
+         continue;
+      GLRenderPass::RenderState state = pass->GetRenderState();
+      state.useFramebufferViewport = false;
+      state.viewportWidth = m_sceneWidth;
+      state.viewportHeight = m_sceneHeight;
+      pass->UpdateRenderState(state);
+   }
+}
+
 void GLRenderer::CreateUtilityMeshes() {
    // Create fullscreen quad for lighting pass
    constexpr std::array<Vertex, 4> quadVerts = {{
@@ -153,6 +364,12 @@ void GLRenderer::LoadShaders() {
 
    m_lightingPassShader = createShader("resources/shaders/gl/lighting_pass.vert",
                                        "resources/shaders/gl/lighting_pass.frag");
+   m_depthPrepassShader = createShader("resources/shaders/gl/depth_prepass.vert",
+                                       "resources/shaders/gl/depth_prepass.frag");
+   m_forwardPassShader = createShader("resources/shaders/gl/geometry_pass.vert",
+                                      "resources/shaders/gl/forward_pass.frag");
+   m_overdrawShader = createShader("resources/shaders/gl/depth_prepass.vert",
+                                   "resources/shaders/gl/overdraw.frag");
    m_gizmoPassShader =
       createShader("resources/shaders/gl/gizmo_pass.vert", "resources/shaders/gl/gizmo_pass.frag");
    m_particlePassShader = createShader("resources/shaders/gl/particle_pass.vert",
@@ -161,20 +378,15 @@ void GLRenderer::LoadShaders() {
 
 void GLRenderer::CreateGeometryFBO() {
    m_gBuffer.reset();
-   // Create G-buffer textures
-   m_gAlbedoTexture = m_resourceManager->CreateRenderTarget(
-      "gbuffer_color", m_window->GetWidth(), m_window->GetHeight(), ITexture::Format::RGBA8);
-   m_gNormalTexture = m_resourceManager->CreateRenderTarget(
-      "gbuffer_normals", m_window->GetWidth(), m_window->GetHeight(), ITexture::Format::RGBA16F);
-   m_gDepthTexture = m_resourceManager->CreateDepthTexture("gbuffer_depth", m_window->GetWidth(),
-                                                           m_window->GetHeight());
-   // Get texture pointers
+   // Get texture pointers, the G-buffer only exists while the frame draws the deferred passes
    const auto* colorTexPtr =
       reinterpret_cast<const GLTexture*>(m_resourceManager->GetTexture(m_gAlbedoTexture));
    const auto* normalTexPtr =
       reinterpret_cast<const GLTexture*>(m_resourceManager->GetTexture(m_gNormalTexture));
    const auto* depthTexPtr =
       reinterpret_cast<const GLTexture*>(m_resourceManager->GetTexture(m_gDepthTexture));
+   if (!colorTexPtr || !normalTexPtr || !depthTexPtr)
+      return;
    // Create framebuffer
    const GLFramebuffer::CreateInfo gbufferInfo{
       .colorAttachments = {{colorTexPtr, 0, 0}, {normalTexPtr, 0, 0}},
@@ -187,11 +399,6 @@ void GLRenderer::CreateGeometryFBO() {
 
 void GLRenderer::CreateLightingFBO() {
    m_lightingFbo.reset();
-   m_lightingColorTexture =
-      m_resourceManager->CreateRenderTarget("lighting_color", m_window->GetWidth(),
-                                            m_window->GetHeight(), ITexture::Format::SRGB8_ALPHA8);
-   m_lightingDepthTexture = m_resourceManager->CreateDepthTexture(
-      "lighting_depth", m_window->GetWidth(), m_window->GetHeight());
    const auto* colorTexPtr =
       reinterpret_cast<const GLTexture*>(m_resourceManager->GetTexture(m_lightingColorTexture));
    const auto* depthTexPtr =
@@ -205,6 +412,12 @@ void GLRenderer::CreateLightingFBO() {
 }
 
 void GLRenderer::CreateGeometryPass() {
+   if (!m_gBuffer) {
+      m_geometryPass.reset();
+      m_gBufferPrepass.reset();
+      m_geometryEqualPass.reset();
+      return;
+   }
    const GLRenderPass::CreateInfo geometryPassInfo{
       .framebuffer = m_gBuffer.get(),
       .colorAttachments =
@@ -226,6 +439,38 @@ void GLRenderer::CreateGeometryPass() {
                       .primitiveType = GLRenderPass::PrimitiveType::Triangles},
       .shader = m_geometryPassShader.get()};
    m_geometryPass = std::make_unique<GLRenderPass>(geometryPassInfo);
+   // The G-buffer colors are cleared by the geometry pass that follows
+   const GLRenderPass::CreateInfo prepassInfo{
+      .framebuffer = m_gBuffer.get(),
+      .colorAttachments =
+         {
+            {GLRenderPass::LoadOp::DontCare,
+             GLRenderPass::StoreOp::Store,
+             {0.0f, 0.0f, 0.0f, 1.0f}},
+            {GLRenderPass::LoadOp::DontCare,
+             GLRenderPass::StoreOp::Store,
+             {0.5f, 0.5f, 1.0f, 0.0f}},
+         },
+      .depthStencilAttachment = {.depthLoadOp = GLRenderPass::LoadOp::Clear,
+                                 .depthStoreOp = GLRenderPass::StoreOp::Store,
+                                 .stencilLoadOp = GLRenderPass::LoadOp::DontCare,
+                                 .stencilStoreOp = GLRenderPass::StoreOp::DontCare,
+                                 .depthClearValue = 1.0f,
+                                 .stencilClearValue = 0},
+      .renderState = {.depthTest = GLRenderPass::DepthTest::Less,
+                      .depthWrite = true,
+                      .colorWrite = false,
+                      .cullMode = GLRenderPass::CullMode::Back,
+                      .frontFaceCCW = true,
+                      .blendMode = GLRenderPass::BlendMode::None,
+                      .primitiveType = GLRenderPass::PrimitiveType::Triangles},
+      .shader = m_depthPrepassShader.get()};
+   m_gBufferPrepass = std::make_unique<GLRenderPass>(prepassInfo);
+   GLRenderPass::CreateInfo equalPassInfo = geometryPassInfo;
+   equalPassInfo.depthStencilAttachment.depthLoadOp = GLRenderPass::LoadOp::Load;
+   equalPassInfo.renderState.depthTest = GLRenderPass::DepthTest::Equal;
+   equalPassInfo.renderState.depthWrite = false;
+   m_geometryEqualPass = std::make_unique<GLRenderPass>(equalPassInfo);
 }
 
 void GLRenderer::CreateLightingPass() {
@@ -248,6 +493,83 @@ void GLRenderer::CreateLightingPass() {
    m_lightingPass = std::make_unique<GLRenderPass>(lightingPassInfo);
 }
 
+void GLRenderer::CreateForwardPasses() {
+   // Lays down the depth of the visible meshes and clears the color for the forward pass
+   const GLRenderPass::CreateInfo depthPrepassInfo{
+      .framebuffer = m_lightingFbo.get(),
+      .colorAttachments =
+         {
+            {GLRenderPass::LoadOp::Clear, GLRenderPass::StoreOp::Store, {0.0f, 0.0f, 0.0f, 1.0f}},
+         },
+      .depthStencilAttachment = {.depthLoadOp = GLRenderPass::LoadOp::Clear,
+                                 .depthStoreOp = GLRenderPass::StoreOp::Store,
+                                 .stencilLoadOp = GLRenderPass::LoadOp::DontCare,
+                                 .stencilStoreOp = GLRenderPass::StoreOp::DontCare,
+                                 .depthClearValue = 1.0f,
+                                 .stencilClearValue = 0},
+      .renderState = {.depthTest = GLRenderPass::DepthTest::Less,
+                      .depthWrite = true,
+                      .colorWrite = false,
+                      .cullMode = GLRenderPass::CullMode::Back,
+                      .frontFaceCCW = true,
+                      .blendMode = GLRenderPass::BlendMode::None,
+                      .primitiveType = GLRenderPass::PrimitiveType::Triangles},
+      .shader = m_depthPrepassShader.get()};
+   m_depthPrepass = std::make_unique<GLRenderPass>(depthPrepassInfo);
+   // Shades only the fragments whose depth won the prepass
+   const GLRenderPass::CreateInfo forwardPassInfo{
+      .framebuffer = m_lightingFbo.get(),
+      .colorAttachments =
+         {
+            {GLRenderPass::LoadOp::Load, GLRenderPass::StoreOp::Store, {0.0f, 0.0f, 0.0f, 1.0f}},
+         },
+      .depthStencilAttachment = {.depthLoadOp = GLRenderPass::LoadOp::Load,
+                                 .depthStoreOp = GLRenderPass::StoreOp::Store,
+                                 .stencilLoadOp = GLRenderPass::LoadOp::DontCare,
+                                 .stencilStoreOp = GLRenderPass::StoreOp::DontCare,
+                                 .depthClearValue = 1.0f,
+                                 .stencilClearValue = 0},
+      .renderState = {.depthTest = GLRenderPass::DepthTest::Equal,
+                      .depthWrite = false,
+                      .cullMode = GLRenderPass::CullMode::Back,
+                      .frontFaceCCW = true,
+                      .blendMode = GLRenderPass::BlendMode::None,
+                      .primitiveType = GLRenderPass::PrimitiveType::Triangles},
+      .shader = m_forwardPassShader.get()};
+   m_forwardPass = std::make_unique<GLRenderPass>(forwardPassInfo);
+}
+
+void GLRenderer::CreateOverdrawPasses() {
+   // Alpha is one, so the additive blend sums the fragment colors
+   const GLRenderPass::CreateInfo overdrawPassInfo{
+      .framebuffer = m_lightingFbo.get(),
+      .colorAttachments =
+         {
+            {GLRenderPass::LoadOp::Clear, GLRenderPass::StoreOp::Store, {0.0f, 0.0f, 0.0f, 1.0f}},
+         },
+      .depthStencilAttachment = {.depthLoadOp = GLRenderPass::LoadOp::Clear,
+                                 .depthStoreOp = GLRenderPass::StoreOp::Store,
+                                 .stencilLoadOp = GLRenderPass::LoadOp::DontCare,
+                                 .stencilStoreOp = GLRenderPass::StoreOp::DontCare,
+                                 .depthClearValue = 1.0f,
+                                 .stencilClearValue = 0},
+      .renderState = {.depthTest = GLRenderPass::DepthTest::Less,
+                      .depthWrite = true,
+                      .cullMode = GLRenderPass::CullMode::Back,
+                      .frontFaceCCW = true,
+                      .blendMode = GLRenderPass::BlendMode::Additive,
+                      .primitiveType = GLRenderPass::PrimitiveType::Triangles},
+      .shader = m_overdrawShader.get()};
+   m_overdrawPass = std::make_unique<GLRenderPass>(overdrawPassInfo);
+   // After the depth prepass, which already cleared the color
+   GLRenderPass::CreateInfo equalPassInfo = overdrawPassInfo;
+   equalPassInfo.colorAttachments[0].loadOp = GLRenderPass::LoadOp::Load;
+   equalPassInfo.depthStencilAttachment.depthLoadOp = GLRenderPass::LoadOp::Load;
+   equalPassInfo.renderState.depthTest = GLRenderPass::DepthTest::Equal;
+   equalPassInfo.renderState.depthWrite = false;
+   m_overdrawEqualPass = std::make_unique<GLRenderPass>(equalPassInfo);
+}
+
 void GLRenderer::CreateGizmoPass() {
    const GLRenderPass::CreateInfo gizmoPassInfo{
       .framebuffer = m_lightingFbo.get(),
@@ -297,11 +619,12 @@ void GLRenderer::CreateUBOs() {
    const CameraData camData{};
    m_cameraUbo->UploadData(&camData, sizeof(CameraData));
    m_cameraUbo->BindBase(CAMERA_UBO_BINDING);
-   // Create lights UBO
-   m_lightsUbo = std::make_unique<GLBuffer>(GLBuffer::Type::Uniform, GLBuffer::Usage::DynamicDraw);
-   const LightsData lightData{};
-   m_lightsUbo->UploadData(&lightData, sizeof(LightsData));
-   m_lightsUbo->BindBase(LIGHTS_UBO_BINDING);
+   // Create the clustered lighting buffers, sized on first upload
+   m_lightsSsbo = std::make_unique<GLBuffer>(GLBuffer::Type::Storage, GLBuffer::Usage::DynamicDraw);
+   m_clusterSsbo =
+      std::make_unique<GLBuffer>(GLBuffer::Type::Storage, GLBuffer::Usage::DynamicDraw);
+   m_lightIndexSsbo =
+      std::make_unique<GLBuffer>(GLBuffer::Type::Storage, GLBuffer::Usage::DynamicDraw);
    // Create particle instance buffer
    m_particleInstanceCapacity = 100000;
    m_particleInstanceVBO =
@@ -338,7 +661,7 @@ void GLRenderer::RenderImgui() {
    m_materialEditor->DrawTextureBrowser();
    // FPS Overlay
    PerformanceGUI::RenderPerformanceGUI(*m_resourceManager.get(), *m_activeScene,
-                                        m_currentFrameMetrics);
+                                        m_currentFrameMetrics, m_settings);
    // Render end
    ImGui::Render();
    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -353,32 +676,27 @@ void GLRenderer::UpdateCameraUBO() noexcept {
    m_cameraUbo->UpdateData(&camData, sizeof(CameraData));
 }
 
-void GLRenderer::UpdateLightsUBO() noexcept {
-   if (!m_activeScene) [[unlikely]]
-      return;
-   LightsData lightsData{};
-   lightsData.lightCount = 0;
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive() || lightsData.lightCount >= MAX_LIGHTS) [[unlikely]]
+void GLRenderer::UpdateLightBuffers() {
+   // Grow geometrically and re-bind, empty lists still get a buffer so every binding is valid
+   const auto reserve = [](GLBuffer& buffer, const uint32_t binding, const size_t size) {
+      if (buffer.GetSize() >= std::max<size_t>(size, 1))
          return;
-      const auto* lightComp = node->GetComponent<LightComponent>();
-      if (lightComp) [[likely]] {
-         auto& light = lightsData.lights[lightsData.lightCount];
-         light.lightType = static_cast<uint32_t>(lightComp->GetType());
-         light.color = lightComp->GetColor();
-         light.intensity = lightComp->GetIntensity();
-         light.constant = lightComp->GetConstant();
-         light.linear = lightComp->GetLinear();
-         light.quadratic = lightComp->GetQuadratic();
-         const auto* transform = node->GetWorldTransform();
-         light.position = transform->GetPosition();
-         light.direction = transform->GetForward();
-         light.innerCone = lightComp->GetInnerCone();
-         light.outerCone = lightComp->GetOuterCone();
-         ++lightsData.lightCount;
-      }
-   });
-   m_lightsUbo->UpdateData(&lightsData, sizeof(LightsData));
+      buffer.UploadData(nullptr, std::max({size, buffer.GetSize() * 2, sizeof(uint32_t)}));
+      buffer.BindBase(binding);
+   };
+   const std::span<const LightClusterer::GPULight> lights = m_lightClusterer.GetLights();
+   const LightClusterer::GridHeader& header = m_lightClusterer.GetHeader();
+   const std::span<const glm::uvec2> clusters = m_lightClusterer.GetClusters();
+   const std::span<const uint32_t> lightIndices = m_lightClusterer.GetLightIndices();
+   reserve(*m_lightsSsbo, LIGHTS_SSBO_BINDING, lights.size_bytes());
+   reserve(*m_clusterSsbo, CLUSTER_SSBO_BINDING, sizeof(header) + clusters.size_bytes());
+   reserve(*m_lightIndexSsbo, LIGHT_INDEX_SSBO_BINDING, lightIndices.size_bytes());
+   if (!lights.empty())
+      m_lightsSsbo->UpdateData(lights);
+   m_clusterSsbo->UpdateData(&header, sizeof(header));
+   m_clusterSsbo->UpdateData(clusters, sizeof(header));
+   if (!lightIndices.empty())
+      m_lightIndexSsbo->UpdateData(lightIndices);
 }
 
 void GLRenderer::BindGBufferTextures() const noexcept {
@@ -394,56 +712,89 @@ void GLRenderer::BindGBufferTextures() const noexcept {
 }
 
 void GLRenderer::RenderGeometry() const noexcept {
-   if (!m_activeScene) [[unlikely]]
-      return;
-   m_activeScene->ForEachNode([this](const Node* node) {
-      if (!node->IsActive()) [[unlikely]]
-         return;
-      const auto* renderer = node->GetComponent<RendererComponent>();
-      if (!renderer || !renderer->IsVisible() || !renderer->HasMesh()) [[unlikely]]
-         return;
+   uint64_t boundMaterial = 0;
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   for (const uint32_t index : m_renderWorld.GetVisibleMeshes()) {
+      const MeshProxy& proxy = meshes[index];
       // Set transformation matrix
-      if (const auto* worldTransform = node->GetWorldTransform(); worldTransform) [[likely]] {
-         m_geometryPassShader->SetMat4("model", worldTransform->GetTransformMatrix());
-      }
+      m_geometryPassShader->SetMat4("model", proxy.worldMatrix);
       // Render mesh with material
-      const auto* mesh = m_resourceManager->GetMesh(renderer->GetMesh());
-      auto* material = m_resourceManager->GetMaterial(renderer->GetMaterial());
+      const auto* mesh = m_resourceManager->GetMesh(proxy.mesh);
+      auto* material = m_resourceManager->GetMaterial(proxy.material);
       if (mesh && material) [[likely]] {
-         material->Bind(MATERIAL_BINDING_SLOT, *m_resourceManager);
+         // Runs of the same material only bind it once
+         if (proxy.material.GetId() != boundMaterial) {
+            material->Bind(MATERIAL_BINDING_SLOT, *m_resourceManager);
+            boundMaterial = proxy.material.GetId();
+         }
          mesh->Draw();
       }
-   });
+   }
+}
+
+void GLRenderer::RenderDepthPrepass(GLRenderPass& pass) const noexcept {
+   pass.Begin();
+   RenderPositions(*m_depthPrepassShader);
+   pass.End();
 }
 
 void GLRenderer::RenderLighting() const noexcept {
    BindGBufferTextures();
+   // The G-buffer holds the scene in its lower left corner
+   m_lightingPassShader->SetVec2(
+      "uvScale",
+      glm::vec2(static_cast<float>(m_sceneWidth) / static_cast<float>(m_window->GetWidth()),
+                static_cast<float>(m_sceneHeight) / static_cast<float>(m_window->GetHeight())));
    if (const auto* quadMesh = m_resourceManager->GetMesh(m_fullscreenQuad); quadMesh) [[likely]] {
       quadMesh->Draw();
    }
 }
 
+void GLRenderer::RenderPositions(const GLShader& shader) const noexcept {
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   for (const uint32_t index : m_renderWorld.GetVisibleMeshes()) {
+      const MeshProxy& proxy = meshes[index];
+      shader.SetMat4("model", proxy.worldMatrix);
+      if (const auto* mesh = m_resourceManager->GetMesh(proxy.mesh); mesh) [[likely]] {
+         static_cast<const GLMesh*>(mesh)->DrawPositions();
+      }
+   }
+}
+
+void GLRenderer::RenderForward() const noexcept {
+   uint64_t boundMaterial = 0;
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   for (const uint32_t index : m_renderWorld.GetVisibleMeshes()) {
+      const MeshProxy& proxy = meshes[index];
+      m_forwardPassShader->SetMat4("model", proxy.worldMatrix);
+      const auto* mesh = m_resourceManager->GetMesh(proxy.mesh);
+      auto* material = m_resourceManager->GetMaterial(proxy.material);
+      if (mesh && material) [[likely]] {
+         // Runs of the same material only bind it once
+         if (proxy.material.GetId() != boundMaterial) {
+            material->Bind(MATERIAL_BINDING_SLOT, *m_resourceManager);
+            boundMaterial = proxy.material.GetId();
+         }
+         mesh->Draw();
+      }
+   }
+}
+
 void GLRenderer::RenderGizmos() const noexcept {
-   if (!m_activeScene) [[unlikely]]
-      return;
    const auto* cubeMesh = m_resourceManager->GetMesh(m_lineCube);
    const auto* glCubeMesh = dynamic_cast<const GLMesh*>(cubeMesh);
    if (!glCubeMesh) [[unlikely]]
       return;
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive()) [[unlikely]]
-         return;
-      const auto* lightComp = node->GetComponent<LightComponent>();
-      if (lightComp) [[likely]] {
-         m_gizmoPassShader->SetMat4("model", node->GetWorldTransform()->GetTransformMatrix());
-         m_gizmoPassShader->SetVec3("gizmoColor", lightComp->GetColor());
-         glCubeMesh->Draw(m_gizmoPass->GetPrimitiveType());
-      }
-   });
+   for (const LightProxy& light : m_renderWorld.GetLightProxies()) {
+      m_gizmoPassShader->SetMat4("model", light.worldMatrix);
+      m_gizmoPassShader->SetVec3("gizmoColor", light.color);
+      glCubeMesh->Draw(m_gizmoPass->GetPrimitiveType());
+   }
 }
 
 void GLRenderer::RenderParticles() noexcept {
-   if (!m_activeScene) [[unlikely]]
+   const uint32_t totalParticles = m_renderWorld.GetParticleInstanceCount();
+   if (totalParticles == 0)
       return;
    const auto* quadMesh = m_resourceManager->GetMesh(m_fullscreenQuad);
    if (!quadMesh) [[unlikely]]
@@ -451,46 +802,71 @@ void GLRenderer::RenderParticles() noexcept {
    const auto* glQuadMesh = dynamic_cast<const GLMesh*>(quadMesh);
    if (!glQuadMesh) [[unlikely]]
       return;
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive()) [[unlikely]]
-         return;
-      const auto* particles = node->GetComponent<ParticleSystemComponent>();
-      if (!particles) [[unlikely]]
-         return;
-      const auto& instanceData = particles->GetInstanceData();
-      const uint32_t activeCount = particles->GetActiveParticleCount();
-      if (activeCount == 0) [[unlikely]]
-         return;
-      // Ensure instance buffer is large enough
-      const size_t requiredSize = activeCount * sizeof(ParticleInstanceData);
-      if (activeCount > m_particleInstanceCapacity) {
-         m_particleInstanceCapacity = activeCount * 2;
-      }
-      // Upload instance data
-      m_particleInstanceVBO->UploadData(std::span(instanceData.data(), activeCount));
-      // Setup instanced vertex attributes
-      const uint32_t vao = reinterpret_cast<uintptr_t>(glQuadMesh->GetNativeHandle());
-      glBindVertexArray(vao);
-      m_particleInstanceVBO->Bind();
-      for (uint32_t i = 0; i < 4; ++i) {
-         glEnableVertexAttribArray(3 + i);
-         glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstanceData),
-                               reinterpret_cast<void*>(i * sizeof(glm::vec4)));
-         glVertexAttribDivisor(3 + i, 1);
-      }
-      glEnableVertexAttribArray(7);
-      glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstanceData),
-                            reinterpret_cast<void*>(sizeof(glm::mat4)));
-      glVertexAttribDivisor(7, 1);
-      glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(glQuadMesh->GetIndexCount()),
-                              GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(activeCount));
-      // Cleanup divisors
-      for (uint32_t i = 0; i < 4; ++i) {
-         glVertexAttribDivisor(3 + i, 0);
+   // Ensure instance buffer is large enough, then orphan it and pack every system's range
+   if (totalParticles > m_particleInstanceCapacity) {
+      m_particleInstanceCapacity = totalParticles * 2;
+   }
+   m_particleInstanceVBO->UploadData(nullptr,
+                                     m_particleInstanceCapacity * sizeof(ParticleInstanceData));
+   // Sorted particles are already packed, back to front across all systems
+   const std::span<const ParticleInstanceData> sorted = m_particleSorter.GetSortedInstances();
+   if (!sorted.empty()) {
+      m_particleInstanceVBO->UpdateData(sorted, 0);
+   } else {
+      for (const ParticleProxy& range : m_renderWorld.GetParticleProxies()) {
+         m_particleInstanceVBO->UpdateData(std::span(range.instances, range.instanceCount),
+                                           range.firstInstance * sizeof(ParticleInstanceData));
       }
-      glVertexAttribDivisor(7, 0);
-      glBindVertexArray(0);
-   });
+   }
+   // Setup instanced vertex attributes
+   const uint32_t vao = reinterpret_cast<uintptr_t>(glQuadMesh->GetNativeHandle());
+   glBindVertexArray(vao);
+   m_particleInstanceVBO->Bind();
+   for (uint32_t i = 0; i < 4; ++i) {
+      glEnableVertexAttribArray(3 + i);
+      glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstanceData),
+                            reinterpret_cast<void*>(i * sizeof(glm::vec4)));
+      glVertexAttribDivisor(3 + i, 1);
+   }
+   glEnableVertexAttribArray(7);
+   glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleInstanceData),
+                         reinterpret_cast<void*>(sizeof(glm::mat4)));
+   glVertexAttribDivisor(7, 1);
+   glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(glQuadMesh->GetIndexCount()),
+                           GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(totalParticles));
+   // Cleanup divisors
+   for (uint32_t i = 0; i < 4; ++i) {
+      glVertexAttribDivisor(3 + i, 0);
+   }
+   glVertexAttribDivisor(7, 0);
+   glBindVertexArray(0);
+}
+
+void GLRenderer::BeginOverdrawQuery() noexcept {
+   glBeginQuery(GL_SAMPLES_PASSED, m_overdrawQueries[m_overdrawQueryIndex]);
+}
+
+void GLRenderer::EndOverdrawQuery() noexcept {
+   glEndQuery(GL_SAMPLES_PASSED);
+   m_overdrawQueryPixels[m_overdrawQueryIndex] =
+      static_cast<uint64_t>(m_sceneWidth) * static_cast<uint64_t>(m_sceneHeight);
+}
+
+void GLRenderer::ReadOverdrawQuery() noexcept {
+   // The oldest query is reused next frame, its result is kept only if it arrived by now
+   m_overdrawQueryIndex = (m_overdrawQueryIndex + 1) % OVERDRAW_QUERY_COUNT;
+   const uint32_t query = m_overdrawQueries[m_overdrawQueryIndex];
+   uint64_t& pixels = m_overdrawQueryPixels[m_overdrawQueryIndex];
+   if (pixels == 0)
+      return;
+   int32_t available = 0;
+   glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+   if (available) {
+      uint64_t samples = 0;
+      glGetQueryObjectui64v(query, GL_QUERY_RESULT, &samples);
+      m_shadingOverdraw = static_cast<float>(samples) / static_cast<float>(pixels);
+   }
+   pixels = 0;
 }
 
 void GLRenderer::RenderFrame() {
@@ -501,47 +877,25 @@ void GLRenderer::RenderFrame() {
    const auto cpuFrameStart = std::chrono::high_resolution_clock::now();
    ImGuiIO& io = ImGui::GetIO();
    io.DeltaTime = m_deltaTime;
+   // Update the scene and extract what the passes draw
+   UpdateActiveScene(m_deltaTime);
    // Update UBOs
    UpdateCameraUBO();
-   UpdateLightsUBO();
-   m_gpuTimer.Begin("GeometryPass");
-   // Geometry pass
-   m_geometryPass->Begin();
-   if (m_activeScene) [[likely]] {
-      m_activeScene->UpdateScene(m_deltaTime);
-      m_activeScene->UpdateTransforms();
-      RenderGeometry();
-   }
-   m_geometryPass->End();
-   m_gpuTimer.End("GeometryPass");
-   // Copy depth buffer from G-buffer to lighting framebuffer
-   m_gBuffer->BlitTo(*m_lightingFbo, 0, 0, m_window->GetWidth(), m_window->GetHeight(), 0, 0,
-                     m_window->GetWidth(), m_window->GetHeight(), GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-   // Lighting pass
-   m_gpuTimer.Begin("LightingPass");
-   m_lightingPass->Begin();
-   RenderLighting();
-   m_lightingPass->End();
-   m_gpuTimer.End("LightingPass");
-   // Gizmo pass
-   m_gpuTimer.Begin("GizmoPass");
-   m_gizmoPass->Begin();
-   RenderGizmos();
-   m_gizmoPass->End();
-   m_gpuTimer.End("GizmoPass");
-   // Particle pass
-   m_gpuTimer.Begin("ParticlePass");
-   m_particlePass->Begin();
-   RenderParticles();
-   m_particlePass->End();
-   m_gpuTimer.End("ParticlePass");
-   // Blit final result to screen
-   m_lightingFbo->BlitToScreen(m_window->GetWidth(), m_window->GetHeight(), GL_COLOR_BUFFER_BIT,
-                               GL_NEAREST);
-   // Render UI
-   m_gpuTimer.Begin("ImGuiPass");
-   RenderImgui();
-   m_gpuTimer.End("ImGuiPass");
+   UpdateLightBuffers();
+   // Read once, the overlay may switch pipelines while this frame is drawn
+   const RenderPipeline pipeline = m_settings.GetActivePipeline();
+   const bool forward = pipeline == RenderPipeline::ForwardPlus;
+   const bool deferredPrepass = !forward && m_settings.depthPrepass;
+   const bool overdrawView = m_settings.overdrawView;
+   UpdateResolutionScale();
+   BuildRenderGraph(pipeline, deferredPrepass, overdrawView);
+   UpdateFramebuffers();
+   ApplySceneViewport();
+   // GL orders attachment writes before later reads of the same texture by itself, so the
+   // graph's barriers need no commands here
+   m_geometryRecordMs = 0.0f;
+   m_renderGraph->Execute([](std::span<const RenderGraph::Barrier>) {});
+   ReadOverdrawQuery();
    // Swap buffers
    glfwSwapBuffers(m_window->GetNativeWindow());
    // End time
@@ -551,18 +905,46 @@ void GLRenderer::RenderFrame() {
    // Build performance metrics
    m_currentFrameMetrics.frameTimeMs = m_deltaTime * 1000.0f;
    m_currentFrameMetrics.cpuTimeMs = cpuTimeMs;
-   m_currentFrameMetrics.geometryPassMs = m_gpuTimer.GetElapsedMs("GeometryPass");
-   m_currentFrameMetrics.lightingPassMs = m_gpuTimer.GetElapsedMs("LightingPass");
+   CollectSceneMetrics();
+   // The timer keeps the last result of passes that did not run, the other path reads zero
+   m_currentFrameMetrics.pipeline = pipeline;
+   m_currentFrameMetrics.resolutionScale = m_dynamicResolution.GetScale();
+   m_currentFrameMetrics.deferredDepthPrepass = deferredPrepass && !overdrawView;
+   m_currentFrameMetrics.overdrawView = overdrawView;
+   m_currentFrameMetrics.shadingOverdraw = m_shadingOverdraw;
+   const bool prepass = forward || deferredPrepass;
+   const bool deferred = !forward && !overdrawView;
+   // The particles are the last scaled pass and timestamps resolve in order, so once theirs did
+   // the times read below are all this frame's
+   const bool scaledPassesResolved = m_gpuTimer.IsAvailable("ParticlePass");
+   // The overdraw view's pass is reported as the geometry pass it replaces
+   m_currentFrameMetrics.geometryPassMs =
+      overdrawView ? m_gpuTimer.GetElapsedMs("OverdrawPass")
+                   : (deferred ? m_gpuTimer.GetElapsedMs("GeometryPass") : 0.0f);
+   m_currentFrameMetrics.geometryRecordMs = m_geometryRecordMs;
+   m_currentFrameMetrics.geometryDrawCalls =
+      static_cast<uint32_t>(m_renderWorld.GetVisibleMeshes().size());
+   m_currentFrameMetrics.lightingPassMs = deferred ? m_gpuTimer.GetElapsedMs("LightingPass") : 0.0f;
+   m_currentFrameMetrics.depthPrepassMs = prepass ? m_gpuTimer.GetElapsedMs("DepthPrepass") : 0.0f;
+   m_currentFrameMetrics.forwardPassMs =
+      forward && !overdrawView ? m_gpuTimer.GetElapsedMs("ForwardPass") : 0.0f;
    m_currentFrameMetrics.gizmoPassMs = m_gpuTimer.GetElapsedMs("GizmoPass");
    m_currentFrameMetrics.particlePassMs = m_gpuTimer.GetElapsedMs("ParticlePass");
    m_currentFrameMetrics.imguiPassMs = m_gpuTimer.GetElapsedMs("ImGuiPass");
    m_currentFrameMetrics.gpuTimeMs =
       m_currentFrameMetrics.geometryPassMs + m_currentFrameMetrics.lightingPassMs +
+      m_currentFrameMetrics.depthPrepassMs + m_currentFrameMetrics.forwardPassMs +
       m_currentFrameMetrics.gizmoPassMs + m_currentFrameMetrics.particlePassMs +
       m_currentFrameMetrics.imguiPassMs;
+   // The gizmos and ImGui cost about the same at any scale
+   m_scaledPassesMs = scaledPassesResolved
+                         ? m_currentFrameMetrics.gpuTimeMs - m_currentFrameMetrics.gizmoPassMs -
+                              m_currentFrameMetrics.imguiPassMs
+                         : -1.0f;
    m_currentFrameMetrics.vramUsageMB = SystemInfoN::GetOpenGLMemoryUsageMB();
    m_currentFrameMetrics.systemMemUsageMB = SystemInfoN::GetSystemMemoryUsageMB();
    m_currentFrameMetrics.cpuUtilization = SystemInfoN::GetCPUUtilization();
+   CollectRenderGraphMetrics(m_renderGraph->GetStats());
 }
 
 ResourceManager* GLRenderer::GetResourceManager() const noexcept { return m_resourceManager.get(); }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "core/DynamicResolution.hpp"
 #include "core/IRenderer.hpp"
+#include "core/RenderGraph.hpp"
 #include "core/resource/IMaterial.hpp"
 #include "core/resource/IMesh.hpp"
 #include "core/resource/ITexture.hpp"
@@ -8,6 +10,7 @@
 #include "gl/GLBuffer.hpp"
 #include "gl/GLGPUTimer.hpp"
 
+#include <array>
 #include <memory>
 
 class GLFramebuffer;
@@ -40,27 +43,49 @@ class GLRenderer : public IRenderer {
    void LoadShaders();
    void CreateUBOs();
 
-   // Render pass creation methods
+   // Wraps a pass body in its GPU timer, geometry passes also add their CPU recording time to
+   // the frame's geometry record time. Keeps the body's own type, so the wrapper still fits in
+   // a RenderGraph::ExecuteFn
+   template <typename Fn>
+   [[nodiscard]] auto TimedPass(const StringId label, const bool geometry, Fn body);
+   // Declares the frame's passes and the attachments they read and write
+   void BuildRenderGraph(const RenderPipeline pipeline, const bool depthPrepass,
+                         const bool overdrawView);
+   // Rebuilds the framebuffers and passes when the graph moved an attachment
+   void UpdateFramebuffers();
+   // Picks this frame's scene extent from the last frame's GPU time
+   void UpdateResolutionScale();
+   // Points the scene passes at the scaled extent, the overlays keep the whole target
+   void ApplySceneViewport();
+   // Render pass creation methods, the framebuffers wrap the render graph's textures
    void CreateGeometryFBO();
    void CreateGeometryPass();
    void CreateLightingFBO();
    void CreateLightingPass();
+   void CreateForwardPasses();
+   void CreateOverdrawPasses();
    void CreateGizmoPass();
    void CreateParticlePass();
 
    void UpdateCameraUBO() noexcept;
-   void UpdateLightsUBO() noexcept;
+   // Uploads the clustered lights, growing the storage buffers as needed
+   void UpdateLightBuffers();
    void BindGBufferTextures() const noexcept;
    void RenderGeometry() const noexcept;
    void RenderLighting() const noexcept;
+   // Position stream only and no material binds, for the depth prepasses and the overdraw view
+   void RenderPositions(const GLShader& shader) const noexcept;
+   void RenderDepthPrepass(GLRenderPass& pass) const noexcept;
+   void RenderForward() const noexcept;
    void RenderGizmos() const noexcept;
    void RenderParticles() noexcept;
+   // Counts the samples the shading pass writes, read back once the result is available
+   void BeginOverdrawQuery() noexcept;
+   void EndOverdrawQuery() noexcept;
+   void ReadOverdrawQuery() noexcept;
 
    [[nodiscard]] ResourceManager* GetResourceManager() const noexcept override;
 
-  public:
-   static constexpr size_t MAX_LIGHTS = 256;
-
   private:
    double m_lastFrameTime{0};
    float m_deltaTime{0};
@@ -70,20 +95,48 @@ class GLRenderer : public IRenderer {
    MeshHandle m_lineCube;
    // Create UBOs for shader data
    std::unique_ptr<GLBuffer> m_cameraUbo;
-   std::unique_ptr<GLBuffer> m_lightsUbo;
-   // Geometry pass things
+   // Clustered lighting storage buffers
+   std::unique_ptr<GLBuffer> m_lightsSsbo;
+   std::unique_ptr<GLBuffer> m_clusterSsbo;
+   std::unique_ptr<GLBuffer> m_lightIndexSsbo;
+   // Owns the G-buffer and lighting attachments, their handles are refreshed every frame
+   std::unique_ptr<RenderGraph> m_renderGraph;
+   uint64_t m_framebufferVersion{UINT64_MAX};
+   // Geometry pass things, invalid while the frame draws no G-buffer
    TextureHandle m_gDepthTexture;
    TextureHandle m_gAlbedoTexture; // RGB color + A AO
    TextureHandle m_gNormalTexture; // RG encoded normal + B roughness + A metallic
    std::unique_ptr<GLFramebuffer> m_gBuffer;
    std::unique_ptr<GLRenderPass> m_geometryPass;
    std::unique_ptr<GLShader> m_geometryPassShader;
+   // Deferred depth prepass into the G-buffer depth, then the geometry pass shades with an equal
+   // depth test and without depth writes
+   std::unique_ptr<GLRenderPass> m_gBufferPrepass;
+   std::unique_ptr<GLRenderPass> m_geometryEqualPass;
    // Lighting pass things
    TextureHandle m_lightingColorTexture;
    TextureHandle m_lightingDepthTexture;
    std::unique_ptr<GLFramebuffer> m_lightingFbo;
    std::unique_ptr<GLRenderPass> m_lightingPass;
    std::unique_ptr<GLShader> m_lightingPassShader;
+   // Forward+ things, both passes draw into the lighting framebuffer
+   std::unique_ptr<GLRenderPass> m_depthPrepass;
+   std::unique_ptr<GLShader> m_depthPrepassShader;
+   std::unique_ptr<GLRenderPass> m_forwardPass;
+   std::unique_ptr<GLShader> m_forwardPassShader;
+   // Overdraw view, additive per fragment, depth tested like the pass it stands in for
+   std::unique_ptr<GLRenderPass> m_overdrawPass;
+   std::unique_ptr<GLRenderPass> m_overdrawEqualPass;
+   std::unique_ptr<GLShader> m_overdrawShader;
+   // Samples passed by the shading pass, a ring so a frame reads an older query without a stall
+   static constexpr uint32_t OVERDRAW_QUERY_COUNT = 2;
+   std::array<uint32_t, OVERDRAW_QUERY_COUNT> m_overdrawQueries{};
+   // Scene pixels each query was issued for, zero while it holds no pending result
+   std::array<uint64_t, OVERDRAW_QUERY_COUNT> m_overdrawQueryPixels{};
+   uint32_t m_overdrawQueryIndex{0};
+   float m_shadingOverdraw{0.0f};
+   // CPU time recording the geometry, or the prepass and forward pass, this frame
+   float m_geometryRecordMs{0.0f};
    // Gizmo pass things
    std::unique_ptr<GLRenderPass> m_gizmoPass;
    std::unique_ptr<GLShader> m_gizmoPassShader;
@@ -92,6 +145,14 @@ class GLRenderer : public IRenderer {
    std::unique_ptr<GLShader> m_particlePassShader;
    std::unique_ptr<GLBuffer> m_particleInstanceVBO;
    size_t m_particleInstanceCapacity{0};
+   // The attachments stay at the window size, the scene passes only draw the lower left
+   // m_sceneWidth x m_sceneHeight of them, which is stretched over the window when presented
+   DynamicResolution m_dynamicResolution;
+   uint32_t m_sceneWidth{0};
+   uint32_t m_sceneHeight{0};
+   // GPU time of the passes whose cost follows the scale, negative while the last frame's
+   // queries have not resolved
+   float m_scaledPassesMs{-1.0f};
    // Timer
    GLGPUTimer m_gpuTimer;
    // ResourceManager
@@ -103,5 +164,7 @@ class GLRenderer : public IRenderer {
    static constexpr uint32_t GBUFFER_NORMAL_SLOT = 4;
    static constexpr uint32_t GBUFFER_DEPTH_SLOT = 5;
    static constexpr uint32_t CAMERA_UBO_BINDING = 0;
-   static constexpr uint32_t LIGHTS_UBO_BINDING = 1;
+   static constexpr uint32_t LIGHTS_SSBO_BINDING = 1;
+   static constexpr uint32_t CLUSTER_SSBO_BINDING = 6;
+   static constexpr uint32_t LIGHT_INDEX_SSBO_BINDING = 7;
 };
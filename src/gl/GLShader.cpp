@@ -76,61 +76,61 @@ void GLShader::Use() const noexcept {
 
 void GLShader::Unbind() noexcept { glUseProgram(0); }
 
-void GLShader::SetBool(const std::string_view name, const bool value) const noexcept {
+void GLShader::SetBool(const StringId name, const bool value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform1i(location, static_cast<int>(value));
    }
 }
 
-void GLShader::SetInt(const std::string_view name, const int32_t value) const noexcept {
+void GLShader::SetInt(const StringId name, const int32_t value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform1i(location, value);
    }
 }
 
-void GLShader::SetUint(const std::string_view name, const uint32_t value) const noexcept {
+void GLShader::SetUint(const StringId name, const uint32_t value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform1ui(location, value);
    }
 }
 
-void GLShader::SetFloat(const std::string_view name, const float value) const noexcept {
+void GLShader::SetFloat(const StringId name, const float value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform1f(location, value);
    }
 }
 
-void GLShader::SetVec2(const std::string_view name, const glm::vec2& value) const noexcept {
+void GLShader::SetVec2(const StringId name, const glm::vec2& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform2fv(location, 1, glm::value_ptr(value));
    }
 }
 
-void GLShader::SetVec3(const std::string_view name, const glm::vec3& value) const noexcept {
+void GLShader::SetVec3(const StringId name, const glm::vec3& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform3fv(location, 1, glm::value_ptr(value));
    }
 }
 
-void GLShader::SetVec4(const std::string_view name, const glm::vec4& value) const noexcept {
+void GLShader::SetVec4(const StringId name, const glm::vec4& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniform4fv(location, 1, glm::value_ptr(value));
    }
 }
 
-void GLShader::SetMat2(const std::string_view name, const glm::mat2& value) const noexcept {
+void GLShader::SetMat2(const StringId name, const glm::mat2& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniformMatrix2fv(location, 1, GL_FALSE, glm::value_ptr(value));
    }
 }
 
-void GLShader::SetMat3(const std::string_view name, const glm::mat3& value) const noexcept {
+void GLShader::SetMat3(const StringId name, const glm::mat3& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value));
    }
 }
 
-void GLShader::SetMat4(const std::string_view name, const glm::mat4& value) const noexcept {
+void GLShader::SetMat4(const StringId name, const glm::mat4& value) const noexcept {
    if (const int32_t location = GetUniformLocation(name); location != -1) {
       glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
    }
@@ -199,12 +199,11 @@ std::string GLShader::ReadFile(const std::string_view filepath) {
    return buffer.str();
 }
 
-uint32_t GLShader::GetUniformLocation(const std::string_view name) const {
-   const std::string nameStr(name);
-   if (const auto it = m_uniformLocations.find(nameStr); it != m_uniformLocations.end()) {
+int32_t GLShader::GetUniformLocation(const StringId name) const {
+   if (const auto it = m_uniformLocations.find(name); it != m_uniformLocations.end()) {
       return it->second;
    }
-   const int32_t location = glGetUniformLocation(m_program, nameStr.c_str());
-   m_uniformLocations.emplace(nameStr, location);
+   const int32_t location = glGetUniformLocation(m_program, name.CStr());
+   m_uniformLocations.emplace(name, location);
    return location;
 }
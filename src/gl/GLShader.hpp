@@ -1,5 +1,7 @@
 #pragma once
 
+#include "core/StringId.hpp"
+
 #include <glad/gl.h>
 
 #include <string>
@@ -33,16 +35,16 @@ class GLShader final {
    static void Unbind() noexcept;
 
    // Uniform setters
-   void SetBool(const std::string_view name, const bool value) const noexcept;
-   void SetInt(const std::string_view name, const int32_t value) const noexcept;
-   void SetUint(const std::string_view name, const uint32_t value) const noexcept;
-   void SetFloat(const std::string_view name, const float value) const noexcept;
-   void SetVec2(const std::string_view name, const glm::vec2& value) const noexcept;
-   void SetVec3(const std::string_view name, const glm::vec3& value) const noexcept;
-   void SetVec4(const std::string_view name, const glm::vec4& value) const noexcept;
-   void SetMat2(const std::string_view name, const glm::mat2& value) const noexcept;
-   void SetMat3(const std::string_view name, const glm::mat3& value) const noexcept;
-   void SetMat4(const std::string_view name, const glm::mat4& value) const noexcept;
+   void SetBool(const StringId name, const bool value) const noexcept;
+   void SetInt(const StringId name, const int32_t value) const noexcept;
+   void SetUint(const StringId name, const uint32_t value) const noexcept;
+   void SetFloat(const StringId name, const float value) const noexcept;
+   void SetVec2(const StringId name, const glm::vec2& value) const noexcept;
+   void SetVec3(const StringId name, const glm::vec3& value) const noexcept;
+   void SetVec4(const StringId name, const glm::vec4& value) const noexcept;
+   void SetMat2(const StringId name, const glm::mat2& value) const noexcept;
+   void SetMat3(const StringId name, const glm::mat3& value) const noexcept;
+   void SetMat4(const StringId name, const glm::mat4& value) const noexcept;
 
    void BindUniformBlock(const std::string_view blockName, const uint32_t bindingPoint) const;
 
@@ -53,10 +55,10 @@ class GLShader final {
   private:
    [[nodiscard]] static uint32_t CompileShader(const Type type, const std::string_view source);
    [[nodiscard]] static std::string ReadFile(const std::string_view filepath);
-   [[nodiscard]] uint32_t GetUniformLocation(const std::string_view name) const;
+   [[nodiscard]] int32_t GetUniformLocation(const StringId name) const;
 
   private:
    uint32_t m_program{0};
    bool m_isLinked{false};
-   mutable std::unordered_map<std::string, uint32_t> m_uniformLocations;
+   mutable std::unordered_map<StringId, int32_t> m_uniformLocations;
 };
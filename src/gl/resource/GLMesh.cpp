@@ -2,10 +2,15 @@
 
 #include "core/Vertex.hpp"
 
-GLMesh::GLMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) noexcept
+#include <vector>
+
+GLMesh::GLMesh(const std::span<const Vertex> vertices,
+               const std::span<const uint32_t> indices) noexcept
     : m_ebo(GLBuffer::Type::Element, GLBuffer::Usage::StaticDraw),
       m_vbo(GLBuffer::Type::Array, GLBuffer::Usage::StaticDraw),
       m_vao(),
+      m_positionVbo(GLBuffer::Type::Array, GLBuffer::Usage::StaticDraw),
+      m_positionVao(),
       m_indexCount(indices.size()),
       m_vertexCount(vertices.size()) {
    if (!vertices.empty())
@@ -23,10 +28,21 @@ GLMesh::GLMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>&
    m_vao.AttachVertexBuffer(m_vbo, 0, 0, sizeof(Vertex));
    m_vao.AttachElementBuffer(m_ebo);
    m_vao.SetupVertexAttributes();
+   std::vector<glm::vec3> positions;
+   positions.reserve(vertices.size());
+   for (const Vertex& vertex : vertices)
+      positions.push_back(vertex.position);
+   if (!positions.empty())
+      m_positionVbo.UploadData(std::span<const glm::vec3>(positions));
+   m_positionVao.AttachVertexBuffer(m_positionVbo, 0, 0, sizeof(glm::vec3));
+   m_positionVao.AttachElementBuffer(m_ebo);
+   m_positionVao.EnableAttribute(0);
+   m_positionVao.SetAttributeFormat(0, 3, GL_FLOAT, GL_FALSE, 0);
+   m_positionVao.SetAttributeBinding(0, 0);
 }
 
 size_t GLMesh::GetMemoryUsage() const noexcept {
-   return (m_vertexCount * sizeof(Vertex)) +
+   return (m_vertexCount * (sizeof(Vertex) + sizeof(glm::vec3))) +
           (m_indexCount * (m_indexType == GL_UNSIGNED_INT ? sizeof(uint32_t) : sizeof(uint16_t)));
 }
 
@@ -40,6 +56,10 @@ void GLMesh::Draw(const uint32_t drawType) const {
    m_vao.DrawElements(drawType, m_indexCount, m_indexType);
 }
 
+void GLMesh::DrawPositions() const noexcept {
+   m_positionVao.DrawElements(GL_TRIANGLES, m_indexCount, m_indexType);
+}
+
 void* GLMesh::GetNativeHandle() const noexcept {
    return reinterpret_cast<void*>(static_cast<uintptr_t>(m_vao.Get()));
 }
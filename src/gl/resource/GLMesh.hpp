@@ -5,13 +5,14 @@
 #include "gl/GLBuffer.hpp"
 #include "gl/GLVertexArray.hpp"
 
-#include <vector>
+#include <span>
 
 struct Vertex;
 
 class GLMesh final : public IMesh {
   public:
-   GLMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) noexcept;
+   GLMesh(const std::span<const Vertex> vertices,
+          const std::span<const uint32_t> indices) noexcept;
    ~GLMesh() override = default;
 
    GLMesh(const GLMesh&) = delete;
@@ -25,6 +26,8 @@ class GLMesh final : public IMesh {
 
    void Draw() const noexcept override;
    void Draw(const uint32_t drawType) const;
+   // Triangles from the packed positions, for passes that only lay down depth
+   void DrawPositions() const noexcept;
    [[nodiscard]] constexpr size_t GetVertexCount() const noexcept override { return m_vertexCount; }
    [[nodiscard]] constexpr size_t GetIndexCount() const noexcept override { return m_indexCount; }
    [[nodiscard]] void* GetNativeHandle() const noexcept override;
@@ -33,6 +36,9 @@ class GLMesh final : public IMesh {
    GLBuffer m_ebo;
    GLBuffer m_vbo;
    GLVertexArray m_vao;
+   // Positions alone, so depth-only passes fetch 12 bytes per vertex instead of a whole Vertex
+   GLBuffer m_positionVbo;
+   GLVertexArray m_positionVao;
    uint32_t m_indexType{GL_UNSIGNED_INT};
 
    size_t m_indexCount{0};
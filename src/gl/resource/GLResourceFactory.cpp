@@ -19,6 +19,12 @@ std::unique_ptr<ITexture> GLResourceFactory::CreateTextureFromFile(const std::st
    return std::make_unique<GLTexture>(std::string{filepath}, generateMipmaps, sRGB);
 }
 
+std::unique_ptr<ITexture> GLResourceFactory::CreateTextureFromImage(const ImageData& image,
+                                                                    const bool generateMipmaps,
+                                                                    const bool sRGB) {
+   return std::make_unique<GLTexture>(image, generateMipmaps, sRGB);
+}
+
 std::unique_ptr<ITexture> GLResourceFactory::CreateDepthTexture(const uint32_t width,
                                                                 const uint32_t height,
                                                                 const ITexture::Format format) {
@@ -28,7 +34,8 @@ std::unique_ptr<ITexture> GLResourceFactory::CreateDepthTexture(const uint32_t w
 std::unique_ptr<ITexture> GLResourceFactory::CreateRenderTarget(const uint32_t width,
                                                                 const uint32_t height,
                                                                 const ITexture::Format format,
-                                                                const uint32_t samples) {
+                                                                const uint32_t samples,
+                                                                const bool) {
    return std::make_unique<GLTexture>(width, height, format, false, samples);
 }
 
@@ -36,7 +43,7 @@ std::unique_ptr<IMaterial> GLResourceFactory::CreateMaterial(const MaterialTempl
    return std::make_unique<GLMaterial>(matTemplate);
 }
 
-std::unique_ptr<IMesh> GLResourceFactory::CreateMesh(const std::vector<Vertex>& vertices,
-                                                     const std::vector<uint32_t>& indices) {
+std::unique_ptr<IMesh> GLResourceFactory::CreateMesh(const std::span<const Vertex> vertices,
+                                                     const std::span<const uint32_t> indices) {
    return std::make_unique<GLMesh>(vertices, indices);
 }
@@ -13,13 +13,17 @@ class GLResourceFactory final : public IResourceFactory {
    std::unique_ptr<ITexture> CreateTextureFromFile(const std::string_view filepath,
                                                    const bool generateMipmaps,
                                                    const bool sRGB) override;
+   std::unique_ptr<ITexture> CreateTextureFromImage(const ImageData& image,
+                                                    const bool generateMipmaps,
+                                                    const bool sRGB) override;
    std::unique_ptr<ITexture> CreateDepthTexture(const uint32_t width, const uint32_t height,
                                                 const ITexture::Format format) override;
    std::unique_ptr<ITexture> CreateRenderTarget(const uint32_t width, const uint32_t height,
                                                 const ITexture::Format format,
-                                                const uint32_t samples) override;
+                                                const uint32_t samples,
+                                                const bool transientAttachment) override;
 
    std::unique_ptr<IMaterial> CreateMaterial(const MaterialTemplate& matTemplate) override;
-   std::unique_ptr<IMesh> CreateMesh(const std::vector<Vertex>& vertices,
-                                     const std::vector<uint32_t>& indices) override;
+   std::unique_ptr<IMesh> CreateMesh(const std::span<const Vertex> vertices,
+                                     const std::span<const uint32_t> indices) override;
 };
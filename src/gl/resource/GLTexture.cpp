@@ -1,7 +1,6 @@
 #include "gl/resource/GLTexture.hpp"
 
 #include <glad/gl.h>
-#include <stb_image.h>
 
 #include <utility>
 #include <cassert>
@@ -26,6 +25,8 @@ static constexpr size_t BytesPerPixelForFormat(const ITexture::Format fmt) noexc
          return 3;
       case ITexture::Format::Depth32F:
          return 4;
+      case ITexture::Format::R32UI:
+         return 4;
    }
    return 4;
 }
@@ -42,28 +43,27 @@ GLTexture::GLTexture(const CreateInfo& info)
 }
 
 GLTexture::GLTexture(const std::string& filepath, const bool generateMipmaps, const bool sRGB)
+    : GLTexture(ImageData::LoadFromFile(filepath), generateMipmaps, sRGB) {}
+
+GLTexture::GLTexture(const ImageData& image, const bool generateMipmaps, const bool sRGB)
     : m_depth(1), m_format(Format::RGBA8), m_isDepth(false), m_samples(1) {
-   glGenTextures(1, &m_id);
-   int32_t w = 0, h = 0, channels = 0;
-   uint8_t* data = stbi_load(filepath.c_str(), &w, &h, &channels, 4);
-   if (!data) {
-      glDeleteTextures(1, &m_id);
-      m_id = 0;
+   if (image.IsEmpty())
       return;
-   }
-   m_width = static_cast<uint32_t>(w);
-   m_height = static_cast<uint32_t>(h);
+   glGenTextures(1, &m_id);
+   m_width = image.width;
+   m_height = image.height;
    uint32_t externalFormat = GL_RGBA;
    uint32_t internalFormat = sRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
    m_format = sRGB ? Format::SRGB8_ALPHA8 : Format::RGBA8;
    const uint32_t target = GL_TEXTURE_2D;
    glBindTexture(target, m_id);
    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-   glTexStorage2D(
-      target,
-      1u + (generateMipmaps ? static_cast<uint32_t>(std::floor(std::log2(std::max(w, h)))) : 0u),
-      internalFormat, m_width, m_height);
-   glTexSubImage2D(target, 0, 0, 0, m_width, m_height, externalFormat, GL_UNSIGNED_BYTE, data);
+   const uint32_t extraMips =
+      generateMipmaps ? static_cast<uint32_t>(std::floor(std::log2(std::max(m_width, m_height))))
+                      : 0u;
+   glTexStorage2D(target, 1u + extraMips, internalFormat, m_width, m_height);
+   glTexSubImage2D(target, 0, 0, 0, m_width, m_height, externalFormat, GL_UNSIGNED_BYTE,
+                   image.pixels.get());
    if (generateMipmaps) {
       glGenerateMipmap(target);
    }
@@ -73,7 +73,6 @@ GLTexture::GLTexture(const std::string& filepath, const bool generateMipmaps, co
    glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_REPEAT);
    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_REPEAT);
-   stbi_image_free(data);
 }
 
 GLTexture::GLTexture(const uint32_t width, const uint32_t height, const Format format,
@@ -208,8 +207,10 @@ void GLTexture::CreateStorage() {
       }
    }
    glTexStorage2D(target, 1, internal, m_width, m_height);
-   glTexParameteri(target, GL_TEXTURE_MIN_FILTER, m_isDepth ? GL_NEAREST : GL_LINEAR);
-   glTexParameteri(target, GL_TEXTURE_MAG_FILTER, m_isDepth ? GL_NEAREST : GL_LINEAR);
+   // Integer textures are incomplete with linear filtering
+   const bool nearest = m_isDepth || m_format == Format::R32UI;
+   glTexParameteri(target, GL_TEXTURE_MIN_FILTER, nearest ? GL_NEAREST : GL_LINEAR);
+   glTexParameteri(target, GL_TEXTURE_MAG_FILTER, nearest ? GL_NEAREST : GL_LINEAR);
    glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
    glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
@@ -234,6 +235,8 @@ uint32_t GLTexture::ConvertFormatInternal(const Format fmt) const noexcept {
          return GL_DEPTH_COMPONENT24;
       case Format::Depth32F:
          return GL_DEPTH_COMPONENT32F;
+      case Format::R32UI:
+         return GL_R32UI;
       default:
          return GL_RGBA8;
    }
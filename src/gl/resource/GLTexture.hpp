@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/resource/ITexture.hpp"
+#include "core/resource/ImageData.hpp"
 
 #include <glm/glm.hpp>
 #include <string>
@@ -10,6 +11,7 @@ class GLTexture final : public ITexture {
    explicit GLTexture(const CreateInfo& info);
    explicit GLTexture(const std::string& filepath, const bool generateMipmaps = true,
                       const bool sRGB = true);
+   GLTexture(const ImageData& image, const bool generateMipmaps, const bool sRGB);
    GLTexture(const uint32_t width, const uint32_t height, const Format format,
              const bool isDepth = false, const uint32_t samples = 1);
    GLTexture(const Format format, const glm::vec4& color);
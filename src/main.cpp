@@ -6,7 +6,11 @@
 #include "core/Window.hpp"
 #include "core/Camera.hpp"
 
+#include "core/scene/PotentiallyVisibleSet.hpp"
+#include "core/scene/RenderWorld.hpp"
 #include "core/scene/Scene.hpp"
+#include "core/scene/SceneSnapshot.hpp"
+#include "core/scene/SceneStreamer.hpp"
 #include "glm/trigonometric.hpp"
 
 #include "BaseScene.hpp"
@@ -14,7 +18,11 @@
 
 #include <GLFW/glfw3.h>
 
+#include <cstdlib>
+#include <filesystem>
+#include <format>
 #include <memory>
+#include <optional>
 #include <print>
 #include <chrono>
 
@@ -32,6 +40,21 @@ int main(int argc, char* argv[]) {
    // Check argv for api
    GraphicsAPI api = GraphicsAPI::Vulkan;
    bool inputEnabled = true;
+   bool rebuildScene = false;
+   bool streamScene = false;
+   bool occlusionCulling = false;
+   bool gpuDrivenGeometry = false;
+   bool gBufferSubpasses = false;
+   bool depthPrepass = false;
+   bool overdrawView = false;
+   // Target GPU time in ms, zero leaves dynamic resolution off
+   float dynamicResolutionMs = 0.0f;
+   bool usePvs = false;
+   RenderPipeline pipeline = RenderPipeline::Deferred;
+   bool particleSorting = true;
+   size_t streamBudgetMB = 2048;
+   // Set by -gen, replaces the fixed scenes
+   std::optional<ScalableSceneDesc> generatedScene;
    uint8_t sceneIndex = 0;
    for (int32_t i = 1; i < argc; ++i) {
       const std::string arg = argv[i];
@@ -48,6 +71,44 @@ int main(int argc, char* argv[]) {
          }
       } else if (arg == "-noinput") {
          inputEnabled = false;
+      } else if (arg == "-rebuild") {
+         rebuildScene = true;
+      } else if (arg == "-gen" && i + 3 < argc) {
+         generatedScene = ScalableSceneDesc{
+            .instanceCount = std::strtoull(argv[i + 1], nullptr, 10),
+            .lightCount = std::strtoull(argv[i + 2], nullptr, 10),
+            .particleSystemCount = std::strtoull(argv[i + 3], nullptr, 10)};
+         i += 3;
+         if (generatedScene->instanceCount == 0)
+            return EXIT_FAILURE;
+      } else if (arg == "-occlusion") {
+         occlusionCulling = true;
+      } else if (arg == "-gpudriven") {
+         gpuDrivenGeometry = true;
+      } else if (arg == "-subpasses") {
+         gBufferSubpasses = true;
+      } else if (arg == "-prepass") {
+         depthPrepass = true;
+      } else if (arg == "-overdraw") {
+         overdrawView = true;
+      } else if (arg == "-dynres" && i + 1 < argc) {
+         dynamicResolutionMs = std::strtof(argv[++i], nullptr);
+         if (dynamicResolutionMs <= 0.0f)
+            return EXIT_FAILURE;
+      } else if (arg == "-forward") {
+         pipeline = RenderPipeline::ForwardPlus;
+      } else if (arg == "-visbuffer") {
+         pipeline = RenderPipeline::VisibilityBuffer;
+      } else if (arg == "-pvs") {
+         usePvs = true;
+      } else if (arg == "-nosort") {
+         particleSorting = false;
+      } else if (arg == "-stream") {
+         streamScene = true;
+      } else if (arg == "-budget" && i + 1 < argc) {
+         streamBudgetMB = std::strtoull(argv[++i], nullptr, 10);
+         if (streamBudgetMB == 0)
+            return EXIT_FAILURE;
       } else {
          return EXIT_FAILURE;
       }
@@ -68,39 +129,100 @@ int main(int argc, char* argv[]) {
 
       // Create the scene
       ResourceManager* resourceManager = renderer->GetResourceManager();
-      Scene scene("Scene_" + std::to_string(sceneIndex));
-      switch (sceneIndex) {
-         case 0:
-            // 5 lights, 1 particle system
-            // Partial scene 1
-            LoadBaseScene(scene, *resourceManager, api, 4);
-            AddParticles(scene, 1);
-            break;
-         case 1:
-            // 9 lights, 1 particle system
-            // Partial scene 2
-            LoadBaseScene(scene, *resourceManager, api, 8);
-            AddParticles(scene, 1);
-            break;
-         case 2:
-            // 17 lights, 1 particle system
-            // Partial scene 3
-            LoadBaseScene(scene, *resourceManager, api, 16);
-            AddParticles(scene, 1);
-            break;
-         case 3:
-            // 22 lights, 0 particle system
-            // Full lit up scene
-            LoadBaseScene(scene, *resourceManager, api, 21);
-            break;
-         case 4:
-            // 1 lights, 2 particle systems
-            // Particle only scene
-            LoadBaseScene(scene, *resourceManager, api, 0);
-            AddParticles(scene, 2);
-            break;
-         default:
-            return EXIT_FAILURE;
+      // Generated scenes are named after their size, so benchmark logs can be plotted against it
+      std::string sceneName = "Scene_" + std::to_string(sceneIndex);
+      if (streamScene) {
+         sceneName = "Scene_stream";
+      } else if (generatedScene) {
+         sceneName = std::format("Scene_gen_{}i_{}l_{}p", generatedScene->instanceCount,
+                                 generatedScene->lightCount, generatedScene->particleSystemCount);
+      }
+      Scene scene(renderer->GetThreadPool(), sceneName);
+      // Declared after the scene so its loads finish before the scene goes away
+      std::unique_ptr<SceneStreamer> streamer;
+      // Scenes are built from code once and snapshotted, later runs map the snapshot instead
+      const std::string snapshotPath =
+         generatedScene ? "resources/cache/" + sceneName + ".snapshot"
+                        : "resources/cache/scene_" + std::to_string(sceneIndex) + ".snapshot";
+      // Snapshots of older code or another model are rebuilt instead of loaded
+      const uint64_t snapshotKey =
+         GetSceneContentKey(sceneIndex, generatedScene ? &*generatedScene : nullptr);
+      const auto loadStart = std::chrono::high_resolution_clock::now();
+      if (streamScene) {
+         // Cells come and go with the camera, so there is nothing to snapshot
+         streamer = std::make_unique<SceneStreamer>(
+            scene, *resourceManager,
+            SceneStreamer::Settings{.memoryBudgetBytes = streamBudgetMB << 20});
+         LoadStreamingScene(scene, *resourceManager, *streamer, 4);
+         renderer->SetSceneStreamer(streamer.get());
+      } else if (rebuildScene ||
+                 !SceneSnapshot::Load(snapshotPath, scene, *resourceManager, snapshotKey)) {
+         // Keep mesh geometry on the CPU until the snapshot is written
+         resourceManager->SetRetainMeshData(true);
+         if (generatedScene) {
+            // Sponza copies, lights and particle systems in any amount
+            LoadScalableScene(scene, *resourceManager, *generatedScene);
+         } else {
+            switch (sceneIndex) {
+               case 0:
+                  // 5 lights, 1 particle system
+                  // Partial scene 1
+                  LoadBaseScene(scene, *resourceManager, api, 4);
+                  AddParticles(scene, 1);
+                  break;
+               case 1:
+                  // 9 lights, 1 particle system
+                  // Partial scene 2
+                  LoadBaseScene(scene, *resourceManager, api, 8);
+                  AddParticles(scene, 1);
+                  break;
+               case 2:
+                  // 17 lights, 1 particle system
+                  // Partial scene 3
+                  LoadBaseScene(scene, *resourceManager, api, 16);
+                  AddParticles(scene, 1);
+                  break;
+               case 3:
+                  // 22 lights, 0 particle system
+                  // Full lit up scene
+                  LoadBaseScene(scene, *resourceManager, api, 21);
+                  break;
+               case 4:
+                  // 1 lights, 2 particle systems
+                  // Particle only scene
+                  LoadBaseScene(scene, *resourceManager, api, 0);
+                  AddParticles(scene, 2);
+                  break;
+               default:
+                  return EXIT_FAILURE;
+            }
+         }
+         SceneSnapshot::Save(scene, *resourceManager, snapshotPath, snapshotKey);
+         resourceManager->SetRetainMeshData(false);
+      }
+      const auto loadEnd = std::chrono::high_resolution_clock::now();
+      std::println("Loaded {} ({} nodes) in {:.1f} ms", scene.GetName(), scene.GetNodeCount(),
+                   std::chrono::duration<float, std::milli>(loadEnd - loadStart).count());
+      // Baked against the loaded scene's proxies, streamed scenes change too often to bake
+      std::unique_ptr<PotentiallyVisibleSet> pvs;
+      if (usePvs && !streamScene) {
+         scene.UpdateTransforms();
+         RenderWorld bakeWorld;
+         bakeWorld.Extract(scene, *resourceManager, nullptr);
+         const std::filesystem::path pvsPath =
+            std::filesystem::path(snapshotPath).replace_extension(".pvs");
+         pvs = std::make_unique<PotentiallyVisibleSet>();
+         if (rebuildScene || !pvs->Load(pvsPath) || !pvs->Matches(bakeWorld)) {
+            const auto bakeStart = std::chrono::high_resolution_clock::now();
+            *pvs = PotentiallyVisibleSet::Bake(bakeWorld, *resourceManager,
+                                               renderer->GetThreadPool());
+            const auto bakeEnd = std::chrono::high_resolution_clock::now();
+            std::println("Baked {} visibility cells ({:.1f} meshes per cell) in {:.1f} ms",
+                         pvs->GetCellCount(), pvs->GetAverageCellMeshes(),
+                         std::chrono::duration<float, std::milli>(bakeEnd - bakeStart).count());
+            pvs->Save(pvsPath);
+         }
+         renderer->SetPotentiallyVisibleSet(pvs.get());
       }
       renderer->SetActiveScene(&scene);
 
@@ -115,6 +237,27 @@ int main(int argc, char* argv[]) {
       const float camSpeed = 3.0f;
       const float camRotateSpeed = glm::radians(60.0f);
       renderer->SetActiveCamera(&cam);
+      RenderSettings& renderSettings = renderer->GetRenderSettings();
+      renderSettings.occlusionCulling = occlusionCulling;
+      renderSettings.potentiallyVisibleSet = pvs != nullptr;
+      renderSettings.pipeline = pipeline;
+      if (renderSettings.GetActivePipeline() != pipeline) {
+         std::println("{} is not implemented by this renderer, drawing and logging {} instead",
+                      GetRenderPipelineName(pipeline),
+                      GetRenderPipelineName(renderSettings.GetActivePipeline()));
+      }
+      renderSettings.particleSorting = particleSorting;
+      // Ignored by renderers without a GPU-driven path
+      renderSettings.gpuDrivenGeometry = gpuDrivenGeometry;
+      renderSettings.gBufferSubpasses = gBufferSubpasses;
+      renderSettings.depthPrepass = depthPrepass;
+      renderSettings.overdrawView = overdrawView;
+      if (dynamicResolutionMs > 0.0f) {
+         renderSettings.dynamicResolution = true;
+         renderSettings.targetFrameTimeMs = dynamicResolutionMs;
+         if (!renderSettings.dynamicResolutionAvailable)
+            std::println("-dynres is ignored, this renderer always renders at scale 1");
+      }
 
       // Create logger
       PerformanceLogger perfLogger("benchmark_results");
@@ -122,6 +265,7 @@ int main(int argc, char* argv[]) {
          api, window,
          api == GraphicsAPI::Vulkan ? &dynamic_cast<VulkanRenderer*>(renderer.get())->GetDevice()
                                     : nullptr);
+      systemInfo.dynamicResolutionAvailable = renderSettings.dynamicResolutionAvailable;
       perfLogger.StartSession(
          scene.GetName() + (api == GraphicsAPI::Vulkan ? "_vulkan" : "_opengl"), systemInfo);
 
@@ -13,7 +13,12 @@ class VulkanBuffer {
       Uniform = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
       Storage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
       TransferSrc = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-      TransferDst = VK_BUFFER_USAGE_TRANSFER_DST_BIT
+      TransferDst = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+      // Draw arguments written by compute shaders
+      Indirect = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      // Geometry that shaders also fetch by hand
+      VertexStorage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+      IndexStorage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
    };
 
    enum class MemoryType { GPUOnly, CPUToGPU, GPUToCPU };
@@ -67,12 +67,16 @@ void VulkanCommandBuffers::Begin(const VkCommandBufferUsageFlags flags, const ui
 
 void VulkanCommandBuffers::BeginSecondary(const VulkanRenderPass& renderPass,
                                           const VkFramebuffer& framebuffer, const uint32_t subpass,
-                                          const uint32_t index) {
+                                          const uint32_t index, const bool inheritOcclusionQuery) {
    VkCommandBufferInheritanceInfo inheritanceInfo{};
    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
    inheritanceInfo.renderPass = renderPass.Get();
    inheritanceInfo.subpass = subpass;
    inheritanceInfo.framebuffer = framebuffer;
+   if (inheritOcclusionQuery) {
+      inheritanceInfo.occlusionQueryEnable = VK_TRUE;
+      inheritanceInfo.queryFlags = VK_QUERY_CONTROL_PRECISE_BIT;
+   }
    VkCommandBufferBeginInfo beginInfo{};
    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
@@ -96,7 +100,8 @@ void VulkanCommandBuffers::BeginRenderPass(const VulkanRenderPass& renderPass,
                                            const VkFramebuffer& framebuffer,
                                            const VkExtent2D& extent,
                                            const std::vector<VkClearValue>& clearValues,
-                                           const uint32_t index) {
+                                           const uint32_t index,
+                                           const VkSubpassContents contents) {
    VkRenderPassBeginInfo renderPassInfo{};
    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
    renderPassInfo.renderPass = renderPass.Get();
@@ -105,7 +110,11 @@ void VulkanCommandBuffers::BeginRenderPass(const VulkanRenderPass& renderPass,
    renderPassInfo.renderArea.extent = extent;
    renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
    renderPassInfo.pClearValues = clearValues.data();
-   vkCmdBeginRenderPass(m_commandBuffers[index], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+   vkCmdBeginRenderPass(m_commandBuffers[index], &renderPassInfo, contents);
+}
+
+void VulkanCommandBuffers::NextSubpass(const VkSubpassContents contents, const uint32_t index) {
+   vkCmdNextSubpass(m_commandBuffers[index], contents);
 }
 
 void VulkanCommandBuffers::EndRenderPass(const uint32_t index) {
@@ -22,14 +22,19 @@ class VulkanCommandBuffers {
    const VkCommandBuffer& Get(const uint32_t index = 0) const;
 
    void Begin(const VkCommandBufferUsageFlags flags = 0, const uint32_t index = 0);
+   // Buffers executed while an occlusion query is active must inherit it
    void BeginSecondary(const VulkanRenderPass& renderPass, const VkFramebuffer& framebuffer,
-                       const uint32_t subpass = 0, const uint32_t index = 0);
+                       const uint32_t subpass = 0, const uint32_t index = 0,
+                       const bool inheritOcclusionQuery = false);
    void End(const uint32_t index = 0);
    void Reset(const uint32_t index = 0);
 
    void BeginRenderPass(const VulkanRenderPass& renderPass, const VkFramebuffer& framebuffer,
                         const VkExtent2D& extent, const std::vector<VkClearValue>& clearValues,
-                        const uint32_t index = 0);
+                        const uint32_t index = 0,
+                        const VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+   void NextSubpass(const VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE,
+                    const uint32_t index = 0);
    void EndRenderPass(const uint32_t index = 0);
 
    void ExecuteCommands(const std::vector<VkCommandBuffer>& secondaryBuffers,
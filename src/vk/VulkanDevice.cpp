@@ -24,7 +24,27 @@ VulkanDevice::VulkanDevice(const VulkanInstance& instance, const VulkanSurface&
    if (!phys_ret)
       throw std::runtime_error("Failed to select physical device: " + phys_ret.error().message());
    auto vkb_physical_device = phys_ret.value();
+   // GPU-driven geometry writes its draw counts on the GPU, enabled only where available
+   VkPhysicalDeviceFeatures multiDrawFeatures{};
+   multiDrawFeatures.multiDrawIndirect = VK_TRUE;
+   multiDrawFeatures.drawIndirectFirstInstance = VK_TRUE;
+   const bool multiDraw = vkb_physical_device.enable_features_if_present(multiDrawFeatures);
+   const bool indirectCount =
+      vkb_physical_device.enable_extension_if_present(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+   m_supportsIndirectCount = multiDraw && indirectCount;
+   // The overdraw count wraps the geometry pass' secondary buffers in an occlusion query
+   VkPhysicalDeviceFeatures queryFeatures{};
+   queryFeatures.occlusionQueryPrecise = VK_TRUE;
+   queryFeatures.inheritedQueries = VK_TRUE;
+   m_supportsPreciseOcclusionQueries =
+      vkb_physical_device.enable_features_if_present(queryFeatures);
    m_physicalDevice = vkb_physical_device.physical_device;
+   VkPhysicalDeviceMemoryProperties memoryProperties;
+   vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memoryProperties);
+   for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+      if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT)
+         m_supportsLazilyAllocatedMemory = true;
+   }
    // Logical device
    vkb::DeviceBuilder device_builder{vkb_physical_device};
    device_builder.add_pNext(&bufferDeviceAddressFeatures);
@@ -79,7 +99,10 @@ VulkanDevice::VulkanDevice(VulkanDevice&& other) noexcept
       m_presentQueue(other.m_presentQueue),
       m_commandPool(other.m_commandPool),
       m_queueFamilies(other.m_queueFamilies),
-      m_ownsDevice(other.m_ownsDevice) {
+      m_ownsDevice(other.m_ownsDevice),
+      m_supportsIndirectCount(other.m_supportsIndirectCount),
+      m_supportsPreciseOcclusionQueries(other.m_supportsPreciseOcclusionQueries),
+      m_supportsLazilyAllocatedMemory(other.m_supportsLazilyAllocatedMemory) {
    other.m_device = VK_NULL_HANDLE;
    other.m_physicalDevice = VK_NULL_HANDLE;
    other.m_graphicsQueue = VK_NULL_HANDLE;
@@ -108,6 +131,9 @@ VulkanDevice& VulkanDevice::operator=(VulkanDevice&& other) noexcept {
       m_commandPool = other.m_commandPool;
       m_queueFamilies = other.m_queueFamilies;
       m_ownsDevice = other.m_ownsDevice;
+      m_supportsIndirectCount = other.m_supportsIndirectCount;
+      m_supportsPreciseOcclusionQueries = other.m_supportsPreciseOcclusionQueries;
+      m_supportsLazilyAllocatedMemory = other.m_supportsLazilyAllocatedMemory;
       other.m_device = VK_NULL_HANDLE;
       other.m_physicalDevice = VK_NULL_HANDLE;
       other.m_graphicsQueue = VK_NULL_HANDLE;
@@ -164,6 +190,16 @@ uint32_t VulkanDevice::GetGraphicsQueueFamily() const {
    return m_queueFamilies.graphicsFamily.value();
 }
 
+bool VulkanDevice::SupportsIndirectCount() const noexcept { return m_supportsIndirectCount; }
+
+bool VulkanDevice::SupportsPreciseOcclusionQueries() const noexcept {
+   return m_supportsPreciseOcclusionQueries;
+}
+
+bool VulkanDevice::SupportsLazilyAllocatedMemory() const noexcept {
+   return m_supportsLazilyAllocatedMemory;
+}
+
 uint32_t VulkanDevice::GetPresentQueueFamily() const {
    return m_queueFamilies.presentFamily.value();
 }
@@ -38,6 +38,12 @@ class VulkanDevice {
    const VmaAllocator& GetAllocator() const;
    uint32_t GetGraphicsQueueFamily() const;
    uint32_t GetPresentQueueFamily() const;
+   // Multi-draw indirect with a GPU written draw count
+   bool SupportsIndirectCount() const noexcept;
+   // Exact sample counts from occlusion queries, also across secondary command buffers
+   bool SupportsPreciseOcclusionQueries() const noexcept;
+   // A memory type that is only committed when a tile-based GPU spills attachments to it
+   bool SupportsLazilyAllocatedMemory() const noexcept;
 
   private:
    void CreateCommandPool();
@@ -54,4 +60,7 @@ class VulkanDevice {
    QueueFamilyIndices m_queueFamilies{};
    VmaAllocator m_allocator{VK_NULL_HANDLE};
    bool m_ownsDevice{false};
+   bool m_supportsIndirectCount{false};
+   bool m_supportsPreciseOcclusionQueries{false};
+   bool m_supportsLazilyAllocatedMemory{false};
 };
@@ -0,0 +1,372 @@
+#include "vk/VulkanGPUCulling.hpp"
+
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/RenderWorld.hpp"
+#include "vk/VulkanDevice.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+VulkanGPUCulling::VulkanGPUCulling(const VulkanDevice& device, VulkanGeometryPool& geometryPool,
+                                   const uint32_t framesInFlight)
+    : m_device(device), m_geometryPool(geometryPool) {
+   m_drawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+      vkGetDeviceProcAddr(m_device.Get(), "vkCmdDrawIndexedIndirectCountKHR"));
+   if (!m_drawIndexedIndirectCount)
+      throw std::runtime_error("vkCmdDrawIndexedIndirectCountKHR is not available");
+   CreateDescriptors(framesInFlight);
+   CreatePipelines();
+}
+
+VulkanGPUCulling::~VulkanGPUCulling() {
+   m_frames.clear();
+   m_compactPipeline.reset();
+   m_cullPipeline.reset();
+   m_cullPipelineLayout.reset();
+   vkDestroyDescriptorPool(m_device.Get(), m_descriptorPool, nullptr);
+   vkDestroyDescriptorSetLayout(m_device.Get(), m_cullSetLayout, nullptr);
+   vkDestroyDescriptorSetLayout(m_device.Get(), m_drawSetLayout, nullptr);
+}
+
+void VulkanGPUCulling::CreateDescriptors(const uint32_t framesInFlight) {
+   // Objects, batches, visible instances, batch info, packed draws, draw counts
+   std::array<VkDescriptorSetLayoutBinding, 6> cullBindings{};
+   for (uint32_t i = 0; i < cullBindings.size(); ++i) {
+      cullBindings[i].binding = i;
+      cullBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      cullBindings[i].descriptorCount = 1;
+      cullBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+   }
+   VkDescriptorSetLayoutCreateInfo cullLayoutInfo{};
+   cullLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   cullLayoutInfo.bindingCount = static_cast<uint32_t>(cullBindings.size());
+   cullLayoutInfo.pBindings = cullBindings.data();
+   if (vkCreateDescriptorSetLayout(m_device.Get(), &cullLayoutInfo, nullptr, &m_cullSetLayout) !=
+       VK_SUCCESS) {
+      throw std::runtime_error("Failed to create GPU culling descriptor set layout.");
+   }
+   // Objects and visible instances
+   std::array<VkDescriptorSetLayoutBinding, 2> drawBindings{};
+   for (uint32_t i = 0; i < drawBindings.size(); ++i) {
+      drawBindings[i].binding = i;
+      drawBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      drawBindings[i].descriptorCount = 1;
+      drawBindings[i].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+   }
+   VkDescriptorSetLayoutCreateInfo drawLayoutInfo{};
+   drawLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   drawLayoutInfo.bindingCount = static_cast<uint32_t>(drawBindings.size());
+   drawLayoutInfo.pBindings = drawBindings.data();
+   if (vkCreateDescriptorSetLayout(m_device.Get(), &drawLayoutInfo, nullptr, &m_drawSetLayout) !=
+       VK_SUCCESS) {
+      throw std::runtime_error("Failed to create indirect draw descriptor set layout.");
+   }
+   const VkDescriptorPoolSize poolSize{
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+      framesInFlight * static_cast<uint32_t>(cullBindings.size() + drawBindings.size())};
+   VkDescriptorPoolCreateInfo poolInfo{};
+   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+   poolInfo.poolSizeCount = 1;
+   poolInfo.pPoolSizes = &poolSize;
+   poolInfo.maxSets = framesInFlight * 2;
+   if (vkCreateDescriptorPool(m_device.Get(), &poolInfo, nullptr, &m_descriptorPool) !=
+       VK_SUCCESS) {
+      throw std::runtime_error("Failed to create GPU culling descriptor pool.");
+   }
+   m_frames.resize(framesInFlight);
+   for (FrameResources& frame : m_frames) {
+      const std::array<VkDescriptorSetLayout, 2> layouts = {m_cullSetLayout, m_drawSetLayout};
+      std::array<VkDescriptorSet, 2> sets{};
+      VkDescriptorSetAllocateInfo allocInfo{};
+      allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+      allocInfo.descriptorPool = m_descriptorPool;
+      allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+      allocInfo.pSetLayouts = layouts.data();
+      if (vkAllocateDescriptorSets(m_device.Get(), &allocInfo, sets.data()) != VK_SUCCESS) {
+         throw std::runtime_error("Failed to allocate GPU culling descriptor sets.");
+      }
+      frame.cullSet = sets[0];
+      frame.drawSet = sets[1];
+      // Descriptors need live buffers even before the first Prepare()
+      using Usage = VulkanBuffer::Usage;
+      using MemoryType = VulkanBuffer::MemoryType;
+      EnsureCapacity(frame.objects, sizeof(ObjectData), Usage::Storage, MemoryType::CPUToGPU);
+      EnsureCapacity(frame.visibleInstances, sizeof(uint32_t), Usage::Storage,
+                     MemoryType::GPUOnly);
+      EnsureCapacity(frame.batchTemplates, sizeof(VkDrawIndexedIndirectCommand),
+                     Usage::TransferSrc, MemoryType::CPUToGPU);
+      EnsureCapacity(frame.batchInfo, sizeof(BatchData), Usage::Storage, MemoryType::CPUToGPU);
+      EnsureCapacity(frame.batches, sizeof(VkDrawIndexedIndirectCommand), Usage::Indirect,
+                     MemoryType::GPUOnly);
+      EnsureCapacity(frame.draws, sizeof(VkDrawIndexedIndirectCommand), Usage::Indirect,
+                     MemoryType::GPUOnly);
+      EnsureCapacity(frame.drawCounts, sizeof(uint32_t), Usage::Indirect, MemoryType::GPUOnly);
+      UpdateDescriptorSets(frame);
+   }
+}
+
+void VulkanGPUCulling::CreatePipelines() {
+   VkPushConstantRange pushConstantRange{};
+   pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+   pushConstantRange.offset = 0;
+   pushConstantRange.size = sizeof(CullPushConstants);
+   m_cullPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device, std::vector<VkDescriptorSetLayout>{m_cullSetLayout},
+      std::vector<VkPushConstantRange>{pushConstantRange});
+   const VulkanShaderModule cullShader(m_device,
+                                       std::string("resources/shaders/vk/gpu_cull.comp.spv"));
+   const VulkanShaderModule compactShader(
+      m_device, std::string("resources/shaders/vk/gpu_compact.comp.spv"));
+   m_cullPipeline = std::make_unique<VulkanComputePipeline>(m_device, cullShader.Get(),
+                                                            m_cullPipelineLayout->Get());
+   m_compactPipeline = std::make_unique<VulkanComputePipeline>(m_device, compactShader.Get(),
+                                                               m_cullPipelineLayout->Get());
+}
+
+void VulkanGPUCulling::Prepare(const uint32_t frameIndex, const RenderWorld& renderWorld,
+                               const ResourceManager& resourceManager) {
+   if (renderWorld.GetMeshGeneration() != m_meshGeneration) {
+      RebuildBatches(renderWorld, resourceManager);
+      m_meshGeneration = renderWorld.GetMeshGeneration();
+      ++m_batchVersion;
+   }
+   using Usage = VulkanBuffer::Usage;
+   using MemoryType = VulkanBuffer::MemoryType;
+   FrameResources& frame = m_frames[frameIndex];
+   const std::span<const MeshProxy> proxies = renderWorld.GetMeshProxies();
+   const std::span<const BoundingBox> bounds = renderWorld.GetMeshBounds();
+   const size_t objectCount = std::max<size_t>(proxies.size(), 1);
+   bool buffersReplaced = EnsureCapacity(frame.objects, objectCount * sizeof(ObjectData),
+                                         Usage::Storage, MemoryType::CPUToGPU);
+   buffersReplaced |= EnsureCapacity(frame.visibleInstances, objectCount * sizeof(uint32_t),
+                                     Usage::Storage, MemoryType::GPUOnly);
+   if (frame.batchVersion != m_batchVersion) {
+      const size_t batchCount = std::max<size_t>(m_batchCommands.size(), 1);
+      const size_t commandsSize = batchCount * sizeof(VkDrawIndexedIndirectCommand);
+      buffersReplaced |= EnsureCapacity(frame.batchTemplates, commandsSize, Usage::TransferSrc,
+                                        MemoryType::CPUToGPU);
+      buffersReplaced |= EnsureCapacity(frame.batchInfo, batchCount * sizeof(BatchData),
+                                        Usage::Storage, MemoryType::CPUToGPU);
+      buffersReplaced |=
+         EnsureCapacity(frame.batches, commandsSize, Usage::Indirect, MemoryType::GPUOnly);
+      buffersReplaced |=
+         EnsureCapacity(frame.draws, commandsSize, Usage::Indirect, MemoryType::GPUOnly);
+      buffersReplaced |=
+         EnsureCapacity(frame.drawCounts, std::max<size_t>(m_groups.size(), 1) * sizeof(uint32_t),
+                        Usage::Indirect, MemoryType::GPUOnly);
+      if (!m_batchCommands.empty()) {
+         frame.batchTemplates->UpdateArray(m_batchCommands.data(), m_batchCommands.size());
+         frame.batchTemplates->FlushRange(0, VK_WHOLE_SIZE);
+         frame.batchInfo->UpdateArray(m_batchInfo.data(), m_batchInfo.size());
+         frame.batchInfo->FlushRange(0, VK_WHOLE_SIZE);
+      }
+      frame.batchVersion = m_batchVersion;
+   }
+   if (buffersReplaced)
+      UpdateDescriptorSets(frame);
+   // Every frame, matrices change without the batches changing
+   auto* const objects = static_cast<ObjectData*>(frame.objects->GetMappedPtr());
+   for (size_t i = 0; i < proxies.size(); ++i) {
+      objects[i] = ObjectData{.model = proxies[i].worldMatrix,
+                              .boundsCenter = glm::vec4(bounds[i].GetCenter(), 0.0f),
+                              .boundsExtents = glm::vec4(bounds[i].GetExtents(), 0.0f),
+                              .batch = m_objectBatches[i]};
+   }
+   frame.objects->FlushRange(0, proxies.size() * sizeof(ObjectData));
+   m_stats = GPUCullingStats{.objects = static_cast<uint32_t>(proxies.size()),
+                             .batches = static_cast<uint32_t>(m_batchCommands.size()),
+                             .groups = static_cast<uint32_t>(m_groups.size())};
+}
+
+void VulkanGPUCulling::RecordCulling(const VkCommandBuffer& commandBuffer,
+                                     const uint32_t frameIndex, const Frustum& frustum) {
+   if (m_batchCommands.empty())
+      return;
+   const FrameResources& frame = m_frames[frameIndex];
+   const uint32_t batchCount = static_cast<uint32_t>(m_batchCommands.size());
+   // Reset the instance counts and the per group draw counts
+   const VkBufferCopy copyRegion{0, 0, batchCount * sizeof(VkDrawIndexedIndirectCommand)};
+   vkCmdCopyBuffer(commandBuffer, frame.batchTemplates->Get(), frame.batches->Get(), 1,
+                   &copyRegion);
+   vkCmdFillBuffer(commandBuffer, frame.drawCounts->Get(), 0, m_groups.size() * sizeof(uint32_t),
+                   0);
+   VkMemoryBarrier barrier{};
+   barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+   barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+   barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+   vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                        nullptr);
+   // Cull objects into their batches' instance ranges
+   CullPushConstants pushConstants{.frustumPlanes = {},
+                                   .objectCount = m_stats.objects};
+   std::ranges::copy(frustum.planes, pushConstants.frustumPlanes.begin());
+   vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                           m_cullPipelineLayout->Get(), 0, 1, &frame.cullSet, 0, nullptr);
+   vkCmdPushConstants(commandBuffer, m_cullPipelineLayout->Get(), VK_SHADER_STAGE_COMPUTE_BIT, 0,
+                      sizeof(CullPushConstants), &pushConstants);
+   vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_cullPipeline->GetPipeline());
+   vkCmdDispatch(commandBuffer, (m_stats.objects + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+   barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+   barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+   vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                        nullptr);
+   // Pack the non-empty batches at the front of their group
+   vkCmdPushConstants(commandBuffer, m_cullPipelineLayout->Get(), VK_SHADER_STAGE_COMPUTE_BIT,
+                      offsetof(CullPushConstants, objectCount), sizeof(uint32_t), &batchCount);
+   vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                     m_compactPipeline->GetPipeline());
+   vkCmdDispatch(commandBuffer, (batchCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+   barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+   barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+   vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                        VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                        0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void VulkanGPUCulling::RecordDraws(
+   const VkCommandBuffer& commandBuffer, const uint32_t frameIndex,
+   const VulkanPipelineLayout& layout,
+   const std::function<void(const MaterialHandle&)>& bindMaterial) const {
+   if (m_groups.empty())
+      return;
+   const FrameResources& frame = m_frames[frameIndex];
+   vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout.Get(), 2, 1,
+                           &frame.drawSet, 0, nullptr);
+   const VkBuffer vertexBuffer = m_geometryPool.GetVertexBuffer();
+   const VkDeviceSize vertexOffset = 0;
+   vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &vertexOffset);
+   VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+   constexpr uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+   for (uint32_t i = 0; i < m_groups.size(); ++i) {
+      const DrawGroup& group = m_groups[i];
+      if (group.indexType != boundIndexType) {
+         vkCmdBindIndexBuffer(commandBuffer, m_geometryPool.GetIndexBuffer(group.indexType), 0,
+                              group.indexType);
+         boundIndexType = group.indexType;
+      }
+      bindMaterial(group.material);
+      m_drawIndexedIndirectCount(commandBuffer, frame.draws->Get(), group.firstDraw * stride,
+                                 frame.drawCounts->Get(), i * sizeof(uint32_t), group.maxDraws,
+                                 stride);
+   }
+}
+
+void VulkanGPUCulling::RebuildBatches(const RenderWorld& renderWorld,
+                                      const ResourceManager& resourceManager) {
+   const std::span<const MeshProxy> proxies = renderWorld.GetMeshProxies();
+   m_geometryPool.Update(renderWorld, resourceManager);
+   // One batch per mesh and material pair, ordered so groups come out contiguous
+   struct BatchBuild final {
+      VulkanGeometryPool::MeshRange range;
+      MaterialHandle material;
+      uint32_t objectCount;
+   };
+   std::map<std::pair<uint64_t, uint64_t>, uint32_t> batchLookup;
+   std::vector<BatchBuild> builds;
+   m_objectBatches.assign(proxies.size(), INVALID_BATCH);
+   for (size_t i = 0; i < proxies.size(); ++i) {
+      const VulkanGeometryPool::MeshRange* range = m_geometryPool.Find(proxies[i].mesh);
+      if (!range)
+         continue;
+      const auto key = std::make_pair(proxies[i].mesh.GetId(), proxies[i].material.GetId());
+      auto [batchIt, inserted] =
+         batchLookup.try_emplace(key, static_cast<uint32_t>(builds.size()));
+      if (inserted)
+         builds.push_back({*range, proxies[i].material, 0});
+      ++builds[batchIt->second].objectCount;
+      m_objectBatches[i] = batchIt->second;
+   }
+   std::vector<uint32_t> order(builds.size());
+   std::iota(order.begin(), order.end(), 0u);
+   std::ranges::sort(order, [&builds](const uint32_t a, const uint32_t b) {
+      const BatchBuild& lhs = builds[a];
+      const BatchBuild& rhs = builds[b];
+      if (lhs.material.GetId() != rhs.material.GetId())
+         return lhs.material.GetId() < rhs.material.GetId();
+      return lhs.range.indexType < rhs.range.indexType;
+   });
+   std::vector<uint32_t> remap(builds.size());
+   m_batchCommands.resize(builds.size());
+   m_batchInfo.resize(builds.size());
+   m_groups.clear();
+   uint32_t firstInstance = 0;
+   for (uint32_t i = 0; i < order.size(); ++i) {
+      const BatchBuild& build = builds[order[i]];
+      remap[order[i]] = i;
+      if (m_groups.empty() || m_groups.back().material != build.material ||
+          m_groups.back().indexType != build.range.indexType) {
+         m_groups.push_back({.material = build.material,
+                             .indexType = build.range.indexType,
+                             .firstDraw = i,
+                             .maxDraws = 0});
+      }
+      ++m_groups.back().maxDraws;
+      m_batchCommands[i] = VkDrawIndexedIndirectCommand{.indexCount = build.range.indexCount,
+                                                        .instanceCount = 0,
+                                                        .firstIndex = build.range.firstIndex,
+                                                        .vertexOffset = build.range.vertexOffset,
+                                                        .firstInstance = firstInstance};
+      m_batchInfo[i] = BatchData{.group = static_cast<uint32_t>(m_groups.size() - 1),
+                                 .groupFirstDraw = m_groups.back().firstDraw};
+      firstInstance += build.objectCount;
+   }
+   for (uint32_t& batch : m_objectBatches) {
+      if (batch != INVALID_BATCH)
+         batch = remap[batch];
+   }
+}
+
+void VulkanGPUCulling::UpdateDescriptorSets(const FrameResources& frame) const {
+   const std::array<VkDescriptorBufferInfo, 6> cullBuffers = {
+      VkDescriptorBufferInfo{frame.objects->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{frame.batches->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{frame.visibleInstances->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{frame.batchInfo->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{frame.draws->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{frame.drawCounts->Get(), 0, VK_WHOLE_SIZE}};
+   std::vector<VkWriteDescriptorSet> writes;
+   for (uint32_t i = 0; i < cullBuffers.size(); ++i) {
+      VkWriteDescriptorSet write{};
+      write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write.dstSet = frame.cullSet;
+      write.dstBinding = i;
+      write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      write.descriptorCount = 1;
+      write.pBufferInfo = &cullBuffers[i];
+      writes.push_back(write);
+   }
+   // The vertex shader only reads the objects and the visible instance indices
+   for (uint32_t i = 0; i < 2; ++i) {
+      VkWriteDescriptorSet write{};
+      write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write.dstSet = frame.drawSet;
+      write.dstBinding = i;
+      write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      write.descriptorCount = 1;
+      write.pBufferInfo = &cullBuffers[i == 0 ? 0 : 2];
+      writes.push_back(write);
+   }
+   vkUpdateDescriptorSets(m_device.Get(), static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                          nullptr);
+}
+
+bool VulkanGPUCulling::EnsureCapacity(std::unique_ptr<VulkanBuffer>& buffer,
+                                      const VkDeviceSize size, const VulkanBuffer::Usage usage,
+                                      const VulkanBuffer::MemoryType memoryType) {
+   if (buffer && buffer->GetSize() >= size)
+      return false;
+   // Grow geometrically so a slowly growing scene does not replace buffers every frame
+   const VkDeviceSize capacity = buffer ? std::max(size, buffer->GetSize() * 2) : size;
+   buffer = std::make_unique<VulkanBuffer>(m_device, capacity, usage, memoryType);
+   if (memoryType != VulkanBuffer::MemoryType::GPUOnly)
+      buffer->Map();
+   return true;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "core/Bounds.hpp"
+#include "core/resource/IMaterial.hpp"
+#include "vk/VulkanBuffer.hpp"
+#include "vk/VulkanGeometryPool.hpp"
+#include "vk/VulkanPipeline.hpp"
+
+#include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+class VulkanDevice;
+class RenderWorld;
+class ResourceManager;
+
+struct GPUCullingStats final {
+   uint32_t objects{0};
+   // Unique mesh and material pairs, each one indirect draw
+   uint32_t batches{0};
+   // Indirect count draws recorded per frame
+   uint32_t groups{0};
+};
+
+// GPU-driven geometry submission. Every mesh proxy's matrix and bounds go into a storage buffer,
+// a compute pass culls them against the frustum and appends the survivors to their batch's
+// instance range, then a second pass packs each group's non-empty batches so a single indirect
+// count draw covers the whole group. Batches are unique mesh and material pairs, groups share a
+// material and index type. Meshes are drawn from the shared geometry pool, so the recorded
+// commands scale with the number of groups rather than the number of objects.
+class VulkanGPUCulling final {
+  public:
+   struct DrawGroup final {
+      MaterialHandle material;
+      VkIndexType indexType;
+      uint32_t firstDraw;
+      uint32_t maxDraws;
+   };
+
+   VulkanGPUCulling(const VulkanDevice& device, VulkanGeometryPool& geometryPool,
+                    const uint32_t framesInFlight);
+   ~VulkanGPUCulling();
+
+   VulkanGPUCulling(const VulkanGPUCulling&) = delete;
+   VulkanGPUCulling& operator=(const VulkanGPUCulling&) = delete;
+   VulkanGPUCulling(VulkanGPUCulling&&) = delete;
+   VulkanGPUCulling& operator=(VulkanGPUCulling&&) = delete;
+
+   // Set 2 of the indirect geometry pipeline, object data and visible instance indices
+   [[nodiscard]] VkDescriptorSetLayout GetDrawDescriptorSetLayout() const noexcept {
+      return m_drawSetLayout;
+   }
+   // Rebuilds the batches if the proxies changed and uploads the frame's object data. The
+   // frame's previous submission must have finished.
+   void Prepare(const uint32_t frame, const RenderWorld& renderWorld,
+                const ResourceManager& resourceManager);
+   // Outside any render pass, before RecordDraws()
+   void RecordCulling(const VkCommandBuffer& commandBuffer, const uint32_t frame,
+                      const Frustum& frustum);
+   // Inside the geometry pass with the indirect pipeline bound, bindMaterial binds set 1
+   void RecordDraws(const VkCommandBuffer& commandBuffer, const uint32_t frame,
+                    const VulkanPipelineLayout& layout,
+                    const std::function<void(const MaterialHandle&)>& bindMaterial) const;
+
+   [[nodiscard]] constexpr const GPUCullingStats& GetStats() const noexcept { return m_stats; }
+
+  private:
+   // Matches the shaders' std430 layouts
+   struct ObjectData final {
+      alignas(16) glm::mat4 model;
+      alignas(16) glm::vec4 boundsCenter;
+      alignas(16) glm::vec4 boundsExtents;
+      alignas(16) uint32_t batch;
+   };
+
+   struct BatchData final {
+      uint32_t group;
+      uint32_t groupFirstDraw;
+   };
+
+   struct CullPushConstants final {
+      std::array<glm::vec4, 6> frustumPlanes;
+      uint32_t objectCount;
+   };
+
+   // Written by the GPU or refilled every frame, so each frame in flight has its own
+   struct FrameResources final {
+      std::unique_ptr<VulkanBuffer> objects;
+      std::unique_ptr<VulkanBuffer> visibleInstances;
+      // Batch commands with no instances, copied over the batches before culling
+      std::unique_ptr<VulkanBuffer> batchTemplates;
+      std::unique_ptr<VulkanBuffer> batchInfo;
+      std::unique_ptr<VulkanBuffer> batches;
+      std::unique_ptr<VulkanBuffer> draws;
+      std::unique_ptr<VulkanBuffer> drawCounts;
+      VkDescriptorSet cullSet{VK_NULL_HANDLE};
+      VkDescriptorSet drawSet{VK_NULL_HANDLE};
+      // m_batchVersion the batch buffers were filled from
+      uint64_t batchVersion{0};
+   };
+
+   static constexpr uint32_t INVALID_BATCH = UINT32_MAX;
+   static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+   void CreateDescriptors(const uint32_t framesInFlight);
+   void CreatePipelines();
+   void RebuildBatches(const RenderWorld& renderWorld, const ResourceManager& resourceManager);
+   void UpdateDescriptorSets(const FrameResources& frame) const;
+   // Returns true if the buffer had to be replaced
+   bool EnsureCapacity(std::unique_ptr<VulkanBuffer>& buffer, const VkDeviceSize size,
+                       const VulkanBuffer::Usage usage, const VulkanBuffer::MemoryType memoryType);
+
+  private:
+   const VulkanDevice& m_device;
+   VulkanGeometryPool& m_geometryPool;
+   PFN_vkCmdDrawIndexedIndirectCountKHR m_drawIndexedIndirectCount{nullptr};
+
+   VkDescriptorSetLayout m_cullSetLayout{VK_NULL_HANDLE};
+   VkDescriptorSetLayout m_drawSetLayout{VK_NULL_HANDLE};
+   VkDescriptorPool m_descriptorPool{VK_NULL_HANDLE};
+   std::unique_ptr<VulkanPipelineLayout> m_cullPipelineLayout;
+   std::unique_ptr<VulkanComputePipeline> m_cullPipeline;
+   std::unique_ptr<VulkanComputePipeline> m_compactPipeline;
+
+   // Built from the render world's proxies, sorted so each group's batches are contiguous
+   std::vector<VkDrawIndexedIndirectCommand> m_batchCommands;
+   std::vector<BatchData> m_batchInfo;
+   std::vector<DrawGroup> m_groups;
+   // Parallel to the mesh proxies
+   std::vector<uint32_t> m_objectBatches;
+   uint64_t m_meshGeneration{UINT64_MAX};
+   uint64_t m_batchVersion{1};
+
+   std::vector<FrameResources> m_frames;
+   GPUCullingStats m_stats{};
+};
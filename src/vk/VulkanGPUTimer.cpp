@@ -43,7 +43,7 @@ void VulkanGPUTimer::BeginFrame(const VkCommandBuffer& commandBuffer, const uint
    vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, MAX_QUERIES_PER_FRAME);
 }
 
-void VulkanGPUTimer::Begin(const std::string& label) {
+void VulkanGPUTimer::Begin(const StringId label) {
    std::lock_guard<std::mutex> lock(m_mutex);
    FrameQueries& frame = m_frameQueries[m_currentFrame];
    if (frame.nextQueryIndex + 2 > MAX_QUERIES_PER_FRAME)
@@ -57,7 +57,7 @@ void VulkanGPUTimer::Begin(const std::string& label) {
                        query.startQuery);
 }
 
-void VulkanGPUTimer::End(const std::string& label) {
+void VulkanGPUTimer::End(const StringId label) {
    std::lock_guard<std::mutex> lock(m_mutex);
    FrameQueries& frame = m_frameQueries[m_currentFrame];
    const auto it = frame.queries.find(label);
@@ -71,7 +71,7 @@ void VulkanGPUTimer::End(const std::string& label) {
                        frame.queryPool, query.endQuery);
 }
 
-void VulkanGPUTimer::BeginOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const std::string& label) {
+void VulkanGPUTimer::BeginOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const StringId label) {
    std::lock_guard<std::mutex> lock(m_mutex);
    FrameQueries& frame = m_frameQueries[m_currentFrame];
    if (frame.nextQueryIndex + 2 > MAX_QUERIES_PER_FRAME)
@@ -86,7 +86,7 @@ void VulkanGPUTimer::BeginOnCommandBuffer(const VkCommandBuffer& cmdBuffer, cons
 }
 
 // NEW: Thread-safe method for recording on specific command buffer
-void VulkanGPUTimer::EndOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const std::string& label) {
+void VulkanGPUTimer::EndOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const StringId label) {
    std::lock_guard<std::mutex> lock(m_mutex);
    FrameQueries& frame = m_frameQueries[m_currentFrame];
    const auto it = frame.queries.find(label);
@@ -126,7 +126,7 @@ void VulkanGPUTimer::EndFrame(const uint32_t frameIndex) {
    }
 }
 
-float VulkanGPUTimer::GetElapsedMs(const std::string& label) {
+float VulkanGPUTimer::GetElapsedMs(const StringId label) {
    std::lock_guard<std::mutex> lock(m_mutex);
    for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
       const uint32_t checkFrame =
@@ -148,7 +148,7 @@ void VulkanGPUTimer::Reset() {
    }
 }
 
-bool VulkanGPUTimer::IsAvailable(const std::string& label) const {
+bool VulkanGPUTimer::IsAvailable(const StringId label) const {
    std::lock_guard<std::mutex> lock(m_mutex);
    for (const auto& frame : m_frameQueries) {
       const auto it = frame.queries.find(label);
@@ -13,13 +13,13 @@ class VulkanGPUTimer : public IGPUTimer {
   public:
    explicit VulkanGPUTimer(const VulkanDevice& device);
    ~VulkanGPUTimer() override;
-   void Begin(const std::string& label) override;
-   void End(const std::string& label) override;
-   void BeginOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const std::string& label);
-   void EndOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const std::string& label);
-   [[nodiscard]] float GetElapsedMs(const std::string& label) override;
+   void Begin(const StringId label) override;
+   void End(const StringId label) override;
+   void BeginOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const StringId label);
+   void EndOnCommandBuffer(const VkCommandBuffer& cmdBuffer, const StringId label);
+   [[nodiscard]] float GetElapsedMs(const StringId label) override;
    void Reset() override;
-   [[nodiscard]] bool IsAvailable(const std::string& label) const override;
+   [[nodiscard]] bool IsAvailable(const StringId label) const override;
    void BeginFrame(const VkCommandBuffer& commandBuffer, const uint32_t frameIndex);
    void EndFrame(const uint32_t frameIndex);
 
@@ -35,7 +35,7 @@ class VulkanGPUTimer : public IGPUTimer {
 
    struct FrameQueries {
       VkQueryPool queryPool{VK_NULL_HANDLE};
-      std::unordered_map<std::string, TimestampQuery> queries;
+      std::unordered_map<StringId, TimestampQuery> queries;
       uint32_t nextQueryIndex{0};
       VkCommandBuffer mainCommandBuffer{VK_NULL_HANDLE};
    };
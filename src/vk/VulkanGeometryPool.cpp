@@ -0,0 +1,110 @@
+#include "vk/VulkanGeometryPool.hpp"
+
+#include "core/resource/ResourceManager.hpp"
+#include "core/scene/RenderWorld.hpp"
+#include "vk/VulkanCommandBuffers.hpp"
+#include "vk/VulkanDevice.hpp"
+#include "vk/resource/VulkanMesh.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+VulkanGeometryPool::VulkanGeometryPool(const VulkanDevice& device) : m_device(device) {}
+
+VulkanGeometryPool::~VulkanGeometryPool() = default;
+
+bool VulkanGeometryPool::Update(const RenderWorld& renderWorld,
+                                const ResourceManager& resourceManager) {
+   if (renderWorld.GetMeshGeneration() == m_meshGeneration)
+      return false;
+   m_meshGeneration = renderWorld.GetMeshGeneration();
+   const bool poolMissesMesh =
+      std::ranges::any_of(renderWorld.GetMeshProxies(), [this](const MeshProxy& proxy) {
+         return proxy.mesh.IsValid() && !m_meshRanges.contains(proxy.mesh.GetId());
+      });
+   if (!poolMissesMesh && m_vertexBuffer)
+      return false;
+   Rebuild(renderWorld, resourceManager);
+   ++m_version;
+   return true;
+}
+
+const VulkanGeometryPool::MeshRange* VulkanGeometryPool::Find(
+   const MeshHandle& mesh) const noexcept {
+   const auto it = m_meshRanges.find(mesh.GetId());
+   return it != m_meshRanges.end() ? &it->second : nullptr;
+}
+
+VkBuffer VulkanGeometryPool::GetVertexBuffer() const noexcept {
+   return m_vertexBuffer ? m_vertexBuffer->Get() : VK_NULL_HANDLE;
+}
+
+VkBuffer VulkanGeometryPool::GetIndexBuffer(const VkIndexType indexType) const noexcept {
+   const std::unique_ptr<VulkanBuffer>& buffer =
+      indexType == VK_INDEX_TYPE_UINT16 ? m_indexBuffer16 : m_indexBuffer32;
+   return buffer ? buffer->Get() : VK_NULL_HANDLE;
+}
+
+void VulkanGeometryPool::Rebuild(const RenderWorld& renderWorld,
+                                 const ResourceManager& resourceManager) {
+   // Frames in flight may still be drawing from the old buffers
+   if (m_vertexBuffer)
+      vkDeviceWaitIdle(m_device.Get());
+   m_meshRanges.clear();
+   std::vector<std::pair<uint64_t, const VulkanMesh*>> meshes;
+   size_t vertexCount = 0;
+   size_t indexCount16 = 0;
+   size_t indexCount32 = 0;
+   for (const MeshProxy& proxy : renderWorld.GetMeshProxies()) {
+      if (m_meshRanges.contains(proxy.mesh.GetId()))
+         continue;
+      const IMesh* const mesh = resourceManager.GetMesh(proxy.mesh);
+      if (!mesh)
+         continue;
+      const auto* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
+      size_t& indexCount =
+         vkMesh->GetIndexType() == VK_INDEX_TYPE_UINT16 ? indexCount16 : indexCount32;
+      m_meshRanges.emplace(proxy.mesh.GetId(),
+                           MeshRange{.vertexOffset = static_cast<int32_t>(vertexCount),
+                                     .firstIndex = static_cast<uint32_t>(indexCount),
+                                     .indexCount = static_cast<uint32_t>(vkMesh->GetIndexCount()),
+                                     .indexType = vkMesh->GetIndexType()});
+      meshes.emplace_back(proxy.mesh.GetId(), vkMesh);
+      vertexCount += vkMesh->GetVertexCount();
+      indexCount += vkMesh->GetIndexCount();
+   }
+   using Usage = VulkanBuffer::Usage;
+   using MemoryType = VulkanBuffer::MemoryType;
+   m_vertexBuffer = std::make_unique<VulkanBuffer>(
+      m_device, std::max<size_t>(vertexCount, 1) * sizeof(Vertex), Usage::VertexStorage,
+      MemoryType::GPUOnly);
+   // Shaders read the 16-bit indices in pairs, so that buffer is rounded up to whole words
+   const size_t indexBytes16 = std::max<size_t>(indexCount16, 1) * sizeof(uint16_t);
+   m_indexBuffer16 = std::make_unique<VulkanBuffer>(
+      m_device, (indexBytes16 + 3) & ~size_t{3}, Usage::IndexStorage, MemoryType::GPUOnly);
+   m_indexBuffer32 = std::make_unique<VulkanBuffer>(
+      m_device, std::max<size_t>(indexCount32, 1) * sizeof(uint32_t), Usage::IndexStorage,
+      MemoryType::GPUOnly);
+   if (meshes.empty())
+      return;
+   VulkanCommandBuffers::ExecuteImmediate(
+      m_device, m_device.GetCommandPool(), m_device.GetGraphicsQueue(),
+      [this, &meshes](const VkCommandBuffer& cmd) {
+         for (const auto& [id, mesh] : meshes) {
+            const MeshRange& range = m_meshRanges.at(id);
+            const VkBufferCopy vertexRegion{
+               0, static_cast<VkDeviceSize>(range.vertexOffset) * sizeof(Vertex),
+               mesh->GetVertexCount() * sizeof(Vertex)};
+            vkCmdCopyBuffer(cmd, mesh->GetVertexBuffer(), m_vertexBuffer->Get(), 1,
+                            &vertexRegion);
+            const bool is16 = range.indexType == VK_INDEX_TYPE_UINT16;
+            const VkDeviceSize indexSize = is16 ? sizeof(uint16_t) : sizeof(uint32_t);
+            const VkBufferCopy indexRegion{0, range.firstIndex * indexSize,
+                                           range.indexCount * indexSize};
+            vkCmdCopyBuffer(cmd, mesh->GetIndexBuffer(),
+                            is16 ? m_indexBuffer16->Get() : m_indexBuffer32->Get(), 1,
+                            &indexRegion);
+         }
+      });
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "core/resource/IMesh.hpp"
+#include "vk/VulkanBuffer.hpp"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+class VulkanDevice;
+class RenderWorld;
+class ResourceManager;
+
+// Every mesh the render world references, copied into shared vertex and index buffers. Indirect
+// draws bind them once for all meshes, the visibility buffer resolve reads them as storage
+// buffers. 16-bit and 32-bit indices keep separate buffers, so meshes draw with their own type.
+class VulkanGeometryPool final {
+  public:
+   // Where a mesh lives in the shared buffers
+   struct MeshRange final {
+      int32_t vertexOffset;
+      uint32_t firstIndex;
+      uint32_t indexCount;
+      VkIndexType indexType;
+   };
+
+   explicit VulkanGeometryPool(const VulkanDevice& device);
+   ~VulkanGeometryPool();
+
+   VulkanGeometryPool(const VulkanGeometryPool&) = delete;
+   VulkanGeometryPool& operator=(const VulkanGeometryPool&) = delete;
+   VulkanGeometryPool(VulkanGeometryPool&&) = delete;
+   VulkanGeometryPool& operator=(VulkanGeometryPool&&) = delete;
+
+   // Rebuilds the buffers when a proxy's mesh is missing from them, waiting for the device
+   // first. Returns true if the buffers were replaced.
+   bool Update(const RenderWorld& renderWorld, const ResourceManager& resourceManager);
+
+   // Null for meshes that are not in the pool
+   [[nodiscard]] const MeshRange* Find(const MeshHandle& mesh) const noexcept;
+   [[nodiscard]] VkBuffer GetVertexBuffer() const noexcept;
+   [[nodiscard]] VkBuffer GetIndexBuffer(const VkIndexType indexType) const noexcept;
+   // Incremented whenever the buffers are replaced, so descriptors can be re-pointed
+   [[nodiscard]] constexpr uint64_t GetVersion() const noexcept { return m_version; }
+
+  private:
+   void Rebuild(const RenderWorld& renderWorld, const ResourceManager& resourceManager);
+
+  private:
+   const VulkanDevice& m_device;
+   // Keyed by mesh handle id
+   std::unordered_map<uint64_t, MeshRange> m_meshRanges;
+   std::unique_ptr<VulkanBuffer> m_vertexBuffer;
+   std::unique_ptr<VulkanBuffer> m_indexBuffer16;
+   std::unique_ptr<VulkanBuffer> m_indexBuffer32;
+   uint64_t m_meshGeneration{UINT64_MAX};
+   uint64_t m_version{0};
+};
@@ -122,6 +122,50 @@ VulkanGraphicsPipeline& VulkanGraphicsPipeline::operator=(VulkanGraphicsPipeline
 VkPipeline VulkanGraphicsPipeline::GetPipeline() const { return m_pipeline; }
 VkPipelineLayout VulkanGraphicsPipeline::GetLayout() const { return m_layout; }
 
+// VulkanComputePipeline
+VulkanComputePipeline::VulkanComputePipeline(const VulkanDevice& device,
+                                             const VkShaderModule& shader,
+                                             const VkPipelineLayout& layout,
+                                             const std::string& entryPoint)
+    : m_device(&device), m_layout(layout) {
+   VkComputePipelineCreateInfo info{};
+   info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+   info.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+   info.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+   info.stage.module = shader;
+   info.stage.pName = entryPoint.c_str();
+   info.layout = layout;
+   if (vkCreateComputePipelines(m_device->Get(), VK_NULL_HANDLE, 1, &info, nullptr,
+                                &m_pipeline) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create compute pipeline");
+   }
+}
+
+VulkanComputePipeline::~VulkanComputePipeline() {
+   if (m_pipeline != VK_NULL_HANDLE) {
+      vkDestroyPipeline(m_device->Get(), m_pipeline, nullptr);
+   }
+}
+
+VulkanComputePipeline::VulkanComputePipeline(VulkanComputePipeline&& other) noexcept {
+   *this = std::move(other);
+}
+
+VulkanComputePipeline& VulkanComputePipeline::operator=(VulkanComputePipeline&& other) noexcept {
+   if (this != &other) {
+      m_device = other.m_device;
+      m_pipeline = other.m_pipeline;
+      m_layout = other.m_layout;
+      other.m_device = nullptr;
+      other.m_pipeline = VK_NULL_HANDLE;
+      other.m_layout = VK_NULL_HANDLE;
+   }
+   return *this;
+}
+
+VkPipeline VulkanComputePipeline::GetPipeline() const { return m_pipeline; }
+VkPipelineLayout VulkanComputePipeline::GetLayout() const { return m_layout; }
+
 // VulkanGraphicsPipelineBuilder
 VulkanGraphicsPipelineBuilder::VulkanGraphicsPipelineBuilder(const VulkanDevice& device)
     : m_device(&device) {}
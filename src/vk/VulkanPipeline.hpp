@@ -66,6 +66,26 @@ class VulkanGraphicsPipeline {
    VkPipelineLayout m_layout = VK_NULL_HANDLE;
 };
 
+class VulkanComputePipeline {
+  public:
+   VulkanComputePipeline(const VulkanDevice& device, const VkShaderModule& shader,
+                         const VkPipelineLayout& layout, const std::string& entryPoint = "main");
+   ~VulkanComputePipeline();
+
+   VulkanComputePipeline(const VulkanComputePipeline&) = delete;
+   VulkanComputePipeline& operator=(const VulkanComputePipeline&) = delete;
+   VulkanComputePipeline(VulkanComputePipeline&& other) noexcept;
+   VulkanComputePipeline& operator=(VulkanComputePipeline&& other) noexcept;
+
+   VkPipeline GetPipeline() const;
+   VkPipelineLayout GetLayout() const;
+
+  private:
+   const VulkanDevice* m_device = nullptr;
+   VkPipeline m_pipeline = VK_NULL_HANDLE;
+   VkPipelineLayout m_layout = VK_NULL_HANDLE;
+};
+
 class VulkanGraphicsPipelineBuilder {
   public:
    struct ShaderStage {
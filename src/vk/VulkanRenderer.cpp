@@ -4,10 +4,7 @@
 #include "core/Camera.hpp"
 
 #include "core/scene/Scene.hpp"
-#include "core/scene/Node.hpp"
-#include "core/scene/components/LightComponent.hpp"
 #include "core/scene/components/ParticleSystemComponent.hpp"
-#include "core/scene/components/RendererComponent.hpp"
 
 #include "core/editor/PerformanceGUI.hpp"
 #include "core/editor/MaterialEditor.hpp"
@@ -23,8 +20,11 @@
 #include <imgui_impl_vulkan.h>
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 #include <stb_image.h>
 #include <vulkan/vulkan_core.h>
@@ -35,29 +35,118 @@ struct CameraData {
    alignas(16) glm::vec3 viewPos;
 };
 
-struct LightData {
-   alignas(4) uint32_t lightType;
-   alignas(16) glm::vec3 position;
-   alignas(16) glm::vec3 direction;
-   alignas(16) glm::vec3 color;
-   alignas(4) float intensity;
-   alignas(4) float constant;
-   alignas(4) float linear;
-   alignas(4) float quadratic;
-   alignas(4) float innerCone;
-   alignas(4) float outerCone;
-};
+namespace {
+
+using GPULight = LightClusterer::GPULight;
+using GridHeader = LightClusterer::GridHeader;
+
+constexpr VkDeviceSize CLUSTER_BUFFER_SIZE =
+   sizeof(GridHeader) + LightClusterer::CLUSTER_COUNT * sizeof(glm::uvec2);
+
+// Returns true if the buffer had to be replaced, the new one is mapped
+bool EnsureStorageCapacity(const VulkanDevice& device, std::unique_ptr<VulkanBuffer>& buffer,
+                           const VkDeviceSize size) {
+   if (buffer && buffer->GetSize() >= size)
+      return false;
+   // Grow geometrically so a slowly growing light count does not replace buffers every frame
+   const VkDeviceSize capacity = buffer ? std::max(size, buffer->GetSize() * 2) : size;
+   buffer = std::make_unique<VulkanBuffer>(device, capacity, VulkanBuffer::Usage::Storage,
+                                           VulkanBuffer::MemoryType::CPUToGPU);
+   buffer->Map();
+   return true;
+}
+
+// VulkanTexture render targets hold 8-bit color, whatever format the G-buffer asks for
+constexpr VkFormat GBUFFER_FORMAT = VK_FORMAT_R8G8B8A8_UNORM;
+
+// Attachments start and end in the layout the render graph's barriers move them into, the
+// barriers also order them against earlier passes, so no render pass declares dependencies
+AttachmentDescription GraphAttachment(const VkFormat format, const VkImageLayout layout,
+                                      const VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+                                      const VkAttachmentStoreOp storeOp =
+                                         VK_ATTACHMENT_STORE_OP_STORE) {
+   AttachmentDescription attachment{};
+   attachment.format = format;
+   attachment.loadOp = loadOp;
+   attachment.storeOp = storeOp;
+   attachment.initialLayout = layout;
+   attachment.finalLayout = layout;
+   return attachment;
+}
+
+// Albedo, normal and depth, plus the swapchain image the lighting subpass writes when merged
+std::vector<VkClearValue> GetGeometryClearValues(const bool gBufferSubpasses) {
+   std::vector<VkClearValue> clearValues = {VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
+                                            VkClearValue{.color = {{0.5f, 0.5f, 1.0f, 0.0f}}},
+                                            VkClearValue{.depthStencil = {1.0f, 0}}};
+   if (gBufferSubpasses)
+      clearValues.push_back(VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}});
+   return clearValues;
+}
 
-struct LightsData {
-   alignas(4) uint32_t lightCount;
-   std::array<LightData, VulkanRenderer::MAX_LIGHTS> lights;
+struct GraphAccessInfo final {
+   VkImageLayout layout;
+   VkPipelineStageFlags stages;
+   VkAccessFlags access;
 };
 
+[[nodiscard]] constexpr GraphAccessInfo GetGraphAccessInfo(
+   const RenderGraphAccess access) noexcept {
+   constexpr VkPipelineStageFlags depthStages =
+      VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+   constexpr VkAccessFlags depthAccess =
+      VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+   switch (access) {
+      case RenderGraphAccess::ColorAttachment:
+         return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                 VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                 VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT};
+      case RenderGraphAccess::DepthAttachment:
+         return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthStages, depthAccess};
+      case RenderGraphAccess::DepthAttachmentSampled:
+         return {VK_IMAGE_LAYOUT_GENERAL, depthStages | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 depthAccess | VK_ACCESS_SHADER_READ_BIT};
+      case RenderGraphAccess::Sampled:
+         return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 VK_ACCESS_SHADER_READ_BIT};
+      // The acquire semaphore waits at color output, which orders the first use after present
+      case RenderGraphAccess::Present:
+         return {VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0};
+      case RenderGraphAccess::None:
+         return {VK_IMAGE_LAYOUT_UNDEFINED, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0};
+   }
+   std::unreachable();
+}
+
+} // namespace
+
 struct GizmoPushConstantData {
    alignas(16) glm::mat4 model;
    alignas(16) glm::vec3 color;
 };
 
+struct VisibilityPushConstantData {
+   alignas(16) glm::mat4 model;
+   uint32_t firstTriangle;
+};
+
+struct MaterialResolvePushConstantData {
+   glm::vec2 viewportSize;
+   uint32_t drawCount;
+   uint32_t materialSlot;
+};
+
+// Matches the std430 DrawData of the material resolve shaders
+struct alignas(16) VisibilityDrawData {
+   glm::mat4 model;
+   uint32_t firstTriangle;
+   uint32_t firstIndex;
+   int32_t vertexOffset;
+   uint32_t indices16;
+   uint32_t materialSlot;
+};
+static_assert(sizeof(VisibilityDrawData) == 96);
+
 VulkanRenderer::VulkanRenderer(Window* windowHandle)
     : IRenderer(windowHandle),
       m_instance(),
@@ -69,6 +158,13 @@ VulkanRenderer::VulkanRenderer(Window* windowHandle)
       std::make_unique<ResourceManager>(std::make_unique<VulkanResourceFactory>(m_device));
    m_materialEditor =
       std::make_unique<MaterialEditor>(m_resourceManager.get(), GraphicsAPI::Vulkan);
+   m_renderGraph = std::make_unique<RenderGraph>(*m_resourceManager, MAX_FRAMES_IN_FLIGHT);
+   m_renderGraph->SetTextureCreatedCallback([this](const TextureHandle& handle) {
+      if (ITexture* texture = m_resourceManager->GetTexture(handle)) {
+         reinterpret_cast<VulkanTexture*>(texture)->UpdateSamplerSettings(VK_FILTER_NEAREST,
+                                                                          VK_FILTER_NEAREST);
+      }
+   });
 
    CreateUBOs();
    CreateMaterialDescriptorSetLayout();
@@ -76,14 +172,34 @@ VulkanRenderer::VulkanRenderer(Window* windowHandle)
 
    CreateGeometryDescriptorSetLayout();
    CreateGeometryPass();
-   CreateGeometryFBO();
    CreateGeometryPipeline();
+   CreateDepthPrepassPasses();
+   CreateDepthPrepassPipelines();
+   m_geometryPool = std::make_unique<VulkanGeometryPool>(m_device);
+   if (m_device.SupportsIndirectCount()) {
+      m_gpuCulling =
+         std::make_unique<VulkanGPUCulling>(m_device, *m_geometryPool, MAX_FRAMES_IN_FLIGHT);
+      CreateIndirectGeometryPipeline();
+      m_settings.gpuDrivenGeometryAvailable = true;
+   }
 
    CreateLightingDescriptorSetLayout();
    CreateLightingPass();
-   CreateLightingFBO();
    CreateLightingPipeline();
 
+   CreateGBufferSubpassDescriptorSetLayout();
+   CreateGBufferSubpassPasses();
+   CreateGBufferSubpassPipelines();
+   m_settings.gBufferSubpassesAvailable = true;
+
+   CreateForwardPass();
+   CreateForwardPipelines();
+
+   CreateVisibilityDescriptorSetLayout();
+   CreateVisibilityPasses();
+   CreateVisibilityPipelines();
+   m_settings.visibilityBufferAvailable = true;
+
    CreateGizmoDescriptorSetLayout();
    CreateGizmoPipeline();
 
@@ -99,9 +215,9 @@ VulkanRenderer::VulkanRenderer(Window* windowHandle)
    CreateDescriptorSets();
 
    CreateSynchronizationObjects();
+   CreateOverdrawQueryPool();
 
-   m_numGeometryThreads = std::max(1u, std::thread::hardware_concurrency());
-   m_geometryThreadPool = std::make_unique<ThreadPool>(m_numGeometryThreads);
+   m_numGeometryThreads = static_cast<uint32_t>(m_threadPool.GetThreadCount());
    m_threadCommandPools.resize(m_numGeometryThreads + NUM_RENDER_PASSES);
    for (uint32_t i = 0; i < m_numGeometryThreads + NUM_RENDER_PASSES; ++i) {
       VkCommandPoolCreateInfo poolInfo{};
@@ -208,87 +324,32 @@ void VulkanRenderer::CreateGeometryDescriptorSetLayout() {
 }
 
 void VulkanRenderer::CreateGeometryPass() {
-   for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-      m_gAlbedoTexture[i] = m_resourceManager->CreateRenderTarget(
-         "gbuffer_albedo_" + std::to_string(i), m_swapchain.GetExtent().width,
-         m_swapchain.GetExtent().height, ITexture::Format::RGBA8);
-      m_gNormalTexture[i] = m_resourceManager->CreateRenderTarget(
-         "gbuffer_normal_" + std::to_string(i), m_swapchain.GetExtent().width,
-         m_swapchain.GetExtent().height, ITexture::Format::RGBA16F);
-      m_gDepthTexture[i] = m_resourceManager->CreateDepthTexture(
-         "gbuffer_depth_" + std::to_string(i), m_swapchain.GetExtent().width,
-         m_swapchain.GetExtent().height);
-   }
-   ITexture* albedoTex = m_resourceManager->GetTexture(m_gAlbedoTexture[0]);
-   ITexture* normalTex = m_resourceManager->GetTexture(m_gNormalTexture[0]);
-   ITexture* depthTex = m_resourceManager->GetTexture(m_gDepthTexture[0]);
-   if (!albedoTex || !normalTex || !depthTex) {
-      throw std::runtime_error("Failed to get G-buffer textures");
-   }
-   VulkanTexture* vkAlbedo = reinterpret_cast<VulkanTexture*>(albedoTex);
-   VulkanTexture* vkNormal = reinterpret_cast<VulkanTexture*>(normalTex);
-   VulkanTexture* vkDepth = reinterpret_cast<VulkanTexture*>(depthTex);
-   m_geometryRenderPass = std::make_unique<VulkanRenderPass>(
-      m_device, std::vector<VkFormat>{vkAlbedo->GetVkFormat(), vkNormal->GetVkFormat()},
-      vkDepth->GetVkFormat());
-}
-
-void VulkanRenderer::CreateGeometryFBO() {
-   for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-      // Create a single framebuffer for the G-buffer using the created textures' image views
-      ITexture* albedoTex = m_resourceManager->GetTexture(m_gAlbedoTexture[i]);
-      ITexture* normalTex = m_resourceManager->GetTexture(m_gNormalTexture[i]);
-      ITexture* depthTex = m_resourceManager->GetTexture(m_gDepthTexture[i]);
-      if (!albedoTex || !normalTex || !depthTex)
-         throw std::runtime_error("Failed to fetch gbuffer textures for framebuffer creation.");
-      VulkanTexture* vkAlbedo = reinterpret_cast<VulkanTexture*>(albedoTex);
-      VulkanTexture* vkNormal = reinterpret_cast<VulkanTexture*>(normalTex);
-      VulkanTexture* vkDepth = reinterpret_cast<VulkanTexture*>(depthTex);
-      vkAlbedo->TransitionLayout(
-         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-      vkNormal->TransitionLayout(
-         VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-         VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-      vkAlbedo->UpdateSamplerSettings(VK_FILTER_NEAREST, VK_FILTER_NEAREST);
-      vkNormal->UpdateSamplerSettings(VK_FILTER_NEAREST, VK_FILTER_NEAREST);
-      vkDepth->UpdateSamplerSettings(VK_FILTER_NEAREST, VK_FILTER_NEAREST);
-      VkImageView attachments[3] = {vkAlbedo->GetImageView(), vkNormal->GetImageView(),
-                                    vkDepth->GetImageView()};
-      VkFramebufferCreateInfo framebufferInfo{};
-      framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-      framebufferInfo.renderPass = m_geometryRenderPass->Get();
-      framebufferInfo.attachmentCount = 3;
-      framebufferInfo.pAttachments = attachments;
-      framebufferInfo.width = m_swapchain.GetExtent().width;
-      framebufferInfo.height = m_swapchain.GetExtent().height;
-      framebufferInfo.layers = 1;
-      if (vkCreateFramebuffer(m_device.Get(), &framebufferInfo, nullptr,
-                              &m_geometryFramebuffers[i]) != VK_SUCCESS) {
-         throw std::runtime_error("Failed to create G-buffer framebuffer.");
-      }
-   }
+   RenderPassDescription desc;
+   desc.attachments = {
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)};
+   SubpassDescription subpass{};
+   subpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   subpass.colorAttachments = {VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
+                               VkAttachmentReference{1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}};
+   subpass.depthStencilAttachment =
+      VkAttachmentReference{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   desc.subpasses.push_back(subpass);
+   m_geometryRenderPass = std::make_unique<VulkanRenderPass>(m_device, desc);
 }
 
-void VulkanRenderer::CreateGeometryPipeline() {
-   // Load shaders
-   const VulkanShaderModule vertShader(m_device,
-                                       std::string("resources/shaders/vk/geometry_pass.vert.spv"));
-   const VulkanShaderModule fragShader(m_device,
-                                       std::string("resources/shaders/vk/geometry_pass.frag.spv"));
-   VkPushConstantRange modelPushConstant{};
-   modelPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-   modelPushConstant.offset = 0;
-   modelPushConstant.size = sizeof(glm::mat4);
-   m_geometryPipelineLayout = std::make_unique<VulkanPipelineLayout>(
-      m_device,
-      std::vector<VkDescriptorSetLayout>{m_geometryDescriptorSetLayout,
-                                         m_materialDescriptorSetLayout},
-      std::vector<VkPushConstantRange>{modelPushConstant});
-   // Build pipeline using the builder
-   VulkanGraphicsPipelineBuilder builder(m_device);
-   builder.SetVertexShader(vertShader.Get())
-      .SetFragmentShader(fragShader.Get())
+// Shared by the per object and the indirect geometry pipelines, which differ only in the vertex
+// shader and layout. After a depth prepass the depth test is equal and writes nothing.
+static VulkanGraphicsPipeline BuildGeometryPipeline(const VulkanDevice& device,
+                                                    const VkShaderModule& vertShader,
+                                                    const VkShaderModule& fragShader,
+                                                    const VkPipelineLayout& layout,
+                                                    const VkRenderPass& renderPass,
+                                                    const bool depthEqual = false) {
+   VulkanGraphicsPipelineBuilder builder(device);
+   builder.SetVertexShader(vertShader)
+      .SetFragmentShader(fragShader)
       .AddVertexBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX)
       .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position))
       .AddVertexAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal))
@@ -298,10 +359,16 @@ void VulkanRenderer::CreateGeometryPipeline() {
       .SetCullMode(VK_CULL_MODE_BACK_BIT)
       .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
       .EnableDepthTest(VK_COMPARE_OP_LESS)
-      .SetPipelineLayout(m_geometryPipelineLayout->Get())
+      .SetPipelineLayout(layout)
       .AddScissor(VkRect2D{})
       .AddViewport(VkViewport{})
-      .SetRenderPass(m_geometryRenderPass->Get());
+      .SetRenderPass(renderPass);
+   if (depthEqual) {
+      VulkanGraphicsPipelineBuilder::DepthStencilState ds{};
+      ds.depthWriteEnable = VK_FALSE;
+      ds.depthCompareOp = VK_COMPARE_OP_EQUAL;
+      builder.SetDepthStencilState(ds);
+   }
    VulkanGraphicsPipelineBuilder::RasterizationState raster{};
    raster.cullMode = VK_CULL_MODE_BACK_BIT;
    raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
@@ -316,9 +383,117 @@ void VulkanRenderer::CreateGeometryPipeline() {
    cbState.attachments.push_back(cb);
    cbState.attachments.push_back(cb);
    builder.SetColorBlendState(cbState);
+   return builder.Build();
+}
+
+// Position stream only, for the depth prepasses and the overdraw view
+static VulkanGraphicsPipelineBuilder PositionOnlyPipelineBuilder(const VulkanDevice& device,
+                                                                 const VkShaderModule& vertShader,
+                                                                 const VkPipelineLayout& layout,
+                                                                 const VkRenderPass& renderPass) {
+   VulkanGraphicsPipelineBuilder builder(device);
+   builder.SetVertexShader(vertShader)
+      .AddVertexBinding(0, sizeof(glm::vec3), VK_VERTEX_INPUT_RATE_VERTEX)
+      .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0)
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(layout)
+      .SetRenderPass(renderPass);
+   VulkanGraphicsPipelineBuilder::RasterizationState raster{};
+   raster.cullMode = VK_CULL_MODE_BACK_BIT;
+   raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+   builder.SetRasterizationState(raster);
+   VulkanGraphicsPipelineBuilder::MultisampleState ms{};
+   ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+   builder.SetMultisampleState(ms);
+   return builder;
+}
+
+void VulkanRenderer::CreateGeometryPipeline() {
+   // Load shaders
+   const VulkanShaderModule vertShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.vert.spv"));
+   const VulkanShaderModule fragShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.frag.spv"));
+   VkPushConstantRange modelPushConstant{};
+   modelPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+   modelPushConstant.offset = 0;
+   modelPushConstant.size = sizeof(glm::mat4);
+   m_geometryPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device,
+      std::vector<VkDescriptorSetLayout>{m_geometryDescriptorSetLayout,
+                                         m_materialDescriptorSetLayout},
+      std::vector<VkPushConstantRange>{modelPushConstant});
    // Build and store pipeline
-   VulkanGraphicsPipeline pipelineObj = builder.Build();
-   m_geometryGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(std::move(pipelineObj));
+   m_geometryGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(
+      BuildGeometryPipeline(m_device, vertShader.Get(), fragShader.Get(),
+                            m_geometryPipelineLayout->Get(), m_geometryRenderPass->Get()));
+}
+
+void VulkanRenderer::CreateIndirectGeometryPipeline() {
+   const VulkanShaderModule vertShader(
+      m_device, std::string("resources/shaders/vk/geometry_pass_indirect.vert.spv"));
+   const VulkanShaderModule fragShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.frag.spv"));
+   // Model matrices come from the culling pass' object buffer instead of push constants
+   m_indirectGeometryPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device,
+      std::vector<VkDescriptorSetLayout>{m_geometryDescriptorSetLayout,
+                                         m_materialDescriptorSetLayout,
+                                         m_gpuCulling->GetDrawDescriptorSetLayout()});
+   m_indirectGeometryGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(
+      BuildGeometryPipeline(m_device, vertShader.Get(), fragShader.Get(),
+                            m_indirectGeometryPipelineLayout->Get(), m_geometryRenderPass->Get()));
+}
+
+void VulkanRenderer::CreateDepthPrepassPasses() {
+   RenderPassDescription depthDesc;
+   depthDesc.attachments = {
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)};
+   SubpassDescription depthSubpass{};
+   depthSubpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   depthSubpass.depthStencilAttachment =
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   depthDesc.subpasses.push_back(depthSubpass);
+   m_depthOnlyRenderPass = std::make_unique<VulkanRenderPass>(m_device, depthDesc);
+   // The geometry pass again, loading the prepass depth instead of clearing it
+   RenderPassDescription desc;
+   desc.attachments = {
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_LOAD)};
+   SubpassDescription subpass{};
+   subpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   subpass.colorAttachments = {VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
+                               VkAttachmentReference{1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}};
+   subpass.depthStencilAttachment =
+      VkAttachmentReference{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   desc.subpasses.push_back(subpass);
+   m_geometryEqualRenderPass = std::make_unique<VulkanRenderPass>(m_device, desc);
+}
+
+void VulkanRenderer::CreateDepthPrepassPipelines() {
+   const VulkanShaderModule prepassVertShader(
+      m_device, std::string("resources/shaders/vk/depth_prepass.vert.spv"));
+   const VulkanShaderModule vertShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.vert.spv"));
+   const VulkanShaderModule fragShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.frag.spv"));
+   // The geometry layout's camera set and model push constant are all the prepass needs
+   VulkanGraphicsPipelineBuilder prepassBuilder =
+      PositionOnlyPipelineBuilder(m_device, prepassVertShader.Get(),
+                                  m_geometryPipelineLayout->Get(), m_depthOnlyRenderPass->Get());
+   prepassBuilder.EnableDepthTest(VK_COMPARE_OP_LESS);
+   prepassBuilder.SetColorBlendState(VulkanGraphicsPipelineBuilder::ColorBlendState{});
+   m_gBufferDepthPrepassGraphicsPipeline =
+      std::make_unique<VulkanGraphicsPipeline>(prepassBuilder.Build());
+   m_geometryEqualGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(
+      BuildGeometryPipeline(m_device, vertShader.Get(), fragShader.Get(),
+                            m_geometryPipelineLayout->Get(), m_geometryEqualRenderPass->Get(),
+                            true));
 }
 
 void VulkanRenderer::CreateLightingDescriptorSetLayout() {
@@ -328,12 +503,12 @@ void VulkanRenderer::CreateLightingDescriptorSetLayout() {
    cameraUboBinding.descriptorCount = 1;
    cameraUboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
    cameraUboBinding.pImmutableSamplers = nullptr;
-   VkDescriptorSetLayoutBinding lightingUboBinding{};
-   lightingUboBinding.binding = 1;
-   lightingUboBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-   lightingUboBinding.descriptorCount = 1;
-   lightingUboBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-   lightingUboBinding.pImmutableSamplers = nullptr;
+   VkDescriptorSetLayoutBinding lightsBinding{};
+   lightsBinding.binding = 1;
+   lightsBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+   lightsBinding.descriptorCount = 1;
+   lightsBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+   lightsBinding.pImmutableSamplers = nullptr;
    VkDescriptorSetLayoutBinding albedoSamplerBinding{};
    albedoSamplerBinding.binding = 3;
    albedoSamplerBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -352,9 +527,21 @@ void VulkanRenderer::CreateLightingDescriptorSetLayout() {
    depthSamplerBinding.descriptorCount = 1;
    depthSamplerBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
    depthSamplerBinding.pImmutableSamplers = nullptr;
-   const std::array<VkDescriptorSetLayoutBinding, 5> bindings = {
-      cameraUboBinding, lightingUboBinding, albedoSamplerBinding, normalSamplerBinding,
-      depthSamplerBinding};
+   VkDescriptorSetLayoutBinding clusterBinding{};
+   clusterBinding.binding = 6;
+   clusterBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+   clusterBinding.descriptorCount = 1;
+   clusterBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+   clusterBinding.pImmutableSamplers = nullptr;
+   VkDescriptorSetLayoutBinding lightIndexBinding{};
+   lightIndexBinding.binding = 7;
+   lightIndexBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+   lightIndexBinding.descriptorCount = 1;
+   lightIndexBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+   lightIndexBinding.pImmutableSamplers = nullptr;
+   const std::array<VkDescriptorSetLayoutBinding, 7> bindings = {
+      cameraUboBinding,    lightsBinding,  albedoSamplerBinding, normalSamplerBinding,
+      depthSamplerBinding, clusterBinding, lightIndexBinding};
    VkDescriptorSetLayoutCreateInfo layoutInfo{};
    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
@@ -366,78 +553,20 @@ void VulkanRenderer::CreateLightingDescriptorSetLayout() {
 }
 
 void VulkanRenderer::CreateLightingPass() {
+   // The depth is loaded from the geometry or visibility pass and sampled while tested against
    RenderPassDescription desc;
-   AttachmentDescription colorAtt{};
-   colorAtt.format = m_swapchain.GetFormat();
-   colorAtt.samples = VK_SAMPLE_COUNT_1_BIT;
-   colorAtt.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-   colorAtt.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-   colorAtt.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-   colorAtt.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-   colorAtt.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-   colorAtt.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-   desc.attachments.push_back(colorAtt);
-   AttachmentDescription depthAtt{};
-   depthAtt.format = VK_FORMAT_D32_SFLOAT;
-   depthAtt.samples = VK_SAMPLE_COUNT_1_BIT;
-   depthAtt.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-   depthAtt.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-   depthAtt.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-   depthAtt.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-   depthAtt.initialLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-   depthAtt.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-   desc.attachments.push_back(depthAtt);
+   desc.attachments = {
+      GraphAttachment(m_swapchain.GetFormat(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_GENERAL, VK_ATTACHMENT_LOAD_OP_LOAD)};
    SubpassDescription subpass{};
    subpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-   VkAttachmentReference colorRef{};
-   colorRef.attachment = 0;
-   colorRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-   subpass.colorAttachments.push_back(colorRef);
-   VkAttachmentReference depthRef{};
-   depthRef.attachment = 1;
-   depthRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-   subpass.depthStencilAttachment = depthRef;
+   subpass.colorAttachments.push_back(
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+   subpass.depthStencilAttachment = VkAttachmentReference{1, VK_IMAGE_LAYOUT_GENERAL};
    desc.subpasses.push_back(subpass);
-   VkSubpassDependency dep{};
-   dep.srcSubpass = VK_SUBPASS_EXTERNAL;
-   dep.dstSubpass = 0;
-   dep.srcStageMask =
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-   dep.srcAccessMask = 0;
-   dep.dstStageMask =
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-   dep.dstAccessMask =
-      VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-   desc.dependencies.push_back(dep);
    m_lightingRenderPass = std::make_unique<VulkanRenderPass>(m_device, desc);
 }
 
-void VulkanRenderer::CreateLightingFBO() {
-   const auto& imageViews = m_swapchain.GetImageViews();
-   m_lightingFramebuffers.resize(imageViews.size());
-   for (uint32_t i = 0; i < imageViews.size(); ++i) {
-      const uint32_t depthIndex = i % MAX_FRAMES_IN_FLIGHT;
-      ITexture* depthTex = m_resourceManager->GetTexture(m_gDepthTexture[depthIndex]);
-      if (!depthTex)
-         throw std::runtime_error("Failed to get depth texture for lighting framebuffer");
-      const VulkanTexture* vkDepth = reinterpret_cast<VulkanTexture*>(depthTex);
-      const VkImageView attachments[2] = {imageViews[i], vkDepth->GetImageView()};
-      VkFramebufferCreateInfo framebufferInfo{};
-      framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-      framebufferInfo.renderPass = m_lightingRenderPass->Get();
-      framebufferInfo.attachmentCount = 2;
-      framebufferInfo.pAttachments = attachments;
-      framebufferInfo.width = m_swapchain.GetExtent().width;
-      framebufferInfo.height = m_swapchain.GetExtent().height;
-      framebufferInfo.layers = 1;
-
-      if (vkCreateFramebuffer(m_device.Get(), &framebufferInfo, nullptr,
-                              &m_lightingFramebuffers[i]) != VK_SUCCESS) {
-         throw std::runtime_error("Failed to create lighting framebuffer.");
-      }
-   }
-}
-
 void VulkanRenderer::CreateLightingPipeline() {
    // Load shaders
    const VulkanShaderModule vertShader(m_device,
@@ -481,6 +610,430 @@ void VulkanRenderer::CreateLightingPipeline() {
    m_lightingGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(std::move(pipelineObj));
 }
 
+void VulkanRenderer::CreateGBufferSubpassDescriptorSetLayout() {
+   // Albedo, normal and depth, each read at the pixel being lit
+   std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+   for (uint32_t i = 0; i < bindings.size(); ++i) {
+      bindings[i].binding = i;
+      bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+      bindings[i].descriptorCount = 1;
+      bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+      bindings[i].pImmutableSamplers = nullptr;
+   }
+   VkDescriptorSetLayoutCreateInfo layoutInfo{};
+   layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+   layoutInfo.pBindings = bindings.data();
+   if (vkCreateDescriptorSetLayout(m_device.Get(), &layoutInfo, nullptr,
+                                   &m_gBufferSubpassDescriptorSetLayout) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create G-buffer subpass descriptor set layout.");
+   }
+}
+
+void VulkanRenderer::CreateGBufferSubpassPasses() {
+   // The G-buffer is neither loaded nor stored, so tiled GPUs can keep it on chip for the whole
+   // render pass. The depth is stored for the overlays.
+   RenderPassDescription desc;
+   desc.attachments = {
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE),
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL),
+      GraphAttachment(m_swapchain.GetFormat(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL)};
+   SubpassDescription geometry{};
+   geometry.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   geometry.colorAttachments = {VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
+                                VkAttachmentReference{1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}};
+   geometry.depthStencilAttachment =
+      VkAttachmentReference{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   SubpassDescription lighting{};
+   lighting.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   lighting.inputAttachments = {
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+      VkAttachmentReference{1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+      VkAttachmentReference{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL}};
+   lighting.colorAttachments.push_back(
+      VkAttachmentReference{3, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+   desc.subpasses = {geometry, lighting};
+   // Unlike the graph's barriers these are inside the pass. The external one orders the layout
+   // transitions at its end before the barriers into the overlay pass.
+   desc.dependencies = {
+      VkSubpassDependency{
+         .srcSubpass = 0,
+         .dstSubpass = 1,
+         .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         .dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+         .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         .dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+         .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT},
+      VkSubpassDependency{
+         .srcSubpass = 1,
+         .dstSubpass = VK_SUBPASS_EXTERNAL,
+         .srcStageMask =
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+         .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+                         VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                         VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+         .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+         .dstAccessMask =
+            VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT |
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+         .dependencyFlags = 0}};
+   m_gBufferSubpassRenderPass = std::make_unique<VulkanRenderPass>(m_device, desc);
+   // Same attachments as the lighting pass, so the overlay pipelines and ImGui draw in it as is
+   RenderPassDescription overlayDesc;
+   overlayDesc.attachments = {
+      GraphAttachment(m_swapchain.GetFormat(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_LOAD),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_LOAD, VK_ATTACHMENT_STORE_OP_DONT_CARE)};
+   SubpassDescription overlay{};
+   overlay.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   overlay.colorAttachments.push_back(
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+   overlay.depthStencilAttachment =
+      VkAttachmentReference{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   overlayDesc.subpasses.push_back(overlay);
+   m_overlayRenderPass = std::make_unique<VulkanRenderPass>(m_device, overlayDesc);
+}
+
+void VulkanRenderer::CreateGBufferSubpassPipelines() {
+   // Geometry subpass, the same pipelines built against subpass 0 of the merged pass
+   const VulkanShaderModule geometryFrag(
+      m_device, std::string("resources/shaders/vk/geometry_pass.frag.spv"));
+   const VulkanShaderModule geometryVert(
+      m_device, std::string("resources/shaders/vk/geometry_pass.vert.spv"));
+   m_subpassGeometryGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(
+      BuildGeometryPipeline(m_device, geometryVert.Get(), geometryFrag.Get(),
+                            m_geometryPipelineLayout->Get(), m_gBufferSubpassRenderPass->Get()));
+   if (m_indirectGeometryPipelineLayout) {
+      const VulkanShaderModule indirectVert(
+         m_device, std::string("resources/shaders/vk/geometry_pass_indirect.vert.spv"));
+      m_subpassIndirectGeometryGraphicsPipeline =
+         std::make_unique<VulkanGraphicsPipeline>(BuildGeometryPipeline(
+            m_device, indirectVert.Get(), geometryFrag.Get(),
+            m_indirectGeometryPipelineLayout->Get(), m_gBufferSubpassRenderPass->Get()));
+   }
+   // Lighting subpass, the lighting set for camera and lights plus the input attachments
+   const VulkanShaderModule vertShader(m_device,
+                                       std::string("resources/shaders/vk/lighting_pass.vert.spv"));
+   const VulkanShaderModule fragShader(
+      m_device, std::string("resources/shaders/vk/lighting_subpass.frag.spv"));
+   m_subpassLightingPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device, std::vector<VkDescriptorSetLayout>{m_lightingDescriptorSetLayout,
+                                                   m_gBufferSubpassDescriptorSetLayout});
+   VulkanGraphicsPipelineBuilder builder(m_device);
+   builder.SetVertexShader(vertShader.Get())
+      .SetFragmentShader(fragShader.Get())
+      .AddVertexBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX)
+      .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position))
+      .AddVertexAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal))
+      .AddVertexAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv))
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .SetCullMode(VK_CULL_MODE_NONE)
+      .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+      .DisableDepthTest()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(m_subpassLightingPipelineLayout->Get())
+      .SetRenderPass(m_gBufferSubpassRenderPass->Get(), 1);
+   VulkanGraphicsPipelineBuilder::RasterizationState raster{};
+   raster.cullMode = VK_CULL_MODE_NONE;
+   raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+   builder.SetRasterizationState(raster);
+   VulkanGraphicsPipelineBuilder::MultisampleState ms{};
+   ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+   builder.SetMultisampleState(ms);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState cb{};
+   cb.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                       VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+   VulkanGraphicsPipelineBuilder::ColorBlendState cbState{};
+   cbState.attachments.push_back(cb);
+   builder.SetColorBlendState(cbState);
+   m_subpassLightingGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(builder.Build());
+}
+
+void VulkanRenderer::CreateForwardPass() {
+   // Same attachments as the lighting pass so the gizmo, particle and ImGui pipelines stay
+   // compatible, but the depth is cleared here instead of loaded from the geometry pass
+   RenderPassDescription desc;
+   desc.attachments = {
+      GraphAttachment(m_swapchain.GetFormat(), VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)};
+   SubpassDescription subpass{};
+   subpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   subpass.colorAttachments.push_back(
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+   subpass.depthStencilAttachment =
+      VkAttachmentReference{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   desc.subpasses.push_back(subpass);
+   m_forwardRenderPass = std::make_unique<VulkanRenderPass>(m_device, desc);
+}
+
+void VulkanRenderer::CreateForwardPipelines() {
+   const VulkanShaderModule prepassVertShader(
+      m_device, std::string("resources/shaders/vk/depth_prepass.vert.spv"));
+   const VulkanShaderModule vertShader(m_device,
+                                       std::string("resources/shaders/vk/geometry_pass.vert.spv"));
+   const VulkanShaderModule fragShader(m_device,
+                                       std::string("resources/shaders/vk/forward_pass.frag.spv"));
+   // The lighting set carries the camera and the clustered lights, the material set follows
+   VkPushConstantRange modelPushConstant{};
+   modelPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+   modelPushConstant.offset = 0;
+   modelPushConstant.size = sizeof(glm::mat4);
+   m_forwardPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device,
+      std::vector<VkDescriptorSetLayout>{m_lightingDescriptorSetLayout,
+                                         m_materialDescriptorSetLayout},
+      std::vector<VkPushConstantRange>{modelPushConstant});
+   VulkanGraphicsPipelineBuilder::RasterizationState raster{};
+   raster.cullMode = VK_CULL_MODE_BACK_BIT;
+   raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+   VulkanGraphicsPipelineBuilder::MultisampleState ms{};
+   ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+   // Depth prepass, position only and no color writes
+   VulkanGraphicsPipelineBuilder prepassBuilder =
+      PositionOnlyPipelineBuilder(m_device, prepassVertShader.Get(),
+                                  m_forwardPipelineLayout->Get(), m_forwardRenderPass->Get());
+   VulkanGraphicsPipelineBuilder::DepthStencilState prepassDs{};
+   prepassDs.depthTestEnable = VK_TRUE;
+   prepassDs.depthWriteEnable = VK_TRUE;
+   prepassDs.depthCompareOp = VK_COMPARE_OP_LESS;
+   prepassBuilder.SetDepthStencilState(prepassDs);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState prepassCb{};
+   prepassCb.colorWriteMask = 0;
+   VulkanGraphicsPipelineBuilder::ColorBlendState prepassCbState{};
+   prepassCbState.attachments.push_back(prepassCb);
+   prepassBuilder.SetColorBlendState(prepassCbState);
+   m_depthPrepassGraphicsPipeline =
+      std::make_unique<VulkanGraphicsPipeline>(prepassBuilder.Build());
+   // Forward shading, only the fragments that won the prepass pass the equal test
+   VulkanGraphicsPipelineBuilder builder(m_device);
+   builder.SetVertexShader(vertShader.Get())
+      .SetFragmentShader(fragShader.Get())
+      .AddVertexBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX)
+      .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position))
+      .AddVertexAttribute(1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, normal))
+      .AddVertexAttribute(2, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, uv))
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(m_forwardPipelineLayout->Get())
+      .SetRenderPass(m_forwardRenderPass->Get());
+   builder.SetRasterizationState(raster);
+   builder.SetMultisampleState(ms);
+   VulkanGraphicsPipelineBuilder::DepthStencilState ds{};
+   ds.depthTestEnable = VK_TRUE;
+   ds.depthWriteEnable = VK_FALSE;
+   ds.depthCompareOp = VK_COMPARE_OP_EQUAL;
+   builder.SetDepthStencilState(ds);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState cb{};
+   cb.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                       VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+   VulkanGraphicsPipelineBuilder::ColorBlendState cbState{};
+   cbState.attachments.push_back(cb);
+   builder.SetColorBlendState(cbState);
+   m_forwardGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(builder.Build());
+   // Overdraw view, every fragment adds its constant color, alpha stays one
+   const VulkanShaderModule overdrawFragShader(
+      m_device, std::string("resources/shaders/vk/overdraw.frag.spv"));
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState overdrawCb{};
+   overdrawCb.blendEnable = VK_TRUE;
+   overdrawCb.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+   overdrawCb.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+   VulkanGraphicsPipelineBuilder::ColorBlendState overdrawCbState{};
+   overdrawCbState.attachments.push_back(overdrawCb);
+   const auto buildOverdrawPipeline = [&](const VkCompareOp compareOp, const VkBool32 depthWrite) {
+      VulkanGraphicsPipelineBuilder overdrawBuilder =
+         PositionOnlyPipelineBuilder(m_device, prepassVertShader.Get(),
+                                     m_forwardPipelineLayout->Get(), m_forwardRenderPass->Get());
+      overdrawBuilder.SetFragmentShader(overdrawFragShader.Get());
+      VulkanGraphicsPipelineBuilder::DepthStencilState overdrawDs{};
+      overdrawDs.depthWriteEnable = depthWrite;
+      overdrawDs.depthCompareOp = compareOp;
+      overdrawBuilder.SetDepthStencilState(overdrawDs);
+      overdrawBuilder.SetColorBlendState(overdrawCbState);
+      return std::make_unique<VulkanGraphicsPipeline>(overdrawBuilder.Build());
+   };
+   m_overdrawGraphicsPipeline = buildOverdrawPipeline(VK_COMPARE_OP_LESS, VK_TRUE);
+   m_overdrawEqualGraphicsPipeline = buildOverdrawPipeline(VK_COMPARE_OP_EQUAL, VK_FALSE);
+}
+
+void VulkanRenderer::CreateVisibilityDescriptorSetLayout() {
+   // Camera, triangle ids, draw table, then the geometry pool the resolve fetches by hand
+   std::array<VkDescriptorSetLayoutBinding, 6> bindings{};
+   for (uint32_t i = 0; i < bindings.size(); ++i) {
+      bindings[i].binding = i;
+      bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      bindings[i].descriptorCount = 1;
+      bindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+      bindings[i].pImmutableSamplers = nullptr;
+   }
+   bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+   bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+   bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+   VkDescriptorSetLayoutCreateInfo layoutInfo{};
+   layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+   layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+   layoutInfo.pBindings = bindings.data();
+   if (vkCreateDescriptorSetLayout(m_device.Get(), &layoutInfo, nullptr,
+                                   &m_visibilityDescriptorSetLayout) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to create visibility descriptor set layout.");
+   }
+}
+
+void VulkanRenderer::CreateVisibilityPasses() {
+   // Triangle ids and the G-buffer depth, which the lighting pass loads as before
+   RenderPassDescription visibilityDesc;
+   visibilityDesc.attachments = {
+      GraphAttachment(VK_FORMAT_R32_UINT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)};
+   SubpassDescription visibilitySubpass{};
+   visibilitySubpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   visibilitySubpass.colorAttachments.push_back(
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL});
+   visibilitySubpass.depthStencilAttachment =
+      VkAttachmentReference{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   visibilityDesc.subpasses.push_back(visibilitySubpass);
+   m_visibilityRenderPass = std::make_unique<VulkanRenderPass>(m_device, visibilityDesc);
+   // Albedo and normal G-buffer targets, the material depth is only needed inside the pass
+   RenderPassDescription resolveDesc;
+   resolveDesc.attachments = {
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(GBUFFER_FORMAT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL),
+      GraphAttachment(VK_FORMAT_D32_SFLOAT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                      VK_ATTACHMENT_LOAD_OP_CLEAR, VK_ATTACHMENT_STORE_OP_DONT_CARE)};
+   SubpassDescription resolveSubpass{};
+   resolveSubpass.bindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+   resolveSubpass.colorAttachments = {
+      VkAttachmentReference{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},
+      VkAttachmentReference{1, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}};
+   resolveSubpass.depthStencilAttachment =
+      VkAttachmentReference{2, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+   resolveDesc.subpasses.push_back(resolveSubpass);
+   m_materialResolveRenderPass = std::make_unique<VulkanRenderPass>(m_device, resolveDesc);
+}
+
+void VulkanRenderer::CreateVisibilityPipelines() {
+   const VulkanShaderModule visibilityVertShader(
+      m_device, std::string("resources/shaders/vk/visibility_pass.vert.spv"));
+   const VulkanShaderModule visibilityFragShader(
+      m_device, std::string("resources/shaders/vk/visibility_pass.frag.spv"));
+   const VulkanShaderModule resolveVertShader(
+      m_device, std::string("resources/shaders/vk/material_resolve.vert.spv"));
+   const VulkanShaderModule materialDepthFragShader(
+      m_device, std::string("resources/shaders/vk/material_depth.frag.spv"));
+   const VulkanShaderModule resolveFragShader(
+      m_device, std::string("resources/shaders/vk/material_resolve.frag.spv"));
+   VkPushConstantRange visibilityPushConstant{};
+   visibilityPushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+   visibilityPushConstant.offset = 0;
+   visibilityPushConstant.size = sizeof(VisibilityPushConstantData);
+   m_visibilityPipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device, std::vector<VkDescriptorSetLayout>{m_visibilityDescriptorSetLayout},
+      std::vector<VkPushConstantRange>{visibilityPushConstant});
+   VkPushConstantRange resolvePushConstant{};
+   resolvePushConstant.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+   resolvePushConstant.offset = 0;
+   resolvePushConstant.size = sizeof(MaterialResolvePushConstantData);
+   m_materialResolvePipelineLayout = std::make_unique<VulkanPipelineLayout>(
+      m_device,
+      std::vector<VkDescriptorSetLayout>{m_visibilityDescriptorSetLayout,
+                                         m_materialDescriptorSetLayout},
+      std::vector<VkPushConstantRange>{resolvePushConstant});
+   VulkanGraphicsPipelineBuilder::MultisampleState ms{};
+   ms.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+   // Visibility pass, position only into the id target
+   VulkanGraphicsPipelineBuilder visibilityBuilder(m_device);
+   visibilityBuilder.SetVertexShader(visibilityVertShader.Get())
+      .SetFragmentShader(visibilityFragShader.Get())
+      .AddVertexBinding(0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX)
+      .AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, position))
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(m_visibilityPipelineLayout->Get())
+      .SetRenderPass(m_visibilityRenderPass->Get());
+   VulkanGraphicsPipelineBuilder::RasterizationState raster{};
+   raster.cullMode = VK_CULL_MODE_BACK_BIT;
+   raster.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+   visibilityBuilder.SetRasterizationState(raster);
+   visibilityBuilder.SetMultisampleState(ms);
+   VulkanGraphicsPipelineBuilder::DepthStencilState visibilityDs{};
+   visibilityDs.depthTestEnable = VK_TRUE;
+   visibilityDs.depthWriteEnable = VK_TRUE;
+   visibilityDs.depthCompareOp = VK_COMPARE_OP_LESS;
+   visibilityBuilder.SetDepthStencilState(visibilityDs);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState idCb{};
+   idCb.colorWriteMask = VK_COLOR_COMPONENT_R_BIT;
+   VulkanGraphicsPipelineBuilder::ColorBlendState idCbState{};
+   idCbState.attachments.push_back(idCb);
+   visibilityBuilder.SetColorBlendState(idCbState);
+   m_visibilityGraphicsPipeline =
+      std::make_unique<VulkanGraphicsPipeline>(visibilityBuilder.Build());
+   // The resolve pipelines draw a full-screen triangle without vertex input
+   raster.cullMode = VK_CULL_MODE_NONE;
+   // Material depth, every covered pixel gets its material slot as depth and no color
+   VulkanGraphicsPipelineBuilder depthBuilder(m_device);
+   depthBuilder.SetVertexShader(resolveVertShader.Get())
+      .SetFragmentShader(materialDepthFragShader.Get())
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(m_materialResolvePipelineLayout->Get())
+      .SetRenderPass(m_materialResolveRenderPass->Get());
+   depthBuilder.SetRasterizationState(raster);
+   depthBuilder.SetMultisampleState(ms);
+   VulkanGraphicsPipelineBuilder::DepthStencilState materialDepthDs{};
+   materialDepthDs.depthTestEnable = VK_TRUE;
+   materialDepthDs.depthWriteEnable = VK_TRUE;
+   materialDepthDs.depthCompareOp = VK_COMPARE_OP_ALWAYS;
+   depthBuilder.SetDepthStencilState(materialDepthDs);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState noColorCb{};
+   noColorCb.colorWriteMask = 0;
+   VulkanGraphicsPipelineBuilder::ColorBlendState noColorCbState{};
+   noColorCbState.attachments.push_back(noColorCb);
+   noColorCbState.attachments.push_back(noColorCb);
+   depthBuilder.SetColorBlendState(noColorCbState);
+   m_materialDepthGraphicsPipeline = std::make_unique<VulkanGraphicsPipeline>(depthBuilder.Build());
+   // Material resolve, only the pixels whose material depth matches the slot pass
+   VulkanGraphicsPipelineBuilder resolveBuilder(m_device);
+   resolveBuilder.SetVertexShader(resolveVertShader.Get())
+      .SetFragmentShader(resolveFragShader.Get())
+      .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+      .SetDynamicViewportAndScissor()
+      .AddScissor(VkRect2D{})
+      .AddViewport(VkViewport{})
+      .SetPipelineLayout(m_materialResolvePipelineLayout->Get())
+      .SetRenderPass(m_materialResolveRenderPass->Get());
+   resolveBuilder.SetRasterizationState(raster);
+   resolveBuilder.SetMultisampleState(ms);
+   VulkanGraphicsPipelineBuilder::DepthStencilState resolveDs{};
+   resolveDs.depthTestEnable = VK_TRUE;
+   resolveDs.depthWriteEnable = VK_FALSE;
+   resolveDs.depthCompareOp = VK_COMPARE_OP_EQUAL;
+   resolveBuilder.SetDepthStencilState(resolveDs);
+   VulkanGraphicsPipelineBuilder::ColorBlendAttachmentState cb{};
+   cb.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                       VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+   VulkanGraphicsPipelineBuilder::ColorBlendState cbState{};
+   cbState.attachments.push_back(cb);
+   cbState.attachments.push_back(cb);
+   resolveBuilder.SetColorBlendState(cbState);
+   m_materialResolveGraphicsPipeline =
+      std::make_unique<VulkanGraphicsPipeline>(resolveBuilder.Build());
+}
+
 void VulkanRenderer::CreateGizmoDescriptorSetLayout() {
    VkDescriptorSetLayoutBinding cameraUboBinding{};
    cameraUboBinding.binding = 0;
@@ -645,8 +1198,6 @@ void VulkanRenderer::CreateCommandBuffers() {
 }
 
 void VulkanRenderer::RecordCommandBuffer(const uint32_t imageIndex) {
-   // Setup record
-   m_commandBuffers->Begin(0, m_currentFrame);
    // Calculate dynamic viewport and scissor
    const VkViewport viewport{.x = 0.0f,
                              .y = 0.0f,
@@ -655,21 +1206,238 @@ void VulkanRenderer::RecordCommandBuffer(const uint32_t imageIndex) {
                              .minDepth = 0.0f,
                              .maxDepth = 1.0f};
    const VkRect2D scissor{.offset = {0, 0}, .extent = m_swapchain.GetExtent()};
-   if (m_activeScene) [[likely]] {
-      m_activeScene->UpdateScene(m_deltaTime);
-      m_activeScene->UpdateTransforms();
-   }
+   BuildRenderGraph(imageIndex, viewport, scissor);
+   // Sets may only be rewritten before this frame's command buffer binds them
+   WriteRenderGraphDescriptors(m_currentFrame);
+   ++m_frameCount;
+   PruneFramebuffers();
+   // Setup record
+   m_commandBuffers->Begin(0, m_currentFrame);
    m_gpuTimer.BeginFrame(m_commandBuffers->Get(m_currentFrame), m_currentFrame);
-   // GEOMETRY PASS
-   m_gpuTimer.Begin("GeometryPass");
-   RenderGeometryPass(viewport, scissor);
-   m_gpuTimer.End("GeometryPass");
-   // Transition G-buffer layouts
-   TransitionGBufferLayouts();
-   // LIGHTING PASS
-   m_gpuTimer.Begin("LightingPass");
-   RenderLightingPass(imageIndex, viewport, scissor);
-   m_gpuTimer.End("LightingPass");
+   if (m_overdrawQueryPool != VK_NULL_HANDLE) {
+      vkCmdResetQueryPool(m_commandBuffers->Get(m_currentFrame), m_overdrawQueryPool,
+                          m_currentFrame, 1);
+   }
+   m_renderGraph->Execute([this](const std::span<const RenderGraph::Barrier> barriers) {
+      RecordRenderGraphBarriers(barriers);
+   });
+   m_commandBuffers->End(m_currentFrame);
+}
+
+void VulkanRenderer::BuildRenderGraph(const uint32_t imageIndex, const VkViewport& viewport,
+                                      const VkRect2D& scissor) {
+   using Access = RenderGraphAccess;
+   using TextureId = RenderGraph::TextureId;
+   using Clock = std::chrono::high_resolution_clock;
+   RenderGraph& graph = *m_renderGraph;
+   graph.Reset();
+   m_imageIndex = imageIndex;
+   m_geometryRecordMs = 0.0f;
+   const VkExtent2D extent = m_swapchain.GetExtent();
+   // VulkanTexture render targets are RGBA8 unless they hold ids, so that is what the normals get
+   const RenderGraph::TextureDesc colorDesc{extent.width, extent.height, ITexture::Format::RGBA8};
+   const RenderGraph::TextureDesc depthDesc{extent.width, extent.height,
+                                            ITexture::Format::Depth32F};
+   const TextureId backbuffer =
+      graph.ImportTexture("backbuffer", TextureHandle{}, Access::Present, Access::Present);
+   const TextureId depth = graph.CreateTexture("scene_depth", depthDesc);
+   m_graphTextures = GraphTextures{.backbuffer = backbuffer, .depth = depth};
+   if (m_overdrawFrame) {
+      // OVERDRAW VIEW in place of the scene passes, then the overlays on top
+      graph
+         .AddPass("OverdrawPass",
+                  [=, this] {
+                     const std::array views{GetGraphImageView(backbuffer),
+                                            GetGraphImageView(depth)};
+                     RenderOverdrawPass(GetFramebuffer(*m_forwardRenderPass, views), viewport,
+                                        scissor);
+                     RenderOverlayPasses(imageIndex, viewport, scissor);
+                  })
+         .Write(backbuffer, Access::ColorAttachment)
+         .Write(depth, Access::DepthAttachment);
+      graph.Compile();
+      return;
+   }
+   if (m_framePipeline == RenderPipeline::ForwardPlus) {
+      // DEPTH PREPASS and FORWARD PASS in one render pass that stays open for the overlays
+      graph
+         .AddPass("ForwardPass",
+                  [=, this] {
+                     const std::array views{GetGraphImageView(backbuffer),
+                                            GetGraphImageView(depth)};
+                     const VkFramebuffer framebuffer = GetFramebuffer(*m_forwardRenderPass, views);
+                     const auto recordStart = Clock::now();
+                     m_gpuTimer.Begin("DepthPrepass");
+                     RenderDepthPrepass(framebuffer, viewport, scissor);
+                     m_gpuTimer.End("DepthPrepass");
+                     m_gpuTimer.Begin("ForwardPass");
+                     RenderForwardPass(viewport, scissor);
+                     m_gpuTimer.End("ForwardPass");
+                     m_geometryRecordMs =
+                        std::chrono::duration<float, std::milli>(Clock::now() - recordStart)
+                           .count();
+                     m_geometryDrawCalls =
+                        static_cast<uint32_t>(m_renderWorld.GetVisibleMeshes().size());
+                     RenderOverlayPasses(imageIndex, viewport, scissor);
+                  })
+         .Write(backbuffer, Access::ColorAttachment)
+         .Write(depth, Access::DepthAttachment);
+      graph.Compile();
+      return;
+   }
+   // The subpass path only reads the G-buffer as input attachments of the pass that writes it
+   RenderGraph::TextureDesc gBufferDesc = colorDesc;
+   gBufferDesc.transientAttachment = m_gBufferSubpassFrame;
+   const TextureId albedo = graph.CreateTexture("gbuffer_albedo", gBufferDesc);
+   const TextureId normal = graph.CreateTexture("gbuffer_normal", gBufferDesc);
+   m_graphTextures.albedo = albedo;
+   m_graphTextures.normal = normal;
+   if (m_framePipeline == RenderPipeline::VisibilityBuffer) {
+      const TextureId ids = graph.CreateTexture(
+         "visibility_ids", {extent.width, extent.height, ITexture::Format::R32UI});
+      const TextureId materialDepth = graph.CreateTexture("material_depth", depthDesc);
+      m_graphTextures.ids = ids;
+      // VISIBILITY PASS and MATERIAL RESOLVE into the G-buffer
+      graph
+         .AddPass("VisibilityPass",
+                  [=, this] {
+                     const std::array views{GetGraphImageView(ids), GetGraphImageView(depth)};
+                     const auto recordStart = Clock::now();
+                     m_gpuTimer.Begin("VisibilityPass");
+                     RenderVisibilityPass(GetFramebuffer(*m_visibilityRenderPass, views),
+                                          viewport, scissor);
+                     m_gpuTimer.End("VisibilityPass");
+                     m_geometryRecordMs =
+                        std::chrono::duration<float, std::milli>(Clock::now() - recordStart)
+                           .count();
+                  })
+         .Write(ids, Access::ColorAttachment)
+         .Write(depth, Access::DepthAttachment);
+      graph
+         .AddPass("MaterialResolve",
+                  [=, this] {
+                     const std::array views{GetGraphImageView(albedo), GetGraphImageView(normal),
+                                            GetGraphImageView(materialDepth)};
+                     const auto recordStart = Clock::now();
+                     m_gpuTimer.Begin("MaterialResolve");
+                     RenderMaterialResolve(GetFramebuffer(*m_materialResolveRenderPass, views),
+                                           viewport, scissor);
+                     m_gpuTimer.End("MaterialResolve");
+                     m_geometryRecordMs +=
+                        std::chrono::duration<float, std::milli>(Clock::now() - recordStart)
+                           .count();
+                     m_geometryDrawCalls = static_cast<uint32_t>(m_visibilityDraws.size() +
+                                                                 m_visibilityMaterials.size());
+                  })
+         .Read(ids, Access::Sampled)
+         .Write(albedo, Access::ColorAttachment)
+         .Write(normal, Access::ColorAttachment)
+         .Write(materialDepth, Access::DepthAttachment);
+   } else {
+      // GEOMETRY PASS, or GEOMETRY and LIGHTING SUBPASSES of one render pass that never stores
+      // the G-buffer
+      const bool subpasses = m_gBufferSubpassFrame;
+      const VulkanRenderPass* renderPass =
+         subpasses ? m_gBufferSubpassRenderPass.get()
+                   : (m_depthPrepassFrame ? m_geometryEqualRenderPass.get()
+                                          : m_geometryRenderPass.get());
+      if (m_depthPrepassFrame) {
+         // DEPTH PREPASS, positions only, so the geometry pass shades each pixel once
+         graph
+            .AddPass("DepthPrepass",
+                     [=, this] {
+                        const std::array views{GetGraphImageView(depth)};
+                        const auto recordStart = Clock::now();
+                        m_gpuTimer.Begin("DepthPrepass");
+                        RenderGBufferDepthPrepass(GetFramebuffer(*m_depthOnlyRenderPass, views),
+                                                  viewport, scissor);
+                        m_gpuTimer.End("DepthPrepass");
+                        m_geometryRecordMs +=
+                           std::chrono::duration<float, std::milli>(Clock::now() - recordStart)
+                              .count();
+                     })
+            .Write(depth, Access::DepthAttachment);
+      }
+      RenderGraph::PassBuilder geometryPass = graph.AddPass(
+         subpasses ? StringId("GBufferSubpasses") : StringId("GeometryPass"), [=, this] {
+            const std::array views{GetGraphImageView(albedo), GetGraphImageView(normal),
+                                   GetGraphImageView(depth), GetGraphImageView(backbuffer)};
+            const VkFramebuffer framebuffer =
+               GetFramebuffer(*renderPass, std::span(views).first(subpasses ? 4 : 3));
+            m_gpuTimer.Begin("GeometryPass");
+            const auto recordStart = Clock::now();
+            if (m_gpuDrivenFrame) {
+               // Culling writes the draw arguments, so it runs before the render pass
+               const Frustum frustum = m_activeCamera ? m_activeCamera->GetFrustum() : Frustum{};
+               m_gpuCulling->RecordCulling(m_commandBuffers->Get(m_currentFrame), m_currentFrame,
+                                           frustum);
+               RenderGeometryPassIndirect(framebuffer, viewport, scissor);
+               m_geometryDrawCalls = m_gpuCulling->GetStats().groups;
+            } else {
+               RenderGeometryPass(framebuffer, viewport, scissor);
+               m_geometryDrawCalls = static_cast<uint32_t>(m_renderWorld.GetVisibleMeshes().size());
+            }
+            m_geometryRecordMs +=
+               std::chrono::duration<float, std::milli>(Clock::now() - recordStart).count();
+            if (!subpasses) {
+               m_gpuTimer.End("GeometryPass");
+               return;
+            }
+            // Timestamps cannot be written in the secondary buffer subpass, so the geometry
+            // time includes the subpass transition
+            m_commandBuffers->NextSubpass(VK_SUBPASS_CONTENTS_INLINE, m_currentFrame);
+            m_gpuTimer.End("GeometryPass");
+            m_gpuTimer.Begin("LightingPass");
+            RenderLightingSubpass(viewport, scissor);
+            m_gpuTimer.End("LightingPass");
+         });
+      geometryPass.Write(albedo, Access::ColorAttachment)
+         .Write(normal, Access::ColorAttachment)
+         .Write(depth, Access::DepthAttachment);
+      if (m_depthPrepassFrame)
+         geometryPass.Read(depth, Access::DepthAttachment);
+      if (subpasses) {
+         geometryPass.Write(backbuffer, Access::ColorAttachment);
+         // OVERLAYS, in a render pass of their own as their pipelines target the lighting pass
+         graph
+            .AddPass("OverlayPass",
+                     [=, this] {
+                        const std::array views{GetGraphImageView(backbuffer),
+                                               GetGraphImageView(depth)};
+                        m_commandBuffers->BeginRenderPass(
+                           *m_overlayRenderPass, GetFramebuffer(*m_overlayRenderPass, views),
+                           m_swapchain.GetExtent(), {}, m_currentFrame);
+                        RenderOverlayPasses(imageIndex, viewport, scissor);
+                     })
+            .Read(backbuffer, Access::ColorAttachment)
+            .Write(backbuffer, Access::ColorAttachment)
+            .Read(depth, Access::DepthAttachment)
+            .Write(depth, Access::DepthAttachment);
+         graph.Compile();
+         return;
+      }
+   }
+   // LIGHTING PASS, depth tested by the overlays while the lighting shader samples it
+   graph
+      .AddPass("LightingPass",
+               [=, this] {
+                  const std::array views{GetGraphImageView(backbuffer), GetGraphImageView(depth)};
+                  m_gpuTimer.Begin("LightingPass");
+                  RenderLightingPass(GetFramebuffer(*m_lightingRenderPass, views), viewport,
+                                     scissor);
+                  m_gpuTimer.End("LightingPass");
+                  RenderOverlayPasses(imageIndex, viewport, scissor);
+               })
+      .Read(albedo, Access::Sampled)
+      .Read(normal, Access::Sampled)
+      .Read(depth, Access::DepthAttachmentSampled)
+      .Write(depth, Access::DepthAttachmentSampled)
+      .Write(backbuffer, Access::ColorAttachment);
+   graph.Compile();
+}
+
+void VulkanRenderer::RenderOverlayPasses(const uint32_t imageIndex, const VkViewport& viewport,
+                                         const VkRect2D& scissor) {
    // GIZMO PASS
    m_gpuTimer.Begin("GizmoPass");
    RenderGizmoPass(viewport, scissor);
@@ -683,68 +1451,71 @@ void VulkanRenderer::RecordCommandBuffer(const uint32_t imageIndex) {
    ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), m_commandBuffers->Get(m_currentFrame));
    m_commandBuffers->EndRenderPass(m_currentFrame);
    m_gpuTimer.End("ImGuiPass");
-   m_commandBuffers->End(m_currentFrame);
 }
 
-void VulkanRenderer::RenderGeometryPass(const VkViewport& viewport, const VkRect2D& scissor) {
-   const std::vector<VkClearValue> clearValues = {VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
-                                                  VkClearValue{.color = {{0.5f, 0.5f, 1.0f, 0.0f}}},
-                                                  VkClearValue{.depthStencil = {1.0f, 0}}};
-   if (!m_activeScene)
-      return;
-   static std::vector<const Node*> renderableNodes;
-   renderableNodes.clear();
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive())
-         return;
-      const auto* renderer = node->GetComponent<RendererComponent>();
-      if (renderer && renderer->IsVisible() && renderer->HasMesh()) {
-         renderableNodes.push_back(node);
-      }
-   });
-   m_commandBuffers->BeginRenderPass(*m_geometryRenderPass, m_geometryFramebuffers[m_currentFrame],
-                                     m_swapchain.GetExtent(), clearValues, m_currentFrame);
-   const size_t nodesPerThread =
-      (renderableNodes.size() + m_numGeometryThreads - 1) / m_numGeometryThreads;
-   const std::vector<const Node*>* nodesPtr = &renderableNodes;
+void VulkanRenderer::RenderGBufferDepthPrepass(const VkFramebuffer framebuffer,
+                                               const VkViewport& viewport,
+                                               const VkRect2D& scissor) {
+   const std::vector<VkClearValue> clearValues = {VkClearValue{.depthStencil = {1.0f, 0}}};
+   m_commandBuffers->BeginRenderPass(*m_depthOnlyRenderPass, framebuffer, m_swapchain.GetExtent(),
+                                     clearValues, m_currentFrame);
+   m_commandBuffers->BindPipeline(m_gBufferDepthPrepassGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->BindDescriptorSet(*m_geometryPipelineLayout, 0,
+                                       m_geometryDescriptorSets[m_currentFrame],
+                                       VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   DrawVisiblePositions(*m_geometryPipelineLayout);
+   m_commandBuffers->EndRenderPass(m_currentFrame);
+}
+
+void VulkanRenderer::RenderGeometryPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                                        const VkRect2D& scissor) {
+   // The G-buffer subpasses record into subpass 0 of the merged pass and leave it open
+   // After a depth prepass the depth is loaded and only equal fragments are shaded
+   const VulkanRenderPass& renderPass =
+      m_gBufferSubpassFrame
+         ? *m_gBufferSubpassRenderPass
+         : (m_depthPrepassFrame ? *m_geometryEqualRenderPass : *m_geometryRenderPass);
+   const VulkanGraphicsPipeline& pipeline =
+      m_gBufferSubpassFrame
+         ? *m_subpassGeometryGraphicsPipeline
+         : (m_depthPrepassFrame ? *m_geometryEqualGraphicsPipeline : *m_geometryGraphicsPipeline);
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   // Only frustum-visible proxies are split across the recording threads
+   const std::span<const uint32_t> visible = m_renderWorld.GetVisibleMeshes();
+   m_commandBuffers->BeginRenderPass(renderPass, framebuffer, m_swapchain.GetExtent(),
+                                     GetGeometryClearValues(m_gBufferSubpassFrame), m_currentFrame,
+                                     VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+   ThreadPool::TaskGroup recordGroup;
+   const size_t meshesPerThread =
+      (visible.size() + m_numGeometryThreads - 1) / m_numGeometryThreads;
    for (uint32_t threadIdx = 0; threadIdx < m_numGeometryThreads; ++threadIdx) {
-      const size_t startIdx = threadIdx * nodesPerThread;
-      const size_t endIdx = std::min(startIdx + nodesPerThread, renderableNodes.size());
-      if (startIdx >= renderableNodes.size())
+      const size_t startIdx = threadIdx * meshesPerThread;
+      const size_t endIdx = std::min(startIdx + meshesPerThread, visible.size());
+      if (startIdx >= visible.size())
          break;
-      m_geometryThreadPool->Submit(
-         [this, nodesPtr, threadIdx, startIdx, endIdx, viewport, scissor]() {
-            const auto& nodes = *nodesPtr;
+      m_threadPool.Submit(
+         recordGroup,
+         [this, &renderPass, &pipeline, framebuffer, meshes, visible, threadIdx, startIdx, endIdx,
+          viewport, scissor]() {
             auto& cmdBuf = m_secondaryCommandBuffers[threadIdx][m_currentFrame];
             cmdBuf->Reset(0);
-            cmdBuf->BeginSecondary(*m_geometryRenderPass, m_geometryFramebuffers[m_currentFrame], 0,
-                                   0);
-            cmdBuf->BindPipeline(m_geometryGraphicsPipeline->GetPipeline(),
-                                 VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
+            cmdBuf->BeginSecondary(renderPass, framebuffer, 0, 0,
+                                   m_overdrawQueryPool != VK_NULL_HANDLE);
+            cmdBuf->BindPipeline(pipeline.GetPipeline(), VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
             cmdBuf->BindDescriptorSet(*m_geometryPipelineLayout, 0,
                                       m_geometryDescriptorSets[m_currentFrame],
                                       VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
             cmdBuf->SetViewport(viewport, 0);
             cmdBuf->SetScissor(scissor, 0);
             for (size_t i = startIdx; i < endIdx; ++i) {
-               const Node* node = nodes[i];
-               const auto* renderer = node->GetComponent<RendererComponent>();
-               if (const Transform* worldTransform = node->GetWorldTransform()) {
-                  cmdBuf->PushConstantsTyped(*m_geometryPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
-                                             worldTransform->GetTransformMatrix(), 0);
-               }
-               if (IMaterial* material = m_resourceManager->GetMaterial(renderer->GetMaterial())) {
-                  VulkanMaterial* vkMaterial = reinterpret_cast<VulkanMaterial*>(material);
-                  if (vkMaterial->GetDescriptorSet() == VK_NULL_HANDLE) {
-                     vkMaterial->CreateDescriptorSet(m_materialDescriptorPool,
-                                                     m_materialDescriptorSetLayout);
-                  }
-                  vkMaterial->Bind(0, *m_resourceManager);
-                  cmdBuf->BindDescriptorSet(*m_geometryPipelineLayout, 1,
-                                            vkMaterial->GetDescriptorSet(),
-                                            VK_PIPELINE_BIND_POINT_GRAPHICS, 0);
-               }
-               if (const IMesh* mesh = m_resourceManager->GetMesh(renderer->GetMesh())) {
+               const MeshProxy& proxy = meshes[visible[i]];
+               cmdBuf->PushConstantsTyped(*m_geometryPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                                          proxy.worldMatrix, 0);
+               BindMaterial(*cmdBuf, 0, *m_geometryPipelineLayout, proxy.material);
+               if (const IMesh* mesh = m_resourceManager->GetMesh(proxy.mesh)) {
                   const VulkanMesh* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
                   vkMesh->Draw(cmdBuf->Get(0));
                }
@@ -752,96 +1523,163 @@ void VulkanRenderer::RenderGeometryPass(const VkViewport& viewport, const VkRect
             cmdBuf->End(0);
          });
    }
-   m_geometryThreadPool->WaitForAll();
+   m_threadPool.Wait(recordGroup);
    static std::vector<VkCommandBuffer> secondaryBuffers;
    secondaryBuffers.clear();
    secondaryBuffers.reserve(m_numGeometryThreads);
    for (uint32_t i = 0; i < m_numGeometryThreads; ++i) {
-      const size_t startIdx = i * nodesPerThread;
-      if (startIdx < renderableNodes.size()) {
+      const size_t startIdx = i * meshesPerThread;
+      if (startIdx < visible.size()) {
          secondaryBuffers.push_back(m_secondaryCommandBuffers[i][m_currentFrame]->Get(0));
       }
    }
+   BeginOverdrawQuery();
    if (!secondaryBuffers.empty()) {
       m_commandBuffers->ExecuteCommands(secondaryBuffers, m_currentFrame);
    }
-   m_commandBuffers->EndRenderPass(m_currentFrame);
+   EndOverdrawQuery();
+   if (!m_gBufferSubpassFrame)
+      m_commandBuffers->EndRenderPass(m_currentFrame);
 }
 
-void VulkanRenderer::TransitionGBufferLayouts() {
-   ITexture* albedoTex = m_resourceManager->GetTexture(m_gAlbedoTexture[m_currentFrame]);
-   ITexture* normalTex = m_resourceManager->GetTexture(m_gNormalTexture[m_currentFrame]);
-   ITexture* depthTex = m_resourceManager->GetTexture(m_gDepthTexture[m_currentFrame]);
+void VulkanRenderer::RenderGeometryPassIndirect(const VkFramebuffer framebuffer,
+                                                const VkViewport& viewport,
+                                                const VkRect2D& scissor) {
+   const VulkanRenderPass& renderPass =
+      m_gBufferSubpassFrame ? *m_gBufferSubpassRenderPass : *m_geometryRenderPass;
+   const VulkanGraphicsPipeline& pipeline = m_gBufferSubpassFrame
+                                               ? *m_subpassIndirectGeometryGraphicsPipeline
+                                               : *m_indirectGeometryGraphicsPipeline;
+   m_commandBuffers->BeginRenderPass(renderPass, framebuffer, m_swapchain.GetExtent(),
+                                     GetGeometryClearValues(m_gBufferSubpassFrame), m_currentFrame);
+   m_commandBuffers->BindPipeline(pipeline.GetPipeline(), VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                  m_currentFrame);
+   m_commandBuffers->BindDescriptorSet(*m_indirectGeometryPipelineLayout, 0,
+                                       m_geometryDescriptorSets[m_currentFrame],
+                                       VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   BeginOverdrawQuery();
+   m_gpuCulling->RecordDraws(m_commandBuffers->Get(m_currentFrame), m_currentFrame,
+                             *m_indirectGeometryPipelineLayout,
+                             [this](const MaterialHandle& material) {
+                                BindMaterial(*m_commandBuffers, m_currentFrame,
+                                             *m_indirectGeometryPipelineLayout, material);
+                             });
+   EndOverdrawQuery();
+   if (!m_gBufferSubpassFrame)
+      m_commandBuffers->EndRenderPass(m_currentFrame);
+}
 
-   if (!albedoTex || !normalTex || !depthTex)
+void VulkanRenderer::BindMaterial(VulkanCommandBuffers& commandBuffers, const uint32_t bufferIndex,
+                                  const VulkanPipelineLayout& layout,
+                                  const MaterialHandle& handle) {
+   IMaterial* material = m_resourceManager->GetMaterial(handle);
+   if (!material)
       return;
+   VulkanMaterial* vkMaterial = reinterpret_cast<VulkanMaterial*>(material);
+   if (vkMaterial->GetDescriptorSet() == VK_NULL_HANDLE) {
+      vkMaterial->CreateDescriptorSet(m_materialDescriptorPool, m_materialDescriptorSetLayout);
+   }
+   vkMaterial->Bind(0, *m_resourceManager);
+   commandBuffers.BindDescriptorSet(layout, 1, vkMaterial->GetDescriptorSet(),
+                                    VK_PIPELINE_BIND_POINT_GRAPHICS, bufferIndex);
+}
 
-   VulkanTexture* vkAlbedo = reinterpret_cast<VulkanTexture*>(albedoTex);
-   VulkanTexture* vkNormal = reinterpret_cast<VulkanTexture*>(normalTex);
-   VulkanTexture* vkDepth = reinterpret_cast<VulkanTexture*>(depthTex);
-
-   std::vector<VkImageMemoryBarrier> barriers;
-   barriers.reserve(3);
-
-   // Albedo transition
-   barriers.push_back(
-      VkImageMemoryBarrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                           .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                           .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                           .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                           .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                           .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .image = vkAlbedo->GetImage(),
-                           .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                                .baseMipLevel = 0,
-                                                .levelCount = 1,
-                                                .baseArrayLayer = 0,
-                                                .layerCount = 1}});
-
-   // Normal transition
-   barriers.push_back(
-      VkImageMemoryBarrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                           .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
-                           .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                           .oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-                           .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                           .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .image = vkNormal->GetImage(),
-                           .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-                                                .baseMipLevel = 0,
-                                                .levelCount = 1,
-                                                .baseArrayLayer = 0,
-                                                .layerCount = 1}});
-
-   // Depth transition
-   barriers.push_back(
-      VkImageMemoryBarrier{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                           .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-                           .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-                           .oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                           .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                           .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-                           .image = vkDepth->GetImage(),
-                           .subresourceRange = {.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-                                                .baseMipLevel = 0,
-                                                .levelCount = 1,
-                                                .baseArrayLayer = 0,
-                                                .layerCount = 1}});
-
-   m_commandBuffers->PipelineBarrier(
-      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-      VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, {}, {}, barriers, m_currentFrame);
-}
-
-void VulkanRenderer::RenderLightingPass(const uint32_t imageIndex, const VkViewport& viewport,
+void VulkanRenderer::RecordRenderGraphBarriers(
+   const std::span<const RenderGraph::Barrier> barriers) {
+   std::vector<VkImageMemoryBarrier> imageBarriers;
+   imageBarriers.reserve(barriers.size());
+   VkPipelineStageFlags srcStages = 0;
+   VkPipelineStageFlags dstStages = 0;
+   for (const RenderGraph::Barrier& barrier : barriers) {
+      VkImage image = VK_NULL_HANDLE;
+      VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+      if (barrier.texture == m_graphTextures.backbuffer) {
+         image = m_swapchain.GetImages()[m_imageIndex];
+      } else if (const ITexture* texture =
+                    m_resourceManager->GetTexture(m_renderGraph->GetTexture(barrier.texture))) {
+         image = reinterpret_cast<const VulkanTexture*>(texture)->GetImage();
+         if (texture->GetFormat() == ITexture::Format::Depth32F)
+            aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+      } else {
+         continue;
+      }
+      const GraphAccessInfo before = GetGraphAccessInfo(barrier.before);
+      const GraphAccessInfo after = GetGraphAccessInfo(barrier.after);
+      imageBarriers.push_back(VkImageMemoryBarrier{
+         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+         .srcAccessMask = before.access,
+         .dstAccessMask = after.access,
+         .oldLayout = barrier.discard ? VK_IMAGE_LAYOUT_UNDEFINED : before.layout,
+         .newLayout = after.layout,
+         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+         .image = image,
+         .subresourceRange = {.aspectMask = aspect,
+                              .baseMipLevel = 0,
+                              .levelCount = 1,
+                              .baseArrayLayer = 0,
+                              .layerCount = 1}});
+      srcStages |= before.stages;
+      dstStages |= after.stages;
+   }
+   if (imageBarriers.empty())
+      return;
+   m_commandBuffers->PipelineBarrier(srcStages, dstStages, 0, {}, {}, imageBarriers,
+                                     m_currentFrame);
+}
+
+VkImageView VulkanRenderer::GetGraphImageView(const RenderGraph::TextureId texture) const {
+   if (texture == m_graphTextures.backbuffer)
+      return m_swapchain.GetImageViews()[m_imageIndex];
+   const ITexture* vkTexture = m_resourceManager->GetTexture(m_renderGraph->GetTexture(texture));
+   return vkTexture ? reinterpret_cast<const VulkanTexture*>(vkTexture)->GetImageView()
+                    : VK_NULL_HANDLE;
+}
+
+VkFramebuffer VulkanRenderer::GetFramebuffer(const VulkanRenderPass& renderPass,
+                                             const std::span<const VkImageView> attachments) {
+   auto key = std::make_pair(renderPass.Get(),
+                             std::vector<VkImageView>(attachments.begin(), attachments.end()));
+   if (const auto it = m_framebuffers.find(key); it != m_framebuffers.end()) {
+      it->second.lastFrame = m_frameCount;
+      return it->second.framebuffer;
+   }
+   VkFramebufferCreateInfo framebufferInfo{};
+   framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+   framebufferInfo.renderPass = renderPass.Get();
+   framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+   framebufferInfo.pAttachments = attachments.data();
+   framebufferInfo.width = m_swapchain.GetExtent().width;
+   framebufferInfo.height = m_swapchain.GetExtent().height;
+   framebufferInfo.layers = 1;
+   VkFramebuffer framebuffer = VK_NULL_HANDLE;
+   if (vkCreateFramebuffer(m_device.Get(), &framebufferInfo, nullptr, &framebuffer) !=
+       VK_SUCCESS) {
+      throw std::runtime_error("Failed to create render graph framebuffer.");
+   }
+   m_framebuffers.emplace(std::move(key), CachedFramebuffer{framebuffer, m_frameCount});
+   return framebuffer;
+}
+
+void VulkanRenderer::PruneFramebuffers() {
+   // Frames still in flight may use a framebuffer until its views were skipped for that many
+   // frames, which is also when the graph destroys the textures behind them
+   std::erase_if(m_framebuffers, [this](const auto& entry) {
+      if (m_frameCount - entry.second.lastFrame <= MAX_FRAMES_IN_FLIGHT)
+         return false;
+      vkDestroyFramebuffer(m_device.Get(), entry.second.framebuffer, nullptr);
+      return true;
+   });
+}
+
+void VulkanRenderer::RenderLightingPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
                                         const VkRect2D& scissor) {
    const std::vector<VkClearValue> clearValues = {VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
                                                   VkClearValue{.depthStencil = {1.0f, 0}}};
-   m_commandBuffers->BeginRenderPass(*m_lightingRenderPass, m_lightingFramebuffers[imageIndex],
-                                     m_swapchain.GetExtent(), clearValues, m_currentFrame);
+   m_commandBuffers->BeginRenderPass(*m_lightingRenderPass, framebuffer, m_swapchain.GetExtent(),
+                                     clearValues, m_currentFrame);
    m_commandBuffers->BindPipeline(m_lightingGraphicsPipeline->GetPipeline(),
                                   VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
    m_commandBuffers->BindDescriptorSet(*m_lightingPipelineLayout, 0,
@@ -855,6 +1693,187 @@ void VulkanRenderer::RenderLightingPass(const uint32_t imageIndex, const VkViewp
    }
 }
 
+void VulkanRenderer::RenderLightingSubpass(const VkViewport& viewport, const VkRect2D& scissor) {
+   m_commandBuffers->BindPipeline(m_subpassLightingGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->BindDescriptorSets(
+      *m_subpassLightingPipelineLayout, 0,
+      {m_lightingDescriptorSets[m_currentFrame], m_gBufferSubpassDescriptorSets[m_currentFrame]},
+      VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   if (const IMesh* mesh = m_resourceManager->GetMesh(m_fullscreenQuad)) {
+      const VulkanMesh* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
+      vkMesh->Draw(m_commandBuffers->Get(m_currentFrame));
+   }
+   m_commandBuffers->EndRenderPass(m_currentFrame);
+}
+
+void VulkanRenderer::RenderDepthPrepass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                                        const VkRect2D& scissor) {
+   const std::vector<VkClearValue> clearValues = {VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
+                                                  VkClearValue{.depthStencil = {1.0f, 0}}};
+   m_commandBuffers->BeginRenderPass(*m_forwardRenderPass, framebuffer, m_swapchain.GetExtent(),
+                                     clearValues, m_currentFrame);
+   m_commandBuffers->BindPipeline(m_depthPrepassGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->BindDescriptorSet(*m_forwardPipelineLayout, 0,
+                                       m_lightingDescriptorSets[m_currentFrame],
+                                       VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   DrawVisiblePositions(*m_forwardPipelineLayout);
+}
+
+void VulkanRenderer::RenderForwardPass(const VkViewport& viewport, const VkRect2D& scissor) {
+   // Same layout as the prepass, so the lighting set stays bound
+   m_commandBuffers->BindPipeline(m_forwardGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   uint64_t boundMaterial = 0;
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   BeginOverdrawQuery();
+   for (const uint32_t index : m_renderWorld.GetVisibleMeshes()) {
+      const MeshProxy& proxy = meshes[index];
+      m_commandBuffers->PushConstantsTyped(*m_forwardPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+                                           proxy.worldMatrix, m_currentFrame);
+      // Runs of the same material only bind it once
+      if (proxy.material.GetId() != boundMaterial) {
+         BindMaterial(*m_commandBuffers, m_currentFrame, *m_forwardPipelineLayout, proxy.material);
+         boundMaterial = proxy.material.GetId();
+      }
+      if (const IMesh* mesh = m_resourceManager->GetMesh(proxy.mesh)) {
+         const VulkanMesh* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
+         vkMesh->Draw(m_commandBuffers->Get(m_currentFrame));
+      }
+   }
+   EndOverdrawQuery();
+}
+
+void VulkanRenderer::RenderOverdrawPass(const VkFramebuffer framebuffer,
+                                        const VkViewport& viewport, const VkRect2D& scissor) {
+   const bool prepass = m_framePipeline == RenderPipeline::ForwardPlus || m_depthPrepassFrame;
+   if (prepass) {
+      m_gpuTimer.Begin("DepthPrepass");
+      RenderDepthPrepass(framebuffer, viewport, scissor);
+      m_gpuTimer.End("DepthPrepass");
+   } else {
+      const std::vector<VkClearValue> clearValues = {
+         VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
+         VkClearValue{.depthStencil = {1.0f, 0}}};
+      m_commandBuffers->BeginRenderPass(*m_forwardRenderPass, framebuffer,
+                                        m_swapchain.GetExtent(), clearValues, m_currentFrame);
+      m_commandBuffers->BindDescriptorSet(*m_forwardPipelineLayout, 0,
+                                          m_lightingDescriptorSets[m_currentFrame],
+                                          VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   }
+   m_gpuTimer.Begin("OverdrawPass");
+   m_commandBuffers->BindPipeline(prepass ? m_overdrawEqualGraphicsPipeline->GetPipeline()
+                                          : m_overdrawGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   BeginOverdrawQuery();
+   DrawVisiblePositions(*m_forwardPipelineLayout);
+   EndOverdrawQuery();
+   m_gpuTimer.End("OverdrawPass");
+}
+
+void VulkanRenderer::DrawVisiblePositions(const VulkanPipelineLayout& layout) {
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   for (const uint32_t index : m_renderWorld.GetVisibleMeshes()) {
+      const MeshProxy& proxy = meshes[index];
+      m_commandBuffers->PushConstantsTyped(layout, VK_SHADER_STAGE_VERTEX_BIT, proxy.worldMatrix,
+                                           m_currentFrame);
+      if (const IMesh* mesh = m_resourceManager->GetMesh(proxy.mesh)) {
+         const VulkanMesh* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
+         vkMesh->DrawPositions(m_commandBuffers->Get(m_currentFrame));
+      }
+   }
+}
+
+void VulkanRenderer::RenderVisibilityPass(const VkFramebuffer framebuffer,
+                                          const VkViewport& viewport, const VkRect2D& scissor) {
+   const std::vector<VkClearValue> clearValues = {VkClearValue{.color = {.uint32 = {0, 0, 0, 0}}},
+                                                  VkClearValue{.depthStencil = {1.0f, 0}}};
+   m_commandBuffers->BeginRenderPass(*m_visibilityRenderPass, framebuffer, m_swapchain.GetExtent(),
+                                     clearValues, m_currentFrame);
+   m_commandBuffers->BindPipeline(m_visibilityGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->BindDescriptorSet(*m_visibilityPipelineLayout, 0,
+                                       m_visibilityDescriptorSets[m_currentFrame],
+                                       VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   if (!m_visibilityDraws.empty()) {
+      // Every draw reads the shared pool, so only a change of index type rebinds a buffer
+      m_commandBuffers->BindVertexBuffers(0, {m_geometryPool->GetVertexBuffer()}, {0},
+                                          m_currentFrame);
+      VkIndexType boundIndexType = VK_INDEX_TYPE_MAX_ENUM;
+      const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+      for (const VisibilityDraw& draw : m_visibilityDraws) {
+         const VisibilityPushConstantData pc{.model = meshes[draw.proxy].worldMatrix,
+                                             .firstTriangle = draw.firstTriangle};
+         m_commandBuffers->PushConstantsTyped(
+            *m_visibilityPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            pc, m_currentFrame);
+         if (draw.range->indexType != boundIndexType) {
+            boundIndexType = draw.range->indexType;
+            m_commandBuffers->BindIndexBuffer(m_geometryPool->GetIndexBuffer(boundIndexType), 0,
+                                              boundIndexType, m_currentFrame);
+         }
+         m_commandBuffers->DrawIndexed(draw.range->indexCount, 1, draw.range->firstIndex,
+                                       draw.range->vertexOffset, 0, m_currentFrame);
+      }
+   }
+   m_commandBuffers->EndRenderPass(m_currentFrame);
+}
+
+void VulkanRenderer::RenderMaterialResolve(const VkFramebuffer framebuffer,
+                                           const VkViewport& viewport, const VkRect2D& scissor) {
+   // Same clear as the geometry pass, so the lighting pass sees identical empty pixels
+   const std::vector<VkClearValue> clearValues = {VkClearValue{.color = {{0.0f, 0.0f, 0.0f, 1.0f}}},
+                                                  VkClearValue{.color = {{0.5f, 0.5f, 1.0f, 0.0f}}},
+                                                  VkClearValue{.depthStencil = {1.0f, 0}}};
+   m_commandBuffers->BeginRenderPass(*m_materialResolveRenderPass, framebuffer,
+                                     m_swapchain.GetExtent(), clearValues, m_currentFrame);
+   if (m_visibilityDraws.empty()) {
+      m_commandBuffers->EndRenderPass(m_currentFrame);
+      return;
+   }
+   const VkCommandBuffer cmd = m_commandBuffers->Get(m_currentFrame);
+   constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+   MaterialResolvePushConstantData pc{
+      .viewportSize = glm::vec2(viewport.width, viewport.height),
+      .drawCount = static_cast<uint32_t>(m_visibilityDraws.size()),
+      .materialSlot = 0};
+   m_commandBuffers->BindPipeline(m_materialDepthGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->BindDescriptorSet(*m_materialResolvePipelineLayout, 0,
+                                       m_visibilityDescriptorSets[m_currentFrame],
+                                       VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   m_commandBuffers->SetViewport(viewport, m_currentFrame);
+   m_commandBuffers->SetScissor(scissor, m_currentFrame);
+   m_commandBuffers->PushConstantsTyped(*m_materialResolvePipelineLayout, stages, pc,
+                                        m_currentFrame);
+   vkCmdDraw(cmd, 3, 1, 0, 0);
+   // Shading cost follows the covered pixels, not the triangles drawn in the visibility pass
+   m_commandBuffers->BindPipeline(m_materialResolveGraphicsPipeline->GetPipeline(),
+                                  VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
+   for (uint32_t slot = 0; slot < m_visibilityMaterials.size(); ++slot) {
+      if (!m_resourceManager->GetMaterial(m_visibilityMaterials[slot]))
+         continue;
+      BindMaterial(*m_commandBuffers, m_currentFrame, *m_materialResolvePipelineLayout,
+                   m_visibilityMaterials[slot]);
+      pc.materialSlot = slot;
+      m_commandBuffers->PushConstantsTyped(*m_materialResolvePipelineLayout, stages, pc,
+                                           m_currentFrame);
+      vkCmdDraw(cmd, 3, 1, 0, 0);
+   }
+   m_commandBuffers->EndRenderPass(m_currentFrame);
+}
+
 void VulkanRenderer::RenderGizmoPass(const VkViewport& viewport, const VkRect2D& scissor) {
    m_commandBuffers->BindPipeline(m_gizmoGraphicsPipeline->GetPipeline(),
                                   VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
@@ -863,17 +1882,8 @@ void VulkanRenderer::RenderGizmoPass(const VkViewport& viewport, const VkRect2D&
                                        VK_PIPELINE_BIND_POINT_GRAPHICS, m_currentFrame);
    m_commandBuffers->SetViewport(viewport, m_currentFrame);
    m_commandBuffers->SetScissor(scissor, m_currentFrame);
-   if (!m_activeScene) {
-      return;
-   }
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive())
-         return;
-      const auto* lightComp = node->GetComponent<LightComponent>();
-      if (!lightComp)
-         return;
-      const GizmoPushConstantData pc{.model = node->GetWorldTransform()->GetTransformMatrix(),
-                                     .color = lightComp->GetColor()};
+   for (const LightProxy& light : m_renderWorld.GetLightProxies()) {
+      const GizmoPushConstantData pc{.model = light.worldMatrix, .color = light.color};
       m_commandBuffers->PushConstantsTyped(
          *m_gizmoPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, pc,
          m_currentFrame);
@@ -881,30 +1891,31 @@ void VulkanRenderer::RenderGizmoPass(const VkViewport& viewport, const VkRect2D&
          const VulkanMesh* vkMesh = reinterpret_cast<const VulkanMesh*>(mesh);
          vkMesh->Draw(m_commandBuffers->Get(m_currentFrame));
       }
-   });
+   }
 }
 
 void VulkanRenderer::RenderParticlePass(const uint32_t imageIndex, const VkViewport& viewport,
                                         const VkRect2D& scissor) {
-   uint32_t totalParticles = 0;
-   auto* dst =
-      static_cast<ParticleInstanceData*>(m_particleInstanceBuffers[m_currentFrame]->GetMappedPtr());
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive())
-         return;
-      const auto* ps = node->GetComponent<ParticleSystemComponent>();
-      if (!ps)
-         return;
-      const uint32_t count = ps->GetActiveParticleCount();
-      if (count == 0)
-         return;
-
-      const auto& src = ps->GetInstanceData();
-      memcpy(dst + totalParticles, src.data(), count * sizeof(ParticleInstanceData));
-      totalParticles += count;
-   });
+   // Ranges past the instance buffer's capacity are dropped
+   const uint32_t totalParticles = static_cast<uint32_t>(
+      std::min<size_t>(m_renderWorld.GetParticleInstanceCount(), m_particleInstanceCapacity));
    if (totalParticles == 0)
       return;
+   auto* dst =
+      static_cast<ParticleInstanceData*>(m_particleInstanceBuffers[m_currentFrame]->GetMappedPtr());
+   // Sorted particles are already packed, back to front across all systems
+   const std::span<const ParticleInstanceData> sorted = m_particleSorter.GetSortedInstances();
+   if (!sorted.empty()) {
+      memcpy(dst, sorted.data(), totalParticles * sizeof(ParticleInstanceData));
+   } else {
+      for (const ParticleProxy& range : m_renderWorld.GetParticleProxies()) {
+         if (range.firstInstance >= totalParticles)
+            break;
+         const uint32_t count =
+            std::min(range.instanceCount, totalParticles - range.firstInstance);
+         memcpy(dst + range.firstInstance, range.instances, count * sizeof(ParticleInstanceData));
+      }
+   }
    m_particleInstanceBuffers[m_currentFrame]->FlushRange(
       0, totalParticles * sizeof(ParticleInstanceData));
    m_commandBuffers->BindPipeline(m_particleGraphicsPipeline->GetPipeline(),
@@ -966,14 +1977,60 @@ void VulkanRenderer::CreateSynchronizationObjects() {
    }
 }
 
+void VulkanRenderer::CreateOverdrawQueryPool() {
+   if (!m_device.SupportsPreciseOcclusionQueries())
+      return;
+   VkQueryPoolCreateInfo poolInfo{};
+   poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+   poolInfo.queryType = VK_QUERY_TYPE_OCCLUSION;
+   poolInfo.queryCount = MAX_FRAMES_IN_FLIGHT;
+   if (vkCreateQueryPool(m_device.Get(), &poolInfo, nullptr, &m_overdrawQueryPool) !=
+       VK_SUCCESS) {
+      throw std::runtime_error("Failed to create occlusion query pool.");
+   }
+}
+
+void VulkanRenderer::BeginOverdrawQuery() {
+   if (m_overdrawQueryPool == VK_NULL_HANDLE)
+      return;
+   vkCmdBeginQuery(m_commandBuffers->Get(m_currentFrame), m_overdrawQueryPool, m_currentFrame,
+                   VK_QUERY_CONTROL_PRECISE_BIT);
+}
+
+void VulkanRenderer::EndOverdrawQuery() {
+   if (m_overdrawQueryPool == VK_NULL_HANDLE)
+      return;
+   vkCmdEndQuery(m_commandBuffers->Get(m_currentFrame), m_overdrawQueryPool, m_currentFrame);
+   const VkExtent2D extent = m_swapchain.GetExtent();
+   m_overdrawQueryPixels[m_currentFrame] =
+      static_cast<uint64_t>(extent.width) * static_cast<uint64_t>(extent.height);
+}
+
+void VulkanRenderer::ReadOverdrawQuery() {
+   // The frame's fence has signalled, so a query it issued has its result
+   uint64_t& pixels = m_overdrawQueryPixels[m_currentFrame];
+   if (m_overdrawQueryPool == VK_NULL_HANDLE || pixels == 0)
+      return;
+   uint64_t samples = 0;
+   if (vkGetQueryPoolResults(m_device.Get(), m_overdrawQueryPool, m_currentFrame, 1,
+                             sizeof(samples), &samples, sizeof(samples),
+                             VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+      m_shadingOverdraw = static_cast<float>(samples) / static_cast<float>(pixels);
+   }
+   pixels = 0;
+}
+
 void VulkanRenderer::RecreateSwapchain() {
    vkDeviceWaitIdle(m_device.Get());
    CleanupSwapchain();
+   // Pooled targets are recreated at the new extent when the next frame declares them
+   m_renderGraph->ReleaseTransients();
    m_swapchain.Recreate();
    CreateGeometryPass();
-   CreateGeometryFBO();
    CreateLightingPass();
-   CreateLightingFBO();
+   CreateGBufferSubpassPasses();
+   CreateForwardPass();
+   CreateVisibilityPasses();
    UpdateDescriptorSets();
    m_secondaryCommandBuffers.resize(m_numGeometryThreads);
    for (uint32_t i = 0; i < m_numGeometryThreads; ++i) {
@@ -989,13 +2046,11 @@ void VulkanRenderer::RecreateSwapchain() {
 }
 
 void VulkanRenderer::CleanupSwapchain() {
-   for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-      vkDestroyFramebuffer(m_device.Get(), m_geometryFramebuffers[i], nullptr);
+   // Render passes are recreated with the swapchain, a new one may reuse an old handle
+   for (const auto& [key, cached] : m_framebuffers) {
+      vkDestroyFramebuffer(m_device.Get(), cached.framebuffer, nullptr);
    }
-   for (VkFramebuffer framebuffer : m_lightingFramebuffers) {
-      vkDestroyFramebuffer(m_device.Get(), framebuffer, nullptr);
-   }
-   m_lightingFramebuffers.clear();
+   m_framebuffers.clear();
 }
 
 void VulkanRenderer::CreateUBOs() {
@@ -1007,14 +2062,15 @@ void VulkanRenderer::CreateUBOs() {
                                         VulkanBuffer::MemoryType::CPUToGPU);
       m_cameraUniformBuffers[i]->Map();
    }
-   // Light buffers
-   const VkDeviceSize lightBufferSize = sizeof(LightsData);
+   // Clustered light buffers, the light and index lists grow with the scene
    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-      m_lightsUniformBuffers[i] =
-         std::make_unique<VulkanBuffer>(m_device, lightBufferSize, VulkanBuffer::Usage::Uniform,
-                                        VulkanBuffer::MemoryType::CPUToGPU);
-      m_lightsUniformBuffers[i]->Map();
+      EnsureStorageCapacity(m_device, m_lightBuffers[i], 64 * sizeof(GPULight));
+      EnsureStorageCapacity(m_device, m_clusterBuffers[i], CLUSTER_BUFFER_SIZE);
+      EnsureStorageCapacity(m_device, m_lightIndexBuffers[i], 4096 * sizeof(uint32_t));
    }
+   // Visibility buffer draw tables, grown with the visible mesh count
+   for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+      EnsureStorageCapacity(m_device, m_visibilityDrawBuffers[i], 256 * sizeof(VisibilityDrawData));
 }
 
 void VulkanRenderer::UpdateCameraUBO(const uint32_t currentImage) {
@@ -1026,39 +2082,183 @@ void VulkanRenderer::UpdateCameraUBO(const uint32_t currentImage) {
    m_cameraUniformBuffers[currentImage]->Update(&camData, sizeof(CameraData));
 }
 
-void VulkanRenderer::UpdateLightsUBO(const uint32_t currentImage) {
-   if (!m_activeScene)
-      return;
-   LightsData lightsData{};
-   lightsData.lightCount = 0;
-   m_activeScene->ForEachNode([&](const Node* node) {
-      if (!node->IsActive() || lightsData.lightCount >= MAX_LIGHTS) [[unlikely]]
-         return;
-      const auto* lightComp = node->GetComponent<LightComponent>();
-      if (lightComp) [[likely]] {
-         auto& light = lightsData.lights[lightsData.lightCount];
-         light.lightType = static_cast<uint32_t>(lightComp->GetType());
-         light.color = lightComp->GetColor();
-         light.intensity = lightComp->GetIntensity();
-         light.constant = lightComp->GetConstant();
-         light.linear = lightComp->GetLinear();
-         light.quadratic = lightComp->GetQuadratic();
-         const auto* transform = node->GetWorldTransform();
-         light.position = transform->GetPosition();
-         light.direction = transform->GetForward();
-         light.innerCone = lightComp->GetInnerCone();
-         light.outerCone = lightComp->GetOuterCone();
-         ++lightsData.lightCount;
-      }
-   });
-   m_lightsUniformBuffers[currentImage]->Update(&lightsData, sizeof(LightsData));
+void VulkanRenderer::UpdateLightBuffers(const uint32_t currentImage) {
+   const std::span<const GPULight> lights = m_lightClusterer.GetLights();
+   const GridHeader& header = m_lightClusterer.GetHeader();
+   const std::span<const glm::uvec2> clusters = m_lightClusterer.GetClusters();
+   const std::span<const uint32_t> lightIndices = m_lightClusterer.GetLightIndices();
+   // The frame's previous submission has finished, so its set can be re-pointed
+   bool replaced = EnsureStorageCapacity(m_device, m_lightBuffers[currentImage],
+                                         std::max<size_t>(lights.size_bytes(), 1));
+   replaced |= EnsureStorageCapacity(m_device, m_lightIndexBuffers[currentImage],
+                                     std::max<size_t>(lightIndices.size_bytes(), 1));
+   if (replaced)
+      WriteLightBufferDescriptors(currentImage);
+   if (!lights.empty())
+      m_lightBuffers[currentImage]->UpdateArray(lights.data(), lights.size());
+   m_clusterBuffers[currentImage]->UpdateTyped(header);
+   m_clusterBuffers[currentImage]->UpdateArray(clusters.data(), clusters.size(), sizeof(header));
+   if (!lightIndices.empty())
+      m_lightIndexBuffers[currentImage]->UpdateArray(lightIndices.data(), lightIndices.size());
+   m_lightBuffers[currentImage]->FlushRange(0, VK_WHOLE_SIZE);
+   m_clusterBuffers[currentImage]->FlushRange(0, VK_WHOLE_SIZE);
+   m_lightIndexBuffers[currentImage]->FlushRange(0, VK_WHOLE_SIZE);
+}
+
+void VulkanRenderer::WriteLightBufferDescriptors(const uint32_t currentImage) {
+   const std::array<VkDescriptorBufferInfo, 3> bufferInfos = {
+      VkDescriptorBufferInfo{m_lightBuffers[currentImage]->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{m_clusterBuffers[currentImage]->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{m_lightIndexBuffers[currentImage]->Get(), 0, VK_WHOLE_SIZE}};
+   constexpr std::array<uint32_t, 3> bindings = {1, 6, 7};
+   std::array<VkWriteDescriptorSet, 3> writes{};
+   for (uint32_t i = 0; i < writes.size(); ++i) {
+      writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      writes[i].dstSet = m_lightingDescriptorSets[currentImage];
+      writes[i].dstBinding = bindings[i];
+      writes[i].dstArrayElement = 0;
+      writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      writes[i].descriptorCount = 1;
+      writes[i].pBufferInfo = &bufferInfos[i];
+   }
+   vkUpdateDescriptorSets(m_device.Get(), static_cast<uint32_t>(writes.size()), writes.data(), 0,
+                          nullptr);
+}
+
+void VulkanRenderer::PrepareVisibilityFrame(const uint32_t currentImage) {
+   m_geometryPool->Update(m_renderWorld, *m_resourceManager);
+   const std::span<const MeshProxy> meshes = m_renderWorld.GetMeshProxies();
+   const std::span<const uint32_t> visible = m_renderWorld.GetVisibleMeshes();
+   const bool replaced = EnsureStorageCapacity(
+      m_device, m_visibilityDrawBuffers[currentImage],
+      std::max<size_t>(visible.size(), 1) * sizeof(VisibilityDrawData));
+   if (replaced || m_visibilityPoolVersions[currentImage] != m_geometryPool->GetVersion())
+      WriteVisibilityDescriptors(currentImage);
+   m_visibilityDraws.clear();
+   m_visibilityMaterials.clear();
+   m_visibilityMaterialSlots.clear();
+   auto* table =
+      static_cast<VisibilityDrawData*>(m_visibilityDrawBuffers[currentImage]->GetMappedPtr());
+   // Triangle ids are frame wide and ascend with the table, 0 is left for empty pixels
+   uint32_t firstTriangle = 1;
+   for (const uint32_t index : visible) {
+      const MeshProxy& proxy = meshes[index];
+      const VulkanGeometryPool::MeshRange* range = m_geometryPool->Find(proxy.mesh);
+      if (!range)
+         continue;
+      const auto [slot, inserted] = m_visibilityMaterialSlots.try_emplace(
+         proxy.material.GetId(), static_cast<uint32_t>(m_visibilityMaterials.size()));
+      if (inserted)
+         m_visibilityMaterials.push_back(proxy.material);
+      table[m_visibilityDraws.size()] = VisibilityDrawData{
+         .model = proxy.worldMatrix,
+         .firstTriangle = firstTriangle,
+         .firstIndex = range->firstIndex,
+         .vertexOffset = range->vertexOffset,
+         .indices16 = range->indexType == VK_INDEX_TYPE_UINT16 ? 1u : 0u,
+         .materialSlot = slot->second};
+      m_visibilityDraws.push_back(
+         VisibilityDraw{.range = range, .proxy = index, .firstTriangle = firstTriangle});
+      firstTriangle += range->indexCount / 3;
+   }
+   m_visibilityDrawBuffers[currentImage]->FlushRange(
+      0, std::max<size_t>(m_visibilityDraws.size(), 1) * sizeof(VisibilityDrawData));
+}
+
+void VulkanRenderer::WriteVisibilityDescriptors(const uint32_t currentImage) {
+   // The triangle id image at binding 1 is written with the render graph's textures
+   const VkDescriptorBufferInfo cameraInfo{m_cameraUniformBuffers[currentImage]->Get(), 0,
+                                           sizeof(CameraData)};
+   const std::array<VkDescriptorBufferInfo, 4> storageInfos = {
+      VkDescriptorBufferInfo{m_visibilityDrawBuffers[currentImage]->Get(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{m_geometryPool->GetVertexBuffer(), 0, VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{m_geometryPool->GetIndexBuffer(VK_INDEX_TYPE_UINT16), 0,
+                             VK_WHOLE_SIZE},
+      VkDescriptorBufferInfo{m_geometryPool->GetIndexBuffer(VK_INDEX_TYPE_UINT32), 0,
+                             VK_WHOLE_SIZE}};
+   std::array<VkWriteDescriptorSet, 5> writes{};
+   for (uint32_t i = 0; i < writes.size(); ++i) {
+      writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      writes[i].dstSet = m_visibilityDescriptorSets[currentImage];
+      writes[i].dstBinding = i == 0 ? 0 : i + 1;
+      writes[i].dstArrayElement = 0;
+      writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      writes[i].descriptorCount = 1;
+      if (i >= 1)
+         writes[i].pBufferInfo = &storageInfos[i - 1];
+   }
+   writes[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+   writes[0].pBufferInfo = &cameraInfo;
+   // The pool has no buffers before the first visibility frame builds it
+   const uint32_t writeCount = m_geometryPool->GetVertexBuffer() != VK_NULL_HANDLE ? 5 : 2;
+   vkUpdateDescriptorSets(m_device.Get(), writeCount, writes.data(), 0, nullptr);
+   m_visibilityPoolVersions[currentImage] = m_geometryPool->GetVersion();
+}
+
+void VulkanRenderer::WriteRenderGraphDescriptors(const uint32_t currentImage) {
+   struct GraphBinding final {
+      VkDescriptorSet set;
+      uint32_t binding;
+      RenderGraph::TextureId texture;
+      VkImageLayout layout;
+      VkDescriptorType type{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER};
+   };
+   // The lighting pass samples the depth it is also testing against, hence the general layout.
+   // The input attachments use the layouts of the lighting subpass' attachment references.
+   constexpr VkDescriptorType input = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+   const VkDescriptorSet inputSet = m_gBufferSubpassDescriptorSets[currentImage];
+   const std::array<GraphBinding, GRAPH_DESCRIPTOR_COUNT> bindings = {
+      GraphBinding{m_lightingDescriptorSets[currentImage], 3, m_graphTextures.albedo,
+                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+      GraphBinding{m_lightingDescriptorSets[currentImage], 4, m_graphTextures.normal,
+                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+      GraphBinding{m_lightingDescriptorSets[currentImage], 5, m_graphTextures.depth,
+                   VK_IMAGE_LAYOUT_GENERAL},
+      GraphBinding{m_visibilityDescriptorSets[currentImage], 1, m_graphTextures.ids,
+                   VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},
+      GraphBinding{inputSet, 0, m_graphTextures.albedo, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                   input},
+      GraphBinding{inputSet, 1, m_graphTextures.normal, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                   input},
+      GraphBinding{inputSet, 2, m_graphTextures.depth,
+                   VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, input}};
+   std::array<VkDescriptorImageInfo, GRAPH_DESCRIPTOR_COUNT> imageInfos{};
+   std::vector<VkWriteDescriptorSet> writes;
+   for (uint32_t i = 0; i < bindings.size(); ++i) {
+      // Textures this frame does not declare keep whatever the set pointed at before
+      const TextureHandle handle = m_renderGraph->GetTexture(bindings[i].texture);
+      const ITexture* texture = m_resourceManager->GetTexture(handle);
+      uint64_t& written = m_graphDescriptorTextures[currentImage][i];
+      if (!texture || written == handle.GetId())
+         continue;
+      written = handle.GetId();
+      const auto* vkTexture = reinterpret_cast<const VulkanTexture*>(texture);
+      const VkSampler sampler = bindings[i].type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT
+                                   ? VK_NULL_HANDLE
+                                   : vkTexture->GetSampler();
+      imageInfos[i] = {sampler, vkTexture->GetImageView(), bindings[i].layout};
+      VkWriteDescriptorSet write{};
+      write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      write.dstSet = bindings[i].set;
+      write.dstBinding = bindings[i].binding;
+      write.dstArrayElement = 0;
+      write.descriptorType = bindings[i].type;
+      write.descriptorCount = 1;
+      write.pImageInfo = &imageInfos[i];
+      writes.push_back(write);
+   }
+   if (!writes.empty()) {
+      vkUpdateDescriptorSets(m_device.Get(), static_cast<uint32_t>(writes.size()), writes.data(),
+                             0, nullptr);
+   }
 }
 
 void VulkanRenderer::CreateDescriptorPool() {
-   std::array<VkDescriptorPoolSize, 3> poolSizes = {
+   std::array<VkDescriptorPoolSize, 4> poolSizes = {
       VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 100},
       VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 100},
       VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 100},
+      VkDescriptorPoolSize{VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 100},
    };
    VkDescriptorPoolCreateInfo poolInfo{};
    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1121,6 +2321,30 @@ void VulkanRenderer::CreateDescriptorSets() {
                                 m_particleDescriptorSets.data()) != VK_SUCCESS) {
       throw std::runtime_error("Failed to allocate particle descriptor sets.");
    }
+   // Allocate visibility buffer descriptor sets
+   std::vector<VkDescriptorSetLayout> visibilityLayouts(MAX_FRAMES_IN_FLIGHT,
+                                                        m_visibilityDescriptorSetLayout);
+   VkDescriptorSetAllocateInfo visibilityAllocInfo{};
+   visibilityAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+   visibilityAllocInfo.descriptorPool = m_descriptorPool;
+   visibilityAllocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+   visibilityAllocInfo.pSetLayouts = visibilityLayouts.data();
+   if (vkAllocateDescriptorSets(m_device.Get(), &visibilityAllocInfo,
+                                m_visibilityDescriptorSets.data()) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to allocate visibility descriptor sets.");
+   }
+   // Allocate G-buffer subpass descriptor sets, written with the graph's textures
+   std::vector<VkDescriptorSetLayout> gBufferSubpassLayouts(MAX_FRAMES_IN_FLIGHT,
+                                                            m_gBufferSubpassDescriptorSetLayout);
+   VkDescriptorSetAllocateInfo gBufferSubpassAllocInfo{};
+   gBufferSubpassAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+   gBufferSubpassAllocInfo.descriptorPool = m_descriptorPool;
+   gBufferSubpassAllocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+   gBufferSubpassAllocInfo.pSetLayouts = gBufferSubpassLayouts.data();
+   if (vkAllocateDescriptorSets(m_device.Get(), &gBufferSubpassAllocInfo,
+                                m_gBufferSubpassDescriptorSets.data()) != VK_SUCCESS) {
+      throw std::runtime_error("Failed to allocate G-buffer subpass descriptor sets.");
+   }
    // Update geometry descriptor sets
    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
       VkDescriptorBufferInfo cameraBufferInfo{};
@@ -1189,79 +2413,22 @@ void VulkanRenderer::UpdateDescriptorSets() {
       cameraWrite.descriptorCount = 1;
       cameraWrite.pBufferInfo = &cameraBufferInfo;
       descriptorWrites.push_back(cameraWrite);
-      // Lighting UBO
-      VkDescriptorBufferInfo lightBufferInfo{};
-      lightBufferInfo.buffer = m_lightsUniformBuffers[i]->Get();
-      lightBufferInfo.offset = 0;
-      lightBufferInfo.range = sizeof(LightsData);
-      VkWriteDescriptorSet lightWrite{};
-      lightWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-      lightWrite.dstSet = m_lightingDescriptorSets[i];
-      lightWrite.dstBinding = 1;
-      lightWrite.dstArrayElement = 0;
-      lightWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-      lightWrite.descriptorCount = 1;
-      lightWrite.pBufferInfo = &lightBufferInfo;
-      descriptorWrites.push_back(lightWrite);
-      // G-Buffer textures
-      ITexture* albedoTex = m_resourceManager->GetTexture(m_gAlbedoTexture[i]);
-      ITexture* normalTex = m_resourceManager->GetTexture(m_gNormalTexture[i]);
-      ITexture* depthTex = m_resourceManager->GetTexture(m_gDepthTexture[i]);
-      if (albedoTex && normalTex && depthTex) {
-         VulkanTexture* vkAlbedo = reinterpret_cast<VulkanTexture*>(albedoTex);
-         VulkanTexture* vkNormal = reinterpret_cast<VulkanTexture*>(normalTex);
-         VulkanTexture* vkDepth = reinterpret_cast<VulkanTexture*>(depthTex);
-         // Albedo texture
-         VkDescriptorImageInfo albedoImageInfo{};
-         albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-         albedoImageInfo.imageView = vkAlbedo->GetImageView();
-         albedoImageInfo.sampler = vkAlbedo->GetSampler();
-         VkWriteDescriptorSet albedoWrite{};
-         albedoWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-         albedoWrite.dstSet = m_lightingDescriptorSets[i];
-         albedoWrite.dstBinding = 3;
-         albedoWrite.dstArrayElement = 0;
-         albedoWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-         albedoWrite.descriptorCount = 1;
-         albedoWrite.pImageInfo = &albedoImageInfo;
-         descriptorWrites.push_back(albedoWrite);
-         // Normal texture
-         VkDescriptorImageInfo normalImageInfo{};
-         normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-         normalImageInfo.imageView = vkNormal->GetImageView();
-         normalImageInfo.sampler = vkNormal->GetSampler();
-         VkWriteDescriptorSet normalWrite{};
-         normalWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-         normalWrite.dstSet = m_lightingDescriptorSets[i];
-         normalWrite.dstBinding = 4;
-         normalWrite.dstArrayElement = 0;
-         normalWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-         normalWrite.descriptorCount = 1;
-         normalWrite.pImageInfo = &normalImageInfo;
-         descriptorWrites.push_back(normalWrite);
-         // Depth texture
-         VkDescriptorImageInfo depthImageInfo{};
-         depthImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-         depthImageInfo.imageView = vkDepth->GetImageView();
-         depthImageInfo.sampler = vkDepth->GetSampler();
-         VkWriteDescriptorSet depthWrite{};
-         depthWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-         depthWrite.dstSet = m_lightingDescriptorSets[i];
-         depthWrite.dstBinding = 5;
-         depthWrite.dstArrayElement = 0;
-         depthWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-         depthWrite.descriptorCount = 1;
-         depthWrite.pImageInfo = &depthImageInfo;
-         descriptorWrites.push_back(depthWrite);
-      }
+      // Clustered light buffers
+      WriteLightBufferDescriptors(i);
       vkUpdateDescriptorSets(m_device.Get(), static_cast<uint32_t>(descriptorWrites.size()),
                              descriptorWrites.data(), 0, nullptr);
+      WriteVisibilityDescriptors(i);
    }
 }
 
 VulkanRenderer::~VulkanRenderer() {
-   m_geometryThreadPool->WaitForAll();
+   m_threadPool.WaitForAll();
    vkDeviceWaitIdle(m_device.Get());
+   if (m_overdrawQueryPool != VK_NULL_HANDLE) {
+      vkDestroyQueryPool(m_device.Get(), m_overdrawQueryPool, nullptr);
+   }
+   m_gpuCulling.reset();
+   m_geometryPool.reset();
    m_resourceManager.reset();
    m_secondaryCommandBuffers.clear();
    for (VkCommandPool pool : m_threadCommandPools) {
@@ -1280,6 +2447,8 @@ VulkanRenderer::~VulkanRenderer() {
    vkDestroyDescriptorPool(m_device.Get(), m_descriptorPool, nullptr);
    vkDestroyDescriptorSetLayout(m_device.Get(), m_geometryDescriptorSetLayout, nullptr);
    vkDestroyDescriptorSetLayout(m_device.Get(), m_lightingDescriptorSetLayout, nullptr);
+   vkDestroyDescriptorSetLayout(m_device.Get(), m_visibilityDescriptorSetLayout, nullptr);
+   vkDestroyDescriptorSetLayout(m_device.Get(), m_gBufferSubpassDescriptorSetLayout, nullptr);
    for (uint32_t i = 0; i < m_renderFinishedSemaphores.size(); ++i) {
       vkDestroySemaphore(m_device.Get(), m_renderFinishedSemaphores[i], nullptr);
    }
@@ -1358,7 +2527,7 @@ void VulkanRenderer::RenderImgui() {
    m_materialEditor->DrawTextureBrowser();
    // FPS Overlay
    PerformanceGUI::RenderPerformanceGUI(*m_resourceManager.get(), *m_activeScene,
-                                        m_currentFrameMetrics);
+                                        m_currentFrameMetrics, m_settings);
    // Imgui render end
    ImGui::Render();
 }
@@ -1374,6 +2543,7 @@ void VulkanRenderer::RenderFrame() {
    // Wait for previous farme
    vkWaitForFences(m_device.Get(), 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
    m_gpuTimer.EndFrame(m_currentFrame);
+   ReadOverdrawQuery();
    // Get the next image of the swapchain
    uint32_t imageIndex;
    const VkResult nextImageResult = m_swapchain.AcquireNextImage(
@@ -1387,9 +2557,23 @@ void VulkanRenderer::RenderFrame() {
    vkResetFences(m_device.Get(), 1, &m_inFlightFences[m_currentFrame]);
    // Setup command buffer to draw the triangle
    m_commandBuffers->Reset(m_currentFrame);
+   // Update the scene and extract what the passes draw
+   UpdateActiveScene(m_deltaTime);
+   m_framePipeline = m_settings.GetActivePipeline();
+   m_gpuDrivenFrame = m_gpuCulling && m_settings.gpuDrivenGeometry &&
+                      m_framePipeline == RenderPipeline::Deferred;
+   m_gBufferSubpassFrame =
+      m_settings.gBufferSubpasses && m_framePipeline == RenderPipeline::Deferred;
+   m_depthPrepassFrame = m_settings.depthPrepass && m_framePipeline == RenderPipeline::Deferred &&
+                         !m_gpuDrivenFrame && !m_gBufferSubpassFrame;
+   m_overdrawFrame = m_settings.overdrawView;
+   if (m_gpuDrivenFrame)
+      m_gpuCulling->Prepare(m_currentFrame, m_renderWorld, *m_resourceManager);
+   if (m_framePipeline == RenderPipeline::VisibilityBuffer)
+      PrepareVisibilityFrame(m_currentFrame);
 
    UpdateCameraUBO(m_currentFrame);
-   UpdateLightsUBO(m_currentFrame);
+   UpdateLightBuffers(m_currentFrame);
 
    RenderImgui();
    RecordCommandBuffer(imageIndex);
@@ -1435,13 +2619,43 @@ void VulkanRenderer::RenderFrame() {
    // Build performance metrics
    m_currentFrameMetrics.frameTimeMs = m_deltaTime * 1000.0f;
    m_currentFrameMetrics.cpuTimeMs = cpuTimeMs;
-   m_currentFrameMetrics.geometryPassMs = m_gpuTimer.GetElapsedMs("GeometryPass");
-   m_currentFrameMetrics.lightingPassMs = m_gpuTimer.GetElapsedMs("LightingPass");
+   CollectSceneMetrics();
+   CollectRenderGraphMetrics(m_renderGraph->GetStats());
+   // The timer still holds results from before a pipeline switch, the other path reads zero
+   const bool forward = m_framePipeline == RenderPipeline::ForwardPlus;
+   const bool visibility = m_framePipeline == RenderPipeline::VisibilityBuffer;
+   m_currentFrameMetrics.pipeline = m_framePipeline;
+   m_currentFrameMetrics.gBufferSubpasses = m_gBufferSubpassFrame;
+   m_currentFrameMetrics.deferredDepthPrepass = m_depthPrepassFrame && !m_overdrawFrame;
+   m_currentFrameMetrics.overdrawView = m_overdrawFrame;
+   // The visibility pipeline has no per material shading pass to count
+   m_currentFrameMetrics.shadingOverdraw =
+      visibility && !m_overdrawFrame ? 0.0f : m_shadingOverdraw;
+   const bool prepass = forward || m_depthPrepassFrame;
+   const bool scene = !m_overdrawFrame;
+   // The overdraw view's pass is reported as the geometry pass it replaces
+   m_currentFrameMetrics.geometryPassMs =
+      m_overdrawFrame ? m_gpuTimer.GetElapsedMs("OverdrawPass")
+      : m_framePipeline == RenderPipeline::Deferred ? m_gpuTimer.GetElapsedMs("GeometryPass")
+                                                    : 0.0f;
+   m_currentFrameMetrics.geometryRecordMs = m_geometryRecordMs;
+   m_currentFrameMetrics.geometryDrawCalls = m_geometryDrawCalls;
+   m_currentFrameMetrics.lightingPassMs =
+      scene && !forward ? m_gpuTimer.GetElapsedMs("LightingPass") : 0.0f;
+   m_currentFrameMetrics.depthPrepassMs = prepass ? m_gpuTimer.GetElapsedMs("DepthPrepass") : 0.0f;
+   m_currentFrameMetrics.forwardPassMs =
+      scene && forward ? m_gpuTimer.GetElapsedMs("ForwardPass") : 0.0f;
+   m_currentFrameMetrics.visibilityPassMs =
+      scene && visibility ? m_gpuTimer.GetElapsedMs("VisibilityPass") : 0.0f;
+   m_currentFrameMetrics.materialResolveMs =
+      scene && visibility ? m_gpuTimer.GetElapsedMs("MaterialResolve") : 0.0f;
    m_currentFrameMetrics.gizmoPassMs = m_gpuTimer.GetElapsedMs("GizmoPass");
    m_currentFrameMetrics.particlePassMs = m_gpuTimer.GetElapsedMs("ParticlePass");
    m_currentFrameMetrics.imguiPassMs = m_gpuTimer.GetElapsedMs("ImGuiPass");
    m_currentFrameMetrics.gpuTimeMs =
       m_currentFrameMetrics.geometryPassMs + m_currentFrameMetrics.lightingPassMs +
+      m_currentFrameMetrics.depthPrepassMs + m_currentFrameMetrics.forwardPassMs +
+      m_currentFrameMetrics.visibilityPassMs + m_currentFrameMetrics.materialResolveMs +
       m_currentFrameMetrics.gizmoPassMs + m_currentFrameMetrics.particlePassMs +
       m_currentFrameMetrics.imguiPassMs;
    m_currentFrameMetrics.vramUsageMB = SystemInfoN::GetVulkanMemoryUsageMB(m_device);
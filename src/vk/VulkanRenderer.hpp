@@ -9,9 +9,12 @@
 #include "vk/VulkanCommandBuffers.hpp"
 #include "vk/VulkanRenderPass.hpp"
 #include "vk/VulkanBuffer.hpp"
+#include "vk/VulkanGPUCulling.hpp"
+#include "vk/VulkanGeometryPool.hpp"
 
 #include "vk/VulkanGPUTimer.hpp"
 
+#include "core/RenderGraph.hpp"
 #include "core/ThreadPool.hpp"
 #include "core/editor/MaterialEditor.hpp"
 #include "core/resource/ResourceManager.hpp"
@@ -23,7 +26,10 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <map>
 #include <memory>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
 class VulkanRenderer : public IRenderer {
@@ -42,7 +48,9 @@ class VulkanRenderer : public IRenderer {
    void CreateUBOs();
 
    void UpdateCameraUBO(const uint32_t currentImage);
-   void UpdateLightsUBO(const uint32_t currentImage);
+   // Uploads the clustered lights, re-pointing the frame's lighting set at any grown buffer
+   void UpdateLightBuffers(const uint32_t currentImage);
+   void WriteLightBufferDescriptors(const uint32_t currentImage);
 
    // Material setup
    void CreateMaterialDescriptorSetLayout();
@@ -51,16 +59,47 @@ class VulkanRenderer : public IRenderer {
 
    // Geometry Pass
    void CreateGeometryDescriptorSetLayout();
-   void CreateGeometryFBO();
    void CreateGeometryPass();
    void CreateGeometryPipeline();
+   void CreateIndirectGeometryPipeline();
+   // Depth-only pass and the equal tested geometry pass after it
+   void CreateDepthPrepassPasses();
+   void CreateDepthPrepassPipelines();
 
    // Lighting Pass
    void CreateLightingDescriptorSetLayout();
-   void CreateLightingFBO();
    void CreateLightingPass();
    void CreateLightingPipeline();
 
+   // Forward+ pass, shares the lighting set and draws into the swapchain image directly
+   void CreateForwardPass();
+   void CreateForwardPipelines();
+
+   // Visibility buffer, triangle ids and depth first, then materials resolved into the G-buffer
+   void CreateVisibilityDescriptorSetLayout();
+   void CreateVisibilityPasses();
+   void CreateVisibilityPipelines();
+   // Fills the frame's draw table and material slots, re-pointing its set at replaced buffers
+   void PrepareVisibilityFrame(const uint32_t currentImage);
+   void WriteVisibilityDescriptors(const uint32_t currentImage);
+
+   // G-buffer subpasses, geometry and lighting in one render pass, then the overlays in another
+   void CreateGBufferSubpassDescriptorSetLayout();
+   void CreateGBufferSubpassPasses();
+   void CreateGBufferSubpassPipelines();
+
+   // Render graph, declares the frame's passes and compiles them
+   void BuildRenderGraph(const uint32_t imageIndex, const VkViewport& viewport,
+                         const VkRect2D& scissor);
+   void RecordRenderGraphBarriers(const std::span<const RenderGraph::Barrier> barriers);
+   // Re-points the frame's sets at the pooled textures this frame's graph placed elsewhere
+   void WriteRenderGraphDescriptors(const uint32_t currentImage);
+   [[nodiscard]] VkImageView GetGraphImageView(const RenderGraph::TextureId texture) const;
+   // Framebuffers are cached per render pass and views, as pooled textures move between passes
+   [[nodiscard]] VkFramebuffer GetFramebuffer(const VulkanRenderPass& renderPass,
+                                              const std::span<const VkImageView> attachments);
+   void PruneFramebuffers();
+
    // Gizmo Pass
    void CreateGizmoDescriptorSetLayout();
    void CreateGizmoPipeline();
@@ -79,17 +118,51 @@ class VulkanRenderer : public IRenderer {
    void RecordCommandBuffer(const uint32_t imageIndex);
    void RenderParticlesInstanced(const uint32_t imageIndex);
 
-   void RenderGeometryPass(const VkViewport& viewport, const VkRect2D& scissor);
-   void RenderLightingPass(const uint32_t imageIndex, const VkViewport& viewport,
+   // Positions only into the G-buffer depth, before the geometry pass
+   void RenderGBufferDepthPrepass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                                  const VkRect2D& scissor);
+   void RenderGeometryPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                           const VkRect2D& scissor);
+   // Records the culled indirect draws inline, without the per object secondary buffers
+   void RenderGeometryPassIndirect(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                                   const VkRect2D& scissor);
+   void BindMaterial(VulkanCommandBuffers& commandBuffers, const uint32_t bufferIndex,
+                     const VulkanPipelineLayout& layout, const MaterialHandle& handle);
+   void RenderLightingPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                           const VkRect2D& scissor);
+   // Lighting subpass of the open G-buffer subpass render pass, which it then ends
+   void RenderLightingSubpass(const VkViewport& viewport, const VkRect2D& scissor);
+   // Depth prepass and forward shading, recorded inline in one render pass that stays open
+   // for the gizmo, particle and ImGui draws
+   void RenderDepthPrepass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                           const VkRect2D& scissor);
+   void RenderForwardPass(const VkViewport& viewport, const VkRect2D& scissor);
+   // Additive fragment counts in the forward render pass, after a depth prepass where the
+   // frame's shading pass has one, which stays open for the overlays
+   void RenderOverdrawPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
                            const VkRect2D& scissor);
+   // Position stream of every visible mesh, the layout's push constant is the model matrix
+   void DrawVisiblePositions(const VulkanPipelineLayout& layout);
+   void RenderVisibilityPass(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                             const VkRect2D& scissor);
+   // Material depth, then one full-screen draw per material with an equal depth test
+   void RenderMaterialResolve(const VkFramebuffer framebuffer, const VkViewport& viewport,
+                              const VkRect2D& scissor);
    void RenderGizmoPass(const VkViewport& viewport, const VkRect2D& scissor);
    void RenderParticlePass(const uint32_t imageIndex, const VkViewport& viewport,
                            const VkRect2D& scissor);
+   // Gizmos, particles and ImGui inside the open render pass, which they then end
+   void RenderOverlayPasses(const uint32_t imageIndex, const VkViewport& viewport,
+                            const VkRect2D& scissor);
 
-   void TransitionGBufferLayouts();
    void ResizeParticleBuffers(const size_t newCapacity);
    // Functions to set up synchronization for drawing
    void CreateSynchronizationObjects();
+   // Counts the samples the shading pass writes, read once the frame's fence has signalled
+   void CreateOverdrawQueryPool();
+   void BeginOverdrawQuery();
+   void EndOverdrawQuery();
+   void ReadOverdrawQuery();
    // Functions to setup swapchain recreation
    void RecreateSwapchain();
    void CleanupSwapchain();
@@ -99,9 +172,6 @@ class VulkanRenderer : public IRenderer {
 
    [[nodiscard]] ResourceManager* GetResourceManager() const noexcept override;
 
-  public:
-   constexpr static uint32_t MAX_LIGHTS{256};
-
   private:
    // TODO: Remove unique ptrs in favour of stack variables once other abstractions are implemented
    constexpr static uint32_t MAX_FRAMES_IN_FLIGHT{2};
@@ -118,33 +188,127 @@ class VulkanRenderer : public IRenderer {
    VulkanSwapchain m_swapchain;
 
    std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_cameraUniformBuffers;
-   std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_lightsUniformBuffers;
+   // Clustered lighting storage buffers, grown when the lights or indices outgrow them
+   std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_lightBuffers;
+   std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_clusterBuffers;
+   std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_lightIndexBuffers;
 
    MeshHandle m_fullscreenQuad;
    MeshHandle m_lineCube;
 
-   // G-Buffer
-   std::array<TextureHandle, MAX_FRAMES_IN_FLIGHT> m_gDepthTexture;
-   std::array<TextureHandle, MAX_FRAMES_IN_FLIGHT> m_gAlbedoTexture; // RGB color + A AO
-   std::array<TextureHandle, MAX_FRAMES_IN_FLIGHT>
-      m_gNormalTexture; // RG encoded normal + B roughness + A metallic
+   // Render graph, owns the G-buffer, depth and visibility targets as pooled transients
+   struct GraphTextures final {
+      RenderGraph::TextureId backbuffer{RenderGraph::INVALID_TEXTURE};
+      RenderGraph::TextureId albedo{RenderGraph::INVALID_TEXTURE}; // RGB color + A AO
+      // RG encoded normal + B roughness + A metallic
+      RenderGraph::TextureId normal{RenderGraph::INVALID_TEXTURE};
+      RenderGraph::TextureId depth{RenderGraph::INVALID_TEXTURE};
+      RenderGraph::TextureId ids{RenderGraph::INVALID_TEXTURE}; // R32UI triangle ids
+   };
+   struct CachedFramebuffer final {
+      VkFramebuffer framebuffer;
+      uint64_t lastFrame;
+   };
+   // Lighting set G-buffer and depth bindings, the visibility set's triangle ids, then the
+   // G-buffer subpass input attachments
+   constexpr static uint32_t GRAPH_DESCRIPTOR_COUNT{7};
+   std::unique_ptr<RenderGraph> m_renderGraph;
+   // Textures the frame's graph declared that are referenced outside their passes
+   GraphTextures m_graphTextures;
+   uint32_t m_imageIndex{0};
+   uint64_t m_frameCount{0};
+   std::map<std::pair<VkRenderPass, std::vector<VkImageView>>, CachedFramebuffer> m_framebuffers;
+   // Texture ids each frame's sets point at, per graph binding
+   std::array<std::array<uint64_t, GRAPH_DESCRIPTOR_COUNT>, MAX_FRAMES_IN_FLIGHT>
+      m_graphDescriptorTextures{};
 
    // Geometry pass
    std::unique_ptr<VulkanRenderPass> m_geometryRenderPass;
-   std::array<VkFramebuffer, MAX_FRAMES_IN_FLIGHT> m_geometryFramebuffers;
    VkDescriptorSetLayout m_geometryDescriptorSetLayout;
    std::unique_ptr<VulkanPipelineLayout> m_geometryPipelineLayout;
    std::unique_ptr<VulkanGraphicsPipeline> m_geometryGraphicsPipeline;
    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_geometryDescriptorSets;
+   // GPU-driven geometry, null when the device lacks indirect count draws
+   std::unique_ptr<VulkanGPUCulling> m_gpuCulling;
+   std::unique_ptr<VulkanPipelineLayout> m_indirectGeometryPipelineLayout;
+   std::unique_ptr<VulkanGraphicsPipeline> m_indirectGeometryGraphicsPipeline;
+   // Latched before Prepare(), the overlay may flip the setting before recording
+   bool m_gpuDrivenFrame{false};
+   // Deferred depth prepass, positions only into a depth-only pass, then the geometry pass loads
+   // that depth and shades with an equal test and no depth writes
+   std::unique_ptr<VulkanRenderPass> m_depthOnlyRenderPass;
+   std::unique_ptr<VulkanRenderPass> m_geometryEqualRenderPass;
+   std::unique_ptr<VulkanGraphicsPipeline> m_gBufferDepthPrepassGraphicsPipeline;
+   std::unique_ptr<VulkanGraphicsPipeline> m_geometryEqualGraphicsPipeline;
+   // Latched with the pipeline, only the separate per object geometry pass runs the prepass
+   bool m_depthPrepassFrame{false};
+   float m_geometryRecordMs{0.0f};
+   uint32_t m_geometryDrawCalls{0};
 
    // Lighting pass
    std::unique_ptr<VulkanRenderPass> m_lightingRenderPass;
-   std::vector<VkFramebuffer> m_lightingFramebuffers;
    VkDescriptorSetLayout m_lightingDescriptorSetLayout;
    std::unique_ptr<VulkanPipelineLayout> m_lightingPipelineLayout;
    std::unique_ptr<VulkanGraphicsPipeline> m_lightingGraphicsPipeline;
    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_lightingDescriptorSets;
 
+   // G-buffer subpasses, the geometry pipelines again for subpass 0 and a lighting pipeline that
+   // reads the G-buffer as input attachments in subpass 1
+   std::unique_ptr<VulkanRenderPass> m_gBufferSubpassRenderPass;
+   // Loads the lit image and depth for the overlays, compatible with the lighting pass
+   std::unique_ptr<VulkanRenderPass> m_overlayRenderPass;
+   VkDescriptorSetLayout m_gBufferSubpassDescriptorSetLayout;
+   std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_gBufferSubpassDescriptorSets;
+   std::unique_ptr<VulkanGraphicsPipeline> m_subpassGeometryGraphicsPipeline;
+   std::unique_ptr<VulkanGraphicsPipeline> m_subpassIndirectGeometryGraphicsPipeline;
+   std::unique_ptr<VulkanPipelineLayout> m_subpassLightingPipelineLayout;
+   std::unique_ptr<VulkanGraphicsPipeline> m_subpassLightingGraphicsPipeline;
+   // Latched with the pipeline, deferred frames only
+   bool m_gBufferSubpassFrame{false};
+
+   // Forward+ pass, the depth prepass and the forward pipeline share one layout
+   std::unique_ptr<VulkanRenderPass> m_forwardRenderPass;
+   std::unique_ptr<VulkanPipelineLayout> m_forwardPipelineLayout;
+   std::unique_ptr<VulkanGraphicsPipeline> m_depthPrepassGraphicsPipeline;
+   std::unique_ptr<VulkanGraphicsPipeline> m_forwardGraphicsPipeline;
+   // Overdraw view, in the forward render pass and layout, depth tested like the shading pass
+   std::unique_ptr<VulkanGraphicsPipeline> m_overdrawGraphicsPipeline;
+   std::unique_ptr<VulkanGraphicsPipeline> m_overdrawEqualGraphicsPipeline;
+   bool m_overdrawFrame{false};
+   // One query per frame in flight, null where the device cannot count precisely inside the
+   // geometry pass' secondary buffers
+   VkQueryPool m_overdrawQueryPool{VK_NULL_HANDLE};
+   // Scene pixels each frame's query was issued for, zero while it holds no pending result
+   std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_overdrawQueryPixels{};
+   float m_shadingOverdraw{0.0f};
+   // Latched with the GPU-driven flag, so recording and metrics agree on the frame's passes
+   RenderPipeline m_framePipeline{RenderPipeline::Deferred};
+
+   // Visibility buffer, the resolve writes the G-buffer the lighting pass already reads
+   struct VisibilityDraw final {
+      const VulkanGeometryPool::MeshRange* range;
+      uint32_t proxy;
+      uint32_t firstTriangle;
+   };
+   std::unique_ptr<VulkanGeometryPool> m_geometryPool;
+   std::unique_ptr<VulkanRenderPass> m_visibilityRenderPass;
+   std::unique_ptr<VulkanRenderPass> m_materialResolveRenderPass;
+   VkDescriptorSetLayout m_visibilityDescriptorSetLayout;
+   std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> m_visibilityDescriptorSets;
+   std::unique_ptr<VulkanPipelineLayout> m_visibilityPipelineLayout;
+   std::unique_ptr<VulkanGraphicsPipeline> m_visibilityGraphicsPipeline;
+   std::unique_ptr<VulkanPipelineLayout> m_materialResolvePipelineLayout;
+   std::unique_ptr<VulkanGraphicsPipeline> m_materialDepthGraphicsPipeline;
+   std::unique_ptr<VulkanGraphicsPipeline> m_materialResolveGraphicsPipeline;
+   // Per draw model matrix, triangle range, pool offsets and material slot
+   std::array<std::unique_ptr<VulkanBuffer>, MAX_FRAMES_IN_FLIGHT> m_visibilityDrawBuffers;
+   // Pool version each frame's set points at
+   std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> m_visibilityPoolVersions{};
+   std::vector<VisibilityDraw> m_visibilityDraws;
+   // Indexed by material slot, the map is keyed by material handle id
+   std::vector<MaterialHandle> m_visibilityMaterials;
+   std::unordered_map<uint64_t, uint32_t> m_visibilityMaterialSlots;
+
    // Material descriptor stuff
    VkDescriptorSetLayout m_materialDescriptorSetLayout;
    VkDescriptorPool m_materialDescriptorPool;
@@ -179,7 +343,5 @@ class VulkanRenderer : public IRenderer {
 
    VulkanGPUTimer m_gpuTimer;
 
-   std::unique_ptr<ThreadPool> m_geometryThreadPool;
-
    uint32_t m_numGeometryThreads{0};
 };
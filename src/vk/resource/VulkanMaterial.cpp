@@ -90,7 +90,7 @@ void VulkanMaterial::UpdateDescriptorSet(const ResourceManager& resourceManager)
          texture = resourceManager.GetTexture(th);
       }
       if (!texture || !texture->IsValid()) {
-         throw std::runtime_error("Material texture '" + std::string(textureName) +
+         throw std::runtime_error("Material texture '" + descriptor.name +
                                   "' has no valid texture or default texture");
       }
       const VulkanTexture* vkTexture = reinterpret_cast<const VulkanTexture*>(texture);
@@ -6,12 +6,14 @@
 #include <glad/gl.h>
 #include <stdexcept>
 
-VulkanMesh::VulkanMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
-                       const VulkanDevice& device)
+VulkanMesh::VulkanMesh(const std::span<const Vertex> vertices,
+                       const std::span<const uint32_t> indices, const VulkanDevice& device)
     : m_indexType(indices.size() <= std::numeric_limits<uint16_t>::max() ? VK_INDEX_TYPE_UINT16
                                                                          : VK_INDEX_TYPE_UINT32),
-      m_vertexBuffer(VulkanMesh::CreateVertexBuffer(vertices, device)),
+      m_vertexBuffer(
+         VulkanMesh::CreateVertexBuffer(vertices.data(), vertices.size_bytes(), device)),
       m_indexBuffer(VulkanMesh::CreateIndexBuffer(indices, device)),
+      m_positionBuffer(VulkanMesh::CreatePositionBuffer(vertices, device)),
       m_indexCount(indices.size()),
       m_vertexCount(vertices.size()) {}
 
@@ -20,7 +22,7 @@ VulkanMesh::~VulkanMesh() = default;
 ResourceType VulkanMesh::GetType() const noexcept { return ResourceType::Mesh; }
 
 size_t VulkanMesh::GetMemoryUsage() const noexcept {
-   return (m_vertexCount * sizeof(Vertex)) +
+   return (m_vertexCount * (sizeof(Vertex) + sizeof(glm::vec3))) +
           (m_indexCount *
            (m_indexType == VK_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t)));
 }
@@ -32,13 +34,12 @@ bool VulkanMesh::IsValid() const noexcept {
 
 void* VulkanMesh::GetNativeHandle() const { return reinterpret_cast<void*>(m_vertexBuffer.Get()); }
 
-VulkanBuffer VulkanMesh::CreateVertexBuffer(const std::vector<Vertex>& vertices,
+VulkanBuffer VulkanMesh::CreateVertexBuffer(const void* data, const VkDeviceSize bufferSize,
                                             const VulkanDevice& device) {
-   VkDeviceSize bufferSize = sizeof(Vertex) * vertices.size();
    VulkanBuffer staging(device, bufferSize, VulkanBuffer::Usage::Vertex,
                         VulkanBuffer::MemoryType::CPUToGPU);
    staging.Map();
-   staging.Update(vertices.data(), bufferSize);
+   staging.Update(data, bufferSize);
    VulkanBuffer vertexBuffer(device, bufferSize, VulkanBuffer::Usage::Vertex,
                              VulkanBuffer::MemoryType::GPUOnly);
    VulkanCommandBuffers::ExecuteImmediate(
@@ -53,7 +54,16 @@ VulkanBuffer VulkanMesh::CreateVertexBuffer(const std::vector<Vertex>& vertices,
    return vertexBuffer;
 }
 
-VulkanBuffer VulkanMesh::CreateIndexBuffer(const std::vector<uint32_t>& indices,
+VulkanBuffer VulkanMesh::CreatePositionBuffer(const std::span<const Vertex> vertices,
+                                              const VulkanDevice& device) {
+   std::vector<glm::vec3> positions;
+   positions.reserve(vertices.size());
+   for (const Vertex& vertex : vertices)
+      positions.push_back(vertex.position);
+   return CreateVertexBuffer(positions.data(), positions.size() * sizeof(glm::vec3), device);
+}
+
+VulkanBuffer VulkanMesh::CreateIndexBuffer(const std::span<const uint32_t> indices,
                                            const VulkanDevice& device) {
    VkDeviceSize bufferSize;
    std::vector<uint8_t> indexData;
@@ -93,6 +103,14 @@ void VulkanMesh::Draw(const VkCommandBuffer& cmd) const {
    vkCmdDrawIndexed(cmd, static_cast<uint32_t>(m_indexCount), 1, 0, 0, 0);
 }
 
+void VulkanMesh::DrawPositions(const VkCommandBuffer& cmd) const {
+   const VkBuffer vertexBuffers[] = {m_positionBuffer.Get()};
+   const VkDeviceSize offsets[] = {0};
+   vkCmdBindVertexBuffers(cmd, 0, 1, vertexBuffers, offsets);
+   vkCmdBindIndexBuffer(cmd, m_indexBuffer.Get(), 0, m_indexType);
+   vkCmdDrawIndexed(cmd, static_cast<uint32_t>(m_indexCount), 1, 0, 0, 0);
+}
+
 size_t VulkanMesh::GetIndexCount() const { return m_indexCount; }
 
 size_t VulkanMesh::GetVertexCount() const { return m_vertexCount; }
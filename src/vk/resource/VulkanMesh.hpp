@@ -5,12 +5,13 @@
 
 #include "vk/VulkanBuffer.hpp"
 
+#include <span>
 #include <vector>
 #include <cstddef>
 
 class VulkanMesh : public IMesh {
   public:
-   VulkanMesh(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices,
+   VulkanMesh(const std::span<const Vertex> vertices, const std::span<const uint32_t> indices,
               const VulkanDevice& device);
    ~VulkanMesh();
 
@@ -33,14 +34,22 @@ class VulkanMesh : public IMesh {
    [[nodiscard]] VkIndexType GetIndexType() const noexcept { return m_indexType; }
 
    void Draw(const VkCommandBuffer& commandBuffer) const;
+   // Binds the packed positions alone, for pipelines that only lay down depth
+   void DrawPositions(const VkCommandBuffer& commandBuffer) const;
 
   private:
-   VulkanBuffer CreateVertexBuffer(const std::vector<Vertex>& vertices, const VulkanDevice& device);
-   VulkanBuffer CreateIndexBuffer(const std::vector<uint32_t>& indices, const VulkanDevice& device);
+   VulkanBuffer CreateVertexBuffer(const void* data, const VkDeviceSize bufferSize,
+                                   const VulkanDevice& device);
+   VulkanBuffer CreatePositionBuffer(const std::span<const Vertex> vertices,
+                                     const VulkanDevice& device);
+   VulkanBuffer CreateIndexBuffer(const std::span<const uint32_t> indices,
+                                  const VulkanDevice& device);
 
   private:
    VulkanBuffer m_vertexBuffer;
    VulkanBuffer m_indexBuffer;
+   // Positions alone, so depth-only passes fetch 12 bytes per vertex instead of a whole Vertex
+   VulkanBuffer m_positionBuffer;
    VkIndexType m_indexType{VK_INDEX_TYPE_UINT32};
 
    size_t m_indexCount;
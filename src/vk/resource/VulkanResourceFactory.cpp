@@ -22,17 +22,22 @@ std::unique_ptr<ITexture> VulkanResourceFactory::CreateTextureFromFile(
    return std::make_unique<VulkanTexture>(*m_device, std::string{filepath}, generateMipmaps, sRGB);
 }
 
+std::unique_ptr<ITexture> VulkanResourceFactory::CreateTextureFromImage(
+   const ImageData& image, const bool generateMipmaps, const bool sRGB) {
+   return std::make_unique<VulkanTexture>(*m_device, image, generateMipmaps, sRGB);
+}
+
 std::unique_ptr<ITexture> VulkanResourceFactory::CreateDepthTexture(const uint32_t width,
                                                                     const uint32_t height,
                                                                     const ITexture::Format format) {
    return std::make_unique<VulkanTexture>(*m_device, width, height, format, true);
 }
 
-std::unique_ptr<ITexture> VulkanResourceFactory::CreateRenderTarget(const uint32_t width,
-                                                                    const uint32_t height,
-                                                                    const ITexture::Format format,
-                                                                    const uint32_t samples) {
-   return std::make_unique<VulkanTexture>(*m_device, width, height, format, false, samples);
+std::unique_ptr<ITexture> VulkanResourceFactory::CreateRenderTarget(
+   const uint32_t width, const uint32_t height, const ITexture::Format format,
+   const uint32_t samples, const bool transientAttachment) {
+   return std::make_unique<VulkanTexture>(*m_device, width, height, format, false, samples,
+                                          transientAttachment);
 }
 
 std::unique_ptr<IMaterial> VulkanResourceFactory::CreateMaterial(
@@ -40,7 +45,7 @@ std::unique_ptr<IMaterial> VulkanResourceFactory::CreateMaterial(
    return std::make_unique<VulkanMaterial>(*m_device, matTemplate);
 }
 
-std::unique_ptr<IMesh> VulkanResourceFactory::CreateMesh(const std::vector<Vertex>& vertices,
-                                                         const std::vector<uint32_t>& indices) {
+std::unique_ptr<IMesh> VulkanResourceFactory::CreateMesh(const std::span<const Vertex> vertices,
+                                                         const std::span<const uint32_t> indices) {
    return std::make_unique<VulkanMesh>(vertices, indices, *m_device);
 }
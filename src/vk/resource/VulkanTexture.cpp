@@ -6,7 +6,6 @@
 
 #include <imgui.h>
 #include <imgui_impl_vulkan.h>
-#include <stb_image.h>
 
 #include <stdexcept>
 #include <cstring>
@@ -32,15 +31,28 @@ VulkanTexture::VulkanTexture(const VulkanDevice& device, const CreateInfo& info)
    UpdateSamplerSettings(VK_FILTER_LINEAR, VK_FILTER_LINEAR);
 }
 
+namespace {
+
+[[nodiscard]] ImageData LoadImageOrThrow(const std::string& filepath) {
+   ImageData image = ImageData::LoadFromFile(filepath);
+   if (image.IsEmpty())
+      throw std::runtime_error("Failed to load texture image: " + filepath);
+   return image;
+}
+
+} // namespace
+
 VulkanTexture::VulkanTexture(const VulkanDevice& device, const std::string& filepath,
                              const bool generateMipmaps, const bool sRGB)
+    : VulkanTexture(device, LoadImageOrThrow(filepath), generateMipmaps, sRGB) {}
+
+VulkanTexture::VulkanTexture(const VulkanDevice& device, const ImageData& image,
+                             const bool generateMipmaps, const bool sRGB)
     : m_device(&device) {
-   int32_t texWidth, texHeight, texChannels;
-   stbi_uc* pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, 4);
-   if (!pixels)
-      throw std::runtime_error("Failed to load texture image: " + filepath);
-   m_width = static_cast<uint32_t>(texWidth);
-   m_height = static_cast<uint32_t>(texHeight);
+   if (image.IsEmpty())
+      throw std::runtime_error("Cannot create a texture from an empty image");
+   m_width = image.width;
+   m_height = image.height;
    m_depth = 1;
    if (sRGB)
       m_format = Format::SRGB8_ALPHA8;
@@ -54,8 +66,7 @@ VulkanTexture::VulkanTexture(const VulkanDevice& device, const std::string& file
    VulkanBuffer staging(*m_device, imageSize, VulkanBuffer::Usage::TransferSrc,
                         VulkanBuffer::MemoryType::CPUToGPU);
    staging.Map();
-   staging.Update(pixels, imageSize);
-   stbi_image_free(pixels);
+   staging.Update(image.pixels.get(), imageSize);
    CreateImage();
    CopyFromBuffer(staging);
    if (generateMipmaps)
@@ -69,15 +80,18 @@ VulkanTexture::VulkanTexture(const VulkanDevice& device, const std::string& file
 
 VulkanTexture::VulkanTexture(const VulkanDevice& device, const uint32_t width,
                              const uint32_t height, const Format format, const bool isDepth,
-                             const uint32_t samples)
+                             const uint32_t samples, const bool transientAttachment)
     : m_device(&device),
       m_width(width),
       m_height(height),
       m_depth(1),
-      m_format(isDepth ? Format::Depth32F : Format::RGBA8),
+      m_format(isDepth                   ? Format::Depth32F
+               : format == Format::R32UI ? Format::R32UI
+                                         : Format::RGBA8),
       m_isDepth(isDepth),
       m_samples(samples),
-      m_mipLevels(1) {
+      m_mipLevels(1),
+      m_transientAttachment(transientAttachment) {
    m_vkFormat = ConvertFormat(m_format);
    CreateImage();
    CreateImageView();
@@ -153,12 +167,22 @@ VulkanTexture& VulkanTexture::operator=(VulkanTexture&& other) noexcept {
       m_samples = other.m_samples;
       m_format = other.m_format;
       m_isDepth = other.m_isDepth;
+      m_transientAttachment = other.m_transientAttachment;
+      m_lazilyAllocated = other.m_lazilyAllocated;
    }
    return *this;
 }
 
 size_t VulkanTexture::GetMemoryUsage() const noexcept {
-   return static_cast<size_t>(m_width) * m_height * m_depth * BytesPerPixel(m_format);
+   const size_t bytes = static_cast<size_t>(m_width) * m_height * m_depth * BytesPerPixel(m_format);
+   if (!m_lazilyAllocated)
+      return bytes;
+   // Lazily allocated memory is only committed as far as the GPU had to back the image
+   VmaAllocationInfo allocation;
+   vmaGetAllocationInfo(m_device->GetAllocator(), m_allocation, &allocation);
+   VkDeviceSize committed = 0;
+   vkGetDeviceMemoryCommitment(m_device->Get(), allocation.deviceMemory, &committed);
+   return std::min(bytes, static_cast<size_t>(committed));
 }
 
 VkFormat VulkanTexture::ConvertFormat(const Format fmt) const {
@@ -181,6 +205,8 @@ VkFormat VulkanTexture::ConvertFormat(const Format fmt) const {
          return VK_FORMAT_X8_D24_UNORM_PACK32;
       case Format::Depth32F:
          return VK_FORMAT_D32_SFLOAT;
+      case Format::R32UI:
+         return VK_FORMAT_R32_UINT;
       default:
          throw std::runtime_error("Unsupported format");
    }
@@ -206,6 +232,8 @@ constexpr size_t VulkanTexture::BytesPerPixel(const Format fmt) noexcept {
          return 4;
       case Format::Depth32F:
          return 4;
+      case Format::R32UI:
+         return 4;
       default:
          return 4;
    }
@@ -253,7 +281,10 @@ void VulkanTexture::CreateImage() {
    imageInfo.format = m_vkFormat;
    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-   imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+   // Transient attachments may not be sampled or copied
+   imageInfo.usage = m_transientAttachment
+                        ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT
+                        : VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
    if (m_mipLevels > 1)
       imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
    if (m_isDepth) {
@@ -261,10 +292,18 @@ void VulkanTexture::CreateImage() {
    } else {
       imageInfo.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
    }
+   // Render targets may be read back by a later subpass of the pass that wrote them
+   imageInfo.usage |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
    imageInfo.samples = static_cast<VkSampleCountFlagBits>(m_samples);
    imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
    VmaAllocationCreateInfo allocInfo{};
    allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+   m_lazilyAllocated = m_transientAttachment && m_device->SupportsLazilyAllocatedMemory();
+   if (m_lazilyAllocated) {
+      // A dedicated allocation, so its commitment is this image's alone
+      allocInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
+      allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+   }
    if (vmaCreateImage(m_device->GetAllocator(), &imageInfo, &allocInfo, &m_image, &m_allocation,
                       nullptr) != VK_SUCCESS) {
       throw std::runtime_error("Failed to create image with VMA");
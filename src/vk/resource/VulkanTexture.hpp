@@ -1,6 +1,7 @@
 #pragma once
 
 #include "core/resource/ITexture.hpp"
+#include "core/resource/ImageData.hpp"
 #include "vk/VulkanDevice.hpp"
 
 #include <glm/glm.hpp>
@@ -19,8 +20,13 @@ class VulkanTexture : public ITexture {
    VulkanTexture(const VulkanDevice& device, const CreateInfo& info);
    VulkanTexture(const VulkanDevice& device, const std::string& filepath,
                  const bool generateMipmaps, const bool sRGB);
+   VulkanTexture(const VulkanDevice& device, const ImageData& image, const bool generateMipmaps,
+                 const bool sRGB);
+   // Transient attachments never leave the render pass that writes them, so they can only be
+   // used as attachments and sit in lazily allocated memory where the device has it
    VulkanTexture(const VulkanDevice& device, const uint32_t width, const uint32_t height,
-                 const Format format, const bool isDepth = false, const uint32_t samples = 1);
+                 const Format format, const bool isDepth = false, const uint32_t samples = 1,
+                 const bool transientAttachment = false);
    VulkanTexture(const VulkanDevice& device, const Format format, const glm::vec4& color);
    ~VulkanTexture();
 
@@ -96,4 +102,6 @@ class VulkanTexture : public ITexture {
    uint32_t m_samples{1};
    Format m_format{Format::RGBA8};
    bool m_isDepth{};
+   bool m_transientAttachment{};
+   bool m_lazilyAllocated{};
 };
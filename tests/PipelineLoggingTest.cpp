@@ -0,0 +1,107 @@
+#include "core/RenderSettings.hpp"
+#include "core/system/PerformanceLogger.hpp"
+#include "core/system/PerformanceMetrics.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <print>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checks that the Pipeline column of the frame log names the pipeline a renderer actually drew.
+// Renderers record RenderSettings::GetActivePipeline(), so a visibility buffer requested from a
+// renderer without one, as on GL, has to be logged as the deferred pipeline it falls back to.
+
+namespace {
+
+[[nodiscard]] std::vector<std::string> SplitCSVLine(const std::string_view line) {
+   std::vector<std::string> fields;
+   size_t start = 0;
+   while (true) {
+      const size_t comma = line.find(',', start);
+      fields.emplace_back(line.substr(start, comma - start));
+      if (comma == std::string_view::npos) {
+         return fields;
+      }
+      start = comma + 1;
+   }
+}
+
+// Pipeline column of every frame in the session's frame log, empty if it cannot be read
+[[nodiscard]] std::vector<std::string> ReadLoggedPipelines(
+   const std::filesystem::path& directory) {
+   for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+      if (!entry.path().filename().string().ends_with("_frames.csv")) {
+         continue;
+      }
+      std::ifstream file(entry.path());
+      std::string line;
+      if (!std::getline(file, line)) {
+         return {};
+      }
+      const std::vector<std::string> header = SplitCSVLine(line);
+      const auto column = std::ranges::find(header, "Pipeline");
+      if (column == header.end()) {
+         return {};
+      }
+      const size_t index = static_cast<size_t>(column - header.begin());
+      std::vector<std::string> pipelines;
+      while (std::getline(file, line)) {
+         const std::vector<std::string> fields = SplitCSVLine(line);
+         pipelines.push_back(index < fields.size() ? fields[index] : std::string{});
+      }
+      return pipelines;
+   }
+   return {};
+}
+
+} // namespace
+
+int main() {
+   const std::filesystem::path directory =
+      std::filesystem::temp_directory_path() / "pipeline_logging_test";
+   std::filesystem::remove_all(directory);
+
+   // Every pipeline requested from a renderer with and without the visibility buffer
+   std::vector<RenderPipeline> expected;
+   {
+      PerformanceLogger logger(directory.string());
+      logger.StartSession("PipelineLogging", SystemInfo{});
+      for (const bool visibilityBufferAvailable : {false, true}) {
+         for (uint8_t i = 0; i < static_cast<uint8_t>(RenderPipeline::Count); ++i) {
+            RenderSettings settings;
+            settings.visibilityBufferAvailable = visibilityBufferAvailable;
+            settings.pipeline = static_cast<RenderPipeline>(i);
+            const bool fallsBack =
+               settings.pipeline == RenderPipeline::VisibilityBuffer && !visibilityBufferAvailable;
+            expected.push_back(fallsBack ? RenderPipeline::Deferred : settings.pipeline);
+            PerformanceMetrics metrics;
+            metrics.frameTimeMs = 16.0f;
+            metrics.pipeline = settings.GetActivePipeline();
+            logger.LogFrame(metrics);
+         }
+      }
+      logger.EndSession();
+   }
+
+   const std::vector<std::string> logged = ReadLoggedPipelines(directory);
+   std::filesystem::remove_all(directory);
+   if (logged.size() != expected.size()) {
+      std::println(stderr, "Logged {} frames, expected {}", logged.size(), expected.size());
+      return EXIT_FAILURE;
+   }
+   bool passed = true;
+   for (size_t i = 0; i < expected.size(); ++i) {
+      const std::string_view name = GetRenderPipelineName(expected[i]);
+      if (logged[i] != name) {
+         std::println(stderr, "Frame {} logged '{}', expected '{}'", i + 1, logged[i], name);
+         passed = false;
+      }
+   }
+   std::println("Checked the logged pipeline of {} frames", logged.size());
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,224 @@
+#include "core/ThreadPool.hpp"
+#include "core/resource/MeshLoader.hpp"
+#include "core/scene/Node.hpp"
+#include "core/scene/Scene.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Checks that Scene::ForEachNode walks the Sponza hierarchy without a single heap allocation,
+// and that pruning callbacks and skipInactive leave out exactly the expected subtrees.
+// Only the node tree is rebuilt, so no graphics context or GPU resources are needed.
+
+namespace {
+
+constexpr const char* SPONZA_PATH = "resources/meshes/sponza.fbx";
+
+std::atomic<size_t> s_allocationCount{0};
+
+[[nodiscard]] void* CountedAlloc(const size_t size) {
+   s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+   if (void* const ptr = std::malloc(size == 0 ? 1 : size)) {
+      return ptr;
+   }
+   throw std::bad_alloc();
+}
+
+[[nodiscard]] void* CountedAlignedAlloc(const size_t size, const std::align_val_t alignment) {
+   s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+   const size_t align = static_cast<size_t>(alignment);
+   // aligned_alloc wants a multiple of the alignment
+   const size_t alignedSize = (std::max<size_t>(size, 1) + align - 1) / align * align;
+#ifdef _WIN32
+   void* const ptr = _aligned_malloc(alignedSize, align);
+#else
+   void* const ptr = std::aligned_alloc(align, alignedSize);
+#endif
+   if (ptr) {
+      return ptr;
+   }
+   throw std::bad_alloc();
+}
+
+void AlignedFree(void* const ptr) noexcept {
+#ifdef _WIN32
+   _aligned_free(ptr);
+#else
+   std::free(ptr);
+#endif
+}
+
+// Scene nodes in creation order, which is also the pre-order the traversal must produce
+struct BuiltNode final {
+   Node* node;
+   // This node plus all of its descendants
+   size_t subtreeSize;
+};
+
+size_t BuildHierarchy(Scene& scene, Node* const parent, const MeshLoader::SceneNode& source,
+                      std::vector<BuiltNode>& built) {
+   Node* const node = scene.CreateChildNode(parent, source.name);
+   const size_t index = built.size();
+   built.push_back({.node = node, .subtreeSize = 1});
+   for (const MeshLoader::SceneNode& child : source.children) {
+      built[index].subtreeSize += BuildHierarchy(scene, node, child, built);
+   }
+   return built[index].subtreeSize;
+}
+
+// First node from start on that has children, or built.size()
+[[nodiscard]] size_t FindInnerNode(const std::vector<BuiltNode>& built, const size_t start) {
+   for (size_t i = start; i < built.size(); ++i) {
+      if (built[i].subtreeSize > 1) {
+         return i;
+      }
+   }
+   return built.size();
+}
+
+// Pre-order of the root and all built nodes, leaving out the given index ranges
+[[nodiscard]] std::vector<const Node*> ExpectedOrder(
+   const Node* const root, const std::vector<BuiltNode>& built,
+   const std::vector<std::pair<size_t, size_t>>& excluded) {
+   std::vector<const Node*> order{root};
+   for (size_t i = 0; i < built.size(); ++i) {
+      const bool skip = std::ranges::any_of(
+         excluded, [i](const auto& range) { return i >= range.first && i < range.second; });
+      if (!skip) {
+         order.push_back(built[i].node);
+      }
+   }
+   return order;
+}
+
+[[nodiscard]] bool CheckOrder(const std::string_view pass, const std::vector<const Node*>& visited,
+                              const std::vector<const Node*>& expected) {
+   if (std::ranges::equal(visited, expected)) {
+      std::println("{}: visited {} nodes", pass, visited.size());
+      return true;
+   }
+   std::println(stderr, "{}: visited {} nodes, expected {}", pass, visited.size(),
+                expected.size());
+   return false;
+}
+
+} // namespace
+
+void* operator new(const size_t size) { return CountedAlloc(size); }
+
+void* operator new[](const size_t size) { return CountedAlloc(size); }
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+   return CountedAlignedAlloc(size, alignment);
+}
+
+void* operator new[](const size_t size, const std::align_val_t alignment) {
+   return CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* const ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* const ptr, const size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* const ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* const ptr, const size_t) noexcept { std::free(ptr); }
+
+void operator delete(void* const ptr, const std::align_val_t) noexcept { AlignedFree(ptr); }
+
+void operator delete(void* const ptr, const size_t, const std::align_val_t) noexcept {
+   AlignedFree(ptr);
+}
+
+void operator delete[](void* const ptr, const std::align_val_t) noexcept { AlignedFree(ptr); }
+
+void operator delete[](void* const ptr, const size_t, const std::align_val_t) noexcept {
+   AlignedFree(ptr);
+}
+
+int main() {
+   const MeshLoader::SceneData sponza = MeshLoader::LoadScene(SPONZA_PATH);
+   if (sponza.IsEmpty()) {
+      std::println(stderr, "Failed to load {}", SPONZA_PATH);
+      return EXIT_FAILURE;
+   }
+   ThreadPool threadPool;
+   Scene scene(threadPool, "Sponza");
+   std::vector<BuiltNode> built;
+   BuildHierarchy(scene, scene.GetRootNode(), sponza.rootNode, built);
+
+   // Prune the first inner node below the model root and deactivate the next one after it
+   const size_t prunedIndex = FindInnerNode(built, 1);
+   const size_t inactiveIndex =
+      prunedIndex < built.size()
+         ? FindInnerNode(built, prunedIndex + built[prunedIndex].subtreeSize)
+         : built.size();
+   if (inactiveIndex >= built.size()) {
+      std::println(stderr, "{} has too few nested nodes for the pruning checks", SPONZA_PATH);
+      return EXIT_FAILURE;
+   }
+   const Node* const prunedNode = built[prunedIndex].node;
+   Node* const inactiveNode = built[inactiveIndex].node;
+   inactiveNode->SetActive(false);
+   std::println("Pruning '{}' ({} nodes), deactivating '{}' ({} nodes)", prunedNode->GetName(),
+                built[prunedIndex].subtreeSize, inactiveNode->GetName(),
+                built[inactiveIndex].subtreeSize);
+
+   // The pruned node itself is visited, only its descendants are left out
+   const std::pair<size_t, size_t> prunedRange{prunedIndex + 1,
+                                               prunedIndex + built[prunedIndex].subtreeSize};
+   const std::pair<size_t, size_t> inactiveRange{
+      inactiveIndex, inactiveIndex + built[inactiveIndex].subtreeSize};
+   const Node* const root = scene.GetRootNode();
+   const std::vector<const Node*> expectedAll = ExpectedOrder(root, built, {});
+   const std::vector<const Node*> expectedActive = ExpectedOrder(root, built, {inactiveRange});
+   const std::vector<const Node*> expectedPruned =
+      ExpectedOrder(root, built, {prunedRange, inactiveRange});
+
+   // Reserved up front, so recording the walks does not allocate either
+   std::vector<const Node*> visitedAll;
+   std::vector<const Node*> visitedActive;
+   std::vector<const Node*> visitedPruned;
+   visitedAll.reserve(expectedAll.size());
+   visitedActive.reserve(expectedAll.size());
+   visitedPruned.reserve(expectedAll.size());
+
+   const size_t allocationsBefore = s_allocationCount.load(std::memory_order_relaxed);
+   scene.ForEachNode([&visitedAll](const Node* const node) { visitedAll.push_back(node); });
+   std::as_const(scene).ForEachNode(
+      [&visitedActive](const Node* const node) { visitedActive.push_back(node); }, true);
+   std::as_const(scene).ForEachNode(
+      [&visitedPruned, prunedNode](const Node* const node) {
+         visitedPruned.push_back(node);
+         return node != prunedNode;
+      },
+      true);
+   const size_t allocations =
+      s_allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+   bool passed = true;
+   if (visitedAll.size() != scene.GetNodeCount()) {
+      std::println(stderr, "Visited {} of {} nodes", visitedAll.size(), scene.GetNodeCount());
+      passed = false;
+   }
+   passed = CheckOrder("Full walk", visitedAll, expectedAll) && passed;
+   passed = CheckOrder("Skipping inactive", visitedActive, expectedActive) && passed;
+   passed = CheckOrder("Pruning and skipping inactive", visitedPruned, expectedPruned) && passed;
+   std::println("Walked the hierarchy 3 times with {} allocations", allocations);
+   if (allocations != 0) {
+      std::println(stderr, "ForEachNode allocated {} times", allocations);
+      passed = false;
+   }
+   return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}